@@ -0,0 +1,785 @@
+#define _GNU_SOURCE
+#include "../multithreading/thread_pool/thread_pool.h"
+#include "../multithreading/mpmc_ring/mpmc_ring.h"
+#include "../multithreading/sharded_counter/sharded_counter.h"
+#include "../multithreading/futex_lock/futex_lock.h"
+#include <getopt.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/utsname.h>
+#include <time.h>
+#include <unistd.h>
+
+// Набор микробенчмарков для отслеживания регрессий между версиями:
+//   pool   — задач в секунду для пустых, 1 мкс и 100 мкс задач
+//            (очередь под мьютексом и work-stealing)
+//   buffer — элементов в секунду через buffer_put/buffer_get
+//            (RingBuffer из condition_variables.c) и mpmc_ring
+//   lock   — нс на критическую секцию для разных блокировок под конкуренцией
+//   counter — нс на инкремент счетчика попаданий (мьютекс, atomic,
+//            шардированный, пакетный)
+// Каждый случай прогоняется warmup раз вхолостую и reps раз с замером;
+// в отчет идут медиана, минимум, максимум и стандартное отклонение.
+//
+// Запуск: ./microbench [--format csv|json] [--output файл] [--reps N]
+//                      [--warmup N] [--threads 1,2,4] [--suite pool,counter]
+
+#define MAX_REPS 100
+#define MAX_THREAD_COUNTS 16
+#define RING_CAPACITY 1024
+#define BUFFER_ITEMS 1000000L
+#define LOCK_OPS_PER_THREAD 200000L
+#define COUNTER_OPS_PER_THREAD 1000000L
+#define COUNTER_BATCH 64
+
+typedef struct bench_case {
+    const char* suite;
+    char name[64];
+    int threads;
+    const char* unit;         // Единица результата
+    long param;               // Параметр случая (длительность задачи и т.п.)
+    int variant;              // Вариант внутри набора
+    void* (*setup)(struct bench_case* c);
+    double (*run)(struct bench_case* c, void* ctx);
+    void (*teardown)(void* ctx);
+} bench_case_t;
+
+typedef struct {
+    const char* format;
+    FILE* out;
+    int reps;
+    int warmup;
+    int thread_counts[MAX_THREAD_COUNTS];
+    int num_thread_counts;
+    const char* suites;
+    bool first_result;        // Для запятых между объектами JSON
+} bench_config_t;
+
+static inline uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// ---------------------------------------------------------------------
+// pool: задачи в секунду
+
+typedef enum { POOL_MUTEX, POOL_WORK_STEALING } pool_mode_t;
+
+// Задача, занимающая процессор заданное число наносекунд
+static void spin_task(void* arg) {
+    uint64_t ns = (uint64_t)(uintptr_t)arg;
+    if (ns == 0) return;
+
+    uint64_t end = now_ns() + ns;
+    while (now_ns() < end) {
+        cpu_relax();
+    }
+}
+
+static void* pool_setup(bench_case_t* c) {
+    thread_pool_options_t options = {
+        .num_threads = c->threads,
+        .work_stealing = c->variant == POOL_WORK_STEALING,
+        .quiet = true,
+    };
+    return thread_pool_create_with_options(&options);
+}
+
+// Задач в одном замере: около 0.1 с работы на поток
+static long pool_task_count(bench_case_t* c) {
+    if (c->param == 0) return 200000;
+    long count = 100000000L / c->param * c->threads;
+    return count < 1000 ? 1000 : count;
+}
+
+static double pool_run(bench_case_t* c, void* ctx) {
+    thread_pool_t* pool = (thread_pool_t*)ctx;
+    long count = pool_task_count(c);
+    void* arg = (void*)(uintptr_t)c->param;
+
+    uint64_t start = now_ns();
+    for (long i = 0; i < count; i++) {
+        thread_pool_add_task(pool, spin_task, arg);
+    }
+    thread_pool_wait(pool);
+    uint64_t elapsed = now_ns() - start;
+
+    return (double)count / ((double)elapsed / 1e9);
+}
+
+static void pool_teardown(void* ctx) {
+    thread_pool_destroy((thread_pool_t*)ctx);
+}
+
+// ---------------------------------------------------------------------
+// buffer: элементов в секунду от производителей к потребителям
+
+typedef enum { BUFFER_MUTEX, BUFFER_MPMC_RING } buffer_mode_t;
+
+#define BUFFER_POISON (-1L)
+
+// Кольцевой буфер на мьютексе, как в condition_variables.c (без printf)
+typedef struct {
+    long buffer[RING_CAPACITY];
+    int count;
+    int in;
+    int out;
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+} RingBuffer;
+
+static void buffer_put(RingBuffer* rb, long value) {
+    pthread_mutex_lock(&rb->mutex);
+    while (rb->count == RING_CAPACITY) {
+        pthread_cond_wait(&rb->not_full, &rb->mutex);
+    }
+    rb->buffer[rb->in] = value;
+    rb->in = (rb->in + 1) % RING_CAPACITY;
+    rb->count++;
+    pthread_cond_signal(&rb->not_empty);
+    pthread_mutex_unlock(&rb->mutex);
+}
+
+static long buffer_get(RingBuffer* rb) {
+    pthread_mutex_lock(&rb->mutex);
+    while (rb->count == 0) {
+        pthread_cond_wait(&rb->not_empty, &rb->mutex);
+    }
+    long value = rb->buffer[rb->out];
+    rb->out = (rb->out + 1) % RING_CAPACITY;
+    rb->count--;
+    pthread_cond_signal(&rb->not_full);
+    pthread_mutex_unlock(&rb->mutex);
+    return value;
+}
+
+typedef struct {
+    RingBuffer rb;
+    mpmc_ring_t ring;
+} buffer_ctx_t;
+
+typedef struct {
+    buffer_ctx_t* ctx;
+    buffer_mode_t mode;
+    long count;
+    long sum;
+} buffer_worker_t;
+
+static void buffer_ctx_put(buffer_ctx_t* ctx, buffer_mode_t mode, long value) {
+    if (mode == BUFFER_MUTEX) {
+        buffer_put(&ctx->rb, value);
+    } else {
+        mpmc_ring_put(&ctx->ring, &value);
+    }
+}
+
+static long buffer_ctx_get(buffer_ctx_t* ctx, buffer_mode_t mode) {
+    if (mode == BUFFER_MUTEX) {
+        return buffer_get(&ctx->rb);
+    }
+    long value;
+    mpmc_ring_get(&ctx->ring, &value);
+    return value;
+}
+
+static void* buffer_producer(void* arg) {
+    buffer_worker_t* w = (buffer_worker_t*)arg;
+    for (long i = 0; i < w->count; i++) {
+        buffer_ctx_put(w->ctx, w->mode, i);
+    }
+    return NULL;
+}
+
+static void* buffer_consumer(void* arg) {
+    buffer_worker_t* w = (buffer_worker_t*)arg;
+    long value;
+    while ((value = buffer_ctx_get(w->ctx, w->mode)) != BUFFER_POISON) {
+        w->sum += value;
+    }
+    return NULL;
+}
+
+static void* buffer_setup(bench_case_t* c) {
+    (void)c;
+    buffer_ctx_t* ctx = calloc(1, sizeof(buffer_ctx_t));
+    if (!ctx) return NULL;
+
+    pthread_mutex_init(&ctx->rb.mutex, NULL);
+    pthread_cond_init(&ctx->rb.not_empty, NULL);
+    pthread_cond_init(&ctx->rb.not_full, NULL);
+    if (mpmc_ring_init(&ctx->ring, RING_CAPACITY, sizeof(long)) != 0) {
+        free(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+// threads — число пар производитель/потребитель
+static double buffer_run(bench_case_t* c, void* ctx) {
+    int pairs = c->threads;
+    pthread_t threads[2 * pairs];
+    buffer_worker_t workers[2 * pairs];
+    long per_producer = BUFFER_ITEMS / pairs;
+
+    uint64_t start = now_ns();
+    for (int i = 0; i < 2 * pairs; i++) {
+        workers[i] = (buffer_worker_t){ctx, (buffer_mode_t)c->variant, per_producer, 0};
+        pthread_create(&threads[i], NULL, i < pairs ? buffer_producer : buffer_consumer,
+                       &workers[i]);
+    }
+    for (int i = 0; i < pairs; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    for (int i = 0; i < pairs; i++) {
+        buffer_ctx_put(ctx, (buffer_mode_t)c->variant, BUFFER_POISON);
+    }
+    long sum = 0;
+    for (int i = pairs; i < 2 * pairs; i++) {
+        pthread_join(threads[i], NULL);
+        sum += workers[i].sum;
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    long expected = (long)pairs * (per_producer * (per_producer - 1) / 2);
+    if (sum != expected) {
+        fprintf(stderr, "%s: неверная сумма %ld, ожидалось %ld\n", c->name, sum, expected);
+        return NAN;
+    }
+    return (double)(per_producer * pairs) / ((double)elapsed / 1e9);
+}
+
+static void buffer_teardown(void* ctx) {
+    buffer_ctx_t* b = (buffer_ctx_t*)ctx;
+    mpmc_ring_destroy(&b->ring);
+    pthread_mutex_destroy(&b->rb.mutex);
+    pthread_cond_destroy(&b->rb.not_empty);
+    pthread_cond_destroy(&b->rb.not_full);
+    free(b);
+}
+
+// ---------------------------------------------------------------------
+// lock: время критической секции под конкуренцией
+
+typedef enum {
+    LOCK_PTHREAD_MUTEX,
+    LOCK_PTHREAD_ADAPTIVE,
+    LOCK_PTHREAD_SPIN,
+    LOCK_PTHREAD_RWLOCK,
+    LOCK_TTAS,
+    LOCK_TICKET,
+    LOCK_FUTEX,
+    LOCK_VARIANTS
+} lock_variant_t;
+
+static const char* lock_names[LOCK_VARIANTS] = {
+    "pthread_mutex", "pthread_mutex_adaptive", "pthread_spinlock",
+    "pthread_rwlock_wr", "ttas_spin_yield", "ticket_spin_yield",
+    "futex_adaptive",
+};
+
+// Сколько раз крутиться перед sched_yield: при потоках больше ядер
+// владелец может быть вытеснен, и чистый спин съедал бы весь квант
+#define SPIN_BEFORE_YIELD 128
+
+typedef struct {
+    lock_variant_t variant;
+    pthread_mutex_t mutex;
+    pthread_spinlock_t spin;
+    pthread_rwlock_t rwlock;
+    futex_mutex_t futex;
+    _Alignas(64) atomic_int ttas;
+    _Alignas(64) atomic_uint ticket_next;
+    atomic_uint ticket_serving;
+    _Alignas(64) long counter;    // Защищаемые данные
+    _Alignas(64) atomic_int start; // Общий старт всех потоков
+} lock_ctx_t;
+
+static void ttas_lock(atomic_int* lock) {
+    int spins = 0;
+    for (;;) {
+        if (!atomic_exchange_explicit(lock, 1, memory_order_acquire)) return;
+        while (atomic_load_explicit(lock, memory_order_relaxed)) {
+            if (++spins < SPIN_BEFORE_YIELD) {
+                cpu_relax();
+            } else {
+                sched_yield();
+            }
+        }
+    }
+}
+
+static void ticket_lock(lock_ctx_t* l) {
+    unsigned int ticket = atomic_fetch_add_explicit(&l->ticket_next, 1, memory_order_relaxed);
+    int spins = 0;
+    while (atomic_load_explicit(&l->ticket_serving, memory_order_acquire) != ticket) {
+        if (++spins < SPIN_BEFORE_YIELD) {
+            cpu_relax();
+        } else {
+            sched_yield();
+        }
+    }
+}
+
+static inline void lock_acquire(lock_ctx_t* l) {
+    switch (l->variant) {
+    case LOCK_PTHREAD_MUTEX:
+    case LOCK_PTHREAD_ADAPTIVE: pthread_mutex_lock(&l->mutex); break;
+    case LOCK_PTHREAD_SPIN: pthread_spin_lock(&l->spin); break;
+    case LOCK_PTHREAD_RWLOCK: pthread_rwlock_wrlock(&l->rwlock); break;
+    case LOCK_TTAS: ttas_lock(&l->ttas); break;
+    case LOCK_TICKET: ticket_lock(l); break;
+    case LOCK_FUTEX: futex_mutex_lock(&l->futex); break;
+    default: break;
+    }
+}
+
+static inline void lock_release(lock_ctx_t* l) {
+    switch (l->variant) {
+    case LOCK_PTHREAD_MUTEX:
+    case LOCK_PTHREAD_ADAPTIVE: pthread_mutex_unlock(&l->mutex); break;
+    case LOCK_PTHREAD_SPIN: pthread_spin_unlock(&l->spin); break;
+    case LOCK_PTHREAD_RWLOCK: pthread_rwlock_unlock(&l->rwlock); break;
+    case LOCK_TTAS: atomic_store_explicit(&l->ttas, 0, memory_order_release); break;
+    case LOCK_TICKET:
+        atomic_store_explicit(&l->ticket_serving,
+                              atomic_load_explicit(&l->ticket_serving, memory_order_relaxed) + 1,
+                              memory_order_release);
+        break;
+    case LOCK_FUTEX: futex_mutex_unlock(&l->futex); break;
+    default: break;
+    }
+}
+
+static void* lock_worker(void* arg) {
+    lock_ctx_t* l = (lock_ctx_t*)arg;
+    while (!atomic_load_explicit(&l->start, memory_order_acquire)) {
+        cpu_relax();
+    }
+    for (long i = 0; i < LOCK_OPS_PER_THREAD; i++) {
+        lock_acquire(l);
+        l->counter++;
+        lock_release(l);
+    }
+    return NULL;
+}
+
+static void* lock_setup(bench_case_t* c) {
+    lock_ctx_t* l = NULL;
+    if (posix_memalign((void**)&l, 64, sizeof(lock_ctx_t)) != 0) return NULL;
+    memset(l, 0, sizeof(*l));
+    l->variant = (lock_variant_t)c->variant;
+
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    if (l->variant == LOCK_PTHREAD_ADAPTIVE) {
+        pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_ADAPTIVE_NP);
+    }
+    pthread_mutex_init(&l->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    pthread_spin_init(&l->spin, PTHREAD_PROCESS_PRIVATE);
+    pthread_rwlock_init(&l->rwlock, NULL);
+    futex_mutex_init(&l->futex);
+    return l;
+}
+
+static double lock_run(bench_case_t* c, void* ctx) {
+    lock_ctx_t* l = (lock_ctx_t*)ctx;
+    pthread_t threads[c->threads];
+
+    l->counter = 0;
+    atomic_store(&l->start, 0);
+    for (int i = 0; i < c->threads; i++) {
+        pthread_create(&threads[i], NULL, lock_worker, l);
+    }
+
+    uint64_t start = now_ns();
+    atomic_store_explicit(&l->start, 1, memory_order_release);
+    for (int i = 0; i < c->threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    long ops = LOCK_OPS_PER_THREAD * c->threads;
+    if (l->counter != ops) {
+        fprintf(stderr, "%s: счетчик %ld, ожидалось %ld\n", c->name, l->counter, ops);
+        return NAN;
+    }
+    return (double)elapsed / (double)ops;
+}
+
+static void lock_teardown(void* ctx) {
+    lock_ctx_t* l = (lock_ctx_t*)ctx;
+    pthread_mutex_destroy(&l->mutex);
+    pthread_spin_destroy(&l->spin);
+    pthread_rwlock_destroy(&l->rwlock);
+    free(l);
+}
+
+// ---------------------------------------------------------------------
+// counter: время инкремента счетчика попаданий
+
+typedef enum {
+    COUNTER_MUTEX,
+    COUNTER_ATOMIC,
+    COUNTER_SHARDED,
+    COUNTER_BATCHED,
+    COUNTER_VARIANTS
+} counter_variant_t;
+
+static const char* counter_names[COUNTER_VARIANTS] = {
+    "mutex", "atomic_fetch_add", "sharded", "batched_64",
+};
+
+typedef struct {
+    counter_variant_t variant;
+    pthread_mutex_t mutex;
+    _Alignas(64) uint64_t plain;
+    atomic_counter_t atomic;
+    sharded_counter_t sharded;
+    _Alignas(64) atomic_int start;
+} counter_ctx_t;
+
+static void* counter_worker(void* arg) {
+    counter_ctx_t* c = (counter_ctx_t*)arg;
+    while (!atomic_load_explicit(&c->start, memory_order_acquire)) {
+        cpu_relax();
+    }
+
+    counter_batch_t batch;
+    counter_batch_init(&batch, &c->atomic, COUNTER_BATCH);
+    for (long i = 0; i < COUNTER_OPS_PER_THREAD; i++) {
+        switch (c->variant) {
+        case COUNTER_MUTEX:
+            pthread_mutex_lock(&c->mutex);
+            c->plain++;
+            pthread_mutex_unlock(&c->mutex);
+            break;
+        case COUNTER_ATOMIC: atomic_counter_add(&c->atomic, 1); break;
+        case COUNTER_SHARDED: sharded_counter_add(&c->sharded, 1); break;
+        case COUNTER_BATCHED: counter_batch_add(&batch, 1); break;
+        default: break;
+        }
+    }
+    counter_batch_flush(&batch);
+    return NULL;
+}
+
+static void* counter_setup(bench_case_t* bc) {
+    counter_ctx_t* c = NULL;
+    if (posix_memalign((void**)&c, 64, sizeof(counter_ctx_t)) != 0) return NULL;
+    memset(c, 0, sizeof(*c));
+    c->variant = (counter_variant_t)bc->variant;
+    pthread_mutex_init(&c->mutex, NULL);
+    atomic_counter_init(&c->atomic);
+    if (sharded_counter_init(&c->sharded, (unsigned int)bc->threads) != 0) {
+        free(c);
+        return NULL;
+    }
+    return c;
+}
+
+static double counter_run(bench_case_t* bc, void* ctx) {
+    counter_ctx_t* c = (counter_ctx_t*)ctx;
+    pthread_t threads[bc->threads];
+
+    uint64_t before = c->plain + atomic_counter_read(&c->atomic) +
+                      sharded_counter_read(&c->sharded);
+    atomic_store(&c->start, 0);
+    for (int i = 0; i < bc->threads; i++) {
+        pthread_create(&threads[i], NULL, counter_worker, c);
+    }
+
+    uint64_t start = now_ns();
+    atomic_store_explicit(&c->start, 1, memory_order_release);
+    for (int i = 0; i < bc->threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    uint64_t added = c->plain + atomic_counter_read(&c->atomic) +
+                     sharded_counter_read(&c->sharded) - before;
+    uint64_t ops = (uint64_t)COUNTER_OPS_PER_THREAD * (uint64_t)bc->threads;
+    if (added != ops) {
+        fprintf(stderr, "%s: прибавлено %llu, ожидалось %llu\n", bc->name,
+                (unsigned long long)added, (unsigned long long)ops);
+        return NAN;
+    }
+    // Время одного инкремента с точки зрения потока
+    return (double)elapsed / (double)COUNTER_OPS_PER_THREAD;
+}
+
+static void counter_teardown(void* ctx) {
+    counter_ctx_t* c = (counter_ctx_t*)ctx;
+    pthread_mutex_destroy(&c->mutex);
+    sharded_counter_destroy(&c->sharded);
+    free(c);
+}
+
+// ---------------------------------------------------------------------
+// Прогон и отчет
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void report(bench_config_t* cfg, const bench_case_t* c, double* samples, int n) {
+    qsort(samples, (size_t)n, sizeof(double), compare_double);
+    double median = n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    double mean = 0, var = 0;
+    for (int i = 0; i < n; i++) mean += samples[i];
+    mean /= n;
+    for (int i = 0; i < n; i++) var += (samples[i] - mean) * (samples[i] - mean);
+    double stddev = n > 1 ? sqrt(var / (n - 1)) : 0;
+
+    if (strcmp(cfg->format, "json") == 0) {
+        fprintf(cfg->out, "%s\n    {\"suite\": \"%s\", \"case\": \"%s\", \"threads\": %d, "
+                          "\"unit\": \"%s\", \"reps\": %d, \"median\": %.6g, \"min\": %.6g, "
+                          "\"max\": %.6g, \"mean\": %.6g, \"stddev\": %.6g}",
+                cfg->first_result ? "" : ",", c->suite, c->name, c->threads, c->unit, n,
+                median, samples[0], samples[n - 1], mean, stddev);
+        cfg->first_result = false;
+    } else {
+        fprintf(cfg->out, "%s,%s,%d,%s,%d,%.6g,%.6g,%.6g,%.6g,%.6g\n",
+                c->suite, c->name, c->threads, c->unit, n,
+                median, samples[0], samples[n - 1], mean, stddev);
+    }
+    fflush(cfg->out);
+
+    fprintf(stderr, "  %-8s %-28s потоков %3d: %12.4g %s (разброс %.1f%%)\n",
+            c->suite, c->name, c->threads, median, c->unit,
+            median != 0 ? 100.0 * stddev / median : 0.0);
+}
+
+static void run_case(bench_config_t* cfg, bench_case_t* c) {
+    void* ctx = c->setup(c);
+    if (!ctx) {
+        fprintf(stderr, "%s/%s: не удалось подготовить случай\n", c->suite, c->name);
+        return;
+    }
+
+    for (int i = 0; i < cfg->warmup; i++) {
+        c->run(c, ctx);
+    }
+
+    double samples[MAX_REPS];
+    int n = 0;
+    for (int i = 0; i < cfg->reps; i++) {
+        double value = c->run(c, ctx);
+        if (!isnan(value)) samples[n++] = value;
+    }
+    c->teardown(ctx);
+
+    if (n > 0) {
+        report(cfg, c, samples, n);
+    }
+}
+
+static bool suite_enabled(const bench_config_t* cfg, const char* suite) {
+    if (!cfg->suites) return true;
+
+    size_t len = strlen(suite);
+    for (const char* p = cfg->suites; (p = strstr(p, suite)) != NULL; p += len) {
+        bool starts = p == cfg->suites || p[-1] == ',';
+        bool ends = p[len] == '\0' || p[len] == ',';
+        if (starts && ends) return true;
+    }
+    return false;
+}
+
+static void run_pool_suite(bench_config_t* cfg) {
+    static const struct {
+        const char* name;
+        long ns;
+    } kinds[] = {{"empty", 0}, {"1us", 1000}, {"100us", 100000}};
+    static const char* modes[] = {"mutex", "ws"};
+
+    for (size_t k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++) {
+        for (int mode = POOL_MUTEX; mode <= POOL_WORK_STEALING; mode++) {
+            for (int t = 0; t < cfg->num_thread_counts; t++) {
+                bench_case_t c = {
+                    .suite = "pool", .threads = cfg->thread_counts[t], .unit = "tasks/s",
+                    .param = kinds[k].ns, .variant = mode,
+                    .setup = pool_setup, .run = pool_run, .teardown = pool_teardown,
+                };
+                snprintf(c.name, sizeof(c.name), "%s_%s", kinds[k].name, modes[mode]);
+                run_case(cfg, &c);
+            }
+        }
+    }
+}
+
+static void run_buffer_suite(bench_config_t* cfg) {
+    static const char* names[] = {"ringbuffer_mutex", "mpmc_ring"};
+
+    for (int mode = BUFFER_MUTEX; mode <= BUFFER_MPMC_RING; mode++) {
+        for (int t = 0; t < cfg->num_thread_counts; t++) {
+            bench_case_t c = {
+                .suite = "buffer", .threads = cfg->thread_counts[t], .unit = "items/s",
+                .variant = mode,
+                .setup = buffer_setup, .run = buffer_run, .teardown = buffer_teardown,
+            };
+            snprintf(c.name, sizeof(c.name), "%s", names[mode]);
+            run_case(cfg, &c);
+        }
+    }
+}
+
+static void run_lock_suite(bench_config_t* cfg) {
+    for (int v = 0; v < LOCK_VARIANTS; v++) {
+        for (int t = 0; t < cfg->num_thread_counts; t++) {
+            bench_case_t c = {
+                .suite = "lock", .threads = cfg->thread_counts[t], .unit = "ns/op",
+                .variant = v,
+                .setup = lock_setup, .run = lock_run, .teardown = lock_teardown,
+            };
+            snprintf(c.name, sizeof(c.name), "%s", lock_names[v]);
+            run_case(cfg, &c);
+        }
+    }
+}
+
+static void run_counter_suite(bench_config_t* cfg) {
+    for (int v = 0; v < COUNTER_VARIANTS; v++) {
+        for (int t = 0; t < cfg->num_thread_counts; t++) {
+            bench_case_t c = {
+                .suite = "counter", .threads = cfg->thread_counts[t], .unit = "ns/op",
+                .variant = v,
+                .setup = counter_setup, .run = counter_run, .teardown = counter_teardown,
+            };
+            snprintf(c.name, sizeof(c.name), "%s", counter_names[v]);
+            run_case(cfg, &c);
+        }
+    }
+}
+
+// Разбор списка "1,2,4,8"
+static int parse_thread_counts(bench_config_t* cfg, const char* list) {
+    cfg->num_thread_counts = 0;
+    const char* p = list;
+    while (*p && cfg->num_thread_counts < MAX_THREAD_COUNTS) {
+        char* end;
+        long n = strtol(p, &end, 10);
+        if (end == p || n <= 0 || n > 1024) return -1;
+        cfg->thread_counts[cfg->num_thread_counts++] = (int)n;
+        p = *end == ',' ? end + 1 : end;
+        if (*end != ',' && *end != '\0') return -1;
+    }
+    return cfg->num_thread_counts > 0 ? 0 : -1;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "Запуск: %s [--format csv|json] [--output файл] [--reps N] [--warmup N]\n"
+            "           [--threads 1,2,4] [--suite pool,buffer,lock,counter]\n", prog);
+}
+
+int main(int argc, char* argv[]) {
+    bench_config_t cfg = {
+        .format = "csv",
+        .out = stdout,
+        .reps = 5,
+        .warmup = 1,
+        .first_result = true,
+    };
+
+    // По умолчанию степени двойки до удвоенного числа процессоров:
+    // хватает, чтобы увидеть конкуренцию, и не слишком долго
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) cpus = 1;
+    for (int n = 1; n <= 2 * cpus && cfg.num_thread_counts < MAX_THREAD_COUNTS; n *= 2) {
+        cfg.thread_counts[cfg.num_thread_counts++] = n;
+    }
+
+    static const struct option long_options[] = {
+        {"format", required_argument, NULL, 'f'},
+        {"output", required_argument, NULL, 'o'},
+        {"reps", required_argument, NULL, 'r'},
+        {"warmup", required_argument, NULL, 'w'},
+        {"threads", required_argument, NULL, 't'},
+        {"suite", required_argument, NULL, 's'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0},
+    };
+
+    const char* output = NULL;
+    int opt;
+    while ((opt = getopt_long(argc, argv, "f:o:r:w:t:s:h", long_options, NULL)) != -1) {
+        switch (opt) {
+        case 'f': cfg.format = optarg; break;
+        case 'o': output = optarg; break;
+        case 'r': cfg.reps = atoi(optarg); break;
+        case 'w': cfg.warmup = atoi(optarg); break;
+        case 's': cfg.suites = optarg; break;
+        case 't':
+            if (parse_thread_counts(&cfg, optarg) != 0) {
+                fprintf(stderr, "Неверный список потоков: %s\n", optarg);
+                return 1;
+            }
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (strcmp(cfg.format, "csv") != 0 && strcmp(cfg.format, "json") != 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (cfg.reps < 1) cfg.reps = 1;
+    if (cfg.reps > MAX_REPS) cfg.reps = MAX_REPS;
+    if (cfg.warmup < 0) cfg.warmup = 0;
+
+    if (output) {
+        cfg.out = fopen(output, "w");
+        if (!cfg.out) {
+            perror(output);
+            return 1;
+        }
+    }
+
+    // Описание машины — чтобы сравнивать только сопоставимые прогоны
+    struct utsname uts;
+    uname(&uts);
+    time_t now = time(NULL);
+    char date[32];
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+    if (strcmp(cfg.format, "json") == 0) {
+        fprintf(cfg.out, "{\n  \"meta\": {\"date\": \"%s\", \"host\": \"%s\", \"kernel\": \"%s\", "
+                         "\"cpus\": %ld, \"reps\": %d, \"warmup\": %d},\n  \"results\": [",
+                date, uts.nodename, uts.release, cpus, cfg.reps, cfg.warmup);
+    } else {
+        fprintf(cfg.out, "suite,case,threads,unit,reps,median,min,max,mean,stddev\n");
+    }
+    fprintf(stderr, "%s, ядро %s, CPU %ld, повторов %d, прогрев %d\n",
+            date, uts.release, cpus, cfg.reps, cfg.warmup);
+
+    if (suite_enabled(&cfg, "pool")) run_pool_suite(&cfg);
+    if (suite_enabled(&cfg, "buffer")) run_buffer_suite(&cfg);
+    if (suite_enabled(&cfg, "lock")) run_lock_suite(&cfg);
+    if (suite_enabled(&cfg, "counter")) run_counter_suite(&cfg);
+
+    if (strcmp(cfg.format, "json") == 0) {
+        fprintf(cfg.out, "\n  ]\n}\n");
+    }
+    if (cfg.out != stdout) {
+        fclose(cfg.out);
+    }
+    return 0;
+}
@@ -0,0 +1,60 @@
+#ifndef COMMON_FUTEX_H
+#define COMMON_FUTEX_H
+
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+// Тонкие обертки над системным вызовом futex(2).
+//
+// shared = false — слово futex используется потоками одного процесса
+// (FUTEX_PRIVATE_FLAG, ядро не ищет разделяемое отображение);
+// shared = true — слово лежит в разделяемой памяти нескольких процессов.
+
+// Ожидание, пока *addr == expected. deadline — абсолютное время по
+// CLOCK_MONOTONIC или NULL (без ограничения). Возвращает 0 после пробуждения,
+// EAGAIN, если значение уже отличается, ETIMEDOUT или EINTR.
+static inline int futex_wait(const void* addr, uint32_t expected,
+                             const struct timespec* deadline, bool shared) {
+    int op = FUTEX_WAIT_BITSET | (shared ? 0 : FUTEX_PRIVATE_FLAG);
+    long rc = syscall(SYS_futex, addr, op, expected, deadline, NULL, FUTEX_BITSET_MATCH_ANY);
+    return rc == 0 ? 0 : errno;
+}
+
+// Пробуждение до count потоков, ожидающих на addr. Возвращает число разбуженных.
+static inline int futex_wake(const void* addr, int count, bool shared) {
+    int op = FUTEX_WAKE | (shared ? 0 : FUTEX_PRIVATE_FLAG);
+    long rc = syscall(SYS_futex, addr, op, count, NULL, NULL, 0);
+    return rc < 0 ? 0 : (int)rc;
+}
+
+// Пробуждение до wake потоков, ожидающих на addr, и перенос остальных
+// (до requeue) в очередь addr2 без пробуждения. Выполняется, только если
+// *addr все еще == expected. Возвращает число разбуженных и перенесенных
+// потоков или -1 (errno = EAGAIN, если значение уже изменилось).
+static inline int futex_requeue(const void* addr, uint32_t expected, int wake,
+                                const void* addr2, int requeue, bool shared) {
+    int op = FUTEX_CMP_REQUEUE | (shared ? 0 : FUTEX_PRIVATE_FLAG);
+    long rc = syscall(SYS_futex, addr, op, wake, (unsigned long)requeue, addr2, expected);
+    return rc < 0 ? -1 : (int)rc;
+}
+
+// Абсолютный момент CLOCK_MONOTONIC через timeout_ms от текущего
+static inline struct timespec futex_deadline_ms(long timeout_ms) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (timeout_ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+#endif // COMMON_FUTEX_H
@@ -0,0 +1,464 @@
+#define _GNU_SOURCE
+#include "async_log.h"
+#include "../common/futex.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#define ASYNC_LOG_CACHE_LINE 64
+#define ASYNC_LOG_PREFIX_MAX 32
+// Сколько iovec собирать в один writev (по два на кольцо при переходе
+// через конец и одна строка о пропущенных)
+#define ASYNC_LOG_BATCH_IOV 256
+
+// Кольцо байт одного потока. head пишет только владелец, tail — только
+// фоновый поток. Кольца не освобождаются до async_log_close: при
+// завершении потока кольцо освобождается и достается следующему новому
+// потоку вместе с еще не записанными данными.
+typedef struct log_ring {
+    _Alignas(ASYNC_LOG_CACHE_LINE) _Atomic uint64_t head;
+    _Atomic uint64_t lines;   // Счетчики владельца (один писатель)
+    _Atomic uint64_t dropped;
+
+    _Alignas(ASYNC_LOG_CACHE_LINE) _Atomic uint64_t tail;
+
+    _Alignas(ASYNC_LOG_CACHE_LINE) atomic_bool owned;
+    struct log_ring* next;    // Не меняется после публикации
+    char* data;
+    uint64_t mask;
+} log_ring_t;
+
+static struct {
+    _Atomic(log_ring_t*) rings; // Список колец (добавление в голову)
+    int fd;
+    char* path;
+    size_t ring_size;
+    int flush_interval_ms;
+    pthread_t writer;
+    pthread_key_t key;
+    atomic_uint generation;   // Растет при каждом открытии (0 — закрыт)
+
+    _Atomic uint32_t wake;    // futex: есть работа для фонового потока
+    atomic_bool reopen;
+    atomic_bool stop;
+    atomic_bool idle;         // Фоновый поток спит без тайм-аута
+
+    _Atomic uint64_t writes;  // Счетчики фонового потока
+    _Atomic uint64_t bytes;
+    uint64_t dropped_reported;
+    async_log_stats_t final_stats; // Итог последнего закрытого журнала
+} logger = { .fd = -1 };
+
+// Кольцо текущего потока и поколение журнала, к которому оно относится
+static _Thread_local log_ring_t* thread_ring;
+static _Thread_local unsigned int thread_generation;
+
+// Кэш метки времени потока: пересчитывается раз в секунду
+static _Thread_local time_t prefix_sec = -1;
+static _Thread_local char prefix[ASYNC_LOG_PREFIX_MAX];
+static _Thread_local size_t prefix_len;
+
+static size_t format_prefix(time_t sec, char* buf) {
+    struct tm tm_info;
+    localtime_r(&sec, &tm_info);
+    return strftime(buf, ASYNC_LOG_PREFIX_MAX, "[%Y-%m-%d %H:%M:%S] ", &tm_info);
+}
+
+static void async_log_wake(void) {
+    atomic_fetch_add_explicit(&logger.wake, 1, memory_order_release);
+    futex_wake(&logger.wake, 1, false);
+}
+
+// При завершении потока его кольцо становится свободным
+static void async_log_release_ring(void* arg) {
+    log_ring_t* ring = (log_ring_t*)arg;
+    atomic_store_explicit(&ring->owned, false, memory_order_release);
+}
+
+static log_ring_t* async_log_thread_ring(void) {
+    unsigned int generation = atomic_load_explicit(&logger.generation, memory_order_acquire);
+    if (generation == 0) {
+        return NULL;
+    }
+    if (thread_ring != NULL && thread_generation == generation) {
+        return thread_ring;
+    }
+
+    // Сначала свободное кольцо завершившегося потока
+    log_ring_t* ring = atomic_load_explicit(&logger.rings, memory_order_acquire);
+    for (; ring != NULL; ring = ring->next) {
+        bool expected = false;
+        if (!atomic_load_explicit(&ring->owned, memory_order_relaxed) &&
+            atomic_compare_exchange_strong_explicit(&ring->owned, &expected, true,
+                                                    memory_order_acquire,
+                                                    memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    if (ring == NULL) {
+        ring = (log_ring_t*)aligned_alloc(ASYNC_LOG_CACHE_LINE, sizeof(log_ring_t));
+        char* data = (char*)malloc(logger.ring_size);
+        if (!ring || !data) {
+            free(ring);
+            free(data);
+            return NULL;
+        }
+        memset(ring, 0, sizeof(*ring));
+        ring->data = data;
+        ring->mask = logger.ring_size - 1;
+        atomic_init(&ring->owned, true);
+
+        log_ring_t* head = atomic_load_explicit(&logger.rings, memory_order_relaxed);
+        do {
+            ring->next = head;
+        } while (!atomic_compare_exchange_weak_explicit(&logger.rings, &head, ring,
+                                                        memory_order_release,
+                                                        memory_order_relaxed));
+    }
+
+    pthread_setspecific(logger.key, ring);
+    thread_ring = ring;
+    thread_generation = generation;
+    return ring;
+}
+
+int async_log_vprintf(const char* format, va_list args) {
+    log_ring_t* ring = async_log_thread_ring();
+    if (ring == NULL) {
+        errno = EBADF;
+        return -1;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME_COARSE, &now);
+    if (now.tv_sec != prefix_sec) {
+        prefix_len = format_prefix(now.tv_sec, prefix);
+        prefix_sec = now.tv_sec;
+    }
+
+    char line[ASYNC_LOG_LINE_MAX];
+    memcpy(line, prefix, prefix_len);
+    size_t len = prefix_len;
+    int n = vsnprintf(line + len, sizeof(line) - len, format, args);
+    if (n > 0) {
+        len += (size_t)n < sizeof(line) - len ? (size_t)n : sizeof(line) - len - 1;
+    }
+    line[len++] = '\n';
+
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    uint64_t size = ring->mask + 1;
+    if (size - (head - tail) < len) {
+        atomic_store_explicit(&ring->dropped,
+                              atomic_load_explicit(&ring->dropped, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+        errno = ENOBUFS;
+        return -1;
+    }
+
+    size_t offset = (size_t)(head & ring->mask);
+    size_t first = size - offset < len ? size - offset : len;
+    memcpy(ring->data + offset, line, first);
+    memcpy(ring->data, line + first, len - first);
+    atomic_store_explicit(&ring->head, head + len, memory_order_release);
+    atomic_store_explicit(&ring->lines,
+                          atomic_load_explicit(&ring->lines, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+
+    // Фоновый поток будится, если он заснул без тайм-аута (все кольца были
+    // пусты) или кольцо перешло через половину; остальное он заберет
+    // по таймеру. Барьер парный барьеру в async_log_writer: либо поток
+    // журнала увидит новый head, либо здесь будет виден флаг idle.
+    atomic_thread_fence(memory_order_seq_cst);
+    uint64_t half = size / 2;
+    if ((atomic_load_explicit(&logger.idle, memory_order_relaxed) &&
+         atomic_exchange_explicit(&logger.idle, false, memory_order_relaxed)) ||
+        (head - tail < half && head + len - tail >= half)) {
+        async_log_wake();
+    }
+    return 0;
+}
+
+int async_log_printf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int rc = async_log_vprintf(format, args);
+    va_end(args);
+    return rc;
+}
+
+void async_log_reopen(void) {
+    atomic_store_explicit(&logger.reopen, true, memory_order_relaxed);
+    async_log_wake();
+}
+
+static bool async_log_pending(void) {
+    log_ring_t* ring = atomic_load_explicit(&logger.rings, memory_order_acquire);
+    for (; ring != NULL; ring = ring->next) {
+        if (atomic_load_explicit(&ring->head, memory_order_relaxed) !=
+            atomic_load_explicit(&ring->tail, memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint64_t async_log_total_dropped(void) {
+    uint64_t dropped = 0;
+    log_ring_t* ring = atomic_load_explicit(&logger.rings, memory_order_acquire);
+    for (; ring != NULL; ring = ring->next) {
+        dropped += atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+    }
+    return dropped;
+}
+
+// Запись iov целиком (с учетом частичной записи). При ошибке данные
+// отбрасываются: фоновый поток не должен застревать на сломанном файле.
+static void async_log_writev(struct iovec* iov, int count) {
+    uint64_t total = 0;
+    while (count > 0) {
+        ssize_t n = writev(logger.fd, iov, count);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        total += (uint64_t)n;
+        while (count > 0 && (size_t)n >= iov->iov_len) {
+            n -= (ssize_t)iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char*)iov->iov_base + n;
+            iov->iov_len -= (size_t)n;
+        }
+        atomic_store_explicit(&logger.writes,
+                              atomic_load_explicit(&logger.writes, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+    }
+    atomic_store_explicit(&logger.bytes,
+                          atomic_load_explicit(&logger.bytes, memory_order_relaxed) + total,
+                          memory_order_relaxed);
+}
+
+// Один проход по всем кольцам: все, что накоплено, уходит пакетами
+// по ASYNC_LOG_BATCH_IOV. Возвращает число записанных байт.
+static uint64_t async_log_drain(void) {
+    struct iovec iov[ASYNC_LOG_BATCH_IOV];
+    log_ring_t* batch_rings[ASYNC_LOG_BATCH_IOV];
+    uint64_t batch_heads[ASYNC_LOG_BATCH_IOV];
+    int iov_count = 0;
+    int ring_count = 0;
+    uint64_t drained = 0;
+
+    // Строка о пропущенных идет первой в пакете
+    char note[ASYNC_LOG_PREFIX_MAX + 64];
+    uint64_t dropped = async_log_total_dropped();
+    if (dropped > logger.dropped_reported) {
+        size_t len = format_prefix(time(NULL), note);
+        len += (size_t)snprintf(note + len, sizeof(note) - len, "async_log: пропущено %llu строк\n",
+                                (unsigned long long)(dropped - logger.dropped_reported));
+        iov[iov_count].iov_base = note;
+        iov[iov_count].iov_len = len;
+        iov_count++;
+        logger.dropped_reported = dropped;
+    }
+
+    log_ring_t* ring = atomic_load_explicit(&logger.rings, memory_order_acquire);
+    while (ring != NULL || iov_count > 0) {
+        if (ring != NULL) {
+            uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+            uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+            if (head != tail) {
+                uint64_t size = ring->mask + 1;
+                size_t offset = (size_t)(tail & ring->mask);
+                size_t len = (size_t)(head - tail);
+                size_t first = size - offset < len ? size - offset : len;
+                iov[iov_count].iov_base = ring->data + offset;
+                iov[iov_count].iov_len = first;
+                iov_count++;
+                if (first < len) {
+                    iov[iov_count].iov_base = ring->data;
+                    iov[iov_count].iov_len = len - first;
+                    iov_count++;
+                }
+                batch_rings[ring_count] = ring;
+                batch_heads[ring_count] = head;
+                ring_count++;
+                drained += len;
+            }
+            ring = ring->next;
+            if (ring != NULL && iov_count + 2 <= ASYNC_LOG_BATCH_IOV) continue;
+        }
+
+        if (iov_count > 0) {
+            async_log_writev(iov, iov_count);
+        }
+        for (int i = 0; i < ring_count; i++) {
+            atomic_store_explicit(&batch_rings[i]->tail, batch_heads[i], memory_order_release);
+        }
+        iov_count = 0;
+        ring_count = 0;
+    }
+    return drained;
+}
+
+static void* async_log_writer(void* arg) {
+    (void)arg;
+    while (true) {
+        uint32_t seen = atomic_load_explicit(&logger.wake, memory_order_acquire);
+        bool stop = atomic_load_explicit(&logger.stop, memory_order_acquire);
+
+        if (atomic_exchange_explicit(&logger.reopen, false, memory_order_relaxed)) {
+            // Старый файл дописывается до переоткрытия
+            async_log_drain();
+            int fd = open(logger.path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+            if (fd >= 0) {
+                close(logger.fd);
+                logger.fd = fd;
+            }
+        }
+
+        uint64_t drained = async_log_drain();
+        if (stop) {
+            // После остановки писатели могли успеть дописать еще что-то
+            if (drained == 0) break;
+            continue;
+        }
+
+        if (drained > 0) {
+            // Пока строки идут, они копятся flush_interval_ms до следующего writev
+            struct timespec deadline = futex_deadline_ms(logger.flush_interval_ms);
+            futex_wait(&logger.wake, seen, &deadline, false);
+            continue;
+        }
+
+        // Журнал пуст: сон без тайм-аута до первой новой строки
+        atomic_store_explicit(&logger.idle, true, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (!async_log_pending()) {
+            futex_wait(&logger.wake, seen, NULL, false);
+        }
+        atomic_store_explicit(&logger.idle, false, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+int async_log_open(const char* path, const async_log_options_t* options) {
+    if (atomic_load_explicit(&logger.generation, memory_order_relaxed) != 0) {
+        errno = EBUSY;
+        return -1;
+    }
+
+    size_t ring_size = options && options->ring_size > 0 ?
+                       options->ring_size : ASYNC_LOG_DEFAULT_RING_SIZE;
+    if (ring_size < 2 * ASYNC_LOG_LINE_MAX) ring_size = 2 * ASYNC_LOG_LINE_MAX;
+    size_t size = 1;
+    while (size < ring_size) {
+        size <<= 1;
+    }
+    logger.ring_size = size;
+    logger.flush_interval_ms = options && options->flush_interval_ms > 0 ?
+                               options->flush_interval_ms : ASYNC_LOG_DEFAULT_FLUSH_MS;
+
+    logger.path = strdup(path);
+    if (!logger.path) {
+        errno = ENOMEM;
+        return -1;
+    }
+    logger.fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (logger.fd < 0) {
+        int saved = errno;
+        free(logger.path);
+        errno = saved;
+        return -1;
+    }
+
+    int rc = pthread_key_create(&logger.key, async_log_release_ring);
+    if (rc != 0) {
+        close(logger.fd);
+        free(logger.path);
+        errno = rc;
+        return -1;
+    }
+
+    atomic_store(&logger.rings, NULL);
+    atomic_store(&logger.reopen, false);
+    atomic_store(&logger.stop, false);
+    atomic_store(&logger.idle, false);
+    atomic_store(&logger.writes, 0);
+    atomic_store(&logger.bytes, 0);
+    logger.dropped_reported = 0;
+
+    // Фоновый поток не принимает сигналы: они должны доставляться
+    // потокам демона, иначе, например, SIGTERM не прервет sleep() в главном
+    sigset_t all, saved;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &saved);
+    rc = pthread_create(&logger.writer, NULL, async_log_writer, NULL);
+    pthread_sigmask(SIG_SETMASK, &saved, NULL);
+    if (rc != 0) {
+        pthread_key_delete(logger.key);
+        close(logger.fd);
+        free(logger.path);
+        errno = rc;
+        return -1;
+    }
+
+    // Поколение 0 означает «закрыт», поэтому при переполнении пропускается
+    static unsigned int last_generation;
+    if (++last_generation == 0) last_generation = 1;
+    atomic_store_explicit(&logger.generation, last_generation, memory_order_release);
+    return 0;
+}
+
+void async_log_close(void) {
+    if (atomic_load_explicit(&logger.generation, memory_order_relaxed) == 0) {
+        return;
+    }
+    atomic_store_explicit(&logger.stop, true, memory_order_release);
+    async_log_wake();
+    pthread_join(logger.writer, NULL);
+    async_log_get_stats(&logger.final_stats);
+    atomic_store_explicit(&logger.generation, 0, memory_order_release);
+
+    log_ring_t* ring = atomic_exchange(&logger.rings, NULL);
+    while (ring != NULL) {
+        log_ring_t* next = ring->next;
+        free(ring->data);
+        free(ring);
+        ring = next;
+    }
+    pthread_key_delete(logger.key);
+    close(logger.fd);
+    logger.fd = -1;
+    free(logger.path);
+    logger.path = NULL;
+}
+
+void async_log_get_stats(async_log_stats_t* stats) {
+    if (atomic_load_explicit(&logger.generation, memory_order_acquire) == 0) {
+        *stats = logger.final_stats;
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+    log_ring_t* ring = atomic_load_explicit(&logger.rings, memory_order_acquire);
+    for (; ring != NULL; ring = ring->next) {
+        stats->lines += atomic_load_explicit(&ring->lines, memory_order_relaxed);
+        stats->dropped += atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+        stats->rings++;
+    }
+    stats->writes = atomic_load_explicit(&logger.writes, memory_order_relaxed);
+    stats->bytes = atomic_load_explicit(&logger.bytes, memory_order_relaxed);
+}
@@ -0,0 +1,65 @@
+#ifndef ASYNC_LOG_H
+#define ASYNC_LOG_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Асинхронный журнал демона: один на процесс.
+//
+// Каждый поток форматирует строку в собственное кольцо байт (один
+// писатель — поток, один читатель — фоновый поток журнала), без
+// блокировок и почти всегда без системных вызовов. Фоновый поток раз
+// в flush_interval_ms или когда какое-то кольцо заполнено наполовину
+// собирает накопленное из всех колец в один writev() в постоянно открытый
+// файл. Пока строк нет, фоновый поток спит без тайм-аута и будится первой
+// новой строкой.
+//
+// Метка времени берется из CLOCK_REALTIME_COARSE и форматируется не чаще
+// раза в секунду на поток. Если в кольце нет места, строка отбрасывается
+// и учитывается в счетчике; фоновый поток дописывает в журнал, сколько
+// строк пропущено. Вызывающий поток никогда не ждет.
+//
+// Демон вызывает async_log_open после daemonize(): fork() не переносит
+// фоновый поток в дочерний процесс.
+
+#define ASYNC_LOG_LINE_MAX 1024                   // Длина строки с меткой времени
+#define ASYNC_LOG_DEFAULT_RING_SIZE (64 * 1024)   // Кольцо одного потока
+#define ASYNC_LOG_DEFAULT_FLUSH_MS 50
+
+typedef struct {
+    size_t ring_size;         // Размер кольца потока (0 — по умолчанию;
+                              // округляется вверх до степени двойки)
+    int flush_interval_ms;    // Наибольшая задержка записи (0 — по умолчанию)
+} async_log_options_t;
+
+typedef struct {
+    uint64_t lines;           // Принято строк
+    uint64_t dropped;         // Отброшено из-за нехватки места
+    uint64_t writes;          // Вызовов writev
+    uint64_t bytes;           // Записано байт
+    int rings;                // Колец потоков
+} async_log_stats_t;
+
+// Открытие файла path (O_APPEND) и запуск фонового потока.
+// options может быть NULL. Возвращает 0 или -1 с errno.
+int async_log_open(const char* path, const async_log_options_t* options);
+
+// Запись всего накопленного, остановка фонового потока и закрытие файла.
+// Вызывается, когда остальные потоки уже не пишут в журнал.
+void async_log_close(void);
+
+// Строка журнала; перевод строки добавляется сам. Возвращает 0 или -1
+// (errno = ENOBUFS — строка отброшена, EBADF — журнал не открыт).
+// Не для обработчиков сигналов.
+int async_log_printf(const char* format, ...) __attribute__((format(printf, 1, 2)));
+int async_log_vprintf(const char* format, va_list args);
+
+// Переоткрыть файл (ротация журнала). Безопасна в обработчике сигнала:
+// только выставляет флаг и будит фоновый поток.
+void async_log_reopen(void);
+
+// Счетчики журнала; после async_log_close — итог закрытого журнала
+void async_log_get_stats(async_log_stats_t* stats);
+
+#endif // ASYNC_LOG_H
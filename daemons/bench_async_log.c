@@ -0,0 +1,157 @@
+#include "async_log.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// Строк в секунду: прежний путь simple_daemon.c (open, localtime,
+// strftime, два write и close на каждую строку) против async_log.
+// Для async_log показаны скорость вызывающих потоков и скорость с учетом
+// записи всего накопленного в async_log_close, а также пропущенные
+// строки и сколько строк в среднем уходит одним writev.
+// Запуск: ./bench_async_log [строк_на_поток] [потоки,через,запятую] [файл]
+
+#define DEFAULT_LINES 200000L
+#define DEFAULT_PATH "/tmp/bench_async_log.log"
+// Кольцо потока для замера: с запасом, чтобы пропуски были редкостью
+#define BENCH_RING_SIZE (4 * 1024 * 1024)
+
+typedef struct {
+    const char* path;
+    long lines;
+    pthread_barrier_t* start;
+} worker_arg_t;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Строка так, как ее пишет прежний simple_daemon.c
+static void log_open_write_close(const char* path) {
+    int log_fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (log_fd >= 0) {
+        char buffer[256];
+        time_t now = time(NULL);
+        struct tm* tm_info = localtime(&now);
+        strftime(buffer, 256, "[%Y-%m-%d %H:%M:%S] ", tm_info);
+        if (write(log_fd, buffer, strlen(buffer)) < 0 ||
+            write(log_fd, "Демон работает\n", sizeof("Демон работает\n") - 1) < 0) {
+            perror("write");
+        }
+        close(log_fd);
+    }
+}
+
+static void* sync_worker(void* arg) {
+    worker_arg_t* w = (worker_arg_t*)arg;
+    pthread_barrier_wait(w->start);
+    for (long i = 0; i < w->lines; i++) {
+        log_open_write_close(w->path);
+    }
+    return NULL;
+}
+
+static void* async_worker(void* arg) {
+    worker_arg_t* w = (worker_arg_t*)arg;
+    pthread_barrier_wait(w->start);
+    for (long i = 0; i < w->lines; i++) {
+        async_log_printf("Демон работает, строка %ld", i);
+    }
+    return NULL;
+}
+
+// Запуск threads потоков с общим стартом; возвращает время до их завершения
+static double run_threads(int threads, void* (*fn)(void*), worker_arg_t* w) {
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, (unsigned int)threads + 1);
+    w->start = &start;
+
+    pthread_t tids[threads];
+    for (int i = 0; i < threads; i++) {
+        pthread_create(&tids[i], NULL, fn, w);
+    }
+    // Время засекается до отпускания барьера (см. bench_sharded_counter.c)
+    double begin = now_sec();
+    pthread_barrier_wait(&start);
+    for (int i = 0; i < threads; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    double elapsed = now_sec() - begin;
+    pthread_barrier_destroy(&start);
+    return elapsed;
+}
+
+static long file_lines(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) return -1;
+    long lines = 0;
+    int c;
+    while ((c = getc(f)) != EOF) {
+        if (c == '\n') lines++;
+    }
+    fclose(f);
+    return lines;
+}
+
+int main(int argc, char* argv[]) {
+    long lines = argc > 1 ? atol(argv[1]) : DEFAULT_LINES;
+    const char* list = argc > 2 ? argv[2] : "1,4,16";
+    const char* path = argc > 3 ? argv[3] : DEFAULT_PATH;
+    if (lines <= 0) lines = DEFAULT_LINES;
+
+    printf("Строк на поток: %ld, файл: %s\n\n", lines, path);
+    printf("потоков  вариант             строк/с (вызов)  строк/с (в файле)  "
+           "пропущено  строк на writev\n");
+
+    for (const char* p = list; *p;) {
+        char* end;
+        long threads = strtol(p, &end, 10);
+        if (end == p || threads <= 0) {
+            fprintf(stderr, "Неверный список потоков: %s\n", list);
+            return 1;
+        }
+        p = *end == ',' ? end + 1 : end;
+
+        worker_arg_t w = { .path = path, .lines = lines };
+        long total = lines * threads;
+
+        // Прежний путь: строка попадает в файл до возврата из вызова
+        unlink(path);
+        double elapsed = run_threads((int)threads, sync_worker, &w);
+        long written = file_lines(path);
+        printf("%7ld  %-18s %16.0f %18.0f %10d %16s\n", threads, "open_write_close",
+               total / elapsed, written / elapsed, 0, "-");
+
+        unlink(path);
+        async_log_options_t options = { .ring_size = BENCH_RING_SIZE };
+        if (async_log_open(path, &options) != 0) {
+            perror("async_log_open");
+            return 1;
+        }
+        double begin = now_sec();
+        double submit = run_threads((int)threads, async_worker, &w);
+        async_log_close();
+        double flushed = now_sec() - begin;
+
+        async_log_stats_t stats;
+        async_log_get_stats(&stats);
+        written = file_lines(path);
+        // Кроме принятых строк в файле могут быть строки о пропущенных
+        if (written < (long)stats.lines) {
+            fprintf(stderr, "async_log: в файле %ld строк, принято %llu\n", written,
+                    (unsigned long long)stats.lines);
+            return 1;
+        }
+        printf("%7ld  %-18s %16.0f %18.0f %10llu %16.1f\n", threads, "async_log",
+               total / submit, stats.lines / flushed, (unsigned long long)stats.dropped,
+               stats.writes ? (double)stats.lines / stats.writes : 0.0);
+    }
+    unlink(path);
+    return 0;
+}
@@ -0,0 +1,240 @@
+#include "event_loop.h"
+#include "../common/futex.h"
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+// Время реакции цикла событий: от события в другом потоке до вызова
+// обработчика в потоке цикла.
+//   fd       — запись байта в pipe
+//   signal   — kill() процессу, доставка через signalfd
+//   post     — event_loop_post из другого потока
+//   offload  — пустая задача в пуле и возврат в цикл (из потока цикла)
+//   timer    — отклонение периода таймера 1 мс от заданного
+// В конце цикл простаивает секунду с таймером на 60 с: выходов из
+// epoll_wait за это время (кроме самого запроса счетчика) должно быть 0.
+
+#define SAMPLES 20000
+#define TIMER_MS 1
+#define TIMER_SAMPLES 2000
+#define IDLE_MS 1000
+
+typedef struct {
+    event_loop_t* loop;
+    thread_pool_t* pool;
+    int pipe_fd[2];
+    _Atomic uint64_t sent_ns;    // Когда отправлено текущее событие
+    _Atomic uint32_t ack;        // futex: обработчик получил событие
+    latency_histogram_t fd_latency;
+    latency_histogram_t signal_latency;
+    latency_histogram_t post_latency;
+    latency_histogram_t offload_latency;
+    latency_histogram_t timer_jitter;
+    int offload_left;
+    int timer_id;
+    int timer_left;
+    uint64_t timer_last_ns;
+    uint64_t idle_wakeups;
+} bench_t;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void print_result(const char* name, latency_histogram_t* h) {
+    printf("%-10s avg %8.1f мкс, p50 %8.1f мкс, p99 %8.1f мкс, max %8.1f мкс\n", name,
+           latency_histogram_mean(h) / 1e3,
+           latency_histogram_percentile(h, 0.50) / 1e3,
+           latency_histogram_percentile(h, 0.99) / 1e3,
+           latency_counter_get(&h->max_ns) / 1e3);
+}
+
+// Отпустить поток-отправитель
+static void ack(bench_t* b) {
+    atomic_fetch_add_explicit(&b->ack, 1, memory_order_release);
+    futex_wake(&b->ack, 1, false);
+}
+
+// Обработчик в потоке цикла отмечает задержку и отпускает отправителя
+static void record_and_ack(bench_t* b, latency_histogram_t* h) {
+    latency_histogram_record(h, now_ns() - atomic_load(&b->sent_ns));
+    ack(b);
+}
+
+// Отправитель: событие, затем ожидание подтверждения
+static void send_and_wait(bench_t* b, void (*send)(bench_t*)) {
+    uint32_t seen = atomic_load_explicit(&b->ack, memory_order_acquire);
+    atomic_store(&b->sent_ns, now_ns());
+    send(b);
+    while (atomic_load_explicit(&b->ack, memory_order_acquire) == seen) {
+        futex_wait(&b->ack, seen, NULL, false);
+    }
+}
+
+static void on_pipe(event_loop_t* loop, int fd, uint32_t events, void* arg) {
+    (void)loop;
+    (void)events;
+    char byte;
+    if (read(fd, &byte, 1) == 1) {
+        record_and_ack((bench_t*)arg, &((bench_t*)arg)->fd_latency);
+    }
+}
+
+static void on_signal(event_loop_t* loop, int signo, void* arg) {
+    (void)loop;
+    (void)signo;
+    record_and_ack((bench_t*)arg, &((bench_t*)arg)->signal_latency);
+}
+
+static void on_post(event_loop_t* loop, void* arg) {
+    (void)loop;
+    record_and_ack((bench_t*)arg, &((bench_t*)arg)->post_latency);
+}
+
+static void send_pipe(bench_t* b) {
+    if (write(b->pipe_fd[1], "x", 1) != 1) {
+        perror("write");
+    }
+}
+
+static void send_signal(bench_t* b) {
+    (void)b;
+    kill(getpid(), SIGUSR1);
+}
+
+static void send_post(bench_t* b) {
+    event_loop_post(b->loop, on_post, b);
+}
+
+// offload: цепочка из SAMPLES заданий, каждое следующее — из done
+static void offload_work(void* arg) {
+    (void)arg;
+}
+
+static void offload_done(event_loop_t* loop, void* arg) {
+    bench_t* b = (bench_t*)arg;
+    latency_histogram_record(&b->offload_latency, now_ns() - atomic_load(&b->sent_ns));
+    if (--b->offload_left > 0) {
+        atomic_store(&b->sent_ns, now_ns());
+        event_loop_offload(loop, b->pool, offload_work, offload_done, b);
+    } else {
+        ack(b);
+    }
+}
+
+static void start_offload(event_loop_t* loop, void* arg) {
+    bench_t* b = (bench_t*)arg;
+    b->offload_left = SAMPLES;
+    atomic_store(&b->sent_ns, now_ns());
+    event_loop_offload(loop, b->pool, offload_work, offload_done, b);
+}
+
+static void on_timer(event_loop_t* loop, uint64_t expirations, void* arg) {
+    bench_t* b = (bench_t*)arg;
+    uint64_t now = now_ns();
+    if (b->timer_last_ns != 0) {
+        uint64_t period = (now - b->timer_last_ns) / expirations;
+        uint64_t expected = TIMER_MS * 1000000ULL;
+        latency_histogram_record(&b->timer_jitter,
+                                 period > expected ? period - expected : expected - period);
+    }
+    b->timer_last_ns = now;
+    if (--b->timer_left == 0) {
+        event_loop_remove_timer(loop, b->timer_id);
+        ack(b);
+    }
+}
+
+static void start_timer(event_loop_t* loop, void* arg) {
+    bench_t* b = (bench_t*)arg;
+    b->timer_left = TIMER_SAMPLES;
+    b->timer_id = event_loop_add_timer(loop, TIMER_MS, false, on_timer, b);
+}
+
+static void read_wakeups(event_loop_t* loop, void* arg) {
+    bench_t* b = (bench_t*)arg;
+    b->idle_wakeups = event_loop_wakeups(loop);
+    ack(b);
+}
+
+// Таймер простоя: за время замера не срабатывает
+static void on_idle_timer(event_loop_t* loop, uint64_t expirations, void* arg) {
+    (void)loop;
+    (void)expirations;
+    (void)arg;
+}
+
+static void post_start(bench_t* b, event_loop_post_cb callback) {
+    uint32_t seen = atomic_load_explicit(&b->ack, memory_order_acquire);
+    event_loop_post(b->loop, callback, b);
+    while (atomic_load_explicit(&b->ack, memory_order_acquire) == seen) {
+        futex_wait(&b->ack, seen, NULL, false);
+    }
+}
+
+static void* driver(void* arg) {
+    bench_t* b = (bench_t*)arg;
+
+    for (int i = 0; i < SAMPLES; i++) send_and_wait(b, send_pipe);
+    for (int i = 0; i < SAMPLES; i++) send_and_wait(b, send_signal);
+    for (int i = 0; i < SAMPLES; i++) send_and_wait(b, send_post);
+    post_start(b, start_offload);
+    post_start(b, start_timer);
+
+    // Простой: второй запрос счетчика сам будит цикл один раз
+    post_start(b, read_wakeups);
+    uint64_t before = b->idle_wakeups;
+    usleep(IDLE_MS * 1000);
+    post_start(b, read_wakeups);
+    b->idle_wakeups -= before + 1;
+
+    event_loop_stop(b->loop);
+    return NULL;
+}
+
+int main(void) {
+    bench_t* b = (bench_t*)calloc(1, sizeof(bench_t));
+    if (!b) return 1;
+
+    // SIGUSR1 блокируется до создания остальных потоков
+    b->loop = event_loop_create();
+    if (!b->loop || event_loop_add_signal(b->loop, SIGUSR1, on_signal, b) != 0) {
+        perror("event_loop");
+        return 1;
+    }
+    thread_pool_options_t options = { .num_threads = 2, .quiet = true };
+    b->pool = thread_pool_create_with_options(&options);
+    if (!b->pool || pipe(b->pipe_fd) != 0 ||
+        event_loop_add_fd(b->loop, b->pipe_fd[0], EPOLLIN, on_pipe, b) != 0 ||
+        event_loop_add_timer(b->loop, 60000, false, on_idle_timer, b) < 0) {
+        perror("setup");
+        return 1;
+    }
+
+    pthread_t tid;
+    pthread_create(&tid, NULL, driver, b);
+    event_loop_run(b->loop);
+    pthread_join(tid, NULL);
+
+    printf("Событий каждого вида: %d, период таймера %d мс (%d срабатываний)\n\n",
+           SAMPLES, TIMER_MS, TIMER_SAMPLES);
+    print_result("fd", &b->fd_latency);
+    print_result("signal", &b->signal_latency);
+    print_result("post", &b->post_latency);
+    print_result("offload", &b->offload_latency);
+    print_result("timer", &b->timer_jitter);
+    printf("\nПробуждений цикла за %d мс простоя: %llu\n", IDLE_MS,
+           (unsigned long long)b->idle_wakeups);
+
+    event_loop_destroy(b->loop);
+    thread_pool_destroy(b->pool);
+    close(b->pipe_fd[0]);
+    close(b->pipe_fd[1]);
+    free(b);
+    return 0;
+}
@@ -0,0 +1,504 @@
+#define _GNU_SOURCE
+#include "event_loop.h"
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+// Сколько событий забирать за один epoll_wait
+#define EVENT_LOOP_BATCH 64
+
+typedef enum {
+    HANDLER_FD,
+    HANDLER_TIMER,
+    HANDLER_SIGNAL,
+    HANDLER_WAKE
+} handler_type_t;
+
+// Обработчик дескриптора (epoll_event.data.ptr). Снятый обработчик
+// освобождается только после прохода по полученным событиям: в том же
+// пакете для него может ждать событие.
+typedef struct event_handler {
+    handler_type_t type;
+    int fd;
+    bool removed;
+    event_loop_fd_cb fd_cb;
+    event_loop_timer_cb timer_cb;
+    void* arg;
+    struct event_handler* next_garbage;
+} event_handler_t;
+
+// Функция, переданная в поток цикла
+typedef struct posted {
+    event_loop_post_cb callback;
+    void* arg;
+    struct posted* next;
+} posted_t;
+
+// Задание для пула с продолжением в потоке цикла. Узел очереди цикла
+// выделен заранее (первым полем), поэтому вернуть результат можно
+// всегда, а освобождает задание сам цикл после вызова done.
+typedef struct {
+    posted_t post;
+    event_loop_t* loop;
+    void (*work)(void*);
+} offload_t;
+
+struct event_loop {
+    int epoll_fd;
+    event_handler_t** handlers; // Обработчики по номеру дескриптора
+    int handlers_size;
+    event_handler_t* garbage;   // Снятые в текущем проходе
+
+    event_handler_t wake;       // eventfd: event_loop_post и event_loop_stop
+    event_handler_t signals;    // signalfd (fd = -1, пока сигналов нет)
+    sigset_t signal_mask;
+    event_loop_signal_cb signal_cbs[_NSIG];
+    void* signal_args[_NSIG];
+
+    pthread_mutex_t post_lock;
+    posted_t* posted_head;
+    posted_t* posted_tail;
+    int offloads;               // Заданий в пуле (под post_lock)
+    pthread_cond_t offloads_done; // offloads стал 0 (ждет event_loop_destroy)
+
+    atomic_bool stop;
+    _Atomic uint64_t wakeups;
+};
+
+static int event_loop_register(event_loop_t* loop, event_handler_t* h, uint32_t events) {
+    if (h->fd >= loop->handlers_size) {
+        int size = loop->handlers_size > 0 ? loop->handlers_size : 64;
+        while (size <= h->fd) {
+            size *= 2;
+        }
+        event_handler_t** handlers = (event_handler_t**)realloc(loop->handlers,
+                                                                sizeof(*handlers) * size);
+        if (!handlers) {
+            errno = ENOMEM;
+            return -1;
+        }
+        memset(handlers + loop->handlers_size, 0,
+               sizeof(*handlers) * (size - loop->handlers_size));
+        loop->handlers = handlers;
+        loop->handlers_size = size;
+    }
+    if (loop->handlers[h->fd] != NULL) {
+        errno = EEXIST;
+        return -1;
+    }
+
+    struct epoll_event ev = { .events = events, .data.ptr = h };
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, h->fd, &ev) != 0) {
+        return -1;
+    }
+    loop->handlers[h->fd] = h;
+    return 0;
+}
+
+static event_handler_t* event_loop_lookup(event_loop_t* loop, int fd, handler_type_t type) {
+    if (fd < 0 || fd >= loop->handlers_size || loop->handlers[fd] == NULL ||
+        loop->handlers[fd]->type != type) {
+        return NULL;
+    }
+    return loop->handlers[fd];
+}
+
+static void event_loop_unregister(event_loop_t* loop, event_handler_t* h) {
+    epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, h->fd, NULL);
+    loop->handlers[h->fd] = NULL;
+    h->removed = true;
+    h->next_garbage = loop->garbage;
+    loop->garbage = h;
+}
+
+static void event_loop_collect_garbage(event_loop_t* loop) {
+    while (loop->garbage != NULL) {
+        event_handler_t* h = loop->garbage;
+        loop->garbage = h->next_garbage;
+        free(h);
+    }
+}
+
+event_loop_t* event_loop_create(void) {
+    event_loop_t* loop = (event_loop_t*)calloc(1, sizeof(event_loop_t));
+    if (!loop) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    loop->wake.type = HANDLER_WAKE;
+    loop->wake.fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    loop->signals.type = HANDLER_SIGNAL;
+    loop->signals.fd = -1;
+    sigemptyset(&loop->signal_mask);
+    pthread_mutex_init(&loop->post_lock, NULL);
+    pthread_cond_init(&loop->offloads_done, NULL);
+    atomic_init(&loop->stop, false);
+    atomic_init(&loop->wakeups, 0);
+
+    if (loop->epoll_fd < 0 || loop->wake.fd < 0) {
+        int saved = errno;
+        event_loop_destroy(loop);
+        errno = saved;
+        return NULL;
+    }
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = &loop->wake };
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->wake.fd, &ev) != 0) {
+        int saved = errno;
+        event_loop_destroy(loop);
+        errno = saved;
+        return NULL;
+    }
+    return loop;
+}
+
+void event_loop_destroy(event_loop_t* loop) {
+    if (!loop) return;
+
+    // Задание пула обращается к циклу до самого конца offload_task
+    pthread_mutex_lock(&loop->post_lock);
+    while (loop->offloads > 0) {
+        pthread_cond_wait(&loop->offloads_done, &loop->post_lock);
+    }
+    pthread_mutex_unlock(&loop->post_lock);
+
+    for (int fd = 0; fd < loop->handlers_size; fd++) {
+        event_handler_t* h = loop->handlers[fd];
+        if (h == NULL) continue;
+        if (h->type == HANDLER_TIMER) {
+            close(h->fd);
+        }
+        free(h);
+    }
+    event_loop_collect_garbage(loop);
+    free(loop->handlers);
+
+    posted_t* p = loop->posted_head;
+    while (p != NULL) {
+        posted_t* next = p->next;
+        free(p);
+        p = next;
+    }
+    pthread_cond_destroy(&loop->offloads_done);
+    pthread_mutex_destroy(&loop->post_lock);
+
+    if (loop->signals.fd >= 0) close(loop->signals.fd);
+    if (loop->wake.fd >= 0) close(loop->wake.fd);
+    if (loop->epoll_fd >= 0) close(loop->epoll_fd);
+    free(loop);
+}
+
+int event_loop_add_fd(event_loop_t* loop, int fd, uint32_t events,
+                      event_loop_fd_cb callback, void* arg) {
+    if (fd < 0 || callback == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    event_handler_t* h = (event_handler_t*)calloc(1, sizeof(event_handler_t));
+    if (!h) {
+        errno = ENOMEM;
+        return -1;
+    }
+    h->type = HANDLER_FD;
+    h->fd = fd;
+    h->fd_cb = callback;
+    h->arg = arg;
+    if (event_loop_register(loop, h, events) != 0) {
+        int saved = errno;
+        free(h);
+        errno = saved;
+        return -1;
+    }
+    return 0;
+}
+
+int event_loop_modify_fd(event_loop_t* loop, int fd, uint32_t events) {
+    event_handler_t* h = event_loop_lookup(loop, fd, HANDLER_FD);
+    if (h == NULL) {
+        errno = ENOENT;
+        return -1;
+    }
+    struct epoll_event ev = { .events = events, .data.ptr = h };
+    return epoll_ctl(loop->epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+}
+
+int event_loop_remove_fd(event_loop_t* loop, int fd) {
+    event_handler_t* h = event_loop_lookup(loop, fd, HANDLER_FD);
+    if (h == NULL) {
+        errno = ENOENT;
+        return -1;
+    }
+    event_loop_unregister(loop, h);
+    return 0;
+}
+
+int event_loop_add_signal(event_loop_t* loop, int signo,
+                          event_loop_signal_cb callback, void* arg) {
+    if (signo <= 0 || signo >= _NSIG || callback == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    sigset_t mask = loop->signal_mask;
+    sigaddset(&mask, signo);
+    sigset_t old_mask;
+    int rc = pthread_sigmask(SIG_BLOCK, &mask, &old_mask);
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+
+    // signalfd с уже существующим дескриптором меняет его маску
+    int fd = signalfd(loop->signals.fd, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (fd < 0) {
+        int saved = errno;
+        pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+        errno = saved;
+        return -1;
+    }
+    if (loop->signals.fd < 0) {
+        loop->signals.fd = fd;
+        struct epoll_event ev = { .events = EPOLLIN, .data.ptr = &loop->signals };
+        if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            int saved = errno;
+            close(fd);
+            loop->signals.fd = -1;
+            pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+            errno = saved;
+            return -1;
+        }
+    }
+
+    loop->signal_mask = mask;
+    loop->signal_cbs[signo] = callback;
+    loop->signal_args[signo] = arg;
+    return 0;
+}
+
+int event_loop_add_timer(event_loop_t* loop, int interval_ms, bool once,
+                         event_loop_timer_cb callback, void* arg) {
+    if (interval_ms <= 0 || callback == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = interval_ms / 1000;
+    spec.it_value.tv_nsec = (long)(interval_ms % 1000) * 1000000L;
+    if (!once) {
+        spec.it_interval = spec.it_value;
+    }
+
+    event_handler_t* h = (event_handler_t*)calloc(1, sizeof(event_handler_t));
+    if (!h || timerfd_settime(fd, 0, &spec, NULL) != 0) {
+        int saved = h ? errno : ENOMEM;
+        free(h);
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    h->type = HANDLER_TIMER;
+    h->fd = fd;
+    h->timer_cb = callback;
+    h->arg = arg;
+    if (event_loop_register(loop, h, EPOLLIN) != 0) {
+        int saved = errno;
+        free(h);
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    return fd;
+}
+
+int event_loop_remove_timer(event_loop_t* loop, int timer_id) {
+    event_handler_t* h = event_loop_lookup(loop, timer_id, HANDLER_TIMER);
+    if (h == NULL) {
+        errno = ENOENT;
+        return -1;
+    }
+    event_loop_unregister(loop, h);
+    close(h->fd);
+    return 0;
+}
+
+static void event_loop_notify(event_loop_t* loop) {
+    uint64_t one = 1;
+    // EAGAIN означает, что счетчик уже ненулевой и цикл все равно проснется
+    if (write(loop->wake.fd, &one, sizeof(one)) < 0) {
+        return;
+    }
+}
+
+// Добавление узла в очередь цикла (узел освобождает цикл)
+static void event_loop_enqueue(event_loop_t* loop, posted_t* p) {
+    p->next = NULL;
+    pthread_mutex_lock(&loop->post_lock);
+    bool was_empty = loop->posted_head == NULL;
+    if (loop->posted_tail) {
+        loop->posted_tail->next = p;
+    } else {
+        loop->posted_head = p;
+    }
+    loop->posted_tail = p;
+    pthread_mutex_unlock(&loop->post_lock);
+
+    // Непустая очередь уже разбудила цикл (или он ее еще не забрал)
+    if (was_empty) {
+        event_loop_notify(loop);
+    }
+}
+
+int event_loop_post(event_loop_t* loop, event_loop_post_cb callback, void* arg) {
+    posted_t* p = (posted_t*)malloc(sizeof(posted_t));
+    if (!p) {
+        errno = ENOMEM;
+        return -1;
+    }
+    p->callback = callback;
+    p->arg = arg;
+    event_loop_enqueue(loop, p);
+    return 0;
+}
+
+static void offload_task(void* arg) {
+    offload_t* job = (offload_t*)arg;
+    event_loop_t* loop = job->loop;
+    job->work(job->post.arg);
+    event_loop_enqueue(loop, &job->post);
+
+    // Последнее обращение к циклу: после него event_loop_destroy
+    // может его освободить
+    pthread_mutex_lock(&loop->post_lock);
+    if (--loop->offloads == 0) {
+        pthread_cond_broadcast(&loop->offloads_done);
+    }
+    pthread_mutex_unlock(&loop->post_lock);
+}
+
+int event_loop_offload(event_loop_t* loop, thread_pool_t* pool, void (*work)(void*),
+                       event_loop_post_cb done, void* arg) {
+    offload_t* job = (offload_t*)malloc(sizeof(offload_t));
+    if (!job) {
+        errno = ENOMEM;
+        return -1;
+    }
+    job->post.callback = done;
+    job->post.arg = arg;
+    job->loop = loop;
+    job->work = work;
+    pthread_mutex_lock(&loop->post_lock);
+    loop->offloads++;
+    pthread_mutex_unlock(&loop->post_lock);
+    if (thread_pool_add_task(pool, offload_task, job) != 0) {
+        pthread_mutex_lock(&loop->post_lock);
+        loop->offloads--;
+        pthread_mutex_unlock(&loop->post_lock);
+        free(job);
+        errno = EAGAIN;
+        return -1;
+    }
+    return 0;
+}
+
+void event_loop_stop(event_loop_t* loop) {
+    atomic_store_explicit(&loop->stop, true, memory_order_release);
+    event_loop_notify(loop);
+}
+
+uint64_t event_loop_wakeups(event_loop_t* loop) {
+    return atomic_load_explicit(&loop->wakeups, memory_order_relaxed);
+}
+
+static void event_loop_run_posted(event_loop_t* loop) {
+    uint64_t value;
+    if (read(loop->wake.fd, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+        return;
+    }
+
+    pthread_mutex_lock(&loop->post_lock);
+    posted_t* p = loop->posted_head;
+    loop->posted_head = NULL;
+    loop->posted_tail = NULL;
+    pthread_mutex_unlock(&loop->post_lock);
+
+    while (p != NULL) {
+        posted_t* next = p->next;
+        p->callback(loop, p->arg);
+        free(p);
+        p = next;
+    }
+}
+
+static void event_loop_read_signals(event_loop_t* loop) {
+    struct signalfd_siginfo info[8];
+    ssize_t n;
+    while ((n = read(loop->signals.fd, info, sizeof(info))) > 0) {
+        for (size_t i = 0; i < (size_t)n / sizeof(info[0]); i++) {
+            int signo = (int)info[i].ssi_signo;
+            if (signo > 0 && signo < _NSIG && loop->signal_cbs[signo] != NULL) {
+                loop->signal_cbs[signo](loop, signo, loop->signal_args[signo]);
+            }
+        }
+    }
+}
+
+static void event_loop_dispatch(event_loop_t* loop, event_handler_t* h, uint32_t events) {
+    switch (h->type) {
+    case HANDLER_FD:
+        h->fd_cb(loop, h->fd, events, h->arg);
+        break;
+    case HANDLER_TIMER: {
+        uint64_t expirations;
+        if (read(h->fd, &expirations, sizeof(expirations)) == (ssize_t)sizeof(expirations)) {
+            h->timer_cb(loop, expirations, h->arg);
+        }
+        break;
+    }
+    case HANDLER_SIGNAL:
+        event_loop_read_signals(loop);
+        break;
+    case HANDLER_WAKE:
+        event_loop_run_posted(loop);
+        break;
+    }
+}
+
+int event_loop_run(event_loop_t* loop) {
+    struct epoll_event events[EVENT_LOOP_BATCH];
+
+    while (!atomic_load_explicit(&loop->stop, memory_order_acquire)) {
+        int n = epoll_wait(loop->epoll_fd, events, EVENT_LOOP_BATCH, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        atomic_store_explicit(&loop->wakeups,
+                              atomic_load_explicit(&loop->wakeups, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+
+        for (int i = 0; i < n; i++) {
+            event_handler_t* h = (event_handler_t*)events[i].data.ptr;
+            if (!h->removed) {
+                event_loop_dispatch(loop, h, events[i].events);
+            }
+        }
+        event_loop_collect_garbage(loop);
+    }
+
+    atomic_store_explicit(&loop->stop, false, memory_order_relaxed);
+    return 0;
+}
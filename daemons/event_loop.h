@@ -0,0 +1,82 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include "../multithreading/thread_pool/thread_pool.h"
+
+// Цикл событий демона на одном epoll: дескрипторы клиентов, сигналы
+// через signalfd и периодические задания через timerfd. Обработчики
+// выполняются в потоке цикла; тяжелую работу можно отдать пулу потоков
+// (event_loop_offload), а результат вернуть в поток цикла.
+//
+// Пока событий нет, поток цикла спит в epoll_wait без тайм-аута и не
+// просыпается вовсе: таймеры — это дескрипторы ядра, а не опрос.
+//
+// Все функции, кроме event_loop_post, event_loop_offload и event_loop_stop,
+// вызываются только из потока цикла (или до event_loop_run).
+
+typedef struct event_loop event_loop_t;
+
+// Готовность дескриптора fd (events — маска EPOLLIN/EPOLLOUT/EPOLLHUP...)
+typedef void (*event_loop_fd_cb)(event_loop_t* loop, int fd, uint32_t events, void* arg);
+// Получен сигнал signo
+typedef void (*event_loop_signal_cb)(event_loop_t* loop, int signo, void* arg);
+// Срабатывание таймера; expirations > 1, если цикл не успевал
+typedef void (*event_loop_timer_cb)(event_loop_t* loop, uint64_t expirations, void* arg);
+// Функция, переданная в поток цикла
+typedef void (*event_loop_post_cb)(event_loop_t* loop, void* arg);
+
+// Создание цикла. Возвращает NULL с errno при ошибке.
+event_loop_t* event_loop_create(void);
+
+// Уничтожение: закрывает таймеры, signalfd и служебные дескрипторы;
+// дескрипторы клиентов остаются за вызывающим. Сначала дожидается
+// заданий event_loop_offload, еще не вернувшихся из пула, поэтому пул
+// уничтожается после цикла: задачи из его очереди отбрасываются и
+// не вернутся никогда. Невыполненные event_loop_post и done
+// вернувшихся заданий отбрасываются.
+void event_loop_destroy(event_loop_t* loop);
+
+// Отслеживание дескриптора fd. Возвращает 0 или -1 с errno.
+int event_loop_add_fd(event_loop_t* loop, int fd, uint32_t events,
+                      event_loop_fd_cb callback, void* arg);
+int event_loop_modify_fd(event_loop_t* loop, int fd, uint32_t events);
+// Снятие с отслеживания; безопасно внутри обработчиков, в том числе
+// для дескриптора, событие которого уже получено в этом проходе
+int event_loop_remove_fd(event_loop_t* loop, int fd);
+
+// Доставка сигнала signo через signalfd. Сигнал блокируется в вызывающем
+// потоке; потоки, созданные после этого, наследуют маску, поэтому сигналы
+// настраиваются до запуска остальных потоков. Возвращает 0 или -1 с errno.
+int event_loop_add_signal(event_loop_t* loop, int signo,
+                          event_loop_signal_cb callback, void* arg);
+
+// Таймер: срабатывает через interval_ms и далее каждые interval_ms
+// (once = true — только один раз).
+// Возвращает идентификатор таймера (>= 0) или -1 с errno.
+int event_loop_add_timer(event_loop_t* loop, int interval_ms, bool once,
+                         event_loop_timer_cb callback, void* arg);
+int event_loop_remove_timer(event_loop_t* loop, int timer_id);
+
+// Выполнить callback в потоке цикла. Можно вызывать из любого потока.
+// Возвращает 0 или -1 (errno = ENOMEM).
+int event_loop_post(event_loop_t* loop, event_loop_post_cb callback, void* arg);
+
+// Выполнить work(arg) в пуле pool, затем done(loop, arg) в потоке цикла.
+// Пул должен пережить цикл (см. event_loop_destroy).
+// Возвращает 0 или -1 с errno.
+int event_loop_offload(event_loop_t* loop, thread_pool_t* pool, void (*work)(void*),
+                       event_loop_post_cb done, void* arg);
+
+// Обработка событий до event_loop_stop. Возвращает 0 или -1 с errno.
+int event_loop_run(event_loop_t* loop);
+
+// Остановка цикла. Можно вызывать из любого потока и из обработчика сигнала.
+void event_loop_stop(event_loop_t* loop);
+
+// Сколько раз поток цикла выходил из epoll_wait (для проверки простоя)
+uint64_t event_loop_wakeups(event_loop_t* loop);
+
+#endif // EVENT_LOOP_H
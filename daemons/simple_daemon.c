@@ -5,7 +5,11 @@
 #include <sys/types.h>
 #include <signal.h>
 #include <fcntl.h>
-#include <time.h>
+#include "async_log.h"
+#include "event_loop.h"
+
+#define LOG_PATH "/var/log/mydaemon.log"
+#define HEARTBEAT_MS 60000
 
 void daemonize() {
     pid_t pid;
@@ -43,45 +47,53 @@ void daemonize() {
     open("/dev/null", O_RDWR);
 }
 
-void signal_handler(int sig) {
-    if (sig == SIGTERM) {
-        // Логирование завершения
-        int log_fd = open("/var/log/mydaemon.log", O_WRONLY | O_CREAT | O_APPEND, 0644);
-        char buffer[256];
-        time_t now = time(NULL);
-        struct tm *tm_info = localtime(&now);
-        strftime(buffer, 256, "[%Y-%m-%d %H:%M:%S] ", tm_info);
-        write(log_fd, buffer, strlen(buffer));
-        write(log_fd, "Демон завершает работу\n", 23);
-        close(log_fd);
-        
-        exit(EXIT_SUCCESS);
+// Сигналы приходят через signalfd в цикл событий, поэтому обработчик
+// выполняется в обычном контексте и может писать в журнал
+static void on_signal(event_loop_t* loop, int signo, void* arg) {
+    (void)arg;
+    if (signo == SIGTERM) {
+        async_log_printf("Демон завершает работу");
+        event_loop_stop(loop);
+    } else if (signo == SIGHUP) {
+        // Ротация журнала: файл переоткрывается фоновым потоком журнала
+        async_log_reopen();
     }
 }
 
+// Периодическое задание (раньше — sleep(60) в основном цикле)
+static void on_heartbeat(event_loop_t* loop, uint64_t expirations, void* arg) {
+    (void)loop;
+    (void)expirations;
+    (void)arg;
+    async_log_printf("Демон работает");
+}
+
 int main() {
     daemonize();
     
-    // Установка обработчика сигналов
-    signal(SIGTERM, signal_handler);
+    // Сигналы настраиваются до запуска потока журнала: он наследует маску
+    event_loop_t* loop = event_loop_create();
+    if (!loop ||
+        event_loop_add_signal(loop, SIGTERM, on_signal, NULL) != 0 ||
+        event_loop_add_signal(loop, SIGHUP, on_signal, NULL) != 0) {
+        exit(EXIT_FAILURE);
+    }
+    
+    // Журнал открывается после daemonize(): его фоновый поток
+    // не пережил бы fork()
+    if (async_log_open(LOG_PATH, NULL) != 0) {
+        exit(EXIT_FAILURE);
+    }
     
-    // Основной цикл демона
-    while (1) {
-        // Открытие лог-файла
-        int log_fd = open("/var/log/mydaemon.log", O_WRONLY | O_CREAT | O_APPEND, 0644);
-        
-        if (log_fd >= 0) {
-            char buffer[256];
-            time_t now = time(NULL);
-            struct tm *tm_info = localtime(&now);
-            strftime(buffer, 256, "[%Y-%m-%d %H:%M:%S] ", tm_info);
-            write(log_fd, buffer, strlen(buffer));
-            write(log_fd, "Демон работает\n", 15);
-            close(log_fd);
-        }
-        
-        sleep(60); // Пауза 60 секунд
+    async_log_printf("Демон работает");
+    if (event_loop_add_timer(loop, HEARTBEAT_MS, false, on_heartbeat, NULL) < 0) {
+        exit(EXIT_FAILURE);
     }
     
+    // Между событиями поток спит в epoll_wait без тайм-аута
+    event_loop_run(loop);
+    
+    async_log_close();
+    event_loop_destroy(loop);
     return 0;
 }
@@ -0,0 +1,224 @@
+#include "barrier.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// Спин имеет смысл, только если все участники могут выполняться
+// одновременно
+static int barrier_spin_for(int parties, int cpus) {
+    return cpus > 1 && parties <= cpus ? BARRIER_SPIN : 0;
+}
+
+// Ожидание, пока *word не уйдет дальше value (с учетом переполнения):
+// сначала спин, затем futex. Счетчик спящих увеличивается до чтения
+// слова, а выпускающий читает счетчик после записи слова, поэтому либо
+// он увидит спящего и разбудит его, либо спящий увидит новое слово.
+static void barrier_wait_past(_Atomic uint32_t* word, uint32_t value, atomic_int* sleepers,
+                              int spin) {
+    for (int i = 0; i < spin; i++) {
+        if ((int32_t)(atomic_load_explicit(word, memory_order_acquire) - value) > 0) {
+            return;
+        }
+        cpu_relax();
+    }
+
+    atomic_fetch_add_explicit(sleepers, 1, memory_order_seq_cst);
+    uint32_t current;
+    while ((int32_t)((current = atomic_load_explicit(word, memory_order_seq_cst)) - value) <= 0) {
+        futex_wait(word, current, NULL, false);
+    }
+    atomic_fetch_sub_explicit(sleepers, 1, memory_order_relaxed);
+}
+
+// Публикация нового значения слова; системный вызов — только если есть спящие
+static void barrier_release(_Atomic uint32_t* word, uint32_t value, atomic_int* sleepers) {
+    atomic_store_explicit(word, value, memory_order_seq_cst);
+    if (atomic_load_explicit(sleepers, memory_order_seq_cst) > 0) {
+        futex_wake(word, INT_MAX, false);
+    }
+}
+
+// --- Барьер ---
+
+int spin_barrier_init(spin_barrier_t* barrier, int parties) {
+    if (parties < 1) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // Число узлов: листья по BARRIER_FANIN потоков, выше — по
+    // BARRIER_FANIN узлов, пока не останется один
+    int num_nodes = 0;
+    for (int width = parties; ; width = (width + BARRIER_FANIN - 1) / BARRIER_FANIN) {
+        int level = (width + BARRIER_FANIN - 1) / BARRIER_FANIN;
+        num_nodes += level;
+        if (level == 1) break;
+    }
+
+    barrier_node_t* nodes = (barrier_node_t*)aligned_alloc(_Alignof(barrier_node_t),
+                                                           num_nodes * sizeof(barrier_node_t));
+    if (!nodes) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    // Уровни лежат подряд: сначала листья, корень — последний узел
+    int first = 0;
+    int width = parties;
+    while (true) {
+        int level = (width + BARRIER_FANIN - 1) / BARRIER_FANIN;
+        for (int i = 0; i < level; i++) {
+            barrier_node_t* node = &nodes[first + i];
+            int children = width - i * BARRIER_FANIN;
+            atomic_init(&node->count, 0);
+            node->expected = (unsigned int)(children < BARRIER_FANIN ? children : BARRIER_FANIN);
+            node->parent = level == 1 ? -1 : first + level + i / BARRIER_FANIN;
+        }
+        if (level == 1) break;
+        first += level;
+        width = level;
+    }
+
+    atomic_init(&barrier->round, 0);
+    atomic_init(&barrier->sleepers, 0);
+    barrier->nodes = nodes;
+    barrier->num_nodes = num_nodes;
+    barrier->parties = parties;
+    barrier->spin = barrier_spin_for(parties, (int)sysconf(_SC_NPROCESSORS_ONLN));
+    return 0;
+}
+
+void spin_barrier_destroy(spin_barrier_t* barrier) {
+    free(barrier->nodes);
+    barrier->nodes = NULL;
+}
+
+bool spin_barrier_wait(spin_barrier_t* barrier, int id) {
+    // Раунд не может смениться, пока этот поток не пришел
+    uint32_t round = atomic_load_explicit(&barrier->round, memory_order_relaxed);
+
+    int index = id / BARRIER_FANIN;
+    while (true) {
+        barrier_node_t* node = &barrier->nodes[index];
+        if (atomic_fetch_add_explicit(&node->count, 1, memory_order_acq_rel) + 1 <
+            node->expected) {
+            barrier_wait_past(&barrier->round, round, &barrier->sleepers, barrier->spin);
+            return false;
+        }
+        // Последний в узле: узел готов к следующему раунду (туда никто не
+        // придет, пока раунд не сменится), дальше — к родителю
+        atomic_store_explicit(&node->count, 0, memory_order_relaxed);
+        if (node->parent < 0) break;
+        index = node->parent;
+    }
+
+    barrier_release(&barrier->round, round + 1, &barrier->sleepers);
+    return true;
+}
+
+// --- Фазер ---
+
+#define PHASER_PHASE(state)     ((uint32_t)((state) >> 32))
+#define PHASER_PARTIES(state)   ((uint32_t)((state) >> 16) & PHASER_MAX_PARTIES)
+#define PHASER_UNARRIVED(state) ((uint32_t)(state) & PHASER_MAX_PARTIES)
+#define PHASER_STATE(phase, parties, unarrived) \
+    (((uint64_t)(phase) << 32) | ((uint64_t)(parties) << 16) | (uint64_t)(unarrived))
+
+int phaser_init(phaser_t* phaser, int parties) {
+    if (parties < 0 || parties > PHASER_MAX_PARTIES) {
+        errno = EINVAL;
+        return -1;
+    }
+    atomic_init(&phaser->state, PHASER_STATE(0, parties, parties));
+    atomic_init(&phaser->phase, 0);
+    atomic_init(&phaser->sleepers, 0);
+    phaser->cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    return 0;
+}
+
+int64_t phaser_register(phaser_t* phaser) {
+    uint64_t state = atomic_load_explicit(&phaser->state, memory_order_relaxed);
+    while (true) {
+        uint32_t parties = PHASER_PARTIES(state);
+        if (parties == PHASER_MAX_PARTIES) {
+            errno = ERANGE;
+            return -1;
+        }
+        uint64_t next = PHASER_STATE(PHASER_PHASE(state), parties + 1,
+                                     PHASER_UNARRIVED(state) + 1);
+        if (atomic_compare_exchange_weak_explicit(&phaser->state, &state, next,
+                                                  memory_order_acq_rel, memory_order_relaxed)) {
+            return PHASER_PHASE(state);
+        }
+    }
+}
+
+// Опубликовать номер новой фазы. Следующая фаза может завершиться раньше,
+// чем опубликована эта, поэтому слово только растет.
+static void phaser_publish(phaser_t* phaser, uint32_t phase) {
+    uint32_t current = atomic_load_explicit(&phaser->phase, memory_order_relaxed);
+    while ((int32_t)(phase - current) > 0) {
+        if (atomic_compare_exchange_weak_explicit(&phaser->phase, &current, phase,
+                                                  memory_order_seq_cst, memory_order_relaxed)) {
+            if (atomic_load_explicit(&phaser->sleepers, memory_order_seq_cst) > 0) {
+                futex_wake(&phaser->phase, INT_MAX, false);
+            }
+            return;
+        }
+    }
+}
+
+// Приход; deregister уменьшает и число участников
+static uint32_t phaser_arrive_impl(phaser_t* phaser, bool deregister) {
+    uint64_t state = atomic_load_explicit(&phaser->state, memory_order_relaxed);
+    while (true) {
+        uint32_t phase = PHASER_PHASE(state);
+        uint32_t parties = PHASER_PARTIES(state) - (deregister ? 1 : 0);
+        uint32_t unarrived = PHASER_UNARRIVED(state) - 1;
+        // Последний пришедший сразу начинает следующую фазу
+        uint64_t next = unarrived == 0 ? PHASER_STATE(phase + 1, parties, parties)
+                                       : PHASER_STATE(phase, parties, unarrived);
+        if (atomic_compare_exchange_weak_explicit(&phaser->state, &state, next,
+                                                  memory_order_acq_rel, memory_order_relaxed)) {
+            if (unarrived == 0) {
+                phaser_publish(phaser, phase + 1);
+            }
+            return phase;
+        }
+    }
+}
+
+uint32_t phaser_arrive(phaser_t* phaser) {
+    return phaser_arrive_impl(phaser, false);
+}
+
+uint32_t phaser_arrive_and_deregister(phaser_t* phaser) {
+    return phaser_arrive_impl(phaser, true);
+}
+
+uint32_t phaser_await(phaser_t* phaser, uint32_t phase) {
+    int spin = barrier_spin_for(phaser_parties(phaser), phaser->cpus);
+    barrier_wait_past(&phaser->phase, phase, &phaser->sleepers, spin);
+    return phase + 1;
+}
+
+uint32_t phaser_arrive_and_await(phaser_t* phaser) {
+    return phaser_await(phaser, phaser_arrive(phaser));
+}
+
+uint32_t phaser_phase(phaser_t* phaser) {
+    return PHASER_PHASE(atomic_load_explicit(&phaser->state, memory_order_acquire));
+}
+
+int phaser_parties(phaser_t* phaser) {
+    return (int)PHASER_PARTIES(atomic_load_explicit(&phaser->state, memory_order_acquire));
+}
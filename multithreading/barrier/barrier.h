@@ -0,0 +1,100 @@
+#ifndef BARRIER_H
+#define BARRIER_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "../../common/futex.h"
+
+// Барьер и фазер для итеративных вычислений, где потоки синхронизируются
+// тысячи раз в секунду.
+//
+// pthread_barrier_wait — мьютекс и futex: каждый раунд каждый поток
+// проходит через ядро. Здесь поток сначала ограниченное время крутится,
+// читая слово раунда (оно меняется один раз за раунд, поэтому спин не
+// создает трафика записи), и только потом засыпает на futex. Кто
+// выпускает раунд, делает системный вызов, только если кто-то уснул.
+// Спина нет, если потоков больше, чем процессоров: крутящийся поток
+// занимал бы процессор опаздывающего.
+
+// Сколько итераций pause ждать перед засыпанием (порядка 10-50 мкс)
+#define BARRIER_SPIN 2048
+
+// Барьер на n потоков: дерево счетчиков с ветвлением BARRIER_FANIN.
+// Поток с номером id приходит в лист id / BARRIER_FANIN; последний
+// пришедший в узел обнуляет счетчик и поднимается к родителю, последний
+// в корне увеличивает слово раунда. Так на один счетчик приходится не
+// больше BARRIER_FANIN атомарных операций за раунд, а не n, как
+// у центрального счетчика. Младший бит слова раунда — «смысл» (sense)
+// барьера: он меняется каждый раунд, поэтому барьер сразу готов
+// к следующему раунду без повторной инициализации.
+#define BARRIER_FANIN 4
+
+typedef struct {
+    _Alignas(64) atomic_uint count; // Пришедших в текущем раунде
+    unsigned int expected;    // Сколько детей у узла
+    int parent;               // -1 у корня
+} barrier_node_t;
+
+typedef struct {
+    _Alignas(64) _Atomic uint32_t round; // Номер раунда (слово futex)
+    atomic_int sleepers;      // Потоки, уснувшие на round
+    _Alignas(64) barrier_node_t* nodes;
+    int num_nodes;
+    int parties;
+    int spin;                 // Итераций спина (0 — сразу засыпать)
+} spin_barrier_t;
+
+// Инициализация на parties потоков. Возвращает 0 или -1 с errno.
+int spin_barrier_init(spin_barrier_t* barrier, int parties);
+void spin_barrier_destroy(spin_barrier_t* barrier);
+
+// Ожидание остальных. id — номер потока от 0 до parties - 1, у каждого
+// свой. Возвращает true ровно одному потоку раунда (последнему
+// пришедшему), как PTHREAD_BARRIER_SERIAL_THREAD.
+bool spin_barrier_wait(spin_barrier_t* barrier, int id);
+
+// Фазер: барьер с переменным числом участников и раздельными
+// arrive/await. Участник сообщает о завершении фазы (arrive), делает
+// работу, не зависящую от остальных, и только потом ждет конца фазы
+// (await) — синхронизация перекрывается с полезной работой.
+//
+// Состояние — одно 64-битное слово: фаза (32 бита), участники и еще не
+// пришедшие (по 16 бит), поэтому регистрация и приход — один CAS.
+// Последний пришедший начинает следующую фазу и публикует ее номер
+// в слове futex.
+#define PHASER_MAX_PARTIES 0xffff
+
+typedef struct {
+    _Alignas(64) _Atomic uint64_t state; // phase << 32 | parties << 16 | unarrived
+    _Alignas(64) _Atomic uint32_t phase; // Номер текущей фазы (слово futex)
+    atomic_int sleepers;
+    int cpus;                 // Спин, только пока участников не больше
+} phaser_t;
+
+// Инициализация с parties участниками (0..PHASER_MAX_PARTIES).
+// Возвращает 0 или -1 с errno.
+int phaser_init(phaser_t* phaser, int parties);
+
+// Регистрация нового участника в текущей фазе. Возвращает номер фазы
+// или -1 (errno = ERANGE), если участников слишком много.
+int64_t phaser_register(phaser_t* phaser);
+
+// Приход в текущую фазу без ожидания. Возвращает номер фазы, в которую
+// пришел участник, — его передают в phaser_await.
+uint32_t phaser_arrive(phaser_t* phaser);
+
+// Приход и выход из числа участников (со следующей фазы)
+uint32_t phaser_arrive_and_deregister(phaser_t* phaser);
+
+// Ожидание конца фазы phase. Возвращает номер следующей фазы.
+uint32_t phaser_await(phaser_t* phaser, uint32_t phase);
+
+// phaser_await(phaser, phaser_arrive(phaser))
+uint32_t phaser_arrive_and_await(phaser_t* phaser);
+
+// Текущая фаза и число участников (для отладки и статистики)
+uint32_t phaser_phase(phaser_t* phaser);
+int phaser_parties(phaser_t* phaser);
+
+#endif // BARRIER_H
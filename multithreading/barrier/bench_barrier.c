@@ -0,0 +1,164 @@
+#include "barrier.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+// Задержка раунда барьера: потоки без работы между раундами проходят
+// барьер ROUNDS раз подряд, замер — время и переключения контекста
+// на раунд для pthread_barrier_t, spin_barrier_t и phaser_t.
+// Каждый раунд поток проверяет, что сосед уже дошел до этого раунда.
+// Запуск: ./bench_barrier [раундов] [потоки,через,запятую]
+
+#define DEFAULT_ROUNDS 20000L
+#define DEFAULT_THREADS "2,4,8,16,64"
+#define MAX_THREADS 256
+
+typedef enum { VARIANT_PTHREAD, VARIANT_SPIN, VARIANT_PHASER, VARIANTS } variant_t;
+
+static const char* variant_names[VARIANTS] = {"pthread_barrier", "spin_barrier", "phaser"};
+
+typedef struct {
+    _Alignas(64) volatile long round;
+} progress_t;
+
+typedef struct {
+    variant_t variant;
+    int threads;
+    long rounds;
+    pthread_barrier_t pbarrier;
+    spin_barrier_t sbarrier;
+    phaser_t phaser;
+    progress_t progress[MAX_THREADS];
+    atomic_long errors;
+} bench_t;
+
+typedef struct {
+    bench_t* bench;
+    int id;
+} worker_arg_t;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long context_switches(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_nvcsw + ru.ru_nivcsw;
+}
+
+static void bench_wait(bench_t* b, int id) {
+    switch (b->variant) {
+    case VARIANT_PTHREAD:
+        pthread_barrier_wait(&b->pbarrier);
+        break;
+    case VARIANT_SPIN:
+        spin_barrier_wait(&b->sbarrier, id);
+        break;
+    default:
+        phaser_arrive_and_await(&b->phaser);
+        break;
+    }
+}
+
+static void* worker(void* arg) {
+    worker_arg_t* w = (worker_arg_t*)arg;
+    bench_t* b = w->bench;
+    progress_t* next = &b->progress[(w->id + 1) % b->threads];
+
+    // Нулевой раунд — общий старт, он не входит в замер
+    bench_wait(b, w->id);
+    for (long round = 1; round <= b->rounds; round++) {
+        b->progress[w->id].round = round;
+        bench_wait(b, w->id);
+        if (next->round < round) {
+            atomic_fetch_add_explicit(&b->errors, 1, memory_order_relaxed);
+        }
+    }
+    return NULL;
+}
+
+// Время раунда в нс; *switches — переключений контекста на раунд
+static double run(bench_t* b, double* switches) {
+    pthread_t threads[MAX_THREADS];
+    worker_arg_t args[MAX_THREADS];
+
+    memset(b->progress, 0, sizeof(b->progress));
+    pthread_barrier_init(&b->pbarrier, NULL, (unsigned int)b->threads + 1);
+    spin_barrier_init(&b->sbarrier, b->threads + 1);
+    phaser_init(&b->phaser, b->threads + 1);
+
+    // Главный поток — участник с номером threads: отмечает начало и конец
+    for (int i = 0; i < b->threads; i++) {
+        args[i] = (worker_arg_t){ b, i };
+        pthread_create(&threads[i], NULL, worker, &args[i]);
+    }
+    b->progress[b->threads].round = b->rounds;
+    bench_wait(b, b->threads);
+
+    long switches_before = context_switches();
+    double start = now_sec();
+    for (long round = 1; round <= b->rounds; round++) {
+        bench_wait(b, b->threads);
+    }
+    double elapsed = now_sec() - start;
+    *switches = (double)(context_switches() - switches_before) / b->rounds;
+
+    for (int i = 0; i < b->threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_barrier_destroy(&b->pbarrier);
+    spin_barrier_destroy(&b->sbarrier);
+    return elapsed * 1e9 / b->rounds;
+}
+
+int main(int argc, char* argv[]) {
+    long rounds = argc > 1 ? atol(argv[1]) : DEFAULT_ROUNDS;
+    char list[256];
+    snprintf(list, sizeof(list), "%s", argc > 2 ? argv[2] : DEFAULT_THREADS);
+    if (rounds <= 0) rounds = DEFAULT_ROUNDS;
+
+    bench_t* b = (bench_t*)aligned_alloc(64, sizeof(bench_t));
+    if (!b) {
+        perror("aligned_alloc");
+        return 1;
+    }
+    atomic_init(&b->errors, 0);
+    b->rounds = rounds;
+
+    printf("Процессоров: %ld, раундов: %ld (участники — потоки и главный)\n",
+           sysconf(_SC_NPROCESSORS_ONLN), rounds);
+    printf("%8s", "потоков");
+    for (int v = 0; v < VARIANTS; v++) {
+        printf(" %16s нс %9s", variant_names[v], "перекл.");
+    }
+    printf("\n");
+
+    for (char* token = strtok(list, ","); token; token = strtok(NULL, ",")) {
+        int threads = atoi(token);
+        if (threads < 1 || threads >= MAX_THREADS) continue;
+        b->threads = threads;
+        printf("%8d", threads);
+        for (int v = 0; v < VARIANTS; v++) {
+            b->variant = (variant_t)v;
+            double switches;
+            double ns = run(b, &switches);
+            printf(" %19.0f %9.2f", ns, switches);
+            fflush(stdout);
+        }
+        printf("\n");
+    }
+
+    long errors = atomic_load(&b->errors);
+    if (errors != 0) {
+        fprintf(stderr, "Поток прошел барьер раньше соседа: %ld раз\n", errors);
+    }
+    free(b);
+    return errors != 0;
+}
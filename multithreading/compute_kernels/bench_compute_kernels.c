@@ -0,0 +1,232 @@
+#include "compute_kernels.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Вычислительные ядра против пропускной способности памяти.
+//   память  — чтение и запись буфера BANDWIDTH_BYTES, ГБ/с
+//   решето  — простые до LIMIT: перебор делителей (прежняя задача примера,
+//             на меньшем пределе), решето с сегментом по L1 и по L2, оно же
+//             в пуле; скорость в числах/с и в байтах обращений к массиву
+//             меток/с
+//   F(n)    — быстрое удвоение в одном потоке и в пуле; скорость
+//             в произведениях разрядов/с и в байтах операндов/с
+// Если байты/с ядра выше пропускной способности памяти, ядро работает
+// из кэша и упирается в вычисления, а не в память.
+// Запуск: ./bench_compute_kernels [LIMIT] [n]
+
+#define NUM_THREADS 4
+#define DEFAULT_LIMIT 1000000000ULL
+#define DEFAULT_FIB 1000000ULL
+#define TRIAL_LIMIT 2000000ULL
+#define BANDWIDTH_BYTES (256UL * 1024 * 1024)
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static double seconds_since(uint64_t start) {
+    return (now_ns() - start) / 1e9;
+}
+
+// Прежнее ядро примера: перебор делителей
+static uint64_t trial_division(uint64_t limit) {
+    uint64_t count = 0;
+    for (uint64_t i = 2; i <= limit; i++) {
+        bool is_prime = true;
+        for (uint64_t j = 2; j * j <= i; j++) {
+            if (i % j == 0) {
+                is_prime = false;
+                break;
+            }
+        }
+        count += is_prime;
+    }
+    return count;
+}
+
+static double read_bandwidth(const uint64_t* data, size_t words) {
+    uint64_t start = now_ns();
+    volatile uint64_t sink;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < words; i++) {
+        sum += data[i];
+    }
+    sink = sum;
+    (void)sink;
+    return words * sizeof(uint64_t) / seconds_since(start) / 1e9;
+}
+
+static double write_bandwidth(uint64_t* data, size_t words) {
+    uint64_t start = now_ns();
+    memset(data, 0x5a, words * sizeof(uint64_t));
+    return words * sizeof(uint64_t) / seconds_since(start) / 1e9;
+}
+
+// Решето до limit; печатает строку таблицы и возвращает число простых
+static uint64_t run_sieve(const char* name, thread_pool_t* pool, uint64_t limit,
+                          size_t segment_bytes, double memory_gbps) {
+    prime_sieve_t sieve;
+    if (prime_sieve_init(&sieve, limit, segment_bytes) != 0) {
+        perror("prime_sieve_init");
+        exit(1);
+    }
+    uint64_t start = now_ns();
+    uint64_t count = prime_sieve_count(pool, &sieve, 0, limit + 1);
+    double elapsed = seconds_since(start);
+    if (count == UINT64_MAX) {
+        perror("prime_sieve_count");
+        exit(1);
+    }
+    // Массив меток (бит на нечетное число) заполняется и считается один
+    // раз, а каждое вычеркивание — чтение и запись слова
+    double crossings = 0;
+    for (size_t i = 0; i < sieve.num_primes; i++) {
+        uint64_t p = sieve.primes[i];
+        crossings += (double)(limit - p * p) / (2.0 * p);
+    }
+    double marks_gbps = (crossings * 16 + limit / 8.0) / elapsed / 1e9;
+    printf("%-22s %9zu %10.3f %12.1f %10.2f %9.2fx\n", name, sieve.segment_bytes / 1024,
+           elapsed, limit / elapsed / 1e6, marks_gbps, marks_gbps / memory_gbps);
+    prime_sieve_destroy(&sieve);
+    return count;
+}
+
+// Приблизительное число произведений разрядов в быстром удвоении до n:
+// на шаге k -> 2k умножения a(2b - a), a^2 и b^2 (квадраты — вполовину)
+static double fib_products(uint64_t n) {
+    double products = 0;
+    uint64_t k = 0;
+    for (int bit = 63 - __builtin_clzll(n); bit >= 0; bit--) {
+        double limbs = k * 0.6943 / 64.0 + 1;
+        products += limbs * limbs * 2;
+        k = 2 * k + ((n >> bit) & 1);
+    }
+    return products;
+}
+
+static double run_fib(const char* name, thread_pool_t* pool, uint64_t n, bignum_t* result,
+                      double memory_gbps) {
+    uint64_t start = now_ns();
+    if (fibonacci_compute(pool, n, result) != 0) {
+        perror("fibonacci_compute");
+        exit(1);
+    }
+    double elapsed = seconds_since(start);
+    double products = fib_products(n);
+    // Каждое произведение читает два 8-байтных разряда
+    double operand_gbps = products * 16 / elapsed / 1e9;
+    printf("%-22s %10.3f %12.1f %12.2f %9.2fx\n", name, elapsed, products / elapsed / 1e6,
+           operand_gbps, operand_gbps / memory_gbps);
+    return elapsed;
+}
+
+// Проверки на значениях, известных независимо
+static int check_fibonacci(void) {
+    uint64_t a = 0, b = 1;
+    for (uint64_t n = 0; n <= 93; n++) {
+        bignum_t f;
+        if (fibonacci_compute(NULL, n, &f) != 0 ||
+            (a == 0 ? f.size != 0 : f.size != 1 || f.limbs[0] != a)) {
+            fprintf(stderr, "F(%llu) неверно\n", (unsigned long long)n);
+            return -1;
+        }
+        bignum_free(&f);
+        uint64_t next = a + b;
+        a = b;
+        b = next;
+    }
+    bignum_t f;
+    fibonacci_compute(NULL, 100, &f);
+    char* text = bignum_to_decimal(&f);
+    int rc = strcmp(text, "354224848179261915075") == 0 ? 0 : -1;
+    if (rc != 0) {
+        fprintf(stderr, "F(100) = %s\n", text);
+    }
+    free(text);
+    bignum_free(&f);
+    return rc;
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t limit = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_LIMIT;
+    uint64_t fib_n = argc > 2 ? strtoull(argv[2], NULL, 10) : DEFAULT_FIB;
+    if (limit < TRIAL_LIMIT) limit = TRIAL_LIMIT;
+    if (fib_n < 2) fib_n = DEFAULT_FIB;
+
+    thread_pool_options_t options = { .num_threads = NUM_THREADS, .quiet = true };
+    thread_pool_t* pool = thread_pool_create_with_options(&options);
+    uint64_t* buffer = (uint64_t*)malloc(BANDWIDTH_BYTES);
+    if (!pool || !buffer) {
+        fprintf(stderr, "Не удалось подготовить замер\n");
+        return 1;
+    }
+    size_t words = BANDWIDTH_BYTES / sizeof(uint64_t);
+    write_bandwidth(buffer, words);   // Страницы выделяются здесь, не в замере
+    double write_gbps = write_bandwidth(buffer, words);
+    double read_gbps = read_bandwidth(buffer, words);
+    free(buffer);
+    printf("Потоков пула: %d, L1 %zu КиБ, L2 %zu КиБ\n", NUM_THREADS,
+           compute_cache_size(1) / 1024, compute_cache_size(2) / 1024);
+    printf("Память (%lu МиБ): чтение %.2f ГБ/с, запись %.2f ГБ/с\n\n",
+           BANDWIDTH_BYTES >> 20, read_gbps, write_gbps);
+
+    // --- решето ---
+    printf("Простые до %llu\n", (unsigned long long)limit);
+    printf("%-22s %9s %10s %12s %10s %10s\n", "", "сегм. КиБ", "с", "млн чисел/с",
+           "метки ГБ/с", "от чтения");
+    uint64_t start = now_ns();
+    uint64_t trial = trial_division(TRIAL_LIMIT);
+    double trial_s = seconds_since(start);
+    printf("%-22s %9s %10.3f %12.1f   (до %llu)\n", "перебор делителей", "-", trial_s,
+           TRIAL_LIMIT / trial_s / 1e6, (unsigned long long)TRIAL_LIMIT);
+
+    prime_sieve_t small;
+    prime_sieve_init(&small, TRIAL_LIMIT, 0);
+    uint64_t small_count = prime_sieve_count_range(&small, 0, TRIAL_LIMIT + 1);
+    prime_sieve_destroy(&small);
+    if (small_count != trial) {
+        fprintf(stderr, "Решето: %llu простых до %llu, перебор: %llu\n",
+                (unsigned long long)small_count, (unsigned long long)TRIAL_LIMIT,
+                (unsigned long long)trial);
+        return 1;
+    }
+
+    uint64_t l1 = run_sieve("решето, L1", NULL, limit, compute_cache_size(1), read_gbps);
+    uint64_t l2 = run_sieve("решето, L2", NULL, limit, compute_cache_size(2), read_gbps);
+    uint64_t pooled = run_sieve("решето, L1, пул", pool, limit, compute_cache_size(1), read_gbps);
+    if (l1 != l2 || l1 != pooled) {
+        fprintf(stderr, "Решето: разные ответы %llu, %llu, %llu\n", (unsigned long long)l1,
+                (unsigned long long)l2, (unsigned long long)pooled);
+        return 1;
+    }
+    printf("Найдено %llu простых\n\n", (unsigned long long)l1);
+
+    // --- Фибоначчи ---
+    if (check_fibonacci() != 0) {
+        return 1;
+    }
+    printf("F(%llu)\n", (unsigned long long)fib_n);
+    printf("%-22s %10s %12s %12s %10s\n", "", "с", "млн произв./с", "операнды ГБ/с",
+           "от чтения");
+    bignum_t sequential, parallel;
+    run_fib("быстрое удвоение", NULL, fib_n, &sequential, read_gbps);
+    run_fib("быстрое удвоение, пул", pool, fib_n, &parallel, read_gbps);
+    if (sequential.size != parallel.size ||
+        memcmp(sequential.limbs, parallel.limbs, sequential.size * sizeof(uint64_t)) != 0) {
+        fprintf(stderr, "F(n) в пуле отличается от последовательного\n");
+        return 1;
+    }
+    // F(n) ~ phi^n / sqrt(5)
+    uint64_t expected_bits = (uint64_t)(fib_n * 0.69424191363061730 - 1.16096404744368117) + 1;
+    printf("%llu бит (ожидалось %llu)\n", (unsigned long long)bignum_bits(&sequential),
+           (unsigned long long)expected_bits);
+    bignum_free(&sequential);
+    bignum_free(&parallel);
+
+    thread_pool_destroy(pool);
+    return 0;
+}
@@ -0,0 +1,527 @@
+#include "compute_kernels.h"
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Векторные варианты заполнения и подсчета меток выбираются при загрузке
+// по возможностям CPU (ifunc), без -march=native в сборке
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+#define KERNEL_CLONES __attribute__((target_clones("avx2", "popcnt", "default")))
+#else
+#define KERNEL_CLONES
+#endif
+
+// Столбцов в отрезке параллельного умножения
+#define MUL_GRAIN 128
+// Меньшие произведения умножаются в одном потоке
+#define MUL_PARALLEL_COLUMNS 2048
+
+typedef unsigned __int128 uint128_t;
+
+size_t compute_cache_size(int level) {
+    long size = sysconf(level == 1 ? _SC_LEVEL1_DCACHE_SIZE : _SC_LEVEL2_CACHE_SIZE);
+    if (size > 0) {
+        return (size_t)size;
+    }
+    // sysconf не знает размер (контейнеры, не x86) — спросим sysfs
+    char path[96];
+    for (int index = 0; index < 8; index++) {
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/level", index);
+        FILE* file = fopen(path, "r");
+        if (!file) {
+            break;
+        }
+        int file_level = 0;
+        int matched = fscanf(file, "%d", &file_level);
+        fclose(file);
+        if (matched != 1 || file_level != level) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/type", index);
+        char type[32] = "";
+        if ((file = fopen(path, "r"))) {
+            matched = fscanf(file, "%31s", type);
+            fclose(file);
+        }
+        if (strcmp(type, "Instruction") == 0) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", index);
+        unsigned long kib = 0;
+        if ((file = fopen(path, "r"))) {
+            matched = fscanf(file, "%luK", &kib);
+            fclose(file);
+            if (matched == 1 && kib > 0) {
+                return kib * 1024;
+            }
+        }
+    }
+    return level == 1 ? 32 * 1024 : 256 * 1024;
+}
+
+// --- Решето ---
+
+typedef uint64_t marks_vec_t __attribute__((vector_size(32)));
+
+// Все числа сегмента — кандидаты в простые
+KERNEL_CLONES
+static void marks_fill(uint64_t* words, size_t count) {
+    const marks_vec_t ones = { ~0ULL, ~0ULL, ~0ULL, ~0ULL };
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        memcpy(&words[i], &ones, sizeof(ones));
+    }
+    for (; i < count; i++) {
+        words[i] = ~0ULL;
+    }
+}
+
+KERNEL_CLONES
+static uint64_t marks_count(const uint64_t* words, size_t count) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += (uint64_t)__builtin_popcountll(words[i]);
+    }
+    return total;
+}
+
+static uint64_t isqrt(uint64_t n) {
+    uint64_t root = 0;
+    for (uint64_t bit = 1ULL << 31; bit; bit >>= 1) {
+        uint64_t candidate = root | bit;
+        if (candidate * candidate <= n) {
+            root = candidate;
+        }
+    }
+    return root;
+}
+
+int prime_sieve_init(prime_sieve_t* sieve, uint64_t limit, size_t segment_bytes) {
+    if (!sieve || limit >= (1ULL << 62)) {
+        errno = EINVAL;
+        return -1;
+    }
+    memset(sieve, 0, sizeof(*sieve));
+    if (segment_bytes == 0) {
+        segment_bytes = compute_cache_size(1);
+    }
+    // Сегмент — целое число строк кэша
+    sieve->segment_bytes = (segment_bytes + 63) / 64 * 64;
+    sieve->limit = limit;
+
+    // Базовые простые до sqrt(limit) обычным решетом
+    uint64_t root = isqrt(limit);
+    unsigned char* composite = (unsigned char*)calloc(root + 1, 1);
+    if (!composite) {
+        return -1;
+    }
+    size_t count = 0;
+    for (uint64_t i = 3; i <= root; i += 2) {
+        if (!composite[i]) {
+            count++;
+            for (uint64_t j = i * i; j <= root; j += 2 * i) {
+                composite[j] = 1;
+            }
+        }
+    }
+    sieve->primes = (uint32_t*)malloc((count + 1) * sizeof(uint32_t));
+    if (!sieve->primes) {
+        free(composite);
+        return -1;
+    }
+    for (uint64_t i = 3; i <= root; i += 2) {
+        if (!composite[i]) {
+            sieve->primes[sieve->num_primes++] = (uint32_t)i;
+        }
+    }
+    free(composite);
+    return 0;
+}
+
+void prime_sieve_destroy(prime_sieve_t* sieve) {
+    if (sieve) {
+        free(sieve->primes);
+        sieve->primes = NULL;
+        sieve->num_primes = 0;
+    }
+}
+
+// Простые среди нечетных чисел [base, top); base четное, бит i — число
+// base + 2i + 1
+static uint64_t sieve_segment(const prime_sieve_t* sieve, uint64_t* marks,
+                              uint64_t base, uint64_t top) {
+    uint64_t bits = (top - base) / 2;
+    size_t words = (size_t)((bits + 63) / 64);
+    marks_fill(marks, words);
+
+    for (size_t k = 0; k < sieve->num_primes; k++) {
+        uint64_t p = sieve->primes[k];
+        uint64_t start = p * p;
+        if (start >= top) {
+            break;
+        }
+        if (start < base) {
+            // Первое нечетное кратное p больше base
+            start = (base + p) / p * p;
+            if ((start & 1) == 0) {
+                start += p;
+            }
+        }
+        for (uint64_t j = (start - base) / 2; j < bits; j += p) {
+            marks[j >> 6] &= ~(1ULL << (j & 63));
+        }
+    }
+
+    if (base == 0) {
+        marks[0] &= ~1ULL;   // 1 не простое
+    }
+    if (bits & 63) {
+        marks[words - 1] &= (1ULL << (bits & 63)) - 1;
+    }
+    return marks_count(marks, words);
+}
+
+uint64_t prime_sieve_count_range(const prime_sieve_t* sieve, uint64_t lo, uint64_t hi) {
+    if (!sieve || !sieve->primes || lo > hi || hi > sieve->limit + 1) {
+        errno = EINVAL;
+        return UINT64_MAX;
+    }
+    uint64_t count = lo <= 2 && hi > 2 ? 1 : 0;   // 2 в массив меток не входит
+    uint64_t* marks = (uint64_t*)aligned_alloc(64, sieve->segment_bytes);
+    if (!marks) {
+        return UINT64_MAX;
+    }
+    // Нечетное lo попадает в сегмент с base = lo - 1 как первый бит
+    uint64_t span = (uint64_t)sieve->segment_bytes * 16;
+    for (uint64_t base = lo & ~1ULL; base < hi; base += span) {
+        uint64_t top = hi - base > span ? base + span : hi;
+        count += sieve_segment(sieve, marks, base, top);
+    }
+    free(marks);
+    return count;
+}
+
+typedef struct {
+    const prime_sieve_t* sieve;
+    uint64_t lo;
+    uint64_t hi;
+    uint64_t span;
+    atomic_bool failed;
+} sieve_job_t;
+
+// Отрезок сегментов [first, last) диапазона
+static void sieve_body(void* ctx, long first, long last, void* partial) {
+    sieve_job_t* job = (sieve_job_t*)ctx;
+    uint64_t base = job->lo & ~1ULL;
+    uint64_t from = base + (uint64_t)first * job->span;
+    uint64_t to = base + (uint64_t)last * job->span;
+    if (from < job->lo) from = job->lo;
+    if (to > job->hi) to = job->hi;
+    uint64_t count = prime_sieve_count_range(job->sieve, from, to);
+    if (count == UINT64_MAX) {
+        atomic_store(&job->failed, true);
+        return;
+    }
+    *(uint64_t*)partial += count;
+}
+
+static void sieve_combine(void* ctx, void* result, const void* partial) {
+    (void)ctx;
+    *(uint64_t*)result += *(const uint64_t*)partial;
+}
+
+uint64_t prime_sieve_count(thread_pool_t* pool, const prime_sieve_t* sieve,
+                           uint64_t lo, uint64_t hi) {
+    if (!pool) {
+        return prime_sieve_count_range(sieve, lo, hi);
+    }
+    if (!sieve || !sieve->primes || lo > hi || hi > sieve->limit + 1) {
+        errno = EINVAL;
+        return UINT64_MAX;
+    }
+    sieve_job_t job = { .sieve = sieve, .lo = lo, .hi = hi,
+                        .span = (uint64_t)sieve->segment_bytes * 16 };
+    atomic_init(&job.failed, false);
+    uint64_t segments = (hi - (lo & ~1ULL) + job.span - 1) / job.span;
+    uint64_t count = 0;
+    if (thread_pool_parallel_reduce(pool, 0, (long)segments, 0, sieve_body, sieve_combine,
+                                    &count, sizeof(count), &job) != 0 ||
+        atomic_load(&job.failed)) {
+        errno = ENOMEM;
+        return UINT64_MAX;
+    }
+    return count;
+}
+
+// --- Длинная арифметика ---
+
+static size_t big_normalize(const uint64_t* a, size_t n) {
+    while (n > 0 && a[n - 1] == 0) {
+        n--;
+    }
+    return n;
+}
+
+// r = a + b; r может совпадать с a
+static size_t big_add(uint64_t* r, const uint64_t* a, size_t na, const uint64_t* b, size_t nb) {
+    if (na < nb) {
+        const uint64_t* t = a; a = b; b = t;
+        size_t tn = na; na = nb; nb = tn;
+    }
+    uint64_t carry = 0;
+    for (size_t i = 0; i < na; i++) {
+        uint128_t sum = (uint128_t)a[i] + (i < nb ? b[i] : 0) + carry;
+        r[i] = (uint64_t)sum;
+        carry = (uint64_t)(sum >> 64);
+    }
+    r[na] = carry;
+    return na + (carry != 0);
+}
+
+// r = a - b при a >= b; r может совпадать с a
+static size_t big_sub(uint64_t* r, const uint64_t* a, size_t na, const uint64_t* b, size_t nb) {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < na; i++) {
+        uint64_t sub = i < nb ? b[i] : 0;
+        uint64_t diff = a[i] - sub - borrow;
+        borrow = (a[i] < sub) || (a[i] - sub < borrow);
+        r[i] = diff;
+    }
+    return big_normalize(r, na);
+}
+
+// r = 2a
+static size_t big_shl1(uint64_t* r, const uint64_t* a, size_t na) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < na; i++) {
+        uint64_t next = a[i] >> 63;
+        r[i] = (a[i] << 1) | carry;
+        carry = next;
+    }
+    r[na] = carry;
+    return na + carry;
+}
+
+// Столбцы [from, to) произведения a * b (Comba). Перенос после последнего
+// столбца отрезка не добавляется к следующему, а возвращается в carry.
+static void mul_columns(uint64_t* r, const uint64_t* a, size_t na, const uint64_t* b, size_t nb,
+                        size_t from, size_t to, uint64_t carry[2]) {
+    bool square = a == b && na == nb;
+    uint128_t low = 0;   // Аккумулятор столбца: low + high * 2^128
+    uint64_t high = 0;
+    for (size_t k = from; k < to; k++) {
+        size_t i = k >= nb ? k - nb + 1 : 0;
+        if (square) {
+            // Пары i < j считаются один раз и удваиваются
+            for (; i < k - i; i++) {
+                uint128_t product = (uint128_t)a[i] * a[k - i];
+                low += product;
+                high += low < product;
+                low += product;
+                high += low < product;
+            }
+            if (i == k - i) {
+                uint128_t product = (uint128_t)a[i] * a[i];
+                low += product;
+                high += low < product;
+            }
+        } else {
+            size_t last = k < na ? k : na - 1;
+            for (; i <= last; i++) {
+                uint128_t product = (uint128_t)a[i] * b[k - i];
+                low += product;
+                high += low < product;
+            }
+        }
+        r[k] = (uint64_t)low;
+        low = (low >> 64) | ((uint128_t)high << 64);
+        high = 0;
+    }
+    carry[0] = (uint64_t)low;
+    carry[1] = (uint64_t)(low >> 64);
+}
+
+typedef struct {
+    uint64_t* r;
+    const uint64_t* a;
+    size_t na;
+    const uint64_t* b;
+    size_t nb;
+    uint64_t (*carries)[2];
+} mul_job_t;
+
+static void mul_body(void* ctx, long lo, long hi) {
+    mul_job_t* job = (mul_job_t*)ctx;
+    mul_columns(job->r, job->a, job->na, job->b, job->nb, (size_t)lo, (size_t)hi,
+                job->carries[lo / MUL_GRAIN]);
+}
+
+// Добавление двухразрядного переноса в r начиная с разряда pos
+static void add_carry(uint64_t* r, size_t size, size_t pos, const uint64_t carry[2]) {
+    uint64_t add[2] = { carry[0], carry[1] };
+    uint64_t c = 0;
+    for (size_t i = pos; i < size; i++) {
+        uint64_t extra = i - pos < 2 ? add[i - pos] : 0;
+        if (extra == 0 && c == 0 && i - pos >= 2) {
+            break;
+        }
+        uint128_t sum = (uint128_t)r[i] + extra + c;
+        r[i] = (uint64_t)sum;
+        c = (uint64_t)(sum >> 64);
+    }
+}
+
+// r = a * b, r размером na + nb не пересекается с a и b.
+// Возвращает длину результата или -1 при ошибке.
+static long big_mul(thread_pool_t* pool, uint64_t* r, const uint64_t* a, size_t na,
+                    const uint64_t* b, size_t nb) {
+    if (na == 0 || nb == 0) {
+        return 0;
+    }
+    size_t size = na + nb;
+    size_t columns = size - 1;
+    uint64_t carry[2];
+    if (!pool || columns < MUL_PARALLEL_COLUMNS) {
+        mul_columns(r, a, na, b, nb, 0, columns, carry);
+        r[columns] = carry[0];
+        return (long)big_normalize(r, size);
+    }
+
+    size_t chunks = (columns + MUL_GRAIN - 1) / MUL_GRAIN;
+    mul_job_t job = { .r = r, .a = a, .na = na, .b = b, .nb = nb,
+                      .carries = (uint64_t (*)[2])malloc(chunks * sizeof(uint64_t[2])) };
+    if (!job.carries) {
+        return -1;
+    }
+    if (thread_pool_parallel_for(pool, 0, (long)columns, MUL_GRAIN, mul_body, &job) != 0) {
+        free(job.carries);
+        return -1;
+    }
+    r[columns] = 0;
+    for (size_t c = 0; c < chunks; c++) {
+        size_t end = (c + 1) * MUL_GRAIN < columns ? (c + 1) * MUL_GRAIN : columns;
+        add_carry(r, size, end, job.carries[c]);
+    }
+    free(job.carries);
+    return (long)big_normalize(r, size);
+}
+
+int fibonacci_compute(thread_pool_t* pool, uint64_t n, bignum_t* result) {
+    if (!result) {
+        errno = EINVAL;
+        return -1;
+    }
+    result->limbs = NULL;
+    result->size = 0;
+
+    // F(n + 1) < 2^(0.6943 (n + 1)); запас на промежуточные 2F(k+1) и произведения
+    size_t capacity = (size_t)((double)(n + 2) * 0.6943 / 64.0) + 8;
+    uint64_t* buffers[6];
+    for (int i = 0; i < 6; i++) {
+        buffers[i] = (uint64_t*)malloc(capacity * sizeof(uint64_t));
+        if (!buffers[i]) {
+            while (i-- > 0) free(buffers[i]);
+            return -1;
+        }
+    }
+    uint64_t *a = buffers[0], *b = buffers[1], *t = buffers[2];
+    uint64_t *c = buffers[3], *d = buffers[4], *s = buffers[5];
+    size_t na = 0, nb = 1;   // F(0), F(1)
+    b[0] = 1;
+
+    int status = 0;
+    for (int bit = n ? 63 - __builtin_clzll(n) : -1; bit >= 0; bit--) {
+        // F(2k) = F(k) (2F(k+1) - F(k)), F(2k+1) = F(k)^2 + F(k+1)^2
+        size_t nt = big_shl1(t, b, nb);
+        nt = big_sub(t, t, nt, a, na);
+        long nc = big_mul(pool, c, a, na, t, nt);
+        long nd = big_mul(pool, d, a, na, a, na);
+        long ns = big_mul(pool, s, b, nb, b, nb);
+        if (nc < 0 || nd < 0 || ns < 0) {
+            status = -1;
+            break;
+        }
+        nd = (long)big_add(d, d, (size_t)nd, s, (size_t)ns);
+        uint64_t* swap;
+        if ((n >> bit) & 1) {
+            // k -> 2k + 1: F(2k+1), F(2k+2) = F(2k) + F(2k+1)
+            nc = (long)big_add(c, c, (size_t)nc, d, (size_t)nd);
+            swap = a; a = d; d = swap; na = (size_t)nd;
+            swap = b; b = c; c = swap; nb = (size_t)nc;
+        } else {
+            swap = a; a = c; c = swap; na = (size_t)nc;
+            swap = b; b = d; d = swap; nb = (size_t)nd;
+        }
+    }
+
+    for (int i = 0; i < 6; i++) {
+        if (buffers[i] != a || status != 0) {
+            free(buffers[i]);
+        }
+    }
+    if (status != 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+    result->limbs = a;
+    result->size = na;
+    return 0;
+}
+
+void bignum_free(bignum_t* number) {
+    if (number) {
+        free(number->limbs);
+        number->limbs = NULL;
+        number->size = 0;
+    }
+}
+
+uint64_t bignum_bits(const bignum_t* number) {
+    if (!number || number->size == 0) {
+        return 0;
+    }
+    return (uint64_t)number->size * 64 - (uint64_t)__builtin_clzll(number->limbs[number->size - 1]);
+}
+
+char* bignum_to_decimal(const bignum_t* number) {
+    const uint64_t base = 10000000000000000000ULL;   // 10^19
+    size_t n = number ? number->size : 0;
+    if (n == 0) {
+        return strdup("0");
+    }
+    uint64_t* work = (uint64_t*)malloc(n * sizeof(uint64_t));
+    // 64 бита — не больше 20 цифр, т.е. не больше двух групп по 19
+    uint64_t* groups = (uint64_t*)malloc(2 * n * sizeof(uint64_t));
+    char* text = (char*)malloc(2 * n * 19 + 1);
+    if (!work || !groups || !text) {
+        free(work);
+        free(groups);
+        free(text);
+        return NULL;
+    }
+    memcpy(work, number->limbs, n * sizeof(uint64_t));
+
+    size_t count = 0;
+    while (n > 0) {
+        uint64_t remainder = 0;
+        for (size_t i = n; i-- > 0;) {
+            uint128_t current = ((uint128_t)remainder << 64) | work[i];
+            work[i] = (uint64_t)(current / base);
+            remainder = (uint64_t)(current % base);
+        }
+        groups[count++] = remainder;
+        n = big_normalize(work, n);
+    }
+
+    char* out = text + sprintf(text, "%llu", (unsigned long long)groups[count - 1]);
+    for (size_t i = count - 1; i-- > 0;) {
+        out += sprintf(out, "%019llu", (unsigned long long)groups[i]);
+    }
+    free(work);
+    free(groups);
+    return text;
+}
@@ -0,0 +1,70 @@
+#ifndef COMPUTE_KERNELS_H
+#define COMPUTE_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../thread_pool/thread_pool.h"
+
+// Вычислительные ядра для нагрузочных задач пула: решето простых чисел
+// по сегментам и числа Фибоначчи произвольной длины. Оба ядра делятся на
+// независимые отрезки и выполняются через thread_pool_parallel_for /
+// thread_pool_parallel_reduce; pool == NULL — последовательно в
+// вызывающем потоке (например, внутри одной задачи пула).
+
+// --- Решето ---
+//
+// Диапазон просеивается сегментами, массив меток которых (по биту на
+// нечетное число) помещается в кэш L1 или L2, поэтому вычеркивание идет
+// в кэше, а не в памяти. Сегмент заполняется векторными записями,
+// простые считаются popcount по 64-битным словам.
+
+typedef struct {
+    uint32_t* primes;        // Нечетные простые до sqrt(limit)
+    size_t num_primes;
+    uint64_t limit;          // Наибольшее число, которое можно проверять
+    size_t segment_bytes;    // Размер массива меток одного сегмента
+} prime_sieve_t;
+
+// Размер кэша данных уровня level (1 или 2) в байтах; если система его не
+// сообщает — 32 КиБ для L1 и 256 КиБ для L2
+size_t compute_cache_size(int level);
+
+// Подготовка решета для чисел до limit включительно. segment_bytes == 0 —
+// по размеру L1. Возвращает 0 или -1 с errno.
+int prime_sieve_init(prime_sieve_t* sieve, uint64_t limit, size_t segment_bytes);
+void prime_sieve_destroy(prime_sieve_t* sieve);
+
+// Число простых в [lo, hi), hi <= limit + 1. Можно вызывать из разных
+// потоков одновременно. Возвращает (uint64_t)-1 с errno при ошибке.
+uint64_t prime_sieve_count_range(const prime_sieve_t* sieve, uint64_t lo, uint64_t hi);
+
+// То же, сегменты распределяются по потокам пула
+uint64_t prime_sieve_count(thread_pool_t* pool, const prime_sieve_t* sieve,
+                           uint64_t lo, uint64_t hi);
+
+// --- Числа Фибоначчи ---
+//
+// F(n) методом быстрого удвоения: F(2k) = F(k)(2F(k+1) - F(k)),
+// F(2k+1) = F(k)^2 + F(k+1)^2 — O(log n) шагов по три умножения.
+// Умножение столбцами (Comba): каждый столбец произведения считается
+// независимо, поэтому большие произведения делятся на отрезки столбцов
+// между потоками, а переносы между отрезками добавляются в конце.
+
+typedef struct {
+    uint64_t* limbs;         // Младшие разряды первыми
+    size_t size;             // Значащих разрядов (0 для нуля)
+} bignum_t;
+
+// F(n) в *result (освобождается bignum_free). Возвращает 0 или -1 с errno.
+int fibonacci_compute(thread_pool_t* pool, uint64_t n, bignum_t* result);
+
+void bignum_free(bignum_t* number);
+
+// Число значащих бит
+uint64_t bignum_bits(const bignum_t* number);
+
+// Десятичная запись (освобождается free) или NULL. Квадратичная по длине:
+// для чисел в десятки тысяч цифр и больше заметно медленнее самого F(n).
+char* bignum_to_decimal(const bignum_t* number);
+
+#endif // COMPUTE_KERNELS_H
@@ -0,0 +1,238 @@
+#include "fiber.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+// Стоимость переключения волокон и много спящих волокон на малом пуле.
+//   switch    — переключение туда-обратно между двумя контекстами в
+//               одном потоке: fiber_context_switch и swapcontext
+//   yield     — tp_yield одного волокна через очередь пула (1 поток)
+//   channel   — два волокна передают друг другу сообщение по каналам
+//   sleepers  — N волокон на WORKERS потоках ждут общего старта на
+//               условной переменной (память на ждущее волокно по RSS),
+//               затем все вместе SLEEP_ROUNDS раз засыпают на 50-150 мс
+// Запуск: ./bench_fibers [N] [WORKERS]
+
+#define DEFAULT_SLEEPERS 100000
+#define DEFAULT_WORKERS 8
+#define SLEEPER_STACK_SIZE (16 * 1024)
+#define SLEEP_ROUNDS 5
+#define SWITCHES 10000000L
+#define YIELDS 1000000L
+#define MESSAGES 500000L
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Резидентная память процесса, байт
+static size_t resident_bytes(void) {
+    FILE* file = fopen("/proc/self/statm", "r");
+    unsigned long size = 0, resident = 0;
+    if (file) {
+        if (fscanf(file, "%lu %lu", &size, &resident) != 2) resident = 0;
+        fclose(file);
+    }
+    return resident * (size_t)sysconf(_SC_PAGESIZE);
+}
+
+// --- switch ---
+
+static fiber_context_t main_context, ping_context;
+
+static void ping(void* arg) {
+    (void)arg;
+    for (;;) {
+        fiber_context_switch(&ping_context, &main_context);
+    }
+}
+
+static ucontext_t main_uc, ping_uc;
+
+static void ping_uc_entry(void) {
+    for (;;) {
+        swapcontext(&ping_uc, &main_uc);
+    }
+}
+
+// switch: туда и обратно — два переключения
+static void measure_switch(void) {
+    static char stack[64 * 1024] __attribute__((aligned(16)));
+    fiber_context_init(&ping_context, stack, sizeof(stack), ping, NULL);
+    fiber_context_switch(&main_context, &ping_context);
+    uint64_t start = now_ns();
+    for (long i = 0; i < SWITCHES; i++) {
+        fiber_context_switch(&main_context, &ping_context);
+    }
+    double switch_ns = (double)(now_ns() - start) / SWITCHES / 2;
+
+    static char uc_stack[64 * 1024] __attribute__((aligned(16)));
+    getcontext(&ping_uc);
+    ping_uc.uc_stack.ss_sp = uc_stack;
+    ping_uc.uc_stack.ss_size = sizeof(uc_stack);
+    makecontext(&ping_uc, ping_uc_entry, 0);
+    swapcontext(&main_uc, &ping_uc);
+    long uc_switches = SWITCHES / 10;
+    start = now_ns();
+    for (long i = 0; i < uc_switches; i++) {
+        swapcontext(&main_uc, &ping_uc);
+    }
+    double uc_switch_ns = (double)(now_ns() - start) / uc_switches / 2;
+    printf("switch   fiber_context_switch %6.1f нс, swapcontext %6.1f нс\n",
+           switch_ns, uc_switch_ns);
+}
+
+// --- yield ---
+
+static void yielder(void* arg) {
+    long count = *(const long*)arg;
+    for (long i = 0; i < count; i++) {
+        tp_yield();
+    }
+}
+
+// --- channel ---
+
+typedef struct {
+    fiber_channel_t* in;
+    fiber_channel_t* out;
+    long count;
+} relay_t;
+
+static void relay(void* arg) {
+    relay_t* relay = (relay_t*)arg;
+    void* message = NULL;
+    for (long i = 0; i < relay->count; i++) {
+        fiber_channel_send(relay->out, message);
+        fiber_channel_recv(relay->in, &message);
+    }
+}
+
+static void echo(void* arg) {
+    relay_t* relay = (relay_t*)arg;
+    void* message;
+    while (fiber_channel_recv(relay->in, &message) == 0) {
+        fiber_channel_send(relay->out, message);
+    }
+}
+
+// --- sleepers ---
+
+static fiber_mutex_t gate_mutex;
+static fiber_cond_t gate_cond;
+static bool gate_open;
+static atomic_long at_gate;       // Волокна, дошедшие до старта
+static atomic_long overslept_ns;  // Суммарное опоздание пробуждений
+
+static void sleeper(void* arg) {
+    unsigned seed = (unsigned)(uintptr_t)arg;
+    fiber_mutex_lock(&gate_mutex);
+    atomic_fetch_add(&at_gate, 1);
+    while (!gate_open) {
+        fiber_cond_wait(&gate_cond, &gate_mutex);
+    }
+    fiber_mutex_unlock(&gate_mutex);
+
+    for (int round = 0; round < SLEEP_ROUNDS; round++) {
+        uint64_t ms = 50 + rand_r(&seed) % 101;
+        uint64_t start = now_ns();
+        tp_sleep(ms);
+        uint64_t late = now_ns() - start - ms * 1000000ULL;
+        atomic_fetch_add_explicit(&overslept_ns, (long)late, memory_order_relaxed);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    long sleepers = argc > 1 ? atol(argv[1]) : DEFAULT_SLEEPERS;
+    int workers = argc > 2 ? atoi(argv[2]) : DEFAULT_WORKERS;
+    if (sleepers <= 0) sleepers = DEFAULT_SLEEPERS;
+    if (workers <= 0) workers = DEFAULT_WORKERS;
+
+    measure_switch();
+
+    // yield и channel на пуле из одного потока
+    thread_pool_options_t options = { .num_threads = 1, .quiet = true };
+    thread_pool_t* pool = thread_pool_create_with_options(&options);
+    fiber_sched_t* sched = fiber_sched_create(pool, 0);
+    if (!pool || !sched) {
+        perror("fiber_sched_create");
+        return 1;
+    }
+    long yields = YIELDS;
+    uint64_t start = now_ns();
+    fiber_spawn(sched, yielder, &yields);
+    fiber_sched_wait(sched);
+    printf("yield    %6.1f нс на tp_yield (переключение + очередь пула)\n",
+           (double)(now_ns() - start) / YIELDS);
+
+    fiber_channel_t to_echo, from_echo;
+    fiber_channel_init(&to_echo, 1);
+    fiber_channel_init(&from_echo, 1);
+    relay_t forward = { .in = &from_echo, .out = &to_echo, .count = MESSAGES };
+    relay_t backward = { .in = &to_echo, .out = &from_echo };
+    start = now_ns();
+    fiber_spawn(sched, echo, &backward);
+    fiber_spawn(sched, relay, &forward);
+    while (fiber_sched_get_stats(sched).live_fibers > 1) {
+        usleep(1000);
+    }
+    double channel_ns = (double)(now_ns() - start) / MESSAGES / 2;
+    fiber_channel_close(&to_echo);
+    fiber_sched_wait(sched);
+    printf("channel  %6.1f нс на сообщение между волокнами\n", channel_ns);
+    fiber_channel_destroy(&to_echo);
+    fiber_channel_destroy(&from_echo);
+    fiber_sched_destroy(sched);
+    thread_pool_destroy(pool);
+
+    // sleepers
+    options.num_threads = workers;
+    pool = thread_pool_create_with_options(&options);
+    sched = fiber_sched_create(pool, SLEEPER_STACK_SIZE);
+    if (!pool || !sched) {
+        perror("fiber_sched_create");
+        return 1;
+    }
+    fiber_mutex_init(&gate_mutex);
+    fiber_cond_init(&gate_cond);
+    size_t rss_before = resident_bytes();
+    start = now_ns();
+    for (long i = 0; i < sleepers; i++) {
+        if (fiber_spawn(sched, sleeper, (void*)(uintptr_t)(i + 1)) != 0) {
+            perror("fiber_spawn");
+            return 1;
+        }
+    }
+    double spawn_ns = (double)(now_ns() - start) / sleepers;
+    while (atomic_load(&at_gate) < sleepers) {
+        usleep(1000);
+    }
+    // Все волокна живы и ждут: поток main — обычный, не волокно
+    size_t rss_waiting = resident_bytes();
+    fiber_sched_stats_t stats = fiber_sched_get_stats(sched);
+    start = now_ns();
+    fiber_mutex_lock(&gate_mutex);
+    gate_open = true;
+    fiber_cond_broadcast(&gate_cond);
+    fiber_mutex_unlock(&gate_mutex);
+    fiber_sched_wait(sched);
+    double elapsed = (now_ns() - start) / 1e9;
+
+    printf("sleepers %ld волокон на %d потоках, стек %zu КиБ, %d снов по 50-150 мс\n",
+           sleepers, workers, stats.stack_size / 1024, SLEEP_ROUNDS);
+    printf("         создание %.1f нс на волокно, одновременно живых %ld\n", spawn_ns,
+           stats.live_fibers);
+    printf("         память: %.1f КиБ RSS на ждущее волокно, зарезервировано %zu МиБ\n",
+           (double)(rss_waiting - rss_before) / sleepers / 1024, stats.reserved_bytes >> 20);
+    printf("         сны: %.2f с от старта (снов у волокна не больше %.2f с), "
+           "опоздание пробуждения в среднем %.2f мс\n", elapsed, SLEEP_ROUNDS * 0.15,
+           atomic_load(&overslept_ns) / 1e6 / (sleepers * SLEEP_ROUNDS));
+
+    fiber_sched_destroy(sched);
+    thread_pool_destroy(pool);
+    return 0;
+}
@@ -0,0 +1,666 @@
+#include "fiber.h"
+#include "../../common/futex.h"
+#include <errno.h>
+#include <limits.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+// Стеков в одном отображении. Отдельная защитная страница на каждый стек
+// стоила бы двух областей памяти (VMA) на волокно, а их число у процесса
+// ограничено (vm.max_map_count, обычно 65530) — 100 тысяч волокон бы не
+// поместились. Вместо этого выход за стек проверяется при каждом
+// переключении.
+#define FIBER_SLAB_STACKS 64
+#define FIBER_MIN_STACK_SIZE (8 * 1024)
+
+// --- Переключение контекста ---
+
+#ifdef FIBER_CONTEXT_ASM
+
+// rdi — куда сохранить указатель стека, rsi — стек, на который перейти.
+// На стеке сохраняются rbp, rbx, r12-r15, MXCSR и управляющее слово x87;
+// остальные регистры по ABI может портить вызываемая функция.
+__asm__(
+    ".text\n"
+    ".p2align 4\n"
+    ".type fiber_context_switch_asm, @function\n"
+    "fiber_context_switch_asm:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    subq $8, %rsp\n"
+    "    stmxcsr (%rsp)\n"
+    "    fnstcw 4(%rsp)\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    ldmxcsr (%rsp)\n"
+    "    fldcw 4(%rsp)\n"
+    "    addq $8, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+    ".size fiber_context_switch_asm, .-fiber_context_switch_asm\n"
+    // Первый вход в контекст: r13 — функция, r12 — ее аргумент
+    ".p2align 4\n"
+    ".type fiber_context_entry_asm, @function\n"
+    "fiber_context_entry_asm:\n"
+    "    movq %r12, %rdi\n"
+    "    callq *%r13\n"
+    "    ud2\n"
+    ".size fiber_context_entry_asm, .-fiber_context_entry_asm\n");
+
+void fiber_context_switch_asm(void** save_sp, void* load_sp);
+void fiber_context_entry_asm(void);
+
+void fiber_context_init(fiber_context_t* context, void* stack, size_t size,
+                        void (*entry)(void*), void* arg) {
+    // Стек как после fiber_context_switch_asm: после ret в
+    // fiber_context_entry_asm указатель стека выровнен на 16
+    uintptr_t top = ((uintptr_t)stack + size) & ~(uintptr_t)15;
+    uint64_t* sp = (uint64_t*)top - 8;
+    const uint32_t mxcsr = 0x1f80;   // Значения по умолчанию
+    const uint16_t x87_control = 0x037f;
+    memcpy(&sp[0], &mxcsr, sizeof(mxcsr));
+    memcpy((char*)&sp[0] + 4, &x87_control, sizeof(x87_control));
+    sp[1] = 0;                             // r15
+    sp[2] = 0;                             // r14
+    sp[3] = (uint64_t)(uintptr_t)entry;    // r13
+    sp[4] = (uint64_t)(uintptr_t)arg;      // r12
+    sp[5] = 0;                             // rbx
+    sp[6] = 0;                             // rbp
+    sp[7] = (uint64_t)(uintptr_t)fiber_context_entry_asm;
+    context->sp = sp;
+}
+
+void fiber_context_switch(fiber_context_t* from, fiber_context_t* to) {
+    fiber_context_switch_asm(&from->sp, to->sp);
+}
+
+#else
+
+// makecontext передает только аргументы int: указатель — двумя половинами
+static void fiber_context_trampoline(unsigned int high, unsigned int low) {
+    fiber_context_t* context = (fiber_context_t*)(uintptr_t)(((uint64_t)high << 32) | low);
+    context->entry(context->arg);
+    abort();
+}
+
+void fiber_context_init(fiber_context_t* context, void* stack, size_t size,
+                        void (*entry)(void*), void* arg) {
+    getcontext(&context->uc);
+    context->uc.uc_stack.ss_sp = stack;
+    context->uc.uc_stack.ss_size = size;
+    context->uc.uc_link = NULL;
+    context->entry = entry;
+    context->arg = arg;
+    uint64_t address = (uint64_t)(uintptr_t)context;
+    makecontext(&context->uc, (void (*)(void))fiber_context_trampoline, 2,
+                (unsigned int)(address >> 32), (unsigned int)address);
+}
+
+void fiber_context_switch(fiber_context_t* from, fiber_context_t* to) {
+    swapcontext(&from->uc, &to->uc);
+}
+
+#endif
+
+// --- Волокна ---
+
+struct fiber_waiter {
+    fiber_t* fiber;              // NULL — ждет обычный поток
+    _Atomic uint32_t ready;      // futex для потока
+    int status;                  // 0 или код ошибки для ожидающего
+    void* message;               // Для каналов
+    fiber_waiter_t* next;
+};
+
+struct fiber {
+    fiber_context_t context;
+    fiber_sched_t* sched;
+    void (*function)(void*);
+    void* arg;
+    // Что сделать в потоке пула после переключения с волокна: до этого
+    // контекст волокна не сохранен, и будить его нельзя
+    void (*after)(fiber_t* fiber, void* arg);
+    void* after_arg;
+    char* stack_low;             // Нижняя граница стека
+    fiber_t* next_free;
+};
+
+struct fiber_sched {
+    thread_pool_t* pool;
+    size_t stack_size;
+
+    futex_mutex_t stacks_lock;   // Защищает free_fibers и slabs
+    fiber_t* free_fibers;
+    void** slabs;
+    size_t num_slabs;
+    size_t slabs_capacity;
+
+    _Atomic uint32_t live;       // futex: незавершенные волокна
+};
+
+typedef struct {
+    fiber_t* current;            // Выполняющееся волокно
+    fiber_context_t scheduler;   // Задача пула, переключившаяся на него
+} fiber_thread_t;
+
+static _Thread_local fiber_thread_t fiber_thread_state;
+
+// Волокно может продолжиться в другом потоке, а компилятор вправе
+// запомнить адрес thread-local переменной между вызовами. Поэтому адрес
+// берется заново в непрозрачной функции при каждом обращении.
+__attribute__((noinline)) static fiber_thread_t* fiber_thread(void) {
+    __asm__ volatile("" ::: "memory");
+    return &fiber_thread_state;
+}
+
+static void fiber_run(void* arg);
+
+static void fiber_check_stack(fiber_t* fiber, const void* sp) {
+    if ((const char*)sp < fiber->stack_low) {
+        fprintf(stderr, "fiber: переполнение стека волокна (%zu байт)\n",
+                fiber->sched->stack_size);
+        abort();
+    }
+}
+
+// Новая пачка стеков; вызывается под stacks_lock
+static int fiber_grow(fiber_sched_t* sched) {
+    if (sched->num_slabs == sched->slabs_capacity) {
+        size_t capacity = sched->slabs_capacity ? sched->slabs_capacity * 2 : 16;
+        void** slabs = (void**)realloc(sched->slabs, capacity * sizeof(void*));
+        if (!slabs) {
+            return -1;
+        }
+        sched->slabs = slabs;
+        sched->slabs_capacity = capacity;
+    }
+    // Страницы стека получают память при первом касании: спящее волокно
+    // с неглубоким стеком занимает одну-две страницы
+    void* slab = mmap(NULL, sched->stack_size * FIBER_SLAB_STACKS, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+    if (slab == MAP_FAILED) {
+        return -1;
+    }
+    sched->slabs[sched->num_slabs++] = slab;
+
+    // Структура волокна — в самом верху его стека
+    size_t header = (sizeof(fiber_t) + 63) & ~(size_t)63;
+    for (int i = FIBER_SLAB_STACKS - 1; i >= 0; i--) {
+        char* low = (char*)slab + (size_t)i * sched->stack_size;
+        fiber_t* fiber = (fiber_t*)(low + sched->stack_size - header);
+        fiber->sched = sched;
+        fiber->stack_low = low;
+        fiber->next_free = sched->free_fibers;
+        sched->free_fibers = fiber;
+    }
+    return 0;
+}
+
+static fiber_t* fiber_alloc(fiber_sched_t* sched) {
+    futex_mutex_lock(&sched->stacks_lock);
+    if (!sched->free_fibers && fiber_grow(sched) != 0) {
+        futex_mutex_unlock(&sched->stacks_lock);
+        errno = ENOMEM;
+        return NULL;
+    }
+    fiber_t* fiber = sched->free_fibers;
+    sched->free_fibers = fiber->next_free;
+    futex_mutex_unlock(&sched->stacks_lock);
+    return fiber;
+}
+
+static void fiber_release(fiber_t* fiber) {
+    fiber_sched_t* sched = fiber->sched;
+    futex_mutex_lock(&sched->stacks_lock);
+    fiber->next_free = sched->free_fibers;
+    sched->free_fibers = fiber;
+    futex_mutex_unlock(&sched->stacks_lock);
+}
+
+// Продолжение волокна — задача пула
+static void fiber_ready(fiber_t* fiber) {
+    if (thread_pool_add_task(fiber->sched->pool, fiber_run, fiber) != 0) {
+        // Пул не принял задачу (завершается) — продолжим здесь
+        fiber_run(fiber);
+    }
+}
+
+// Переключение с волокна в задачу пула, которая его выполняет; after
+// выполняется уже на стеке потока
+static void fiber_park(fiber_t* fiber, void (*after)(fiber_t*, void*), void* arg) {
+    fiber->after = after;
+    fiber->after_arg = arg;
+    fiber_check_stack(fiber, __builtin_frame_address(0));
+    fiber_context_switch(&fiber->context, &fiber_thread()->scheduler);
+}
+
+static void fiber_after_yield(fiber_t* fiber, void* arg) {
+    (void)arg;
+    fiber_ready(fiber);
+}
+
+static void fiber_after_sleep(fiber_t* fiber, void* arg) {
+    uint64_t ms = *(const uint64_t*)arg;
+    if (thread_pool_schedule_after(fiber->sched->pool, ms, fiber_run, fiber) == 0) {
+        fiber_ready(fiber);
+    }
+}
+
+static void fiber_after_unlock(fiber_t* fiber, void* arg) {
+    (void)fiber;
+    futex_mutex_unlock((futex_mutex_t*)arg);
+}
+
+static void fiber_after_exit(fiber_t* fiber, void* arg) {
+    (void)arg;
+    fiber_sched_t* sched = fiber->sched;
+    fiber_release(fiber);
+    // После уменьшения счетчика планировщик может быть уже уничтожен:
+    // futex_wake лишь передает адрес ядру и память не читает
+    if (atomic_fetch_sub_explicit(&sched->live, 1, memory_order_acq_rel) == 1) {
+        futex_wake(&sched->live, INT_MAX, false);
+    }
+}
+
+static void fiber_main(void* arg) {
+    fiber_t* fiber = (fiber_t*)arg;
+    fiber->function(fiber->arg);
+    fiber_park(fiber, fiber_after_exit, NULL);
+}
+
+// Задача пула: выполнить волокно до следующей точки ожидания
+static void fiber_run(void* arg) {
+    fiber_t* fiber = (fiber_t*)arg;
+    fiber_thread_t* thread = fiber_thread();
+    if (thread->current) {
+        // Задачу пула выполнили изнутри другого волокна — отложим
+        if (thread_pool_add_task(fiber->sched->pool, fiber_run, fiber) == 0) {
+            return;
+        }
+        fprintf(stderr, "fiber: волокно нельзя продолжить внутри другого\n");
+        abort();
+    }
+    thread->current = fiber;
+    fiber_context_switch(&thread->scheduler, &fiber->context);
+    thread->current = NULL;
+#ifdef FIBER_CONTEXT_ASM
+    fiber_check_stack(fiber, fiber->context.sp);
+#endif
+    fiber->after(fiber, fiber->after_arg);
+}
+
+fiber_sched_t* fiber_sched_create(thread_pool_t* pool, size_t stack_size) {
+    if (!pool) {
+        errno = EINVAL;
+        return NULL;
+    }
+    fiber_sched_t* sched = (fiber_sched_t*)calloc(1, sizeof(fiber_sched_t));
+    if (!sched) {
+        return NULL;
+    }
+    long page = sysconf(_SC_PAGESIZE);
+    if (page <= 0) page = 4096;
+    if (stack_size == 0) stack_size = FIBER_DEFAULT_STACK_SIZE;
+    if (stack_size < FIBER_MIN_STACK_SIZE) stack_size = FIBER_MIN_STACK_SIZE;
+    sched->stack_size = (stack_size + (size_t)page - 1) / (size_t)page * (size_t)page;
+    sched->pool = pool;
+    futex_mutex_init(&sched->stacks_lock);
+    atomic_init(&sched->live, 0);
+    return sched;
+}
+
+void fiber_sched_wait(fiber_sched_t* sched) {
+    if (!sched) {
+        return;
+    }
+    uint32_t live;
+    while ((live = atomic_load_explicit(&sched->live, memory_order_acquire)) != 0) {
+        futex_wait(&sched->live, live, NULL, false);
+    }
+}
+
+void fiber_sched_destroy(fiber_sched_t* sched) {
+    if (!sched) {
+        return;
+    }
+    fiber_sched_wait(sched);
+    for (size_t i = 0; i < sched->num_slabs; i++) {
+        munmap(sched->slabs[i], sched->stack_size * FIBER_SLAB_STACKS);
+    }
+    free(sched->slabs);
+    futex_mutex_destroy(&sched->stacks_lock);
+    free(sched);
+}
+
+fiber_sched_stats_t fiber_sched_get_stats(fiber_sched_t* sched) {
+    fiber_sched_stats_t stats = { 0 };
+    if (!sched) {
+        return stats;
+    }
+    futex_mutex_lock(&sched->stacks_lock);
+    stats.stacks_total = (long)(sched->num_slabs * FIBER_SLAB_STACKS);
+    stats.reserved_bytes = sched->num_slabs * FIBER_SLAB_STACKS * sched->stack_size;
+    futex_mutex_unlock(&sched->stacks_lock);
+    stats.live_fibers = (long)atomic_load(&sched->live);
+    stats.stack_size = sched->stack_size;
+    return stats;
+}
+
+int fiber_spawn(fiber_sched_t* sched, void (*function)(void*), void* arg) {
+    if (!sched || !function) {
+        errno = EINVAL;
+        return -1;
+    }
+    fiber_t* fiber = fiber_alloc(sched);
+    if (!fiber) {
+        return -1;
+    }
+    fiber->function = function;
+    fiber->arg = arg;
+    fiber->after = NULL;
+    fiber_context_init(&fiber->context, fiber->stack_low,
+                       (size_t)((char*)fiber - fiber->stack_low), fiber_main, fiber);
+    atomic_fetch_add_explicit(&sched->live, 1, memory_order_relaxed);
+    if (thread_pool_add_task(sched->pool, fiber_run, fiber) != 0) {
+        atomic_fetch_sub(&sched->live, 1);
+        fiber_release(fiber);
+        errno = EAGAIN;
+        return -1;
+    }
+    return 0;
+}
+
+bool tp_in_fiber(void) {
+    return fiber_thread()->current != NULL;
+}
+
+void tp_yield(void) {
+    fiber_t* fiber = fiber_thread()->current;
+    if (!fiber) {
+        sched_yield();
+        return;
+    }
+    fiber_park(fiber, fiber_after_yield, NULL);
+}
+
+void tp_sleep(uint64_t ms) {
+    fiber_t* fiber = fiber_thread()->current;
+    if (!fiber) {
+        struct timespec ts = { .tv_sec = (time_t)(ms / 1000), .tv_nsec = (long)(ms % 1000) * 1000000L };
+        while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+        }
+        return;
+    }
+    if (ms == 0) {
+        fiber_park(fiber, fiber_after_yield, NULL);
+        return;
+    }
+    fiber_park(fiber, fiber_after_sleep, &ms);
+}
+
+// --- Очереди ожидания ---
+
+static void waiter_init(fiber_waiter_t* waiter) {
+    waiter->fiber = fiber_thread()->current;
+    atomic_init(&waiter->ready, 0);
+    waiter->status = 0;
+    waiter->message = NULL;
+    waiter->next = NULL;
+}
+
+static void queue_push(fiber_wait_queue_t* queue, fiber_waiter_t* waiter) {
+    waiter->next = NULL;
+    if (queue->tail) {
+        queue->tail->next = waiter;
+    } else {
+        queue->head = waiter;
+    }
+    queue->tail = waiter;
+}
+
+static fiber_waiter_t* queue_pop(fiber_wait_queue_t* queue) {
+    fiber_waiter_t* waiter = queue->head;
+    if (waiter) {
+        queue->head = waiter->next;
+        if (!queue->head) {
+            queue->tail = NULL;
+        }
+    }
+    return waiter;
+}
+
+// Ожидание узла, поставленного в очередь под lock; lock отпускается
+static void waiter_sleep(fiber_waiter_t* waiter, futex_mutex_t* lock) {
+    if (waiter->fiber) {
+        fiber_park(waiter->fiber, fiber_after_unlock, lock);
+        return;
+    }
+    futex_mutex_unlock(lock);
+    while (!atomic_load_explicit(&waiter->ready, memory_order_acquire)) {
+        futex_wait(&waiter->ready, 0, NULL, false);
+    }
+}
+
+// Пробуждение узла, снятого с очереди. Узел лежит на стеке ожидающего и
+// после пробуждения может исчезнуть — к нему больше не обращаемся.
+static void waiter_wake(fiber_waiter_t* waiter) {
+    fiber_t* fiber = waiter->fiber;
+    if (fiber) {
+        fiber_ready(fiber);
+        return;
+    }
+    atomic_store_explicit(&waiter->ready, 1, memory_order_release);
+    futex_wake(&waiter->ready, 1, false);
+}
+
+// Разбудить всю очередь (снятую под блокировкой) с кодом status
+static void waiter_wake_all(fiber_waiter_t* waiter, int status) {
+    while (waiter) {
+        fiber_waiter_t* next = waiter->next;
+        waiter->status = status;
+        waiter_wake(waiter);
+        waiter = next;
+    }
+}
+
+// --- Мьютекс ---
+
+int fiber_mutex_init(fiber_mutex_t* mutex) {
+    if (!mutex) {
+        errno = EINVAL;
+        return -1;
+    }
+    memset(mutex, 0, sizeof(*mutex));
+    return futex_mutex_init(&mutex->lock);
+}
+
+void fiber_mutex_lock(fiber_mutex_t* mutex) {
+    futex_mutex_lock(&mutex->lock);
+    if (!mutex->locked) {
+        mutex->locked = true;
+        futex_mutex_unlock(&mutex->lock);
+        return;
+    }
+    fiber_waiter_t waiter;
+    waiter_init(&waiter);
+    queue_push(&mutex->waiters, &waiter);
+    waiter_sleep(&waiter, &mutex->lock);
+    // fiber_mutex_unlock передал мьютекс этому волокну
+}
+
+bool fiber_mutex_trylock(fiber_mutex_t* mutex) {
+    futex_mutex_lock(&mutex->lock);
+    bool acquired = !mutex->locked;
+    mutex->locked = true;
+    futex_mutex_unlock(&mutex->lock);
+    return acquired;
+}
+
+void fiber_mutex_unlock(fiber_mutex_t* mutex) {
+    futex_mutex_lock(&mutex->lock);
+    fiber_waiter_t* next = queue_pop(&mutex->waiters);
+    if (!next) {
+        mutex->locked = false;
+    }
+    futex_mutex_unlock(&mutex->lock);
+    if (next) {
+        waiter_wake(next);
+    }
+}
+
+// --- Условная переменная ---
+
+int fiber_cond_init(fiber_cond_t* cond) {
+    if (!cond) {
+        errno = EINVAL;
+        return -1;
+    }
+    memset(cond, 0, sizeof(*cond));
+    return futex_mutex_init(&cond->lock);
+}
+
+void fiber_cond_wait(fiber_cond_t* cond, fiber_mutex_t* mutex) {
+    fiber_waiter_t waiter;
+    waiter_init(&waiter);
+    // Пока держим cond->lock, signal не может пропустить это ожидание
+    futex_mutex_lock(&cond->lock);
+    queue_push(&cond->waiters, &waiter);
+    fiber_mutex_unlock(mutex);
+    waiter_sleep(&waiter, &cond->lock);
+    fiber_mutex_lock(mutex);
+}
+
+void fiber_cond_signal(fiber_cond_t* cond) {
+    futex_mutex_lock(&cond->lock);
+    fiber_waiter_t* waiter = queue_pop(&cond->waiters);
+    futex_mutex_unlock(&cond->lock);
+    if (waiter) {
+        waiter_wake(waiter);
+    }
+}
+
+void fiber_cond_broadcast(fiber_cond_t* cond) {
+    futex_mutex_lock(&cond->lock);
+    fiber_waiter_t* waiters = cond->waiters.head;
+    cond->waiters.head = cond->waiters.tail = NULL;
+    futex_mutex_unlock(&cond->lock);
+    waiter_wake_all(waiters, 0);
+}
+
+// --- Канал ---
+
+int fiber_channel_init(fiber_channel_t* channel, size_t capacity) {
+    if (!channel || capacity == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    memset(channel, 0, sizeof(*channel));
+    channel->buffer = (void**)malloc(capacity * sizeof(void*));
+    if (!channel->buffer) {
+        return -1;
+    }
+    channel->capacity = capacity;
+    return futex_mutex_init(&channel->lock);
+}
+
+void fiber_channel_destroy(fiber_channel_t* channel) {
+    if (channel) {
+        free(channel->buffer);
+        channel->buffer = NULL;
+        futex_mutex_destroy(&channel->lock);
+    }
+}
+
+int fiber_channel_send(fiber_channel_t* channel, void* message) {
+    futex_mutex_lock(&channel->lock);
+    if (channel->closed) {
+        futex_mutex_unlock(&channel->lock);
+        errno = EPIPE;
+        return -1;
+    }
+    // Получатели ждут только при пустом буфере: сообщение — сразу им
+    fiber_waiter_t* receiver = queue_pop(&channel->receivers);
+    if (receiver) {
+        futex_mutex_unlock(&channel->lock);
+        receiver->message = message;
+        waiter_wake(receiver);
+        return 0;
+    }
+    if (channel->count < channel->capacity) {
+        channel->buffer[(channel->head + channel->count) % channel->capacity] = message;
+        channel->count++;
+        futex_mutex_unlock(&channel->lock);
+        return 0;
+    }
+    fiber_waiter_t waiter;
+    waiter_init(&waiter);
+    waiter.message = message;
+    queue_push(&channel->senders, &waiter);
+    waiter_sleep(&waiter, &channel->lock);
+    if (waiter.status != 0) {
+        errno = waiter.status;
+        return -1;
+    }
+    return 0;
+}
+
+int fiber_channel_recv(fiber_channel_t* channel, void** message) {
+    futex_mutex_lock(&channel->lock);
+    if (channel->count > 0) {
+        *message = channel->buffer[channel->head];
+        channel->head = (channel->head + 1) % channel->capacity;
+        channel->count--;
+        // Освободилось место — сообщение первого ждущего отправителя в буфер
+        fiber_waiter_t* sender = queue_pop(&channel->senders);
+        if (sender) {
+            channel->buffer[(channel->head + channel->count) % channel->capacity] = sender->message;
+            channel->count++;
+        }
+        futex_mutex_unlock(&channel->lock);
+        if (sender) {
+            waiter_wake(sender);
+        }
+        return 0;
+    }
+    if (channel->closed) {
+        futex_mutex_unlock(&channel->lock);
+        errno = EPIPE;
+        return -1;
+    }
+    fiber_waiter_t waiter;
+    waiter_init(&waiter);
+    queue_push(&channel->receivers, &waiter);
+    waiter_sleep(&waiter, &channel->lock);
+    if (waiter.status != 0) {
+        errno = waiter.status;
+        return -1;
+    }
+    *message = waiter.message;
+    return 0;
+}
+
+void fiber_channel_close(fiber_channel_t* channel) {
+    futex_mutex_lock(&channel->lock);
+    channel->closed = true;
+    fiber_waiter_t* senders = channel->senders.head;
+    fiber_waiter_t* receivers = channel->receivers.head;
+    channel->senders.head = channel->senders.tail = NULL;
+    channel->receivers.head = channel->receivers.tail = NULL;
+    futex_mutex_unlock(&channel->lock);
+    waiter_wake_all(senders, EPIPE);
+    waiter_wake_all(receivers, EPIPE);
+}
@@ -0,0 +1,123 @@
+#ifndef FIBER_H
+#define FIBER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../thread_pool/thread_pool.h"
+#include "../futex_lock/futex_lock.h"
+#include "fiber_context.h"
+
+// Волокна (M:N) поверх пула потоков. Волокно — задача на собственном
+// небольшом стеке: его запуск и каждое продолжение — обычная задача пула,
+// которая переключается на стек волокна. Когда волокно ждет (tp_sleep,
+// мьютекс, условная переменная, канал), оно переключается обратно, задача
+// завершается и поток пула берет следующую. Продолжение ставится в пул
+// тем, кто разбудил волокно, и может выполниться в другом потоке.
+//
+// Поэтому тысячи "блокирующих" задач укладываются в несколько потоков:
+// ожидающее волокно занимает только свой стек (обычно одну-две страницы
+// памяти), а не поток.
+//
+// Внутри волокна нельзя надолго блокировать поток (pthread_mutex,
+// sleep, thread_pool_wait и т.п.) — это занимает поток пула, как раньше.
+// Ссылки на thread-local переменные нельзя держать через точки ожидания:
+// после них волокно может продолжиться в другом потоке.
+
+// Размер стека волокна по умолчанию
+#define FIBER_DEFAULT_STACK_SIZE (64 * 1024)
+
+typedef struct fiber fiber_t;
+typedef struct fiber_sched fiber_sched_t;
+
+typedef struct {
+    long live_fibers;         // Созданные и еще не завершившиеся
+    long stacks_total;        // Выделено стеков (включая свободные)
+    size_t stack_size;
+    size_t reserved_bytes;    // Адресное пространство под стеки
+} fiber_sched_stats_t;
+
+// Планировщик волокон для пула. stack_size == 0 — FIBER_DEFAULT_STACK_SIZE.
+// Стеки выделяются пачками и переиспользуются. Возвращает NULL с errno.
+fiber_sched_t* fiber_sched_create(thread_pool_t* pool, size_t stack_size);
+
+// Ожидание завершения всех волокон (не из волокна этого планировщика)
+void fiber_sched_wait(fiber_sched_t* sched);
+
+// Ожидание всех волокон и освобождение стеков
+void fiber_sched_destroy(fiber_sched_t* sched);
+
+fiber_sched_stats_t fiber_sched_get_stats(fiber_sched_t* sched);
+
+// Запуск function(arg) в новом волокне. Возвращает 0 или -1 с errno.
+int fiber_spawn(fiber_sched_t* sched, void (*function)(void*), void* arg);
+
+// Выполняется ли вызывающий код в волокне
+bool tp_in_fiber(void);
+
+// Уступить поток другим задачам пула. Вне волокна — sched_yield().
+void tp_yield(void);
+
+// Заснуть на ms миллисекунд (с точностью тика таймеров пула), не занимая
+// поток. Вне волокна — обычный nanosleep.
+void tp_sleep(uint64_t ms);
+
+// --- Синхронизация ---
+//
+// Ожидающее волокно паркуется и освобождает поток; обычный поток (вне
+// волокна) ждет на futex, так что примитивы можно использовать и между
+// волокнами и потоками.
+
+typedef struct fiber_waiter fiber_waiter_t;
+
+typedef struct {
+    fiber_waiter_t* head;
+    fiber_waiter_t* tail;
+} fiber_wait_queue_t;
+
+typedef struct {
+    futex_mutex_t lock;       // Защищает поля ниже, держится недолго
+    bool locked;
+    fiber_wait_queue_t waiters;
+} fiber_mutex_t;
+
+typedef struct {
+    futex_mutex_t lock;
+    fiber_wait_queue_t waiters;
+} fiber_cond_t;
+
+// Канал фиксированной емкости для указателей
+typedef struct {
+    futex_mutex_t lock;
+    void** buffer;
+    size_t capacity;
+    size_t head;
+    size_t count;
+    bool closed;
+    fiber_wait_queue_t senders;   // Ждут места (сообщение в узле ожидания)
+    fiber_wait_queue_t receivers; // Ждут сообщения
+} fiber_channel_t;
+
+int fiber_mutex_init(fiber_mutex_t* mutex);
+void fiber_mutex_lock(fiber_mutex_t* mutex);
+bool fiber_mutex_trylock(fiber_mutex_t* mutex);
+// Мьютекс передается первому ожидающему напрямую (без гонки за захват)
+void fiber_mutex_unlock(fiber_mutex_t* mutex);
+
+int fiber_cond_init(fiber_cond_t* cond);
+void fiber_cond_wait(fiber_cond_t* cond, fiber_mutex_t* mutex);
+void fiber_cond_signal(fiber_cond_t* cond);
+void fiber_cond_broadcast(fiber_cond_t* cond);
+
+// capacity >= 1. Возвращает 0 или -1 с errno.
+int fiber_channel_init(fiber_channel_t* channel, size_t capacity);
+void fiber_channel_destroy(fiber_channel_t* channel);
+// Отправка; ждет, пока есть место. -1 (errno = EPIPE) — канал закрыт.
+int fiber_channel_send(fiber_channel_t* channel, void* message);
+// Прием; ждет сообщения. -1 (errno = EPIPE) — канал закрыт и пуст.
+int fiber_channel_recv(fiber_channel_t* channel, void** message);
+// Закрытие: ожидающие отправители и получатели просыпаются с ошибкой,
+// уже лежащие в канале сообщения можно дочитать
+void fiber_channel_close(fiber_channel_t* channel);
+
+#endif // FIBER_H
@@ -0,0 +1,36 @@
+#ifndef FIBER_CONTEXT_H
+#define FIBER_CONTEXT_H
+
+#include <stddef.h>
+
+// Переключение контекста исполнения в пределах потока: сохраняются только
+// регистры, которые по ABI сохраняет вызываемая функция, и указатель
+// стека. На x86_64 — несколько инструкций на ассемблере; на остальных
+// архитектурах (или с -DFIBER_UCONTEXT) — makecontext/swapcontext,
+// который дополнительно сохраняет маску сигналов системным вызовом.
+
+#if defined(__x86_64__) && !defined(FIBER_UCONTEXT)
+#define FIBER_CONTEXT_ASM 1
+typedef struct {
+    void* sp;                 // Вершина стека с сохраненными регистрами
+} fiber_context_t;
+#else
+#include <ucontext.h>
+typedef struct {
+    ucontext_t uc;
+    void (*entry)(void*);
+    void* arg;
+} fiber_context_t;
+#endif
+
+// Подготовка контекста: при первом переключении на него на стеке
+// [stack, stack + size) вызывается entry(arg). entry не должна
+// возвращаться — только переключаться на другой контекст.
+void fiber_context_init(fiber_context_t* context, void* stack, size_t size,
+                        void (*entry)(void*), void* arg);
+
+// Сохранение текущего контекста в from и переход в to. Возвращается,
+// когда кто-то переключится обратно на from (возможно, из другого потока).
+void fiber_context_switch(fiber_context_t* from, fiber_context_t* to);
+
+#endif // FIBER_CONTEXT_H
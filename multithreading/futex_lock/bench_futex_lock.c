@@ -0,0 +1,320 @@
+#include "futex_lock.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+// futex_mutex_t/futex_cond_t против pthread_mutex_t/pthread_cond_t:
+//   lock      — нс на захват и освобождение под конкуренцией
+//               (критическая секция — один инкремент), по NUM_THREADS
+//   pingpong  — нс на передачу хода между двумя потоками через
+//               условную переменную (signal + пробуждение)
+//   broadcast — мкс от broadcast до прохода всех ожидающих через мьютекс
+//               и переключений контекста на один broadcast
+// Запуск: ./bench_futex_lock [операций_на_поток] [потоки,через,запятую]
+
+#define DEFAULT_ITERATIONS 1000000L
+#define PINGPONG_ROUNDS 50000
+#define BROADCAST_ROUNDS 2000
+#define BROADCAST_WAITERS 16
+
+typedef enum { VARIANT_PTHREAD, VARIANT_FUTEX, VARIANTS } variant_t;
+
+// Условные переменные: на первой ждут рабочие потоки, на второй — главный
+// (broadcast), чтобы его пробуждения не задевали рабочих
+typedef enum { COND_WORKERS, COND_MAIN, CONDS } cond_id_t;
+
+static const char* variant_names[VARIANTS] = {"pthread", "futex"};
+
+typedef struct {
+    variant_t variant;
+    pthread_mutex_t pmutex;
+    pthread_cond_t pcond[CONDS];
+    futex_mutex_t fmutex;
+    futex_cond_t fcond[CONDS];
+
+    long iterations;
+    _Alignas(64) long counter;    // Защищаемые данные
+    int turn;                     // pingpong: чей ход
+    int generation;               // broadcast: номер раунда
+    int passed;                   // broadcast: сколько ожидающих прошло
+    int ready;                    // broadcast: сколько ожидающих на месте
+    pthread_barrier_t start;
+} bench_t;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long context_switches(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_nvcsw + ru.ru_nivcsw;
+}
+
+static inline void bench_lock(bench_t* b) {
+    if (b->variant == VARIANT_FUTEX) {
+        futex_mutex_lock(&b->fmutex);
+    } else {
+        pthread_mutex_lock(&b->pmutex);
+    }
+}
+
+static inline void bench_unlock(bench_t* b) {
+    if (b->variant == VARIANT_FUTEX) {
+        futex_mutex_unlock(&b->fmutex);
+    } else {
+        pthread_mutex_unlock(&b->pmutex);
+    }
+}
+
+static inline void bench_wait(bench_t* b, cond_id_t id) {
+    if (b->variant == VARIANT_FUTEX) {
+        futex_cond_wait(&b->fcond[id], &b->fmutex);
+    } else {
+        pthread_cond_wait(&b->pcond[id], &b->pmutex);
+    }
+}
+
+static inline void bench_signal(bench_t* b, cond_id_t id) {
+    if (b->variant == VARIANT_FUTEX) {
+        futex_cond_signal(&b->fcond[id]);
+    } else {
+        pthread_cond_signal(&b->pcond[id]);
+    }
+}
+
+static inline void bench_broadcast(bench_t* b, cond_id_t id) {
+    if (b->variant == VARIANT_FUTEX) {
+        futex_cond_broadcast(&b->fcond[id]);
+    } else {
+        pthread_cond_broadcast(&b->pcond[id]);
+    }
+}
+
+static bench_t* bench_create(variant_t variant, int parties) {
+    bench_t* b = NULL;
+    if (posix_memalign((void**)&b, 64, sizeof(bench_t)) != 0) return NULL;
+    memset(b, 0, sizeof(*b));
+    b->variant = variant;
+    pthread_mutex_init(&b->pmutex, NULL);
+    futex_mutex_init(&b->fmutex);
+    for (int i = 0; i < CONDS; i++) {
+        pthread_cond_init(&b->pcond[i], NULL);
+        futex_cond_init(&b->fcond[i]);
+    }
+    pthread_barrier_init(&b->start, NULL, (unsigned int)parties);
+    return b;
+}
+
+static void bench_destroy(bench_t* b) {
+    pthread_barrier_destroy(&b->start);
+    for (int i = 0; i < CONDS; i++) {
+        pthread_cond_destroy(&b->pcond[i]);
+        futex_cond_destroy(&b->fcond[i]);
+    }
+    pthread_mutex_destroy(&b->pmutex);
+    futex_mutex_destroy(&b->fmutex);
+    free(b);
+}
+
+// lock: каждый поток iterations раз захватывает мьютекс ради инкремента
+
+static void* lock_worker(void* arg) {
+    bench_t* b = (bench_t*)arg;
+    pthread_barrier_wait(&b->start);
+    for (long i = 0; i < b->iterations; i++) {
+        bench_lock(b);
+        b->counter++;
+        bench_unlock(b);
+    }
+    return NULL;
+}
+
+static int run_lock(variant_t variant, int threads, long iterations, double* ns_per_op,
+                    double* mops) {
+    bench_t* b = bench_create(variant, threads + 1);
+    if (!b) return -1;
+    b->iterations = iterations;
+
+    pthread_t tids[threads];
+    for (int i = 0; i < threads; i++) {
+        pthread_create(&tids[i], NULL, lock_worker, b);
+    }
+
+    // Время засекается до отпускания барьера (см. bench_sharded_counter.c)
+    double start = now_sec();
+    pthread_barrier_wait(&b->start);
+    for (int i = 0; i < threads; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    double elapsed = now_sec() - start;
+
+    long expected = iterations * threads;
+    long counter = b->counter;
+    bench_destroy(b);
+    if (counter != expected) {
+        fprintf(stderr, "%s: счетчик %ld, ожидалось %ld\n", variant_names[variant],
+                counter, expected);
+        return -1;
+    }
+    *ns_per_op = elapsed * 1e9 / (double)expected;
+    *mops = (double)expected / elapsed / 1e6;
+    return 0;
+}
+
+// pingpong: два потока по очереди ждут своего хода на одной переменной
+
+static void pingpong_play(bench_t* b, int me) {
+    bench_lock(b);
+    for (int round = 0; round < PINGPONG_ROUNDS; round++) {
+        while (b->turn != me) {
+            bench_wait(b, COND_WORKERS);
+        }
+        b->turn = 1 - me;
+        bench_signal(b, COND_WORKERS);
+    }
+    bench_unlock(b);
+}
+
+static void* pingpong_worker(void* arg) {
+    bench_t* b = (bench_t*)arg;
+    pthread_barrier_wait(&b->start);
+    pingpong_play(b, 1);
+    return NULL;
+}
+
+static double run_pingpong(variant_t variant) {
+    bench_t* b = bench_create(variant, 2);
+    if (!b) return -1;
+
+    pthread_t tid;
+    pthread_create(&tid, NULL, pingpong_worker, b);
+    double start = now_sec();
+    pthread_barrier_wait(&b->start);
+    pingpong_play(b, 0);
+    pthread_join(tid, NULL);
+    double elapsed = now_sec() - start;
+
+    bench_destroy(b);
+    // За раунд ход передается дважды
+    return elapsed * 1e9 / (PINGPONG_ROUNDS * 2.0);
+}
+
+// broadcast: BROADCAST_WAITERS потоков ждут нового раунда, главный
+// будит всех и ждет, пока каждый пройдет через мьютекс
+
+static void* broadcast_worker(void* arg) {
+    bench_t* b = (bench_t*)arg;
+    bench_lock(b);
+    for (int round = 1; round <= BROADCAST_ROUNDS; round++) {
+        b->ready++;
+        if (b->ready == BROADCAST_WAITERS) {
+            bench_signal(b, COND_MAIN);
+        }
+        while (b->generation < round) {
+            bench_wait(b, COND_WORKERS);
+        }
+        b->passed++;
+        if (b->passed == BROADCAST_WAITERS) {
+            bench_signal(b, COND_MAIN);
+        }
+    }
+    bench_unlock(b);
+    return NULL;
+}
+
+static int run_broadcast(variant_t variant, double* us_per_round, double* switches) {
+    bench_t* b = bench_create(variant, 1);
+    if (!b) return -1;
+
+    pthread_t tids[BROADCAST_WAITERS];
+    for (int i = 0; i < BROADCAST_WAITERS; i++) {
+        pthread_create(&tids[i], NULL, broadcast_worker, b);
+    }
+
+    double total = 0;
+    long csw = 0;
+    bench_lock(b);
+    for (int round = 1; round <= BROADCAST_ROUNDS; round++) {
+        // Все ожидающие должны заснуть до начала замера
+        while (b->ready < BROADCAST_WAITERS) {
+            bench_wait(b, COND_MAIN);
+        }
+        b->ready = 0;
+        b->passed = 0;
+
+        long csw_start = context_switches();
+        double start = now_sec();
+        b->generation = round;
+        bench_broadcast(b, COND_WORKERS);
+        while (b->passed < BROADCAST_WAITERS) {
+            bench_wait(b, COND_MAIN);
+        }
+        total += now_sec() - start;
+        csw += context_switches() - csw_start;
+    }
+    bench_unlock(b);
+
+    for (int i = 0; i < BROADCAST_WAITERS; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    bench_destroy(b);
+
+    *us_per_round = total * 1e6 / BROADCAST_ROUNDS;
+    *switches = (double)csw / BROADCAST_ROUNDS;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    long iterations = argc > 1 ? atol(argv[1]) : DEFAULT_ITERATIONS;
+    const char* list = argc > 2 ? argv[2] : "1,2,4,8,16";
+    if (iterations <= 0) iterations = DEFAULT_ITERATIONS;
+
+    int thread_counts[32];
+    int num_counts = 0;
+    for (const char* p = list; *p && num_counts < 32;) {
+        char* end;
+        long n = strtol(p, &end, 10);
+        if (end == p || n <= 0) {
+            fprintf(stderr, "Неверный список потоков: %s\n", list);
+            return 1;
+        }
+        thread_counts[num_counts++] = (int)n;
+        p = *end == ',' ? end + 1 : end;
+    }
+
+    printf("lock: операций на поток %ld\n", iterations);
+    printf("NUM_THREADS  вариант   нс/операция  млн опер./с\n");
+    for (int t = 0; t < num_counts; t++) {
+        for (int v = 0; v < VARIANTS; v++) {
+            double ns_per_op, mops;
+            if (run_lock((variant_t)v, thread_counts[t], iterations, &ns_per_op, &mops) != 0) {
+                return 1;
+            }
+            printf("%11d  %-8s %12.2f %12.2f\n", thread_counts[t], variant_names[v],
+                   ns_per_op, mops);
+        }
+    }
+
+    printf("\npingpong: %d раундов\n", PINGPONG_ROUNDS);
+    for (int v = 0; v < VARIANTS; v++) {
+        printf("  %-8s %10.0f нс на передачу хода\n", variant_names[v],
+               run_pingpong((variant_t)v));
+    }
+
+    printf("\nbroadcast: %d ожидающих, %d раундов\n", BROADCAST_WAITERS, BROADCAST_ROUNDS);
+    for (int v = 0; v < VARIANTS; v++) {
+        double us, switches;
+        if (run_broadcast((variant_t)v, &us, &switches) != 0) {
+            return 1;
+        }
+        printf("  %-8s %10.1f мкс на раунд, %6.1f переключений контекста\n",
+               variant_names[v], us, switches);
+    }
+    return 0;
+}
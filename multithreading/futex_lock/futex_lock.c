@@ -0,0 +1,139 @@
+#include "futex_lock.h"
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+
+// Верхняя граница спина (итераций pause) и шаг экспоненциальной паузы
+#define FUTEX_MUTEX_MAX_SPIN 512
+#define FUTEX_MUTEX_MAX_BACKOFF 32
+// Минимальный спин при нулевой оценке
+#define FUTEX_MUTEX_MIN_SPIN 16
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// Предел спина для этой машины (-1 — еще не определен)
+static atomic_int spin_limit = -1;
+
+static int futex_spin_limit(void) {
+    int limit = atomic_load_explicit(&spin_limit, memory_order_relaxed);
+    if (limit < 0) {
+        limit = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? FUTEX_MUTEX_MAX_SPIN : 0;
+        atomic_store_explicit(&spin_limit, limit, memory_order_relaxed);
+    }
+    return limit;
+}
+
+int futex_mutex_init(futex_mutex_t* m) {
+    atomic_init(&m->state, 0);
+    atomic_init(&m->spins, 0);
+    return 0;
+}
+
+int futex_mutex_destroy(futex_mutex_t* m) {
+    (void)m;
+    return 0;
+}
+
+// Захват с пометкой «есть ждущие»: поток не знает, остались ли за ним
+// другие спящие, поэтому его unlock должен будить следующего
+static void futex_mutex_lock_contended(futex_mutex_t* m) {
+    while (atomic_exchange_explicit(&m->state, 2, memory_order_acquire) != 0) {
+        futex_wait(&m->state, 2, NULL, false);
+    }
+}
+
+void futex_mutex_lock_slow(futex_mutex_t* m) {
+    int limit = futex_spin_limit();
+    if (limit > 0) {
+        // Оценка — скользящее среднее итераций до успешного захвата;
+        // крутимся до двух оценок, чтобы она могла расти
+        int estimate = atomic_load_explicit(&m->spins, memory_order_relaxed);
+        int max_spins = 2 * estimate + FUTEX_MUTEX_MIN_SPIN;
+        if (max_spins > limit) max_spins = limit;
+
+        int spun = 0;
+        int backoff = 1;
+        while (spun < max_spins) {
+            for (int i = 0; i < backoff; i++) {
+                cpu_relax();
+            }
+            spun += backoff;
+            if (backoff < FUTEX_MUTEX_MAX_BACKOFF) backoff <<= 1;
+
+            if (atomic_load_explicit(&m->state, memory_order_relaxed) == 0 &&
+                futex_mutex_trylock(m)) {
+                atomic_store_explicit(&m->spins, estimate + (spun - estimate) / 8,
+                                      memory_order_relaxed);
+                return;
+            }
+        }
+        // Спин не помог: секции под этим мьютексом длинные,
+        // в следующий раз уходим в ядро раньше
+        atomic_store_explicit(&m->spins, estimate - estimate / 8 - (estimate > 0),
+                              memory_order_relaxed);
+    }
+    futex_mutex_lock_contended(m);
+}
+
+int futex_cond_init(futex_cond_t* c) {
+    atomic_init(&c->seq, 0);
+    atomic_init(&c->waiters, 0);
+    atomic_init(&c->mutex, NULL);
+    return 0;
+}
+
+int futex_cond_destroy(futex_cond_t* c) {
+    (void)c;
+    return 0;
+}
+
+int futex_cond_timedwait(futex_cond_t* c, futex_mutex_t* m, const struct timespec* deadline) {
+    // Счетчик ожидающих увеличивается до чтения seq: signal увеличивает seq
+    // до чтения счетчика, поэтому либо он увидит ожидающего, либо ожидающий
+    // увидит новый seq и не заснет
+    atomic_fetch_add_explicit(&c->waiters, 1, memory_order_seq_cst);
+    uint32_t seq = atomic_load_explicit(&c->seq, memory_order_seq_cst);
+    atomic_store_explicit(&c->mutex, m, memory_order_relaxed);
+
+    futex_mutex_unlock(m);
+    int rc = futex_wait(&c->seq, seq, deadline, false);
+    atomic_fetch_sub_explicit(&c->waiters, 1, memory_order_relaxed);
+
+    // После broadcast поток мог проснуться уже в очереди мьютекса,
+    // и за ним там могут спать другие перенесенные
+    futex_mutex_lock_contended(m);
+    return rc == ETIMEDOUT ? ETIMEDOUT : 0;
+}
+
+int futex_cond_wait(futex_cond_t* c, futex_mutex_t* m) {
+    return futex_cond_timedwait(c, m, NULL);
+}
+
+void futex_cond_signal(futex_cond_t* c) {
+    atomic_fetch_add_explicit(&c->seq, 1, memory_order_seq_cst);
+    if (atomic_load_explicit(&c->waiters, memory_order_seq_cst) > 0) {
+        futex_wake(&c->seq, 1, false);
+    }
+}
+
+void futex_cond_broadcast(futex_cond_t* c) {
+    uint32_t seq = atomic_fetch_add_explicit(&c->seq, 1, memory_order_seq_cst) + 1;
+    if (atomic_load_explicit(&c->waiters, memory_order_seq_cst) == 0) {
+        return;
+    }
+
+    // Разбуженный захватывает мьютекс с состоянием 2, поэтому при
+    // освобождении разбудит следующего перенесенного, и так по цепочке.
+    // Если seq уже изменился (параллельный signal), переносить нельзя —
+    // будим всех.
+    futex_mutex_t* m = atomic_load_explicit(&c->mutex, memory_order_relaxed);
+    if (m == NULL || futex_requeue(&c->seq, seq, 1, &m->state, INT_MAX, false) < 0) {
+        futex_wake(&c->seq, INT_MAX, false);
+    }
+}
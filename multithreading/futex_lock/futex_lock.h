@@ -0,0 +1,88 @@
+#ifndef FUTEX_LOCK_H
+#define FUTEX_LOCK_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include "../../common/futex.h"
+
+// Мьютекс и условная переменная на futex для коротких критических секций.
+//
+// futex_mutex_t — три состояния (0 — свободен, 1 — захвачен, 2 — захвачен
+// и в ядре могут быть ждущие). Захват без конкуренции — один CAS,
+// освобождение — один обмен; системный вызов нужен, только если кто-то
+// спит. Перед засыпанием поток коротко крутится с pause и растущей паузой;
+// длина спина подстраивается под то, сколько обычно приходится ждать
+// этот мьютекс. На однопроцессорной машине спина нет: владелец не может
+// освободить мьютекс, пока ждущий занимает процессор.
+//
+// futex_cond_t — счетчик последовательности. signal будит одного
+// ожидающего, broadcast будит одного, а остальных переносит
+// (FUTEX_CMP_REQUEUE) в очередь мьютекса: они все равно пройдут через
+// мьютекс по одному, и будить их всех сразу незачем.
+//
+// Все потоки, ожидающие на одной условной переменной, должны использовать
+// один и тот же мьютекс (как и для pthread_cond_t). Объекты работают только
+// внутри процесса.
+
+typedef struct {
+    _Atomic uint32_t state;   // 0, 1 или 2 (слово futex)
+    atomic_int spins;         // Сколько итераций спина обычно хватает
+} futex_mutex_t;
+
+#define FUTEX_MUTEX_INITIALIZER { 0, 0 }
+
+typedef struct {
+    _Atomic uint32_t seq;     // Растет при каждом signal/broadcast (слово futex)
+    atomic_int waiters;       // Потоки внутри futex_cond_wait
+    _Atomic(futex_mutex_t*) mutex; // Мьютекс ожидающих (цель переноса)
+} futex_cond_t;
+
+#define FUTEX_COND_INITIALIZER { 0, 0, NULL }
+
+// Инициализация и уничтожение. Всегда возвращают 0 (для единообразия
+// с pthread_mutex_init/pthread_cond_init).
+int futex_mutex_init(futex_mutex_t* m);
+int futex_mutex_destroy(futex_mutex_t* m);
+int futex_cond_init(futex_cond_t* c);
+int futex_cond_destroy(futex_cond_t* c);
+
+// Захват после неудачного быстрого пути: спин, затем ожидание в ядре
+void futex_mutex_lock_slow(futex_mutex_t* m);
+
+static inline bool futex_mutex_trylock(futex_mutex_t* m) {
+    uint32_t expected = 0;
+    return atomic_compare_exchange_strong_explicit(&m->state, &expected, 1,
+                                                   memory_order_acquire,
+                                                   memory_order_relaxed);
+}
+
+static inline void futex_mutex_lock(futex_mutex_t* m) {
+    if (!futex_mutex_trylock(m)) {
+        futex_mutex_lock_slow(m);
+    }
+}
+
+static inline void futex_mutex_unlock(futex_mutex_t* m) {
+    if (atomic_exchange_explicit(&m->state, 0, memory_order_release) == 2) {
+        futex_wake(&m->state, 1, false);
+    }
+}
+
+// Ожидание сигнала. Мьютекс m должен быть захвачен; на время ожидания
+// освобождается и захватывается снова перед возвратом. Возможны ложные
+// пробуждения. Возвращает 0.
+int futex_cond_wait(futex_cond_t* c, futex_mutex_t* m);
+
+// То же с ограничением: deadline — абсолютное время по CLOCK_MONOTONIC.
+// Возвращает 0 или ETIMEDOUT (мьютекс захвачен в обоих случаях).
+int futex_cond_timedwait(futex_cond_t* c, futex_mutex_t* m, const struct timespec* deadline);
+
+// Пробуждение одного ожидающего. Без ожидающих системного вызова нет.
+void futex_cond_signal(futex_cond_t* c);
+
+// Пробуждение всех: один просыпается, остальные переносятся на мьютекс
+void futex_cond_broadcast(futex_cond_t* c);
+
+#endif // FUTEX_LOCK_H
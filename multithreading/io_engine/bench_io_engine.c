@@ -0,0 +1,425 @@
+#define _GNU_SOURCE
+#include "io_engine.h"
+#include "../../common/futex.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// Замер в духе fio: блоки по bs байт случайно (или подряд) по файлу size
+// байт, iodepth запросов в полете, всего ops запросов.
+//   blocking  — поток на каждый блокирующий вызов: iodepth потоков делают
+//               pread/pwrite в цикле (iodepth запросов в полете)
+//   io_engine — пул из нескольких потоков и io_uring: iodepth запросов в
+//               полете, следующий запрос ставит продолжение предыдущего
+// Для каждого варианта: IOPS, МБ/с, задержка запроса, время CPU процесса
+// и число переключений контекста; для io_engine — запросов на отправку.
+// После записи файл сбрасывается на диск (blocking: fsync, io_engine: fsync
+// через io_uring), это время входит в замер.
+//
+// Без --direct чтения обслуживает страничный кэш (файл только что
+// записан), то есть замеряется стоимость вызова, а не диска.
+//
+// Запуск: ./bench_io_engine [--rw randread|randwrite|read|write] [--bs 4096]
+//         [--size 64M] [--iodepth 64] [--ops 100000] [--threads 2]
+//         [--direct] [--file путь]
+
+#define DEFAULT_PATH "/tmp/bench_io_engine.dat"
+#define FILL_CHUNK (1024 * 1024)
+
+typedef enum { RW_RANDREAD, RW_RANDWRITE, RW_READ, RW_WRITE } rw_mode_t;
+
+static const char* rw_names[] = { "randread", "randwrite", "read", "write" };
+
+typedef struct {
+    rw_mode_t rw;
+    size_t bs;
+    off_t size;
+    int iodepth;
+    long ops;
+    int threads;
+    bool direct;
+    const char* path;
+} bench_config_t;
+
+typedef struct bench bench_t;
+
+// Запрос в полете: у каждого свой буфер и своя гистограмма (писатель
+// у гистограммы один — запросы одного слота идут строго друг за другом)
+typedef struct {
+    bench_t* bench;
+    int index;
+    unsigned char* buffer;    // blocking: свой буфер; io_engine: зарегистрированный
+    uint64_t start_ns;
+    uint64_t random;
+    latency_histogram_t latency;
+} slot_t;
+
+struct bench {
+    bench_config_t config;
+    int fd;
+    io_engine_t* engine;
+    slot_t* slots;
+    atomic_long issued;       // Выдано запросов (номер следующего)
+    atomic_long errors;
+    _Atomic uint32_t active;  // futex: слотов, еще выполняющих запросы
+};
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static bool is_write(const bench_t* b) {
+    return b->config.rw == RW_RANDWRITE || b->config.rw == RW_WRITE;
+}
+
+// Смещение запроса number; false — запросы кончились
+static bool next_offset(bench_t* b, slot_t* s, off_t* offset) {
+    long number = atomic_fetch_add_explicit(&b->issued, 1, memory_order_relaxed);
+    if (number >= b->config.ops) {
+        return false;
+    }
+    off_t blocks = b->config.size / (off_t)b->config.bs;
+    off_t block;
+    if (b->config.rw == RW_RANDREAD || b->config.rw == RW_RANDWRITE) {
+        // xorshift64 на слот: без общего состояния генератора
+        s->random ^= s->random << 13;
+        s->random ^= s->random >> 7;
+        s->random ^= s->random << 17;
+        block = (off_t)(s->random % (uint64_t)blocks);
+    } else {
+        block = (off_t)(number % blocks);
+    }
+    *offset = block * (off_t)b->config.bs;
+    return true;
+}
+
+static void slot_finished(bench_t* b) {
+    if (atomic_fetch_sub(&b->active, 1) == 1) {
+        futex_wake(&b->active, 1, false);
+    }
+}
+
+static void wait_slots(bench_t* b) {
+    uint32_t active;
+    while ((active = atomic_load(&b->active)) != 0) {
+        futex_wait(&b->active, active, NULL, false);
+    }
+}
+
+// --- blocking: поток на вызов ---
+
+static void* blocking_worker(void* arg) {
+    slot_t* s = (slot_t*)arg;
+    bench_t* b = s->bench;
+    off_t offset;
+    while (next_offset(b, s, &offset)) {
+        uint64_t start = now_ns();
+        ssize_t done = is_write(b) ? pwrite(b->fd, s->buffer, b->config.bs, offset)
+                                   : pread(b->fd, s->buffer, b->config.bs, offset);
+        latency_histogram_record(&s->latency, now_ns() - start);
+        if (done != (ssize_t)b->config.bs) {
+            atomic_fetch_add(&b->errors, 1);
+        }
+    }
+    return NULL;
+}
+
+static void run_blocking(bench_t* b) {
+    pthread_t* tids = (pthread_t*)calloc(b->config.iodepth, sizeof(pthread_t));
+    for (int i = 0; i < b->config.iodepth; i++) {
+        pthread_create(&tids[i], NULL, blocking_worker, &b->slots[i]);
+    }
+    for (int i = 0; i < b->config.iodepth; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    if (is_write(b) && fsync(b->fd) != 0) {
+        atomic_fetch_add(&b->errors, 1);
+    }
+    free(tids);
+}
+
+// --- io_engine: продолжения в пуле ---
+
+static void on_complete(void* arg, int result);
+
+// Следующий запрос слота; false — запросы кончились
+static bool issue(slot_t* s) {
+    bench_t* b = s->bench;
+    off_t offset;
+    if (!next_offset(b, s, &offset)) {
+        return false;
+    }
+    s->start_ns = now_ns();
+    int rc = is_write(b)
+        ? io_engine_write_fixed(b->engine, b->fd, s->index, b->config.bs, offset, on_complete, s)
+        : io_engine_read_fixed(b->engine, b->fd, s->index, b->config.bs, offset, on_complete, s);
+    if (rc != 0) {
+        atomic_fetch_add(&b->errors, 1);
+        return false;
+    }
+    return true;
+}
+
+static void on_complete(void* arg, int result) {
+    slot_t* s = (slot_t*)arg;
+    bench_t* b = s->bench;
+    latency_histogram_record(&s->latency, now_ns() - s->start_ns);
+    if (result != (int)b->config.bs) {
+        atomic_fetch_add(&b->errors, 1);
+    }
+    if (!issue(s)) {
+        slot_finished(b);
+    }
+}
+
+static void on_fsync(void* arg, int result) {
+    bench_t* b = (bench_t*)arg;
+    if (result != 0) {
+        atomic_fetch_add(&b->errors, 1);
+    }
+    slot_finished(b);
+}
+
+static void run_io_engine(bench_t* b) {
+    for (int i = 0; i < b->config.iodepth; i++) {
+        if (!issue(&b->slots[i])) {
+            slot_finished(b);
+        }
+    }
+    io_engine_submit(b->engine);
+    wait_slots(b);
+
+    if (is_write(b)) {
+        atomic_store(&b->active, 1);
+        io_engine_fsync(b->engine, b->fd, false, on_fsync, b);
+        io_engine_submit(b->engine);
+        wait_slots(b);
+    }
+}
+
+// --- общее ---
+
+static int prepare_file(const bench_config_t* config) {
+    struct stat st;
+    if (stat(config->path, &st) == 0 && st.st_size >= config->size) {
+        return 0;
+    }
+    int fd = open(config->path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+    unsigned char* chunk = (unsigned char*)malloc(FILL_CHUNK);
+    if (!chunk) {
+        close(fd);
+        return -1;
+    }
+    for (size_t i = 0; i < FILL_CHUNK; i++) {
+        chunk[i] = (unsigned char)(i * 131 + 7);
+    }
+    for (off_t done = 0; done < config->size; done += FILL_CHUNK) {
+        size_t len = config->size - done < FILL_CHUNK ? (size_t)(config->size - done) : FILL_CHUNK;
+        if (write(fd, chunk, len) != (ssize_t)len) {
+            free(chunk);
+            close(fd);
+            return -1;
+        }
+    }
+    free(chunk);
+    int rc = fsync(fd);
+    close(fd);
+    return rc;
+}
+
+static double cpu_sec(const struct rusage* ru) {
+    return ru->ru_utime.tv_sec + ru->ru_utime.tv_usec / 1e6 +
+           ru->ru_stime.tv_sec + ru->ru_stime.tv_usec / 1e6;
+}
+
+static int run_variant(const bench_config_t* config, bool use_engine) {
+    bench_t b = { .config = *config };
+    b.fd = open(config->path, (is_write(&b) ? O_RDWR : O_RDONLY) | (config->direct ? O_DIRECT : 0));
+    if (b.fd < 0) {
+        perror("open");
+        return -1;
+    }
+
+    thread_pool_t* pool = NULL;
+    if (use_engine) {
+        thread_pool_options_t pool_options = { .num_threads = config->threads, .quiet = true };
+        pool = thread_pool_create_with_options(&pool_options);
+        // Очередь отправки не меньше iodepth: начальная пачка уходит одним вызовом
+        io_engine_options_t options = {
+            .queue_depth = (unsigned int)config->iodepth,
+            .num_buffers = config->iodepth,
+            .buffer_size = config->bs,
+        };
+        b.engine = pool ? io_engine_create(pool, &options) : NULL;
+        if (!b.engine) {
+            perror("io_engine_create");
+            if (pool) thread_pool_destroy(pool);
+            close(b.fd);
+            return -1;
+        }
+    }
+
+    b.slots = (slot_t*)calloc(config->iodepth, sizeof(slot_t));
+    for (int i = 0; i < config->iodepth; i++) {
+        slot_t* s = &b.slots[i];
+        s->bench = &b;
+        s->index = i;
+        s->random = 0x9e3779b97f4a7c15ULL * (uint64_t)(i + 1);
+        if (use_engine) {
+            s->buffer = (unsigned char*)io_engine_buffer(b.engine, i);
+        } else {
+            s->buffer = (unsigned char*)aligned_alloc(4096, (config->bs + 4095) / 4096 * 4096);
+        }
+        memset(s->buffer, 0x5a, config->bs);
+    }
+    atomic_store(&b.active, (uint32_t)config->iodepth);
+
+    struct rusage before, after;
+    getrusage(RUSAGE_SELF, &before);
+    uint64_t begin = now_ns();
+    if (use_engine) {
+        run_io_engine(&b);
+    } else {
+        run_blocking(&b);
+    }
+    double elapsed = (now_ns() - begin) / 1e9;
+    getrusage(RUSAGE_SELF, &after);
+
+    latency_histogram_t latency;
+    memset(&latency, 0, sizeof(latency));
+    for (int i = 0; i < config->iodepth; i++) {
+        latency_histogram_merge(&latency, &b.slots[i].latency);
+        if (!use_engine) free(b.slots[i].buffer);
+    }
+    long ops = (long)latency_counter_get(&latency.count);
+    long switches = (after.ru_nvcsw - before.ru_nvcsw) + (after.ru_nivcsw - before.ru_nivcsw);
+
+    char submits[32] = "-";
+    if (use_engine) {
+        io_engine_stats_t stats;
+        io_engine_get_stats(b.engine, &stats);
+        snprintf(submits, sizeof(submits), "%.1f",
+                 stats.submit_calls ? (double)stats.queued / stats.submit_calls : 0.0);
+    }
+    char name[32];
+    if (use_engine) {
+        snprintf(name, sizeof(name), "io_engine/%d", config->threads);
+    } else {
+        snprintf(name, sizeof(name), "blocking/%d", config->iodepth);
+    }
+    printf("%-14s %10.0f %9.1f %9.1f %9.1f %9.1f %8.2f %10ld %9s %6ld\n", name,
+           ops / elapsed, ops * (double)config->bs / elapsed / (1024 * 1024),
+           latency_histogram_mean(&latency) / 1e3,
+           latency_histogram_percentile(&latency, 0.50) / 1e3,
+           latency_histogram_percentile(&latency, 0.99) / 1e3,
+           cpu_sec(&after) - cpu_sec(&before), switches, submits,
+           atomic_load(&b.errors));
+
+    if (use_engine) {
+        io_engine_destroy(b.engine);
+        thread_pool_destroy(pool);
+    }
+    free(b.slots);
+    close(b.fd);
+    return 0;
+}
+
+static off_t parse_size(const char* text) {
+    char* end;
+    double value = strtod(text, &end);
+    switch (*end) {
+        case 'k': case 'K': value *= 1024; break;
+        case 'm': case 'M': value *= 1024 * 1024; break;
+        case 'g': case 'G': value *= 1024.0 * 1024 * 1024; break;
+        default: break;
+    }
+    return (off_t)value;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Использование: %s [--rw randread|randwrite|read|write] [--bs N] "
+            "[--size N[KMG]] [--iodepth N] [--ops N] [--threads N] [--direct] [--file путь]\n",
+            prog);
+}
+
+int main(int argc, char* argv[]) {
+    bench_config_t config = {
+        .rw = RW_RANDREAD,
+        .bs = 4096,
+        .size = 64 * 1024 * 1024,
+        .iodepth = 64,
+        .ops = 100000,
+        .threads = 2,
+        .direct = false,
+        .path = DEFAULT_PATH,
+    };
+    static const struct option long_options[] = {
+        { "rw", required_argument, NULL, 'r' },
+        { "bs", required_argument, NULL, 'b' },
+        { "size", required_argument, NULL, 's' },
+        { "iodepth", required_argument, NULL, 'q' },
+        { "ops", required_argument, NULL, 'n' },
+        { "threads", required_argument, NULL, 't' },
+        { "direct", no_argument, NULL, 'd' },
+        { "file", required_argument, NULL, 'f' },
+        { NULL, 0, NULL, 0 },
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'r': {
+                int found = -1;
+                for (int i = 0; i < 4; i++) {
+                    if (strcmp(optarg, rw_names[i]) == 0) found = i;
+                }
+                if (found < 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                config.rw = (rw_mode_t)found;
+                break;
+            }
+            case 'b': config.bs = (size_t)parse_size(optarg); break;
+            case 's': config.size = parse_size(optarg); break;
+            case 'q': config.iodepth = atoi(optarg); break;
+            case 'n': config.ops = atol(optarg); break;
+            case 't': config.threads = atoi(optarg); break;
+            case 'd': config.direct = true; break;
+            case 'f': config.path = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (config.bs == 0 || config.size < (off_t)config.bs || config.iodepth <= 0 ||
+        config.ops <= 0 || config.threads <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (prepare_file(&config) != 0) {
+        perror(config.path);
+        return 1;
+    }
+    printf("%s, bs %zu, файл %lld МБ%s, iodepth %d, запросов %ld\n\n", rw_names[config.rw],
+           config.bs, (long long)(config.size / (1024 * 1024)),
+           config.direct ? " (O_DIRECT)" : "", config.iodepth, config.ops);
+    printf("%-14s %10s %9s %9s %9s %9s %8s %10s %9s %6s\n", "вариант", "IOPS", "МБ/с",
+           "avg мкс", "p50 мкс", "p99 мкс", "CPU с", "переключ.", "на submit", "ошибок");
+
+    if (run_variant(&config, false) != 0 || run_variant(&config, true) != 0) {
+        return 1;
+    }
+    return 0;
+}
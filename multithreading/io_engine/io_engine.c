@@ -0,0 +1,605 @@
+#include "io_engine.h"
+#include "../../common/futex.h"
+#include <errno.h>
+#include <limits.h>
+#include <linux/io_uring.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// user_data служебного NOP, которым io_engine_destroy будит поток завершений
+#define IO_ENGINE_WAKE_TAG UINT64_MAX
+// Завершений, разбираемых за один проход потока завершений
+#define REAP_BATCH 64
+
+// Слово active: младшие 31 бит — продолжения, еще обращающиеся к движку,
+// старший бит — io_engine_destroy спит на слове и при обнулении нужен futex_wake
+#define ACTIVE_WAITING    0x80000000u
+#define ACTIVE_COUNT_MASK 0x7fffffffu
+
+// Запрос в полете: индекс слота передается ядру в user_data
+typedef struct {
+    io_engine_cb callback;
+    void* arg;
+    uint32_t next_free;
+} io_request_t;
+
+// Задача-продолжение в пуле (копируется в задачу без выделения памяти)
+typedef struct {
+    io_engine_t* engine;
+    io_engine_cb callback;
+    void* arg;
+    int result;
+} io_completion_t;
+
+struct io_engine {
+    thread_pool_t* pool;
+    int ring_fd;
+
+    // Кольцо отправки (общая с ядром память)
+    _Atomic unsigned int* sq_head;
+    _Atomic unsigned int* sq_tail;
+    unsigned int sq_mask;
+    unsigned int sq_entries;
+    struct io_uring_sqe* sqes;
+
+    // Кольцо завершений
+    _Atomic unsigned int* cq_head;
+    _Atomic unsigned int* cq_tail;
+    unsigned int cq_mask;
+    struct io_uring_cqe* cqes;
+
+    void* ring_ptr;
+    size_t ring_size;
+    size_t sqes_size;
+
+    // Очередь отправки и список свободных слотов под одной блокировкой
+    pthread_mutex_t sq_lock;
+    _Atomic unsigned int sq_pending;  // Поставлено, но не отправлено
+    io_request_t* requests;
+    uint32_t free_head;
+
+    // Запросов в полете (поставленных, еще не доставленных в пул); не
+    // больше capacity, поэтому кольцо завершений не переполняется.
+    _Atomic uint32_t inflight;        // futex для ожидающих места и drain
+    atomic_int inflight_waiters;
+    uint32_t capacity;
+
+    // Продолжений, поставленных в пул и еще не завершившихся
+    atomic_int running;
+    // То же, но уменьшается последним обращением продолжения к движку
+    _Atomic uint32_t active;          // Счетчик | ACTIVE_WAITING (слово futex)
+
+    pthread_t reaper;
+    atomic_bool stop;
+
+    // Зарегистрированные буферы
+    unsigned char* buffers;
+    int num_buffers;
+    size_t buffer_size;
+
+    _Atomic uint64_t queued;
+    _Atomic uint64_t completed;
+    _Atomic uint64_t submit_calls;
+    _Atomic uint64_t wait_calls;
+};
+
+static int sys_io_uring_setup(unsigned int entries, struct io_uring_params* params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int sys_io_uring_enter(int fd, unsigned int to_submit, unsigned int min_complete,
+                              unsigned int flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int sys_io_uring_register(int fd, unsigned int opcode, const void* arg,
+                                 unsigned int nr_args) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+// Движок, чьи завершения разбирает текущий поток (NULL вне потока завершений)
+static __thread io_engine_t* reaper_engine;
+
+// Запросы, поставленные продолжениями, отправляет последнее из
+// выполняющихся продолжений: одна отправка на пачку, а не на каждое.
+// После уменьшения active движок может быть сразу уничтожен в
+// io_engine_destroy, поэтому к нему больше не обращаемся: futex_wake по
+// освобожденному адресу безвреден.
+static void io_engine_run_completion(void* arg) {
+    io_completion_t* completion = (io_completion_t*)arg;
+    io_engine_t* engine = completion->engine;
+    completion->callback(completion->arg, completion->result);
+    if (atomic_fetch_sub(&engine->running, 1) == 1 &&
+        atomic_load_explicit(&engine->sq_pending, memory_order_relaxed) > 0) {
+        io_engine_submit(engine);
+    }
+    uint32_t old = atomic_fetch_sub(&engine->active, 1);
+    if ((old & ACTIVE_COUNT_MASK) == 1 && (old & ACTIVE_WAITING)) {
+        futex_wake(&engine->active, INT_MAX, false);
+    }
+}
+
+// Отправка накопленного; вызывается под sq_lock
+static int io_engine_submit_locked(io_engine_t* engine) {
+    unsigned int pending = atomic_load_explicit(&engine->sq_pending, memory_order_relaxed);
+    if (pending == 0) {
+        return 0;
+    }
+    int submitted;
+    do {
+        submitted = sys_io_uring_enter(engine->ring_fd, pending, 0, 0);
+    } while (submitted < 0 && errno == EINTR);
+    if (submitted < 0) {
+        return -1;
+    }
+    atomic_store_explicit(&engine->sq_pending, pending - (unsigned int)submitted,
+                          memory_order_relaxed);
+    atomic_fetch_add_explicit(&engine->submit_calls, 1, memory_order_relaxed);
+    return submitted;
+}
+
+// Свободная SQE; если кольцо отправки заполнено, оно сначала отправляется.
+// Вызывается под sq_lock.
+static struct io_uring_sqe* io_engine_get_sqe(io_engine_t* engine) {
+    unsigned int tail = atomic_load_explicit(engine->sq_tail, memory_order_relaxed);
+    if (tail - atomic_load_explicit(engine->sq_head, memory_order_acquire) >= engine->sq_entries) {
+        if (io_engine_submit_locked(engine) < 0) {
+            return NULL;
+        }
+        if (tail - atomic_load_explicit(engine->sq_head, memory_order_acquire) >=
+            engine->sq_entries) {
+            errno = EAGAIN;
+            return NULL;
+        }
+    }
+    struct io_uring_sqe* sqe = &engine->sqes[tail & engine->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+// Публикация заполненной SQE для ядра; вызывается под sq_lock
+static void io_engine_commit_sqe(io_engine_t* engine) {
+    unsigned int tail = atomic_load_explicit(engine->sq_tail, memory_order_relaxed);
+    atomic_store_explicit(engine->sq_tail, tail + 1, memory_order_release);
+    atomic_fetch_add_explicit(&engine->sq_pending, 1, memory_order_relaxed);
+}
+
+// Место в полете: ждет, пока поток завершений не освободит слот. Сам
+// поток завершений (продолжение, выполняемое им после отказа пула) ждать
+// не может — слоты освобождает только он, поэтому получает EAGAIN.
+static int io_engine_reserve(io_engine_t* engine) {
+    uint32_t current = atomic_load(&engine->inflight);
+    for (;;) {
+        if (current < engine->capacity) {
+            if (atomic_compare_exchange_weak(&engine->inflight, &current, current + 1)) {
+                return 0;
+            }
+            continue;
+        }
+        if (reaper_engine == engine) {
+            errno = EAGAIN;
+            return -1;
+        }
+        // Все места могут быть заняты еще не отправленными запросами
+        if (atomic_load_explicit(&engine->sq_pending, memory_order_relaxed) > 0) {
+            io_engine_submit(engine);
+        }
+        atomic_fetch_add(&engine->inflight_waiters, 1);
+        futex_wait(&engine->inflight, current, NULL, false);
+        atomic_fetch_sub(&engine->inflight_waiters, 1);
+        current = atomic_load(&engine->inflight);
+    }
+}
+
+static void io_engine_release(io_engine_t* engine, uint32_t count) {
+    atomic_fetch_sub(&engine->inflight, count);
+    if (atomic_load(&engine->inflight_waiters) > 0) {
+        futex_wake(&engine->inflight, INT_MAX, false);
+    }
+}
+
+// Общая часть постановки запроса
+static int io_engine_queue(io_engine_t* engine, uint8_t opcode, int fd, uint64_t addr,
+                           size_t len, off_t offset, int buf_index, uint32_t rw_flags,
+                           io_engine_cb callback, void* arg) {
+    if (!engine || fd < 0 || len > INT_MAX || offset < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (io_engine_reserve(engine) != 0) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&engine->sq_lock);
+    struct io_uring_sqe* sqe = io_engine_get_sqe(engine);
+    if (!sqe) {
+        int saved = errno;
+        pthread_mutex_unlock(&engine->sq_lock);
+        io_engine_release(engine, 1);
+        errno = saved;
+        return -1;
+    }
+    // Слот есть всегда: свободных слотов не меньше, чем мест в полете
+    uint32_t slot = engine->free_head;
+    engine->free_head = engine->requests[slot].next_free;
+    engine->requests[slot].callback = callback;
+    engine->requests[slot].arg = arg;
+
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = addr;
+    sqe->len = (uint32_t)len;
+    sqe->off = (uint64_t)offset;
+    sqe->rw_flags = (__kernel_rwf_t)rw_flags;
+    sqe->buf_index = (uint16_t)buf_index;
+    sqe->user_data = slot;
+    io_engine_commit_sqe(engine);
+    atomic_fetch_add_explicit(&engine->queued, 1, memory_order_relaxed);
+    pthread_mutex_unlock(&engine->sq_lock);
+    return 0;
+}
+
+// Поток завершений: забирает CQE пачками, возвращает слоты и ставит
+// продолжения в пул. Пока в полете ничего нет, спит в io_uring_enter.
+static void* io_engine_reaper(void* arg) {
+    io_engine_t* engine = (io_engine_t*)arg;
+    io_completion_t batch[REAP_BATCH];
+    uint32_t slots[REAP_BATCH];
+    reaper_engine = engine;
+
+    for (;;) {
+        unsigned int head = atomic_load_explicit(engine->cq_head, memory_order_relaxed);
+        unsigned int tail = atomic_load_explicit(engine->cq_tail, memory_order_acquire);
+        if (head == tail) {
+            if (atomic_load(&engine->stop)) {
+                break;
+            }
+            // Запросы, поставленные без io_engine_submit, уходят перед сном
+            if (atomic_load_explicit(&engine->sq_pending, memory_order_relaxed) > 0) {
+                io_engine_submit(engine);
+            }
+            sys_io_uring_enter(engine->ring_fd, 0, 1, IORING_ENTER_GETEVENTS);
+            atomic_fetch_add_explicit(&engine->wait_calls, 1, memory_order_relaxed);
+            continue;
+        }
+
+        int count = 0;
+        while (head != tail && count < REAP_BATCH) {
+            struct io_uring_cqe* cqe = &engine->cqes[head & engine->cq_mask];
+            head++;
+            if (cqe->user_data == IO_ENGINE_WAKE_TAG) {
+                continue;
+            }
+            io_request_t* request = &engine->requests[cqe->user_data];
+            batch[count].engine = engine;
+            batch[count].callback = request->callback;
+            batch[count].arg = request->arg;
+            batch[count].result = cqe->res;
+            slots[count] = (uint32_t)cqe->user_data;
+            count++;
+        }
+        atomic_store_explicit(engine->cq_head, head, memory_order_release);
+        if (count == 0) {
+            continue;
+        }
+
+        pthread_mutex_lock(&engine->sq_lock);
+        for (int i = 0; i < count; i++) {
+            engine->requests[slots[i]].next_free = engine->free_head;
+            engine->free_head = slots[i];
+        }
+        pthread_mutex_unlock(&engine->sq_lock);
+
+        int delivered = 0;
+        for (int i = 0; i < count; i++) {
+            if (batch[i].callback) {
+                batch[delivered++] = batch[i];
+            }
+        }
+        atomic_fetch_add(&engine->running, delivered);
+        atomic_fetch_add(&engine->active, (uint32_t)delivered);
+        // Отвергнутые пулом (он уже останавливается) продолжения
+        // откладываются в начало batch и выполняются здесь
+        int deferred = 0;
+        for (int i = 0; i < delivered; i++) {
+            if (thread_pool_add_task_copy(engine->pool, io_engine_run_completion,
+                                          &batch[i], sizeof(batch[i])) != 0) {
+                batch[deferred++] = batch[i];
+            }
+        }
+        atomic_fetch_add_explicit(&engine->completed, (uint64_t)count, memory_order_relaxed);
+        // Место освобождается после доставки: drain возвращается, когда все
+        // продолжения уже в пуле
+        io_engine_release(engine, (uint32_t)count);
+        // Отложенные выполняются после возврата слотов пачки: их новые
+        // запросы получают освободившееся место
+        for (int i = 0; i < deferred; i++) {
+            io_engine_run_completion(&batch[i]);
+        }
+    }
+    return NULL;
+}
+
+static void io_engine_unmap(io_engine_t* engine) {
+    if (engine->sqes) munmap(engine->sqes, engine->sqes_size);
+    if (engine->ring_ptr) munmap(engine->ring_ptr, engine->ring_size);
+    if (engine->ring_fd >= 0) close(engine->ring_fd);
+    free(engine->requests);
+    free(engine->buffers);
+    free(engine);
+}
+
+// Отображение колец по смещениям из io_uring_params
+static int io_engine_map_rings(io_engine_t* engine, struct io_uring_params* params) {
+    size_t sq_size = params->sq_off.array + params->sq_entries * sizeof(uint32_t);
+    size_t cq_size = params->cq_off.cqes + params->cq_entries * sizeof(struct io_uring_cqe);
+    if (!(params->features & IORING_FEAT_SINGLE_MMAP)) {
+        // Ядра до 5.4 не поддерживаются: там кольца отображаются раздельно
+        errno = ENOSYS;
+        return -1;
+    }
+    engine->ring_size = sq_size > cq_size ? sq_size : cq_size;
+    void* ring = mmap(NULL, engine->ring_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, engine->ring_fd, IORING_OFF_SQ_RING);
+    if (ring == MAP_FAILED) {
+        return -1;
+    }
+    engine->ring_ptr = ring;
+
+    engine->sqes_size = params->sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(NULL, engine->sqes_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, engine->ring_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        return -1;
+    }
+    engine->sqes = (struct io_uring_sqe*)sqes;
+
+    unsigned char* base = (unsigned char*)ring;
+    engine->sq_head = (_Atomic unsigned int*)(base + params->sq_off.head);
+    engine->sq_tail = (_Atomic unsigned int*)(base + params->sq_off.tail);
+    engine->sq_mask = *(unsigned int*)(base + params->sq_off.ring_mask);
+    engine->sq_entries = params->sq_entries;
+    engine->cq_head = (_Atomic unsigned int*)(base + params->cq_off.head);
+    engine->cq_tail = (_Atomic unsigned int*)(base + params->cq_off.tail);
+    engine->cq_mask = *(unsigned int*)(base + params->cq_off.ring_mask);
+    engine->cqes = (struct io_uring_cqe*)(base + params->cq_off.cqes);
+
+    // Массив индексов SQ заполняется раз и навсегда: i-я позиция — i-я SQE
+    uint32_t* array = (uint32_t*)(base + params->sq_off.array);
+    for (unsigned int i = 0; i < params->sq_entries; i++) {
+        array[i] = i;
+    }
+    return 0;
+}
+
+static int io_engine_register_buffers(io_engine_t* engine, const io_engine_options_t* options) {
+    const size_t page = 4096;
+    engine->num_buffers = options->num_buffers;
+    engine->buffer_size = (options->buffer_size + page - 1) / page * page;
+    if (engine->buffer_size == 0 || engine->num_buffers > UINT16_MAX) {
+        errno = EINVAL;
+        return -1;
+    }
+    engine->buffers = (unsigned char*)aligned_alloc(page,
+                                                    engine->buffer_size * engine->num_buffers);
+    struct iovec* iov = (struct iovec*)calloc(engine->num_buffers, sizeof(struct iovec));
+    if (!engine->buffers || !iov) {
+        free(iov);
+        errno = ENOMEM;
+        return -1;
+    }
+    memset(engine->buffers, 0, engine->buffer_size * engine->num_buffers);
+    for (int i = 0; i < engine->num_buffers; i++) {
+        iov[i].iov_base = engine->buffers + (size_t)i * engine->buffer_size;
+        iov[i].iov_len = engine->buffer_size;
+    }
+    int rc = sys_io_uring_register(engine->ring_fd, IORING_REGISTER_BUFFERS, iov,
+                                   (unsigned int)engine->num_buffers);
+    free(iov);
+    return rc < 0 ? -1 : 0;
+}
+
+io_engine_t* io_engine_create(thread_pool_t* pool, const io_engine_options_t* options) {
+    io_engine_options_t defaults = { 0 };
+    if (!options) {
+        options = &defaults;
+    }
+    if (!pool || options->num_buffers < 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    io_engine_t* engine = (io_engine_t*)calloc(1, sizeof(io_engine_t));
+    if (!engine) {
+        return NULL;
+    }
+    engine->pool = pool;
+
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    unsigned int depth = options->queue_depth ? options->queue_depth
+                                              : IO_ENGINE_DEFAULT_QUEUE_DEPTH;
+    engine->ring_fd = sys_io_uring_setup(depth, &params);
+    if (engine->ring_fd < 0 || io_engine_map_rings(engine, &params) != 0) {
+        int saved = errno;
+        io_engine_unmap(engine);
+        errno = saved;
+        return NULL;
+    }
+
+    // Мест в полете столько же, сколько CQE: кольцо завершений не переполнится
+    engine->capacity = params.cq_entries;
+    engine->requests = (io_request_t*)calloc(engine->capacity, sizeof(io_request_t));
+    if (!engine->requests) {
+        io_engine_unmap(engine);
+        errno = ENOMEM;
+        return NULL;
+    }
+    for (uint32_t i = 0; i < engine->capacity; i++) {
+        engine->requests[i].next_free = i + 1;
+    }
+    engine->free_head = 0;
+
+    if (options->num_buffers > 0 && io_engine_register_buffers(engine, options) != 0) {
+        int saved = errno;
+        io_engine_unmap(engine);
+        errno = saved;
+        return NULL;
+    }
+
+    pthread_mutex_init(&engine->sq_lock, NULL);
+    atomic_init(&engine->sq_pending, 0);
+    atomic_init(&engine->inflight, 0);
+    atomic_init(&engine->inflight_waiters, 0);
+    atomic_init(&engine->running, 0);
+    atomic_init(&engine->active, 0);
+    atomic_init(&engine->stop, false);
+
+    // Поток завершений не принимает сигналы (как и поток async_log):
+    // иначе io_uring_enter прерывался бы сигналами, адресованными программе
+    sigset_t all, saved_mask;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &saved_mask);
+    int rc = pthread_create(&engine->reaper, NULL, io_engine_reaper, engine);
+    pthread_sigmask(SIG_SETMASK, &saved_mask, NULL);
+    if (rc != 0) {
+        pthread_mutex_destroy(&engine->sq_lock);
+        io_engine_unmap(engine);
+        errno = rc;
+        return NULL;
+    }
+    return engine;
+}
+
+// Ожидание, пока продолжения не перестанут обращаться к движку
+static void io_engine_wait_active(io_engine_t* engine) {
+    uint32_t state = atomic_load(&engine->active);
+    while ((state & ACTIVE_COUNT_MASK) != 0) {
+        if (!(state & ACTIVE_WAITING)) {
+            if (!atomic_compare_exchange_weak(&engine->active, &state,
+                                              state | ACTIVE_WAITING)) {
+                continue;
+            }
+            state |= ACTIVE_WAITING;
+        }
+        futex_wait(&engine->active, state, NULL, false);
+        state = atomic_load(&engine->active);
+    }
+}
+
+void io_engine_destroy(io_engine_t* engine) {
+    if (!engine) {
+        return;
+    }
+    // Продолжения могут ставить новые запросы: ждем, пока не останется ни
+    // запросов в полете, ни выполняющихся продолжений
+    do {
+        io_engine_drain(engine);
+        io_engine_wait_active(engine);
+    } while (atomic_load(&engine->inflight) != 0);
+
+    // Служебный NOP будит поток завершений, спящий в io_uring_enter
+    atomic_store(&engine->stop, true);
+    pthread_mutex_lock(&engine->sq_lock);
+    struct io_uring_sqe* sqe = io_engine_get_sqe(engine);
+    if (sqe) {
+        sqe->opcode = IORING_OP_NOP;
+        sqe->user_data = IO_ENGINE_WAKE_TAG;
+        io_engine_commit_sqe(engine);
+        io_engine_submit_locked(engine);
+    }
+    pthread_mutex_unlock(&engine->sq_lock);
+    pthread_join(engine->reaper, NULL);
+
+    pthread_mutex_destroy(&engine->sq_lock);
+    // Закрытие кольца снимает и регистрацию буферов
+    io_engine_unmap(engine);
+}
+
+int io_engine_read(io_engine_t* engine, int fd, void* buf, size_t len, off_t offset,
+                   io_engine_cb callback, void* arg) {
+    return io_engine_queue(engine, IORING_OP_READ, fd, (uint64_t)(uintptr_t)buf, len, offset,
+                           0, 0, callback, arg);
+}
+
+int io_engine_write(io_engine_t* engine, int fd, const void* buf, size_t len, off_t offset,
+                    io_engine_cb callback, void* arg) {
+    return io_engine_queue(engine, IORING_OP_WRITE, fd, (uint64_t)(uintptr_t)buf, len, offset,
+                           0, 0, callback, arg);
+}
+
+int io_engine_fsync(io_engine_t* engine, int fd, bool datasync,
+                    io_engine_cb callback, void* arg) {
+    return io_engine_queue(engine, IORING_OP_FSYNC, fd, 0, 0, 0, 0,
+                           datasync ? IORING_FSYNC_DATASYNC : 0, callback, arg);
+}
+
+int io_engine_read_fixed(io_engine_t* engine, int fd, int index, size_t len, off_t offset,
+                         io_engine_cb callback, void* arg) {
+    void* buf = io_engine_buffer(engine, index);
+    if (!buf || len > engine->buffer_size) {
+        errno = EINVAL;
+        return -1;
+    }
+    return io_engine_queue(engine, IORING_OP_READ_FIXED, fd, (uint64_t)(uintptr_t)buf, len,
+                           offset, index, 0, callback, arg);
+}
+
+int io_engine_write_fixed(io_engine_t* engine, int fd, int index, size_t len, off_t offset,
+                          io_engine_cb callback, void* arg) {
+    void* buf = io_engine_buffer(engine, index);
+    if (!buf || len > engine->buffer_size) {
+        errno = EINVAL;
+        return -1;
+    }
+    return io_engine_queue(engine, IORING_OP_WRITE_FIXED, fd, (uint64_t)(uintptr_t)buf, len,
+                           offset, index, 0, callback, arg);
+}
+
+void* io_engine_buffer(io_engine_t* engine, int index) {
+    if (!engine || index < 0 || index >= engine->num_buffers) {
+        return NULL;
+    }
+    return engine->buffers + (size_t)index * engine->buffer_size;
+}
+
+int io_engine_submit(io_engine_t* engine) {
+    if (!engine) {
+        errno = EINVAL;
+        return -1;
+    }
+    pthread_mutex_lock(&engine->sq_lock);
+    int submitted = io_engine_submit_locked(engine);
+    pthread_mutex_unlock(&engine->sq_lock);
+    return submitted;
+}
+
+void io_engine_drain(io_engine_t* engine) {
+    if (!engine) {
+        return;
+    }
+    io_engine_submit(engine);
+    uint32_t current;
+    while ((current = atomic_load(&engine->inflight)) != 0) {
+        atomic_fetch_add(&engine->inflight_waiters, 1);
+        futex_wait(&engine->inflight, current, NULL, false);
+        atomic_fetch_sub(&engine->inflight_waiters, 1);
+    }
+}
+
+void io_engine_get_stats(io_engine_t* engine, io_engine_stats_t* stats) {
+    if (!engine || !stats) {
+        return;
+    }
+    stats->queued = atomic_load_explicit(&engine->queued, memory_order_relaxed);
+    stats->completed = atomic_load_explicit(&engine->completed, memory_order_relaxed);
+    stats->submit_calls = atomic_load_explicit(&engine->submit_calls, memory_order_relaxed);
+    stats->wait_calls = atomic_load_explicit(&engine->wait_calls, memory_order_relaxed);
+}
@@ -0,0 +1,88 @@
+#ifndef IO_ENGINE_H
+#define IO_ENGINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "../thread_pool/thread_pool.h"
+
+// Асинхронный файловый ввод-вывод через io_uring (системные вызовы
+// напрямую, без liburing) с доставкой завершений в пул потоков.
+//
+// io_engine_read/write/fsync только ставят запрос в очередь отправки
+// (SQ); io_engine_submit отправляет все накопленное одним io_uring_enter,
+// поэтому запросы, поставленные разными потоками между двумя отправками,
+// уходят в ядро пакетом. Отдельный поток ждет завершений и для каждого
+// ставит в пул задачу-продолжение callback(arg, result): рабочий поток
+// пула не блокируется на вводе-выводе, и несколько потоков держат в
+// полете тысячи запросов.
+//
+// Запросы, поставленные вне продолжений, нужно отправить io_engine_submit.
+// Запросы, поставленные из продолжений, отправляются сами, когда
+// завершается последнее выполняющееся продолжение (одна отправка на пачку).
+//
+// Зарегистрированные буферы (options.num_buffers) закрепляются ядром один
+// раз при создании; запросы *_fixed не отображают страницы заново на
+// каждый вызов.
+
+#define IO_ENGINE_DEFAULT_QUEUE_DEPTH 256
+
+// Продолжение: result — число байт или -errno
+typedef void (*io_engine_cb)(void* arg, int result);
+
+typedef struct {
+    unsigned int queue_depth; // Размер SQ (0 — по умолчанию); в полете
+                              // может быть до 2 * queue_depth запросов
+    int num_buffers;          // Зарегистрированных буферов (0 — без них)
+    size_t buffer_size;       // Размер каждого (кратен 4096)
+} io_engine_options_t;
+
+typedef struct {
+    uint64_t queued;          // Поставлено запросов
+    uint64_t completed;       // Получено завершений
+    uint64_t submit_calls;    // io_uring_enter с отправкой
+    uint64_t wait_calls;      // io_uring_enter с ожиданием завершений
+} io_engine_stats_t;
+
+typedef struct io_engine io_engine_t;
+
+// Создание кольца и потока завершений. options может быть NULL.
+// Возвращает NULL с errno при ошибке (ENOSYS — ядро без io_uring).
+io_engine_t* io_engine_create(thread_pool_t* pool, const io_engine_options_t* options);
+
+// Ожидание всех запросов в полете и всех продолжений (вместе с запросами,
+// которые они ставят) и уничтожение. Нельзя вызывать из продолжения.
+void io_engine_destroy(io_engine_t* engine);
+
+// Постановка запросов в очередь. Если в полете уже предельное число
+// запросов, вызывающий ждет освобождения места; продолжение, которое
+// остановленный пул отверг и которое выполняется в потоке завершений,
+// вместо ожидания получает EAGAIN. Возвращают 0 или -1 с errno.
+int io_engine_read(io_engine_t* engine, int fd, void* buf, size_t len, off_t offset,
+                   io_engine_cb callback, void* arg);
+int io_engine_write(io_engine_t* engine, int fd, const void* buf, size_t len, off_t offset,
+                    io_engine_cb callback, void* arg);
+int io_engine_fsync(io_engine_t* engine, int fd, bool datasync,
+                    io_engine_cb callback, void* arg);
+
+// То же с зарегистрированным буфером index (len <= buffer_size)
+int io_engine_read_fixed(io_engine_t* engine, int fd, int index, size_t len, off_t offset,
+                         io_engine_cb callback, void* arg);
+int io_engine_write_fixed(io_engine_t* engine, int fd, int index, size_t len, off_t offset,
+                          io_engine_cb callback, void* arg);
+
+// Зарегистрированный буфер index (NULL, если такого нет)
+void* io_engine_buffer(io_engine_t* engine, int index);
+
+// Отправка всех поставленных запросов. Возвращает число отправленных
+// или -1 с errno.
+int io_engine_submit(io_engine_t* engine);
+
+// Отправка и ожидание, пока в полете не останется запросов (продолжения
+// при этом уже поставлены в пул, но могут еще выполняться)
+void io_engine_drain(io_engine_t* engine);
+
+void io_engine_get_stats(io_engine_t* engine, io_engine_stats_t* stats);
+
+#endif // IO_ENGINE_H
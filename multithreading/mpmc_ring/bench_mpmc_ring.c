@@ -0,0 +1,210 @@
+#include "mpmc_ring.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Сравнение RingBuffer из condition_variables.c (мьютекс и две условные
+// переменные, без printf) с mpmc_ring при поштучной и пакетной передаче.
+// Конфигурации 2 производителя / 3 потребителя и 16 / 16.
+
+#define CAPACITY 1024
+#define TOTAL_ITEMS 2000000L
+#define BATCH 16
+#define POISON (-1L)
+
+typedef enum { MODE_MUTEX, MODE_RING, MODE_RING_BATCH } mode_t_;
+
+// Кольцевой буфер на мьютексе, как в condition_variables.c
+typedef struct {
+    long buffer[CAPACITY];
+    int count;
+    int in;
+    int out;
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+} RingBuffer;
+
+static void buffer_put(RingBuffer* rb, long value) {
+    pthread_mutex_lock(&rb->mutex);
+    while (rb->count == CAPACITY) {
+        pthread_cond_wait(&rb->not_full, &rb->mutex);
+    }
+    rb->buffer[rb->in] = value;
+    rb->in = (rb->in + 1) % CAPACITY;
+    rb->count++;
+    pthread_cond_signal(&rb->not_empty);
+    pthread_mutex_unlock(&rb->mutex);
+}
+
+static long buffer_get(RingBuffer* rb) {
+    pthread_mutex_lock(&rb->mutex);
+    while (rb->count == 0) {
+        pthread_cond_wait(&rb->not_empty, &rb->mutex);
+    }
+    long value = rb->buffer[rb->out];
+    rb->out = (rb->out + 1) % CAPACITY;
+    rb->count--;
+    pthread_cond_signal(&rb->not_full);
+    pthread_mutex_unlock(&rb->mutex);
+    return value;
+}
+
+typedef struct {
+    mode_t_ mode;
+    RingBuffer* rb;
+    mpmc_ring_t* ring;
+    long first;
+    long count;
+    long sum;
+} worker_arg_t;
+
+static void put_one(worker_arg_t* w, long value) {
+    if (w->mode == MODE_MUTEX) {
+        buffer_put(w->rb, value);
+    } else {
+        mpmc_ring_put(w->ring, &value);
+    }
+}
+
+static void* producer(void* arg) {
+    worker_arg_t* w = (worker_arg_t*)arg;
+
+    if (w->mode == MODE_RING_BATCH) {
+        long batch[BATCH];
+        for (long i = 0; i < w->count; i += BATCH) {
+            long n = w->count - i < BATCH ? w->count - i : BATCH;
+            for (long j = 0; j < n; j++) {
+                batch[j] = w->first + i + j;
+            }
+            mpmc_ring_put_batch(w->ring, batch, (size_t)n);
+        }
+        return NULL;
+    }
+
+    for (long i = 0; i < w->count; i++) {
+        put_one(w, w->first + i);
+    }
+    return NULL;
+}
+
+static void* consumer(void* arg) {
+    worker_arg_t* w = (worker_arg_t*)arg;
+    long sum = 0;
+
+    if (w->mode == MODE_RING_BATCH) {
+        long batch[BATCH];
+        int poison = 0;
+        while (!poison) {
+            size_t n = mpmc_ring_get_batch(w->ring, batch, BATCH);
+            for (size_t j = 0; j < n; j++) {
+                if (batch[j] == POISON) {
+                    poison++;
+                } else {
+                    sum += batch[j];
+                }
+            }
+        }
+        // Лишние маркеры конца возвращаются остальным потребителям
+        for (int i = 1; i < poison; i++) {
+            put_one(w, POISON);
+        }
+        w->sum = sum;
+        return NULL;
+    }
+
+    for (;;) {
+        long value;
+        if (w->mode == MODE_MUTEX) {
+            value = buffer_get(w->rb);
+        } else {
+            mpmc_ring_get(w->ring, &value);
+        }
+        if (value == POISON) break;
+        sum += value;
+    }
+    w->sum = sum;
+    return NULL;
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Прогон; возвращает миллионы элементов в секунду или -1 при ошибке
+static double run(mode_t_ mode, int producers, int consumers) {
+    RingBuffer* rb = calloc(1, sizeof(RingBuffer));
+    mpmc_ring_t ring;
+    pthread_mutex_init(&rb->mutex, NULL);
+    pthread_cond_init(&rb->not_empty, NULL);
+    pthread_cond_init(&rb->not_full, NULL);
+    if (mpmc_ring_init(&ring, CAPACITY, sizeof(long)) != 0) {
+        free(rb);
+        return -1;
+    }
+
+    pthread_t threads[producers + consumers];
+    worker_arg_t args[producers + consumers];
+    long per_producer = TOTAL_ITEMS / producers;
+
+    double start = now_sec();
+    for (int i = 0; i < producers + consumers; i++) {
+        args[i] = (worker_arg_t){.mode = mode, .rb = rb, .ring = &ring};
+        if (i < producers) {
+            args[i].first = i * per_producer;
+            args[i].count = per_producer;
+            pthread_create(&threads[i], NULL, producer, &args[i]);
+        } else {
+            pthread_create(&threads[i], NULL, consumer, &args[i]);
+        }
+    }
+
+    for (int i = 0; i < producers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    // Каждому потребителю по маркеру конца
+    for (int i = 0; i < consumers; i++) {
+        put_one(&args[0], POISON);
+    }
+
+    long sum = 0;
+    for (int i = producers; i < producers + consumers; i++) {
+        pthread_join(threads[i], NULL);
+        sum += args[i].sum;
+    }
+    double elapsed = now_sec() - start;
+
+    long items = per_producer * producers;
+    long expected = items * (items - 1) / 2;
+    if (sum != expected) {
+        fprintf(stderr, "Неверная сумма: %ld, ожидалось %ld\n", sum, expected);
+    }
+
+    mpmc_ring_destroy(&ring);
+    pthread_mutex_destroy(&rb->mutex);
+    pthread_cond_destroy(&rb->not_empty);
+    pthread_cond_destroy(&rb->not_full);
+    free(rb);
+    return sum == expected ? items / elapsed / 1e6 : -1;
+}
+
+int main(void) {
+    const int configs[][2] = {{2, 3}, {16, 16}};
+
+    for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); c++) {
+        int producers = configs[c][0];
+        int consumers = configs[c][1];
+
+        double mutex = run(MODE_MUTEX, producers, consumers);
+        double ring = run(MODE_RING, producers, consumers);
+        double batch = run(MODE_RING_BATCH, producers, consumers);
+
+        printf("%2dP/%2dC  мьютекс: %6.2f млн/с, mpmc_ring: %6.2f млн/с (x%.2f), "
+               "пакетами по %d: %6.2f млн/с (x%.2f)\n",
+               producers, consumers, mutex, ring, ring / mutex, BATCH, batch, batch / mutex);
+    }
+    return 0;
+}
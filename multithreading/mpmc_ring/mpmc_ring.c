@@ -0,0 +1,264 @@
+#include "mpmc_ring.h"
+#include "../../common/futex.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Сколько раз проверить очередь перед тем, как заснуть на futex
+#define MPMC_RING_SPIN 128
+
+typedef struct {
+    atomic_size_t seq;
+    unsigned char data[];
+} mpmc_ring_slot_t;
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+static inline mpmc_ring_slot_t* ring_slot(mpmc_ring_t* ring, size_t pos) {
+    return (mpmc_ring_slot_t*)(ring->slots + (pos & ring->mask) * ring->slot_size);
+}
+
+int mpmc_ring_init(mpmc_ring_t* ring, size_t capacity, size_t elem_size) {
+    if (!ring || capacity == 0 || elem_size == 0 || capacity > (SIZE_MAX >> 2)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    size_t cap = 2;
+    while (cap < capacity) {
+        cap <<= 1;
+    }
+
+    // Номер последовательности и данные, выровненные по 8 байт
+    size_t slot_size = (sizeof(mpmc_ring_slot_t) + elem_size + 7) & ~(size_t)7;
+    size_t bytes = (cap * slot_size + MPMC_RING_CACHE_LINE - 1) & ~(size_t)(MPMC_RING_CACHE_LINE - 1);
+
+    ring->slots = aligned_alloc(MPMC_RING_CACHE_LINE, bytes);
+    if (!ring->slots) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    ring->mask = cap - 1;
+    ring->elem_size = elem_size;
+    ring->slot_size = slot_size;
+
+    for (size_t i = 0; i < cap; i++) {
+        atomic_init(&ring_slot(ring, i)->seq, i);
+    }
+
+    atomic_init(&ring->enqueue_pos, 0);
+    atomic_init(&ring->dequeue_pos, 0);
+    atomic_init(&ring->not_empty_seq, 0);
+    atomic_init(&ring->consumers_sleeping, 0);
+    atomic_init(&ring->not_full_seq, 0);
+    atomic_init(&ring->producers_sleeping, 0);
+    return 0;
+}
+
+void mpmc_ring_destroy(mpmc_ring_t* ring) {
+    if (!ring) return;
+    free(ring->slots);
+    ring->slots = NULL;
+}
+
+size_t mpmc_ring_size(mpmc_ring_t* ring) {
+    size_t tail = atomic_load_explicit(&ring->dequeue_pos, memory_order_acquire);
+    size_t head = atomic_load_explicit(&ring->enqueue_pos, memory_order_acquire);
+    size_t size = head - tail;
+
+    // Индексы читаются не атомарно вместе, поэтому разность может
+    // временно выйти за допустимые пределы
+    if ((intptr_t)size < 0) return 0;
+    if (size > ring->mask + 1) return ring->mask + 1;
+    return size;
+}
+
+// Разбудить потоки, спящие на event. Барьер упорядочивает публикацию
+// ячеек перед проверкой флага — в паре с барьером в mpmc_ring_wait это
+// исключает потерянное пробуждение. Флаг сбрасывает только первый
+// уведомляющий, так что пока разбуженные не заснули снова, остальные
+// операции обходятся без системного вызова.
+static void mpmc_ring_notify(_Atomic uint32_t* event, atomic_int* sleeping) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(sleeping, memory_order_relaxed) &&
+        atomic_exchange_explicit(sleeping, 0, memory_order_relaxed)) {
+        atomic_fetch_add_explicit(event, 1, memory_order_release);
+        futex_wake(event, INT_MAX, false);
+    }
+}
+
+// Очередь полна: ячейка под следующую позицию записи еще не освобождена
+static bool mpmc_ring_full(mpmc_ring_t* ring) {
+    size_t pos = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+    size_t seq = atomic_load_explicit(&ring_slot(ring, pos)->seq, memory_order_acquire);
+    return (intptr_t)(seq - pos) < 0;
+}
+
+// Очередь пуста: ячейка под следующую позицию чтения еще не заполнена
+static bool mpmc_ring_empty(mpmc_ring_t* ring) {
+    size_t pos = atomic_load_explicit(&ring->dequeue_pos, memory_order_relaxed);
+    size_t seq = atomic_load_explicit(&ring_slot(ring, pos)->seq, memory_order_acquire);
+    return (intptr_t)(seq - (pos + 1)) < 0;
+}
+
+// Ожидание, пока очередь перестанет быть полной (for_put) или пустой.
+// Сначала короткое активное ожидание, затем сон на futex.
+static void mpmc_ring_wait(mpmc_ring_t* ring, bool for_put) {
+    bool (*blocked)(mpmc_ring_t*) = for_put ? mpmc_ring_full : mpmc_ring_empty;
+
+    for (int i = 0; i < MPMC_RING_SPIN; i++) {
+        if (!blocked(ring)) return;
+        cpu_relax();
+    }
+
+    _Atomic uint32_t* event = for_put ? &ring->not_full_seq : &ring->not_empty_seq;
+    atomic_int* sleeping = for_put ? &ring->producers_sleeping : &ring->consumers_sleeping;
+
+    // Номер события читаем до установки флага: если уведомление успеет
+    // сбросить флаг, оно же изменит event, и futex_wait сразу вернется
+    uint32_t seen = atomic_load_explicit(event, memory_order_acquire);
+    atomic_store_explicit(sleeping, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    if (blocked(ring)) {
+        futex_wait(event, seen, NULL, false);
+    }
+}
+
+size_t mpmc_ring_try_put_batch(mpmc_ring_t* ring, const void* elems, size_t count) {
+    if (count == 0) return 0;
+
+    size_t pos = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+    size_t n;
+
+    for (;;) {
+        size_t seq = atomic_load_explicit(&ring_slot(ring, pos)->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)(seq - pos);
+
+        if (diff < 0) {
+            return 0;  // Очередь полна
+        }
+        if (diff > 0) {
+            // Позицию уже занял другой производитель
+            pos = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+            continue;
+        }
+
+        // Сколько ячеек подряд свободно. Ячейка со seq == pos + n ждет
+        // именно производителя позиции pos + n, поэтому после успешного
+        // CAS никто другой ее не тронет.
+        n = 1;
+        while (n < count && n <= ring->mask &&
+               atomic_load_explicit(&ring_slot(ring, pos + n)->seq,
+                                    memory_order_acquire) == pos + n) {
+            n++;
+        }
+
+        if (atomic_compare_exchange_weak_explicit(&ring->enqueue_pos, &pos, pos + n,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    const unsigned char* src = (const unsigned char*)elems;
+    for (size_t i = 0; i < n; i++) {
+        mpmc_ring_slot_t* slot = ring_slot(ring, pos + i);
+        memcpy(slot->data, src + i * ring->elem_size, ring->elem_size);
+        atomic_store_explicit(&slot->seq, pos + i + 1, memory_order_release);
+    }
+
+    mpmc_ring_notify(&ring->not_empty_seq, &ring->consumers_sleeping);
+    return n;
+}
+
+size_t mpmc_ring_try_get_batch(mpmc_ring_t* ring, void* elems, size_t max_count) {
+    if (max_count == 0) return 0;
+
+    size_t pos = atomic_load_explicit(&ring->dequeue_pos, memory_order_relaxed);
+    size_t n;
+
+    for (;;) {
+        size_t seq = atomic_load_explicit(&ring_slot(ring, pos)->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)(seq - (pos + 1));
+
+        if (diff < 0) {
+            return 0;  // Очередь пуста
+        }
+        if (diff > 0) {
+            pos = atomic_load_explicit(&ring->dequeue_pos, memory_order_relaxed);
+            continue;
+        }
+
+        n = 1;
+        while (n < max_count && n <= ring->mask &&
+               atomic_load_explicit(&ring_slot(ring, pos + n)->seq,
+                                    memory_order_acquire) == pos + n + 1) {
+            n++;
+        }
+
+        if (atomic_compare_exchange_weak_explicit(&ring->dequeue_pos, &pos, pos + n,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    unsigned char* dst = (unsigned char*)elems;
+    for (size_t i = 0; i < n; i++) {
+        mpmc_ring_slot_t* slot = ring_slot(ring, pos + i);
+        memcpy(dst + i * ring->elem_size, slot->data, ring->elem_size);
+        // Ячейка свободна для позиции следующего круга
+        atomic_store_explicit(&slot->seq, pos + i + ring->mask + 1, memory_order_release);
+    }
+
+    mpmc_ring_notify(&ring->not_full_seq, &ring->producers_sleeping);
+    return n;
+}
+
+bool mpmc_ring_try_put(mpmc_ring_t* ring, const void* elem) {
+    return mpmc_ring_try_put_batch(ring, elem, 1) == 1;
+}
+
+bool mpmc_ring_try_get(mpmc_ring_t* ring, void* elem) {
+    return mpmc_ring_try_get_batch(ring, elem, 1) == 1;
+}
+
+void mpmc_ring_put_batch(mpmc_ring_t* ring, const void* elems, size_t count) {
+    const unsigned char* src = (const unsigned char*)elems;
+
+    while (count > 0) {
+        size_t n = mpmc_ring_try_put_batch(ring, src, count);
+        if (n == 0) {
+            mpmc_ring_wait(ring, true);
+            continue;
+        }
+        src += n * ring->elem_size;
+        count -= n;
+    }
+}
+
+size_t mpmc_ring_get_batch(mpmc_ring_t* ring, void* elems, size_t max_count) {
+    if (max_count == 0) return 0;
+
+    for (;;) {
+        size_t n = mpmc_ring_try_get_batch(ring, elems, max_count);
+        if (n > 0) return n;
+        mpmc_ring_wait(ring, false);
+    }
+}
+
+void mpmc_ring_put(mpmc_ring_t* ring, const void* elem) {
+    mpmc_ring_put_batch(ring, elem, 1);
+}
+
+void mpmc_ring_get(mpmc_ring_t* ring, void* elem) {
+    mpmc_ring_get_batch(ring, elem, 1);
+}
@@ -0,0 +1,69 @@
+#ifndef MPMC_RING_H
+#define MPMC_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Ограниченная кольцевая очередь много производителей / много потребителей
+// для элементов фиксированного размера.
+//
+// Каждая ячейка хранит номер последовательности: ячейка свободна для
+// позиции pos, когда seq == pos, и заполнена, когда seq == pos + 1.
+// Производители и потребители захватывают позиции через CAS на своих
+// индексах и не блокируют друг друга. Если очередь полна или пуста,
+// блокирующие операции после короткого ожидания засыпают на futex.
+
+#define MPMC_RING_CACHE_LINE 64
+
+typedef struct {
+    // Индексы производителей и потребителей на разных кэш-линиях
+    _Alignas(MPMC_RING_CACHE_LINE) atomic_size_t enqueue_pos;
+    _Alignas(MPMC_RING_CACHE_LINE) atomic_size_t dequeue_pos;
+
+    // Счетчики событий для futex и флаги "на них кто-то спит"
+    _Alignas(MPMC_RING_CACHE_LINE) _Atomic uint32_t not_empty_seq;
+    atomic_int consumers_sleeping;
+    _Alignas(MPMC_RING_CACHE_LINE) _Atomic uint32_t not_full_seq;
+    atomic_int producers_sleeping;
+
+    // Неизменяемая после инициализации часть
+    _Alignas(MPMC_RING_CACHE_LINE) size_t mask;
+    size_t elem_size;
+    size_t slot_size;
+    unsigned char* slots;
+} mpmc_ring_t;
+
+// Инициализация: capacity округляется вверх до степени двойки.
+// Возвращает 0 или -1 (errno = EINVAL / ENOMEM).
+int mpmc_ring_init(mpmc_ring_t* ring, size_t capacity, size_t elem_size);
+void mpmc_ring_destroy(mpmc_ring_t* ring);
+
+// Емкость очереди в элементах
+static inline size_t mpmc_ring_capacity(const mpmc_ring_t* ring) {
+    return ring->mask + 1;
+}
+
+// Приблизительное число элементов (точно только без конкурентного доступа)
+size_t mpmc_ring_size(mpmc_ring_t* ring);
+
+// Неблокирующие операции: false, если очередь полна / пуста
+bool mpmc_ring_try_put(mpmc_ring_t* ring, const void* elem);
+bool mpmc_ring_try_get(mpmc_ring_t* ring, void* elem);
+
+// Блокирующие операции
+void mpmc_ring_put(mpmc_ring_t* ring, const void* elem);
+void mpmc_ring_get(mpmc_ring_t* ring, void* elem);
+
+// Пакетные операции: один CAS на весь пакет.
+// try-версии переносят сколько получится (возможно 0) и возвращают число
+// элементов. mpmc_ring_put_batch кладет все count элементов, при
+// необходимости засыпая; mpmc_ring_get_batch ждет хотя бы один элемент
+// и возвращает от 1 до max_count.
+size_t mpmc_ring_try_put_batch(mpmc_ring_t* ring, const void* elems, size_t count);
+size_t mpmc_ring_try_get_batch(mpmc_ring_t* ring, void* elems, size_t max_count);
+void mpmc_ring_put_batch(mpmc_ring_t* ring, const void* elems, size_t count);
+size_t mpmc_ring_get_batch(mpmc_ring_t* ring, void* elems, size_t max_count);
+
+#endif // MPMC_RING_H
@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <pthread.h>
 #include <unistd.h>
+#include "sharded_counter/sharded_counter.h"
 
 #define NUM_THREADS 5
 #define NUM_ITERATIONS 100000
@@ -90,6 +91,18 @@ void* test_recursive_mutex(void* arg) {
     return NULL;
 }
 
+// Пример со счетчиком без мьютекса: у каждого потока свой шард,
+// значение — сумма шардов (см. sharded_counter/bench_sharded_counter.c)
+sharded_counter_t hits;
+
+void* increment_sharded(void* arg) {
+    (void)arg;
+    for (int i = 0; i < NUM_ITERATIONS; i++) {
+        sharded_counter_add(&hits, 1);
+    }
+    return NULL;
+}
+
 int main() {
     pthread_t threads[NUM_THREADS];
     int thread_ids[NUM_THREADS];
@@ -161,6 +174,22 @@ int main() {
         pthread_join(threads[i], NULL);
     }
     
+    printf("\n=== Пример 5: Шардированный счетчик ===\n");
+    sharded_counter_init(&hits, NUM_THREADS);
+    
+    for (int i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, increment_sharded, NULL);
+    }
+    
+    for (int i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    
+    printf("Ожидаемое значение счетчика: %d\n", NUM_THREADS * NUM_ITERATIONS);
+    printf("Фактическое значение счетчика: %llu\n",
+           (unsigned long long)sharded_counter_read(&hits));
+    sharded_counter_destroy(&hits);
+    
     // Очистка ресурсов
     pthread_mutex_destroy(&mutex_counter);
     pthread_mutex_destroy(&recursive_mutex);
@@ -0,0 +1,189 @@
+#include "process_pool.h"
+#include "../thread_pool/thread_pool.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// Накладные расходы на задачу: пустые задачи с аргументом ARG_SIZE байт
+// через thread_pool_add_task_copy, process_pool_add_task и fork на
+// каждую задачу (не больше workers процессов одновременно). Затем
+// проверка изоляции: каждая CRASH_EVERY-я задача падает по SIGSEGV,
+// остальные должны выполниться все, а рабочие — перезапуститься.
+// Запуск: ./bench_process_pool [задач] [рабочих]
+
+#define DEFAULT_TASKS 200000L
+#define FORK_TASKS 2000L      // fork на задачу в сотни раз дороже
+#define ARG_SIZE 64
+#define CRASH_TASKS 20000L
+#define CRASH_EVERY 1000L
+
+typedef struct {
+    long index;
+    char data[ARG_SIZE - sizeof(long)];
+} task_arg_t;
+
+// Счетчик выполненных задач в разделяемой памяти: его видят и рабочие
+// процессы, запущенные после создания отображения
+static _Atomic long* executed;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void empty_task(void* arg) {
+    (void)arg;
+    atomic_fetch_add_explicit(executed, 1, memory_order_relaxed);
+}
+
+static void crashing_task(void* arg) {
+    task_arg_t* a = (task_arg_t*)arg;
+    if (a->index % CRASH_EVERY == CRASH_EVERY - 1) {
+        raise(SIGSEGV);
+    }
+    atomic_fetch_add_explicit(executed, 1, memory_order_relaxed);
+}
+
+static double bench_thread_pool(long tasks, int workers) {
+    thread_pool_options_t options = { .num_threads = workers, .quiet = true };
+    thread_pool_t* pool = thread_pool_create_with_options(&options);
+    if (!pool) {
+        perror("thread_pool_create_with_options");
+        exit(1);
+    }
+    task_arg_t arg;
+    memset(&arg, 0, sizeof(arg));
+    double start = now_sec();
+    for (long i = 0; i < tasks; i++) {
+        arg.index = i;
+        thread_pool_add_task_copy(pool, empty_task, &arg, sizeof(arg));
+    }
+    thread_pool_wait(pool);
+    double elapsed = now_sec() - start;
+    thread_pool_destroy(pool);
+    return elapsed;
+}
+
+static double bench_process_pool(long tasks, int workers) {
+    process_pool_options_t options = { .num_workers = workers, .quiet = true };
+    process_pool_t* pool = process_pool_create_with_options(&options);
+    if (!pool) {
+        perror("process_pool_create_with_options");
+        exit(1);
+    }
+    task_arg_t arg;
+    memset(&arg, 0, sizeof(arg));
+    double start = now_sec();
+    for (long i = 0; i < tasks; i++) {
+        arg.index = i;
+        process_pool_add_task(pool, empty_task, &arg, sizeof(arg));
+    }
+    process_pool_wait(pool);
+    double elapsed = now_sec() - start;
+    process_pool_destroy(pool);
+    return elapsed;
+}
+
+static double bench_fork_per_task(long tasks, int workers) {
+    task_arg_t arg;
+    memset(&arg, 0, sizeof(arg));
+    int running = 0;
+    double start = now_sec();
+    for (long i = 0; i < tasks; i++) {
+        if (running == workers) {
+            wait(NULL);
+            running--;
+        }
+        arg.index = i;
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            exit(1);
+        }
+        if (pid == 0) {
+            empty_task(&arg);
+            _exit(0);
+        }
+        running++;
+    }
+    while (running-- > 0) {
+        wait(NULL);
+    }
+    return now_sec() - start;
+}
+
+static int bench_crashes(int workers) {
+    process_pool_options_t options = { .num_workers = workers, .quiet = true };
+    process_pool_t* pool = process_pool_create_with_options(&options);
+    if (!pool) {
+        perror("process_pool_create_with_options");
+        return 1;
+    }
+    atomic_store(executed, 0);
+    task_arg_t arg;
+    memset(&arg, 0, sizeof(arg));
+    double start = now_sec();
+    for (long i = 0; i < CRASH_TASKS; i++) {
+        arg.index = i;
+        process_pool_add_task(pool, crashing_task, &arg, sizeof(arg));
+    }
+    int failed = process_pool_wait(pool);
+    double elapsed = now_sec() - start;
+    process_pool_stats_t stats = process_pool_get_stats(pool);
+    process_pool_destroy(pool);
+
+    long expected_failed = CRASH_TASKS / CRASH_EVERY;
+    long done = atomic_load(executed);
+    printf("\nПадения: %ld задач, каждая %ld-я — SIGSEGV, %.3f с\n",
+           CRASH_TASKS, CRASH_EVERY, elapsed);
+    printf("выполнено %ld из %ld, неудачных %d, перезапусков %llu, рабочих в конце %d\n",
+           done, CRASH_TASKS - expected_failed, failed,
+           (unsigned long long)stats.restarts, stats.workers);
+    if (done != CRASH_TASKS - expected_failed || failed != expected_failed ||
+        stats.restarts != (uint64_t)expected_failed) {
+        fprintf(stderr, "Потеряны задачи или перезапуски\n");
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    long tasks = argc > 1 ? atol(argv[1]) : DEFAULT_TASKS;
+    int workers = argc > 2 ? atoi(argv[2]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (tasks <= 0) tasks = DEFAULT_TASKS;
+    if (workers <= 0) workers = 1;
+
+    // Падающие задачи не должны писать дампы памяти
+    struct rlimit no_core = { 0, 0 };
+    setrlimit(RLIMIT_CORE, &no_core);
+
+    executed = (_Atomic long*)mmap(NULL, sizeof(*executed), PROT_READ | PROT_WRITE,
+                                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (executed == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+
+    long fork_tasks = tasks < FORK_TASKS ? tasks : FORK_TASKS;
+    printf("Процессоров: %ld, рабочих: %d, аргумент %d байт\n",
+           sysconf(_SC_NPROCESSORS_ONLN), workers, ARG_SIZE);
+    printf("%-16s %10s %12s %10s\n", "вариант", "задач", "мкс/задачу", "к потокам");
+
+    double thread_us = bench_thread_pool(tasks, workers) * 1e6 / tasks;
+    printf("%-16s %10ld %12.3f %10.1f\n", "thread_pool", tasks, thread_us, 1.0);
+    double process_us = bench_process_pool(tasks, workers) * 1e6 / tasks;
+    printf("%-16s %10ld %12.3f %10.1f\n", "process_pool", tasks, process_us,
+           process_us / thread_us);
+    double fork_us = bench_fork_per_task(fork_tasks, workers) * 1e6 / fork_tasks;
+    printf("%-16s %10ld %12.3f %10.1f\n", "fork на задачу", fork_tasks, fork_us,
+           fork_us / thread_us);
+
+    return bench_crashes(workers);
+}
@@ -0,0 +1,606 @@
+#include "process_pool.h"
+#include "../../common/futex.h"
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Состояние ячейки задачи. Рабочий с номером id захватывает ячейку
+// переводом QUEUED -> RUNNING + id, а выполнив задачу, одной записью
+// ставит флаг DONE — это единственное, что он пишет о задаче. Свободной
+// ячейку делает только родитель: DONE -> FREE (задача выполнена) или,
+// после падения рабочего, RUNNING + id -> FREE (не выполнена). Счетчики
+// меняет тот поток родителя, чей CAS прошел, поэтому рабочий может
+// упасть в любой момент, и задача не потеряется и не учтется дважды.
+#define SLOT_FREE    0u
+#define SLOT_QUEUED  1u
+#define SLOT_RUNNING 2u
+#define SLOT_DONE    0x80000000u
+
+// Итераций спина рабочего перед засыпанием (только на нескольких CPU)
+#define PROCESS_POOL_SPIN 1024
+// Рабочий без задач раз в столько мс проверяет, жив ли родитель
+#define PROCESS_POOL_PARENT_CHECK_MS 1000
+// Опрос рабочих, если pidfd недоступен или замену не удалось запустить
+#define PROCESS_POOL_POLL_MS 100
+
+// Ячейка задачи; аргумент лежит сразу за заголовком
+typedef struct {
+    _Atomic uint32_t state;
+    uint32_t size;            // Размер копии аргумента (0 — передается arg)
+    void (*function)(void*);
+    void* arg;
+} process_pool_slot_t;
+
+// Общая часть пула в разделяемой памяти. За ней идут кольцо номеров
+// ячеек (cells) и сами ячейки.
+//
+// Кольцо заполняет только родитель (под submit_lock), рабочие двигают
+// tail через CAS. Ячейка в кольце может оказаться уже захваченной:
+// рабочий, прочитавший старую позицию, мог захватить ее раньше очереди.
+// Такие позиции любой рабочий просто пропускает, поэтому рабочий,
+// упавший между захватом ячейки и сдвигом tail, очередь не останавливает.
+typedef struct {
+    // Сторона родителя
+    _Alignas(64) _Atomic uint64_t head;
+    _Atomic uint32_t queue_seq;         // futex: появились задачи
+    atomic_int workers_sleeping;
+    _Atomic uint32_t shutdown;
+
+    // Сторона рабочих
+    _Alignas(64) _Atomic uint64_t tail;
+
+    // Завершение задач
+    _Alignas(64) _Atomic uint32_t completion_seq; // futex: задача выполнена или рабочий упал
+    atomic_int completion_sleepers;          // Потоков родителя, спящих на completion_seq
+} process_pool_shared_t;
+
+struct process_pool {
+    process_pool_shared_t* shared;
+    _Atomic uint32_t* cells;
+    unsigned char* slots;
+    void* map;
+    size_t map_size;
+    size_t slot_size;
+    size_t max_payload;
+    uint32_t num_slots;
+    uint64_t cell_mask;
+    int spin;
+    bool quiet;
+    pid_t parent;
+
+    // Добавление задач (поля ниже — под submit_lock)
+    pthread_mutex_t submit_lock;
+    uint32_t alloc_cursor;
+    uint64_t submitted;
+    _Atomic uint64_t failed_reported;  // Неудавшихся задач, уже возвращенных из wait
+
+    // Учет задач (только в родителе, см. process_pool_collect)
+    _Atomic uint32_t pending;  // Задач в очереди, в работе и не подобранных
+    _Atomic uint64_t completed;
+    _Atomic uint64_t failed;
+
+    // Рабочие процессы (меняет только надзиратель после создания)
+    int num_workers;
+    pid_t* pids;              // 0 — процесса нет
+    int* pidfds;              // -1 — pidfd недоступен
+    atomic_int live_workers;
+    atomic_uint_least64_t restarts;
+    pthread_t supervisor;
+};
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+static inline process_pool_slot_t* process_pool_slot(process_pool_t* pool, uint32_t index) {
+    return (process_pool_slot_t*)(pool->slots + (size_t)index * pool->slot_size);
+}
+
+static inline void* process_pool_payload(process_pool_slot_t* slot) {
+    return (unsigned char*)slot + sizeof(process_pool_slot_t);
+}
+
+static int process_pool_pidfd_open(pid_t pid) {
+#ifdef SYS_pidfd_open
+    return (int)syscall(SYS_pidfd_open, pid, 0);
+#else
+    (void)pid;
+    return -1;
+#endif
+}
+
+// Сигнал спящим на completion_seq потокам родителя. Счетчик спящих
+// увеличивается до чтения completion_seq, а здесь читается после его
+// увеличения, поэтому сигнал не теряется.
+static void process_pool_notify_completion(process_pool_shared_t* shared) {
+    atomic_fetch_add_explicit(&shared->completion_seq, 1, memory_order_seq_cst);
+    if (atomic_load_explicit(&shared->completion_sleepers, memory_order_seq_cst) > 0) {
+        futex_wake(&shared->completion_seq, INT_MAX, true);
+    }
+}
+
+// Подбор ячейки в состоянии state (DONE или RUNNING упавшего рабочего)
+// потоком родителя. Учитывает задачу только выигравший CAS.
+static void process_pool_collect(process_pool_t* pool, process_pool_slot_t* slot,
+                                 uint32_t state) {
+    if (!atomic_compare_exchange_strong_explicit(&slot->state, &state, SLOT_FREE,
+                                                 memory_order_acq_rel, memory_order_relaxed)) {
+        return;
+    }
+    atomic_fetch_add_explicit((state & SLOT_DONE) ? &pool->completed : &pool->failed, 1,
+                              memory_order_relaxed);
+    // Последнюю задачу мог подобрать не ожидающий в wait поток
+    if (atomic_fetch_sub_explicit(&pool->pending, 1, memory_order_seq_cst) == 1) {
+        process_pool_notify_completion(pool->shared);
+    }
+}
+
+// Подбор всех выполненных ячеек
+static void process_pool_collect_done(process_pool_t* pool) {
+    for (uint32_t i = 0; i < pool->num_slots; i++) {
+        process_pool_slot_t* slot = process_pool_slot(pool, i);
+        uint32_t state = atomic_load_explicit(&slot->state, memory_order_acquire);
+        if (state & SLOT_DONE) {
+            process_pool_collect(pool, slot, state);
+        }
+    }
+}
+
+// --- Рабочий процесс ---
+
+// Ожидание задач. Счетчик спящих увеличивается до чтения queue_seq,
+// а родитель читает его после публикации head и увеличения queue_seq,
+// поэтому новая задача не может остаться незамеченной.
+static void process_pool_worker_sleep(process_pool_t* pool) {
+    process_pool_shared_t* shared = pool->shared;
+    atomic_fetch_add_explicit(&shared->workers_sleeping, 1, memory_order_seq_cst);
+    uint32_t seq = atomic_load_explicit(&shared->queue_seq, memory_order_seq_cst);
+    if (atomic_load_explicit(&shared->tail, memory_order_seq_cst) ==
+            atomic_load_explicit(&shared->head, memory_order_seq_cst) &&
+        !atomic_load_explicit(&shared->shutdown, memory_order_relaxed)) {
+        struct timespec deadline = futex_deadline_ms(PROCESS_POOL_PARENT_CHECK_MS);
+        futex_wait(&shared->queue_seq, seq, &deadline, true);
+    }
+    atomic_fetch_sub_explicit(&shared->workers_sleeping, 1, memory_order_relaxed);
+}
+
+static void process_pool_worker_main(process_pool_t* pool, int id) {
+    process_pool_shared_t* shared = pool->shared;
+    uint32_t running = SLOT_RUNNING + (uint32_t)id;
+
+    while (true) {
+        uint64_t tail = atomic_load_explicit(&shared->tail, memory_order_acquire);
+        if (tail == atomic_load_explicit(&shared->head, memory_order_acquire)) {
+            if (atomic_load_explicit(&shared->shutdown, memory_order_acquire)) break;
+            bool found = false;
+            for (int i = 0; i < pool->spin && !found; i++) {
+                cpu_relax();
+                found = atomic_load_explicit(&shared->head, memory_order_relaxed) != tail;
+            }
+            if (!found) {
+                process_pool_worker_sleep(pool);
+                // Родитель завершился, не уничтожив пул
+                if (getppid() != pool->parent) break;
+            }
+            continue;
+        }
+
+        uint32_t index = atomic_load_explicit(&pool->cells[tail & pool->cell_mask],
+                                              memory_order_relaxed);
+        process_pool_slot_t* slot = process_pool_slot(pool, index);
+        uint32_t expected = SLOT_QUEUED;
+        bool claimed = atomic_compare_exchange_strong_explicit(&slot->state, &expected, running,
+                                                               memory_order_acq_rel,
+                                                               memory_order_relaxed);
+        // Позиция пропускается и тогда, когда ячейку уже захватил другой
+        // рабочий; неудачный CAS значит, что tail сдвинул кто-то еще
+        atomic_compare_exchange_strong_explicit(&shared->tail, &tail, tail + 1,
+                                                memory_order_acq_rel, memory_order_relaxed);
+        if (claimed) {
+            slot->function(slot->size ? process_pool_payload(slot) : slot->arg);
+            // Точка фиксации: после этой записи задача выполнена, даже если
+            // рабочий упадет раньше сигнала
+            atomic_store_explicit(&slot->state, running | SLOT_DONE, memory_order_seq_cst);
+            process_pool_notify_completion(shared);
+        }
+    }
+}
+
+static int process_pool_spawn(process_pool_t* pool, int id) {
+    pid_t pid = fork();
+    if (pid < 0) {
+        return -1;
+    }
+    if (pid == 0) {
+        process_pool_worker_main(pool, id);
+        _exit(0);
+    }
+    pool->pids[id] = pid;
+    pool->pidfds[id] = process_pool_pidfd_open(pid);
+    atomic_fetch_add_explicit(&pool->live_workers, 1, memory_order_relaxed);
+    return 0;
+}
+
+// --- Надзиратель ---
+
+static void process_pool_worker_exited(process_pool_t* pool, int id, int status) {
+    if (pool->pidfds[id] >= 0) {
+        close(pool->pidfds[id]);
+        pool->pidfds[id] = -1;
+    }
+    pid_t pid = pool->pids[id];
+    pool->pids[id] = 0;
+    atomic_fetch_sub_explicit(&pool->live_workers, 1, memory_order_relaxed);
+
+    // Процесс больше ничего не изменит. Выполненных им ячеек, еще не
+    // подобранных родителем, может быть несколько; незавершенная (не
+    // больше одной) считается неудавшейся.
+    uint32_t running = SLOT_RUNNING + (uint32_t)id;
+    process_pool_slot_t* unfinished = NULL;
+    for (uint32_t i = 0; i < pool->num_slots; i++) {
+        process_pool_slot_t* slot = process_pool_slot(pool, i);
+        uint32_t state = atomic_load_explicit(&slot->state, memory_order_acquire);
+        if (state == (running | SLOT_DONE)) {
+            process_pool_collect(pool, slot, state);
+        } else if (state == running) {
+            unfinished = slot;
+        }
+    }
+
+    // Замена запускается до подбора незавершенной задачи: дождавшийся ее
+    // в wait видит пул уже восстановленным. Новый рабочий с тем же номером
+    // эту ячейку не тронет — он захватывает только QUEUED. Если запуск не
+    // удался, его повторит цикл надзирателя.
+    if (!atomic_load_explicit(&pool->shared->shutdown, memory_order_acquire) &&
+        process_pool_spawn(pool, id) == 0) {
+        atomic_fetch_add_explicit(&pool->restarts, 1, memory_order_relaxed);
+    }
+    if (unfinished) {
+        process_pool_collect(pool, unfinished, running);
+    }
+    // О последней выполненной задаче рабочий мог не успеть сообщить
+    process_pool_notify_completion(pool->shared);
+
+    if (!pool->quiet && !(WIFEXITED(status) && WEXITSTATUS(status) == 0)) {
+        if (WIFSIGNALED(status)) {
+            fprintf(stderr, "Process Pool: рабочий процесс %d (pid %d) завершен сигналом %d\n",
+                    id, (int)pid, WTERMSIG(status));
+        } else {
+            fprintf(stderr, "Process Pool: рабочий процесс %d (pid %d) завершился с кодом %d\n",
+                    id, (int)pid, WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+        }
+    }
+}
+
+static void* process_pool_supervisor(void* arg) {
+    process_pool_t* pool = (process_pool_t*)arg;
+    struct pollfd* fds = (struct pollfd*)calloc(pool->num_workers, sizeof(struct pollfd));
+
+    while (true) {
+        bool stopping = atomic_load_explicit(&pool->shared->shutdown, memory_order_acquire);
+
+        // Замена упавших (и тех, кого не удалось запустить в прошлый раз)
+        bool missing = false;
+        for (int i = 0; i < pool->num_workers && !stopping; i++) {
+            if (pool->pids[i] != 0) continue;
+            if (process_pool_spawn(pool, i) == 0) {
+                atomic_fetch_add_explicit(&pool->restarts, 1, memory_order_relaxed);
+            } else {
+                missing = true;
+            }
+        }
+
+        int alive = 0;
+        for (int i = 0; i < pool->num_workers; i++) {
+            fds[i].fd = pool->pids[i] != 0 ? pool->pidfds[i] : -1;
+            fds[i].events = POLLIN;
+            fds[i].revents = 0;
+            if (pool->pids[i] != 0) {
+                alive++;
+                missing |= pool->pidfds[i] < 0;
+            }
+        }
+        if (stopping && alive == 0) break;
+
+        if (fds) {
+            poll(fds, pool->num_workers, missing || stopping ? PROCESS_POOL_POLL_MS : -1);
+        } else {
+            poll(NULL, 0, PROCESS_POOL_POLL_MS);
+        }
+
+        for (int i = 0; i < pool->num_workers; i++) {
+            if (pool->pids[i] == 0) continue;
+            int status = 0;
+            pid_t rc = waitpid(pool->pids[i], &status, WNOHANG);
+            // ECHILD — процесс уже подобран (SIGCHLD игнорируется)
+            if (rc == pool->pids[i] || (rc < 0 && errno == ECHILD)) {
+                process_pool_worker_exited(pool, i, status);
+            }
+        }
+    }
+    free(fds);
+    return NULL;
+}
+
+// --- Создание и уничтожение ---
+
+// Остановка уже запущенных рабочих при ошибке создания
+static void process_pool_abort_workers(process_pool_t* pool) {
+    atomic_store_explicit(&pool->shared->shutdown, 1, memory_order_seq_cst);
+    atomic_fetch_add_explicit(&pool->shared->queue_seq, 1, memory_order_seq_cst);
+    futex_wake(&pool->shared->queue_seq, INT_MAX, true);
+    for (int i = 0; i < pool->num_workers; i++) {
+        if (pool->pids[i] != 0) {
+            waitpid(pool->pids[i], NULL, 0);
+        }
+        if (pool->pidfds[i] >= 0) {
+            close(pool->pidfds[i]);
+        }
+    }
+}
+
+static void process_pool_free(process_pool_t* pool) {
+    if (pool->map) {
+        munmap(pool->map, pool->map_size);
+    }
+    pthread_mutex_destroy(&pool->submit_lock);
+    free(pool->pids);
+    free(pool->pidfds);
+    free(pool);
+}
+
+process_pool_t* process_pool_create(int num_workers) {
+    process_pool_options_t options = { .num_workers = num_workers };
+    return process_pool_create_with_options(&options);
+}
+
+process_pool_t* process_pool_create_with_options(const process_pool_options_t* options) {
+    if (!options || options->num_workers < 0 || options->slots < 0 ||
+        options->slots > INT_MAX / 2) {
+        errno = EINVAL;
+        return NULL;
+    }
+    int cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int num_workers = options->num_workers > 0 ? options->num_workers : (cpus > 0 ? cpus : 1);
+    uint32_t num_slots = options->slots > 0 ? (uint32_t)options->slots : PROCESS_POOL_DEFAULT_SLOTS;
+    size_t max_payload = options->max_payload > 0 ? options->max_payload
+                                                  : PROCESS_POOL_DEFAULT_PAYLOAD;
+    if (max_payload > UINT32_MAX) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    process_pool_t* pool = (process_pool_t*)calloc(1, sizeof(process_pool_t));
+    if (!pool) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    pthread_mutex_init(&pool->submit_lock, NULL);
+    pool->num_workers = num_workers;
+    pool->pids = (pid_t*)calloc(num_workers, sizeof(pid_t));
+    pool->pidfds = (int*)malloc(num_workers * sizeof(int));
+    if (!pool->pids || !pool->pidfds) {
+        process_pool_free(pool);
+        errno = ENOMEM;
+        return NULL;
+    }
+    for (int i = 0; i < num_workers; i++) {
+        pool->pidfds[i] = -1;
+    }
+
+    // Позиций в кольце вдвое больше, чем ячеек: место для пропускаемых
+    // позиций уже захваченных ячеек
+    uint64_t cells = 1;
+    while (cells < 2 * (uint64_t)num_slots) cells <<= 1;
+    pool->cell_mask = cells - 1;
+    pool->num_slots = num_slots;
+    pool->max_payload = max_payload;
+    pool->slot_size = (sizeof(process_pool_slot_t) + max_payload + 63) & ~(size_t)63;
+
+    size_t header_size = (sizeof(process_pool_shared_t) + 63) & ~(size_t)63;
+    size_t cells_size = (cells * sizeof(uint32_t) + 63) & ~(size_t)63;
+    pool->map_size = header_size + cells_size + (size_t)num_slots * pool->slot_size;
+    void* map = mmap(NULL, pool->map_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) {
+        int saved = errno;
+        process_pool_free(pool);
+        errno = saved;
+        return NULL;
+    }
+    // Анонимное отображение уже заполнено нулями: все ячейки SLOT_FREE
+    pool->map = map;
+    pool->shared = (process_pool_shared_t*)map;
+    pool->cells = (_Atomic uint32_t*)((unsigned char*)map + header_size);
+    pool->slots = (unsigned char*)map + header_size + cells_size;
+    pool->spin = cpus > 1 ? PROCESS_POOL_SPIN : 0;
+    pool->quiet = options->quiet;
+    pool->parent = getpid();
+
+    for (int i = 0; i < num_workers; i++) {
+        if (process_pool_spawn(pool, i) != 0) {
+            int saved = errno;
+            process_pool_abort_workers(pool);
+            process_pool_free(pool);
+            errno = saved;
+            return NULL;
+        }
+    }
+
+    int rc = pthread_create(&pool->supervisor, NULL, process_pool_supervisor, pool);
+    if (rc != 0) {
+        process_pool_abort_workers(pool);
+        process_pool_free(pool);
+        errno = rc;
+        return NULL;
+    }
+
+    if (!pool->quiet) {
+        printf("Пул процессов создан с %d рабочими процессами\n", num_workers);
+    }
+    return pool;
+}
+
+// Свободная ячейка (под submit_lock); выполненные подбираются по пути.
+// Если все заняты — ожидание, пока рабочий не выполнит задачу или
+// надзиратель не подберет ячейку упавшего.
+static uint32_t process_pool_alloc_slot_locked(process_pool_t* pool) {
+    process_pool_shared_t* shared = pool->shared;
+    while (true) {
+        uint32_t seq = atomic_load_explicit(&shared->completion_seq, memory_order_seq_cst);
+        for (uint32_t n = 0; n < pool->num_slots; n++) {
+            uint32_t index = pool->alloc_cursor;
+            pool->alloc_cursor = index + 1 == pool->num_slots ? 0 : index + 1;
+            process_pool_slot_t* slot = process_pool_slot(pool, index);
+            uint32_t state = atomic_load_explicit(&slot->state, memory_order_acquire);
+            // Если CAS выиграл другой поток, ячейка все равно уже свободна:
+            // занимает ячейки только этот поток
+            if (state & SLOT_DONE) {
+                process_pool_collect(pool, slot, state);
+                state = atomic_load_explicit(&slot->state, memory_order_acquire);
+            }
+            if (state == SLOT_FREE) {
+                return index;
+            }
+        }
+        atomic_fetch_add_explicit(&shared->completion_sleepers, 1, memory_order_seq_cst);
+        futex_wait(&shared->completion_seq, seq, NULL, true);
+        atomic_fetch_sub_explicit(&shared->completion_sleepers, 1, memory_order_relaxed);
+    }
+}
+
+// Публикация ячейки в кольце (под submit_lock)
+static void process_pool_push_locked(process_pool_t* pool, uint32_t index) {
+    process_pool_shared_t* shared = pool->shared;
+    uint64_t head = atomic_load_explicit(&shared->head, memory_order_relaxed);
+
+    // Кольцо полно, только если рабочие еще не сдвинули tail за уже
+    // захваченными ячейками: сдвигаем сами или уступаем процессор
+    uint64_t tail;
+    while (head - (tail = atomic_load_explicit(&shared->tail, memory_order_acquire)) >
+           pool->cell_mask) {
+        uint32_t first = atomic_load_explicit(&pool->cells[tail & pool->cell_mask],
+                                              memory_order_relaxed);
+        if (atomic_load_explicit(&process_pool_slot(pool, first)->state,
+                                 memory_order_acquire) != SLOT_QUEUED) {
+            atomic_compare_exchange_strong_explicit(&shared->tail, &tail, tail + 1,
+                                                    memory_order_acq_rel, memory_order_relaxed);
+        } else {
+            sched_yield();
+        }
+    }
+
+    atomic_store_explicit(&pool->cells[head & pool->cell_mask], index, memory_order_relaxed);
+    atomic_store_explicit(&shared->head, head + 1, memory_order_seq_cst);
+    atomic_fetch_add_explicit(&shared->queue_seq, 1, memory_order_seq_cst);
+    if (atomic_load_explicit(&shared->workers_sleeping, memory_order_seq_cst) > 0) {
+        futex_wake(&shared->queue_seq, 1, true);
+    }
+}
+
+int process_pool_add_task(process_pool_t* pool, void (*function)(void*),
+                          const void* arg, size_t arg_size) {
+    if (!pool || !function) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (arg_size > pool->max_payload) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    pthread_mutex_lock(&pool->submit_lock);
+    if (atomic_load_explicit(&pool->shared->shutdown, memory_order_relaxed)) {
+        pthread_mutex_unlock(&pool->submit_lock);
+        errno = EINVAL;
+        return -1;
+    }
+    uint32_t index = process_pool_alloc_slot_locked(pool);
+    process_pool_slot_t* slot = process_pool_slot(pool, index);
+    slot->function = function;
+    slot->arg = (void*)arg;
+    slot->size = (uint32_t)arg_size;
+    if (arg_size > 0) {
+        memcpy(process_pool_payload(slot), arg, arg_size);
+    }
+    pool->submitted++;
+    atomic_fetch_add_explicit(&pool->pending, 1, memory_order_seq_cst);
+    atomic_store_explicit(&slot->state, SLOT_QUEUED, memory_order_release);
+    process_pool_push_locked(pool, index);
+    pthread_mutex_unlock(&pool->submit_lock);
+    return 0;
+}
+
+int process_pool_wait(process_pool_t* pool) {
+    if (!pool) {
+        errno = EINVAL;
+        return -1;
+    }
+    process_pool_shared_t* shared = pool->shared;
+    while (true) {
+        uint32_t seq = atomic_load_explicit(&shared->completion_seq, memory_order_seq_cst);
+        process_pool_collect_done(pool);
+        if (atomic_load_explicit(&pool->pending, memory_order_seq_cst) == 0) {
+            break;
+        }
+        atomic_fetch_add_explicit(&shared->completion_sleepers, 1, memory_order_seq_cst);
+        futex_wait(&shared->completion_seq, seq, NULL, true);
+        atomic_fetch_sub_explicit(&shared->completion_sleepers, 1, memory_order_relaxed);
+    }
+
+    uint64_t failed = atomic_load_explicit(&pool->failed, memory_order_relaxed);
+    uint64_t reported = atomic_exchange_explicit(&pool->failed_reported, failed,
+                                                 memory_order_relaxed);
+    return (int)(failed - reported);
+}
+
+int process_pool_destroy(process_pool_t* pool) {
+    if (!pool) {
+        errno = EINVAL;
+        return -1;
+    }
+    process_pool_wait(pool);
+
+    // Рабочие выходят, когда очередь пуста; надзиратель больше никого
+    // не перезапускает и завершается, подобрав всех
+    pthread_mutex_lock(&pool->submit_lock);
+    atomic_store_explicit(&pool->shared->shutdown, 1, memory_order_seq_cst);
+    pthread_mutex_unlock(&pool->submit_lock);
+    atomic_fetch_add_explicit(&pool->shared->queue_seq, 1, memory_order_seq_cst);
+    futex_wake(&pool->shared->queue_seq, INT_MAX, true);
+    pthread_join(pool->supervisor, NULL);
+
+    bool quiet = pool->quiet;
+    process_pool_free(pool);
+    if (!quiet) {
+        printf("Пул процессов уничтожен\n");
+    }
+    return 0;
+}
+
+process_pool_stats_t process_pool_get_stats(process_pool_t* pool) {
+    process_pool_stats_t stats;
+    process_pool_collect_done(pool);
+    pthread_mutex_lock(&pool->submit_lock);
+    stats.submitted = pool->submitted;
+    pthread_mutex_unlock(&pool->submit_lock);
+    stats.completed = atomic_load_explicit(&pool->completed, memory_order_relaxed);
+    stats.failed = atomic_load_explicit(&pool->failed, memory_order_relaxed);
+    stats.restarts = atomic_load_explicit(&pool->restarts, memory_order_relaxed);
+    stats.workers = atomic_load_explicit(&pool->live_workers, memory_order_relaxed);
+    return stats;
+}
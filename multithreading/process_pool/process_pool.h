@@ -0,0 +1,78 @@
+#ifndef PROCESS_POOL_H
+#define PROCESS_POOL_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Пул процессов с тем же порядком работы, что у thread_pool_t
+// (create / add_task / wait / destroy), для задач, которым нельзя
+// доверить общее адресное пространство: падение задачи убивает только
+// ее рабочий процесс.
+//
+// Рабочие процессы создаются fork заранее и берут задачи из очереди
+// в разделяемой памяти (MAP_SHARED | MAP_ANONYMOUS, наследуется при
+// fork). Задача — указатель на функцию (после fork адреса кода те же)
+// и копия аргумента в ячейке очереди. Рабочий захватывает ячейку одним
+// CAS ее состояния, в котором записан его номер, поэтому в любой момент
+// видно, какую задачу выполнял упавший процесс. Выполнив задачу, рабочий
+// одной записью помечает ячейку выполненной; освобождает ячейки и ведет
+// счетчики только родитель, поэтому падение рабочего в любой момент не
+// теряет задачу и не учитывает ее дважды. Поток-надзиратель ждет
+// завершения рабочих через pidfd, запускает замену и помечает
+// незавершенную задачу неудавшейся; остальные задачи в очереди и у других
+// процессов не теряются.
+//
+// Ожидания — futex на словах в разделяемой памяти (shared = true).
+// Задачи, запущенные в рабочем процессе, видят память родителя на
+// момент fork рабочего и не могут менять память родителя, кроме
+// явно разделяемой.
+
+// Значения по умолчанию
+#define PROCESS_POOL_DEFAULT_SLOTS 1024    // Задач в очереди и в работе
+#define PROCESS_POOL_DEFAULT_PAYLOAD 200   // Байт аргумента в ячейке
+
+typedef struct process_pool process_pool_t;
+
+typedef struct {
+    int num_workers;          // Рабочих процессов (0 — по числу процессоров)
+    int slots;                // Ячеек очереди (0 — PROCESS_POOL_DEFAULT_SLOTS)
+    size_t max_payload;       // Наибольший размер аргумента (0 — по умолчанию)
+    bool quiet;               // Не печатать о создании, уничтожении и перезапусках
+} process_pool_options_t;
+
+// Статистика пула
+typedef struct {
+    uint64_t submitted;       // Задач добавлено
+    uint64_t completed;       // Выполнено до конца
+    uint64_t failed;          // Рабочий процесс завершился во время задачи
+    uint64_t restarts;        // Рабочих процессов перезапущено
+    int workers;              // Рабочих процессов сейчас
+} process_pool_stats_t;
+
+// Создание пула. Потоки родителя, запущенные до создания, в рабочих
+// процессах не существуют: задачи не должны ждать их блокировок.
+// Возвращает NULL с errno.
+process_pool_t* process_pool_create(int num_workers);
+process_pool_t* process_pool_create_with_options(const process_pool_options_t* options);
+
+// Добавление задачи: arg_size байт по адресу arg копируются в очередь,
+// функция получает указатель на копию. При arg_size == 0 функция
+// получает сам arg (он должен быть действителен в рабочем процессе,
+// например статические данные или NULL). Ждет, если все ячейки заняты.
+// Возвращает 0 или -1 с errno (EMSGSIZE — аргумент больше max_payload,
+// EINVAL — пул уничтожается).
+int process_pool_add_task(process_pool_t* pool, void (*function)(void*),
+                          const void* arg, size_t arg_size);
+
+// Ожидание завершения всех задач. Возвращает, сколько задач с прошлого
+// вызова не выполнено из-за завершения рабочего процесса, или -1.
+int process_pool_wait(process_pool_t* pool);
+
+// Уничтожение: дожидается задач из очереди, завершает рабочие процессы
+int process_pool_destroy(process_pool_t* pool);
+
+process_pool_stats_t process_pool_get_stats(process_pool_t* pool);
+
+#endif // PROCESS_POOL_H
@@ -0,0 +1,338 @@
+#include "rcu.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Читатели ищут маршруты в таблице, писатель раз в WRITE_INTERVAL_US
+// меняет одну запись. Замер — поисков в секунду при защите таблицы
+// pthread_mutex, pthread_rwlock и RCU (копия таблицы, замена указателя,
+// rcu_retire старой версии), затем — то же на задачах пула
+// с rcu_pool_hooks, где состояния покоя объявляет сам пул.
+// Запуск: ./bench_rcu [мс на замер] [потоки,через,запятую]
+
+#define DEFAULT_DURATION_MS 300
+#define DEFAULT_THREADS "1,2,4,8"
+#define MAX_THREADS 256
+#define TABLE_SIZE 1024       // Маршрутов в таблице (степень двойки)
+#define READ_BATCH 64         // Поисков между состояниями покоя
+#define WRITE_INTERVAL_US 1000
+#define POOL_TASKS 100000
+#define POOL_LOOKUPS 1000     // Поисков в одной задаче пула
+
+typedef enum { VARIANT_MUTEX, VARIANT_RWLOCK, VARIANT_RCU, VARIANTS } variant_t;
+
+static const char* variant_names[VARIANTS] = {"mutex", "rwlock", "rcu"};
+
+typedef struct {
+    uint64_t version;
+    uint32_t next_hop[TABLE_SIZE];
+} route_table_t;
+
+typedef struct {
+    variant_t variant;
+    int threads;
+    atomic_bool stop;
+    pthread_mutex_t mutex;
+    pthread_rwlock_t rwlock;
+    route_table_t* locked_table;      // Для mutex и rwlock — меняется на месте
+    void* _Atomic table;              // Для RCU
+    rcu_domain_t* domain;
+    atomic_long lookups;
+    atomic_long errors;
+    long updates;
+    size_t max_pending;
+} bench_t;
+
+typedef struct {
+    _Alignas(64) bench_t* bench;
+    uint64_t seed;
+} reader_arg_t;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static inline uint64_t next_key(uint64_t* seed) {
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 7;
+    *seed ^= *seed << 17;
+    return *seed;
+}
+
+// Поиск маршрута. Живые записи не нулевые, освобождаемая таблица
+// обнуляется: ноль — признак чтения после освобождения.
+static inline uint32_t lookup(bench_t* b, const route_table_t* table, uint64_t key) {
+    uint32_t hop = table->next_hop[key & (TABLE_SIZE - 1)];
+    if (hop == 0) {
+        atomic_fetch_add_explicit(&b->errors, 1, memory_order_relaxed);
+    }
+    return hop;
+}
+
+static route_table_t* table_create(void) {
+    route_table_t* table = (route_table_t*)malloc(sizeof(route_table_t));
+    table->version = 0;
+    for (int i = 0; i < TABLE_SIZE; i++) {
+        table->next_hop[i] = (uint32_t)i + 1;
+    }
+    return table;
+}
+
+static void table_destroy(void* object) {
+    route_table_t* table = (route_table_t*)object;
+    memset(table->next_hop, 0, sizeof(table->next_hop));
+    free(table);
+}
+
+// Результаты поисков, чтобы компилятор их не выбросил
+static atomic_uint sink;
+
+static void* reader(void* arg) {
+    reader_arg_t* r = (reader_arg_t*)arg;
+    bench_t* b = r->bench;
+    rcu_thread_t* self = b->variant == VARIANT_RCU ? rcu_register_thread(b->domain) : NULL;
+    long count = 0;
+    uint32_t sum = 0;
+
+    while (!atomic_load_explicit(&b->stop, memory_order_relaxed)) {
+        for (int i = 0; i < READ_BATCH; i++) {
+            uint64_t key = next_key(&r->seed);
+            switch (b->variant) {
+            case VARIANT_MUTEX:
+                pthread_mutex_lock(&b->mutex);
+                sum += lookup(b, b->locked_table, key);
+                pthread_mutex_unlock(&b->mutex);
+                break;
+            case VARIANT_RWLOCK:
+                pthread_rwlock_rdlock(&b->rwlock);
+                sum += lookup(b, b->locked_table, key);
+                pthread_rwlock_unlock(&b->rwlock);
+                break;
+            default:
+                sum += lookup(b, rcu_dereference(&b->table), key);
+                break;
+            }
+        }
+        count += READ_BATCH;
+        if (self) {
+            rcu_quiescent_state(self);
+        }
+    }
+
+    if (self) {
+        rcu_unregister_thread(self);
+    }
+    atomic_fetch_add_explicit(&b->lookups, count, memory_order_relaxed);
+    atomic_fetch_add_explicit(&sink, sum, memory_order_relaxed);
+    return NULL;
+}
+
+// Одно обновление: запись index получает новое значение
+static void update(bench_t* b, long n) {
+    int index = (int)(n % TABLE_SIZE);
+    switch (b->variant) {
+    case VARIANT_MUTEX:
+        pthread_mutex_lock(&b->mutex);
+        b->locked_table->next_hop[index] = (uint32_t)n | 1;
+        pthread_mutex_unlock(&b->mutex);
+        break;
+    case VARIANT_RWLOCK:
+        pthread_rwlock_wrlock(&b->rwlock);
+        b->locked_table->next_hop[index] = (uint32_t)n | 1;
+        pthread_rwlock_unlock(&b->rwlock);
+        break;
+    default: {
+        route_table_t* copy = (route_table_t*)malloc(sizeof(route_table_t));
+        memcpy(copy, atomic_load_explicit(&b->table, memory_order_relaxed), sizeof(*copy));
+        copy->version++;
+        copy->next_hop[index] = (uint32_t)n | 1;
+        rcu_retire(b->domain, rcu_exchange(&b->table, copy), table_destroy);
+        size_t pending = rcu_get_stats(b->domain).pending;
+        if (pending > b->max_pending) b->max_pending = pending;
+        break;
+    }
+    }
+}
+
+// Писатель работает, пока не выставлен stop
+static void writer_loop(bench_t* b) {
+    struct timespec pause = { .tv_sec = 0, .tv_nsec = WRITE_INTERVAL_US * 1000L };
+    while (!atomic_load_explicit(&b->stop, memory_order_relaxed)) {
+        nanosleep(&pause, NULL);
+        update(b, ++b->updates);
+    }
+}
+
+typedef struct {
+    bench_t* bench;
+    int ms;
+} timer_arg_t;
+
+static void* stop_after(void* arg) {
+    timer_arg_t* t = (timer_arg_t*)arg;
+    struct timespec pause = { .tv_sec = t->ms / 1000, .tv_nsec = (t->ms % 1000) * 1000000L };
+    nanosleep(&pause, NULL);
+    atomic_store(&t->bench->stop, true);
+    return NULL;
+}
+
+static void bench_reset(bench_t* b, variant_t variant) {
+    b->variant = variant;
+    atomic_store(&b->stop, false);
+    atomic_store(&b->lookups, 0);
+    b->updates = 0;
+    b->max_pending = 0;
+    b->locked_table = table_create();
+    atomic_store(&b->table, table_create());
+    b->domain = rcu_domain_create();
+}
+
+static void bench_finish(bench_t* b) {
+    free(b->locked_table);
+    // Все читатели сняты с регистрации: последнюю версию можно освободить сразу
+    free(atomic_load(&b->table));
+    rcu_domain_destroy(b->domain);
+}
+
+// Поисков в секунду на потоках-читателях
+static double run_threads(bench_t* b, variant_t variant, int ms) {
+    pthread_t threads[MAX_THREADS];
+    reader_arg_t args[MAX_THREADS];
+    bench_reset(b, variant);
+
+    for (int i = 0; i < b->threads; i++) {
+        args[i] = (reader_arg_t){ .bench = b, .seed = 0x9e3779b97f4a7c15ULL * (i + 1) };
+        pthread_create(&threads[i], NULL, reader, &args[i]);
+    }
+    pthread_t timer;
+    timer_arg_t timer_arg = { b, ms };
+    double start = now_sec();
+    pthread_create(&timer, NULL, stop_after, &timer_arg);
+    writer_loop(b);
+    for (int i = 0; i < b->threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    double elapsed = now_sec() - start;
+    pthread_join(timer, NULL);
+
+    double rate = atomic_load(&b->lookups) / elapsed;
+    bench_finish(b);
+    return rate;
+}
+
+// --- Пул ---
+
+static void pool_task(void* arg) {
+    bench_t* b = (bench_t*)arg;
+    uint64_t seed = 0x2545f4914f6cdd1dULL *
+                    (uint64_t)(atomic_load_explicit(&b->lookups, memory_order_relaxed) + 1);
+    uint32_t sum = 0;
+    // Указатель живет только внутри задачи: состояние покоя объявит пул
+    for (int i = 0; i < POOL_LOOKUPS; i++) {
+        sum += lookup(b, rcu_dereference(&b->table), next_key(&seed));
+    }
+    atomic_fetch_add_explicit(&b->lookups, POOL_LOOKUPS, memory_order_relaxed);
+    atomic_fetch_add_explicit(&sink, sum, memory_order_relaxed);
+}
+
+static void* pool_writer(void* arg) {
+    writer_loop((bench_t*)arg);
+    return NULL;
+}
+
+static void run_pool(bench_t* b) {
+    bench_reset(b, VARIANT_RCU);
+    thread_pool_options_t options = { .num_threads = b->threads, .quiet = true,
+                                      .hooks = rcu_pool_hooks(b->domain) };
+    thread_pool_t* pool = thread_pool_create_with_options(&options);
+    if (!pool) {
+        perror("thread_pool_create_with_options");
+        exit(1);
+    }
+
+    pthread_t writer;
+    pthread_create(&writer, NULL, pool_writer, b);
+    double start = now_sec();
+    for (int i = 0; i < POOL_TASKS; i++) {
+        thread_pool_add_task(pool, pool_task, b);
+    }
+    thread_pool_wait(pool);
+    double elapsed = now_sec() - start;
+    atomic_store(&b->stop, true);
+    pthread_join(writer, NULL);
+
+    // Простаивающие потоки пула offline, поэтому барьер не ждет их задач
+    rcu_barrier(b->domain);
+    rcu_stats_t stats = rcu_get_stats(b->domain);
+    printf("%8d %14.1f %10ld %12zu %14zu\n", b->threads,
+           atomic_load(&b->lookups) / elapsed / 1e6, b->updates, b->max_pending, stats.pending);
+    thread_pool_destroy(pool);
+    bench_finish(b);
+}
+
+int main(int argc, char* argv[]) {
+    int ms = argc > 1 ? atoi(argv[1]) : DEFAULT_DURATION_MS;
+    char list[256];
+    snprintf(list, sizeof(list), "%s", argc > 2 ? argv[2] : DEFAULT_THREADS);
+    if (ms <= 0) ms = DEFAULT_DURATION_MS;
+
+    bench_t* b = (bench_t*)calloc(1, sizeof(bench_t));
+    if (!b) {
+        perror("calloc");
+        return 1;
+    }
+    pthread_mutex_init(&b->mutex, NULL);
+    pthread_rwlock_init(&b->rwlock, NULL);
+    atomic_init(&b->errors, 0);
+
+    int counts[MAX_THREADS];
+    int num_counts = 0;
+    for (char* token = strtok(list, ","); token && num_counts < MAX_THREADS;
+         token = strtok(NULL, ",")) {
+        int threads = atoi(token);
+        if (threads >= 1 && threads < MAX_THREADS) counts[num_counts++] = threads;
+    }
+
+    printf("Процессоров: %ld, %d мс на замер, таблица %d маршрутов, "
+           "обновление раз в %d мкс\n",
+           sysconf(_SC_NPROCESSORS_ONLN), ms, TABLE_SIZE, WRITE_INTERVAL_US);
+    printf("Млн поисков/с на потоках-читателях:\n%8s", "потоков");
+    for (int v = 0; v < VARIANTS; v++) {
+        printf(" %10s", variant_names[v]);
+    }
+    printf(" %14s\n", "rcu на поток");
+    for (int c = 0; c < num_counts; c++) {
+        b->threads = counts[c];
+        printf("%8d", b->threads);
+        double rcu = 0;
+        for (int v = 0; v < VARIANTS; v++) {
+            double rate = run_threads(b, (variant_t)v, ms);
+            if (v == VARIANT_RCU) rcu = rate;
+            printf(" %10.1f", rate / 1e6);
+            fflush(stdout);
+        }
+        printf(" %14.1f\n", rcu / b->threads / 1e6);
+    }
+
+    printf("\nПул с rcu_pool_hooks (%d задач по %d поисков):\n", POOL_TASKS, POOL_LOOKUPS);
+    printf("%8s %14s %10s %12s %14s\n", "потоков", "млн поисков/с", "обновлений",
+           "макс. ждут", "после барьера");
+    for (int c = 0; c < num_counts; c++) {
+        b->threads = counts[c];
+        run_pool(b);
+    }
+
+    long errors = atomic_load(&b->errors);
+    if (errors != 0) {
+        fprintf(stderr, "Чтение освобожденной таблицы: %ld раз\n", errors);
+    }
+    pthread_mutex_destroy(&b->mutex);
+    pthread_rwlock_destroy(&b->rwlock);
+    free(b);
+    return errors != 0;
+}
@@ -0,0 +1,353 @@
+#include "rcu.h"
+#include <errno.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Эпоха домена растет на каждом rcu_retire и rcu_synchronize. Поток в
+// состоянии покоя записывает в свою запись текущую эпоху; объект,
+// отложенный с эпохой e, можно освободить, когда у каждого online-потока
+// записана эпоха не меньше e: поток прошел состояние покоя уже после
+// того, как объект стал недоступен через опубликованный указатель.
+
+// Сколько отложенных объектов копится до попытки освобождения
+#define RCU_RECLAIM_THRESHOLD 64
+// Пауза писателя в ожидании читателей, нс
+#define RCU_WAIT_MIN_NS 10000L
+#define RCU_WAIT_MAX_NS 1000000L
+
+typedef struct rcu_retired {
+    struct rcu_retired* next;
+    void* object;
+    void (*destroy)(void*);
+    uint64_t epoch;           // Освобождать, когда все online-потоки дошли до нее
+} rcu_retired_t;
+
+struct rcu_domain {
+    _Alignas(64) _Atomic uint64_t epoch; // Начинается с 1 (0 — offline)
+
+    // Список потоков. Писатель ждет потоки без блокировки, удерживая
+    // только запись ожидаемого потока (waiters): снятая с регистрации
+    // запись остается в списке, пока ее не отпустит последний писатель.
+    // Поэтому rcu_unregister_thread (хук thread_stop пула) не ждет
+    // писателей.
+    _Alignas(64) pthread_mutex_t threads_lock;
+    rcu_thread_t* threads;
+    int num_threads;
+
+    // Отложенные объекты по возрастанию эпохи
+    pthread_mutex_t retired_lock;
+    rcu_retired_t* retired_head;
+    rcu_retired_t* retired_tail;
+    size_t pending;
+    uint64_t retired_total;
+    uint64_t reclaimed_total;
+};
+
+// Последняя регистрация текущего потока
+static _Thread_local rcu_thread_t* current_thread = NULL;
+
+rcu_domain_t* rcu_domain_create(void) {
+    rcu_domain_t* domain = (rcu_domain_t*)aligned_alloc(64, sizeof(rcu_domain_t));
+    if (!domain) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    atomic_init(&domain->epoch, 1);
+    pthread_mutex_init(&domain->threads_lock, NULL);
+    domain->threads = NULL;
+    domain->num_threads = 0;
+    pthread_mutex_init(&domain->retired_lock, NULL);
+    domain->retired_head = NULL;
+    domain->retired_tail = NULL;
+    domain->pending = 0;
+    domain->retired_total = 0;
+    domain->reclaimed_total = 0;
+    return domain;
+}
+
+void rcu_domain_destroy(rcu_domain_t* domain) {
+    if (!domain) return;
+    while (domain->retired_head != NULL) {
+        rcu_retired_t* retired = domain->retired_head;
+        domain->retired_head = retired->next;
+        retired->destroy(retired->object);
+        free(retired);
+    }
+    while (domain->threads != NULL) {
+        rcu_thread_t* next = domain->threads->next;
+        free(domain->threads);
+        domain->threads = next;
+    }
+    pthread_mutex_destroy(&domain->threads_lock);
+    pthread_mutex_destroy(&domain->retired_lock);
+    free(domain);
+}
+
+rcu_thread_t* rcu_register_thread(rcu_domain_t* domain) {
+    if (!domain) {
+        errno = EINVAL;
+        return NULL;
+    }
+    rcu_thread_t* thread = (rcu_thread_t*)aligned_alloc(64, sizeof(rcu_thread_t));
+    if (!thread) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    atomic_init(&thread->epoch, 0);
+    thread->domain = domain;
+    thread->waiters = 0;
+    thread->unregistered = false;
+
+    pthread_mutex_lock(&domain->threads_lock);
+    thread->next = domain->threads;
+    domain->threads = thread;
+    domain->num_threads++;
+    pthread_mutex_unlock(&domain->threads_lock);
+
+    rcu_thread_online(thread);
+    current_thread = thread;
+    return thread;
+}
+
+// Удаление записи из списка (под threads_lock)
+static void rcu_unlink_locked(rcu_domain_t* domain, rcu_thread_t* thread) {
+    rcu_thread_t** link = &domain->threads;
+    while (*link != thread) {
+        link = &(*link)->next;
+    }
+    *link = thread->next;
+}
+
+void rcu_unregister_thread(rcu_thread_t* thread) {
+    if (!thread) return;
+    rcu_domain_t* domain = thread->domain;
+    rcu_thread_offline(thread);
+
+    // Запись, которую сейчас ждет писатель, освободит он сам
+    pthread_mutex_lock(&domain->threads_lock);
+    bool release = thread->waiters == 0;
+    if (release) {
+        rcu_unlink_locked(domain, thread);
+    } else {
+        thread->unregistered = true;
+    }
+    domain->num_threads--;
+    pthread_mutex_unlock(&domain->threads_lock);
+
+    if (current_thread == thread) {
+        current_thread = NULL;
+    }
+    if (release) {
+        free(thread);
+    }
+}
+
+rcu_thread_t* rcu_thread_self(rcu_domain_t* domain) {
+    rcu_thread_t* thread = current_thread;
+    return thread != NULL && thread->domain == domain ? thread : NULL;
+}
+
+// Acquire-чтение эпохи: если поток увидел эпоху, взятую писателем после
+// замены указателя, то последующие чтения увидят новый указатель
+void rcu_quiescent_state(rcu_thread_t* thread) {
+    uint64_t epoch = atomic_load_explicit(&thread->domain->epoch, memory_order_acquire);
+    atomic_store_explicit(&thread->epoch, epoch, memory_order_release);
+}
+
+void rcu_thread_offline(rcu_thread_t* thread) {
+    atomic_store_explicit(&thread->epoch, 0, memory_order_release);
+}
+
+// Писатель, увидевший поток offline, мог уже освободить объект, поэтому
+// запись эпохи должна стать видимой раньше первого чтения указателя
+void rcu_thread_online(rcu_thread_t* thread) {
+    atomic_store_explicit(&thread->epoch,
+                          atomic_load_explicit(&thread->domain->epoch, memory_order_acquire),
+                          memory_order_seq_cst);
+    atomic_thread_fence(memory_order_seq_cst);
+}
+
+// Наименьшая эпоха online-потоков (под threads_lock); без online-потоков —
+// текущая эпоха домена
+static uint64_t rcu_min_epoch_locked(rcu_domain_t* domain) {
+    uint64_t min = atomic_load_explicit(&domain->epoch, memory_order_seq_cst);
+    for (rcu_thread_t* thread = domain->threads; thread != NULL; thread = thread->next) {
+        uint64_t epoch = atomic_load_explicit(&thread->epoch, memory_order_seq_cst);
+        if (epoch != 0 && epoch < min) {
+            min = epoch;
+        }
+    }
+    return min;
+}
+
+// Ожидание без threads_lock: ждущий писатель не мешает регистрации и
+// снятию с регистрации (потоки пула делают это при динамическом
+// масштабировании). Ожидаемая запись удерживается счетчиком waiters и
+// остается в списке, поэтому переход к следующей под блокировкой
+// корректен, даже если поток за это время снят с регистрации.
+void rcu_synchronize(rcu_domain_t* domain) {
+    uint64_t target = atomic_fetch_add_explicit(&domain->epoch, 1, memory_order_seq_cst) + 1;
+
+    pthread_mutex_lock(&domain->threads_lock);
+    rcu_thread_t* thread = domain->threads;
+    while (thread != NULL) {
+        thread->waiters++;
+        pthread_mutex_unlock(&domain->threads_lock);
+
+        long pause_ns = RCU_WAIT_MIN_NS;
+        int yields = 0;
+        while (true) {
+            uint64_t epoch = atomic_load_explicit(&thread->epoch, memory_order_seq_cst);
+            if (epoch == 0 || epoch >= target) break;
+            // Сначала уступаем процессор (читатель мог быть вытеснен),
+            // затем спим с растущей паузой
+            if (yields++ < 16) {
+                sched_yield();
+                continue;
+            }
+            struct timespec pause = { .tv_sec = 0, .tv_nsec = pause_ns };
+            nanosleep(&pause, NULL);
+            if (pause_ns < RCU_WAIT_MAX_NS) pause_ns *= 2;
+        }
+
+        pthread_mutex_lock(&domain->threads_lock);
+        rcu_thread_t* next = thread->next;
+        if (--thread->waiters == 0 && thread->unregistered) {
+            rcu_unlink_locked(domain, thread);
+            free(thread);
+        }
+        thread = next;
+    }
+    pthread_mutex_unlock(&domain->threads_lock);
+}
+
+// Освобождение объектов с эпохой не больше safe
+static size_t rcu_reclaim_until(rcu_domain_t* domain, uint64_t safe) {
+    pthread_mutex_lock(&domain->retired_lock);
+    rcu_retired_t* ready = NULL;
+    rcu_retired_t** tail = &ready;
+    size_t count = 0;
+    while (domain->retired_head != NULL && domain->retired_head->epoch <= safe) {
+        *tail = domain->retired_head;
+        tail = &domain->retired_head->next;
+        domain->retired_head = domain->retired_head->next;
+        count++;
+    }
+    *tail = NULL;
+    if (domain->retired_head == NULL) {
+        domain->retired_tail = NULL;
+    }
+    domain->pending -= count;
+    domain->reclaimed_total += count;
+    pthread_mutex_unlock(&domain->retired_lock);
+
+    // Деструкторы — без блокировки: они могут сами вызвать rcu_retire
+    while (ready != NULL) {
+        rcu_retired_t* next = ready->next;
+        ready->destroy(ready->object);
+        free(ready);
+        ready = next;
+    }
+    return count;
+}
+
+size_t rcu_reclaim(rcu_domain_t* domain) {
+    pthread_mutex_lock(&domain->threads_lock);
+    uint64_t safe = rcu_min_epoch_locked(domain);
+    pthread_mutex_unlock(&domain->threads_lock);
+    return rcu_reclaim_until(domain, safe);
+}
+
+int rcu_retire(rcu_domain_t* domain, void* object, void (*destroy)(void*)) {
+    if (!domain || !destroy) {
+        errno = EINVAL;
+        return -1;
+    }
+    rcu_retired_t* retired = (rcu_retired_t*)malloc(sizeof(rcu_retired_t));
+    if (!retired) {
+        errno = ENOMEM;
+        return -1;
+    }
+    retired->next = NULL;
+    retired->object = object;
+    retired->destroy = destroy;
+
+    // Эпоха берется под блокировкой, чтобы список оставался упорядоченным
+    pthread_mutex_lock(&domain->retired_lock);
+    retired->epoch = atomic_fetch_add_explicit(&domain->epoch, 1, memory_order_seq_cst) + 1;
+    if (domain->retired_tail) {
+        domain->retired_tail->next = retired;
+    } else {
+        domain->retired_head = retired;
+    }
+    domain->retired_tail = retired;
+    domain->retired_total++;
+    bool reclaim = ++domain->pending >= RCU_RECLAIM_THRESHOLD;
+    pthread_mutex_unlock(&domain->retired_lock);
+
+    if (reclaim) {
+        rcu_reclaim(domain);
+    }
+    return 0;
+}
+
+void rcu_barrier(rcu_domain_t* domain) {
+    uint64_t epoch = atomic_load_explicit(&domain->epoch, memory_order_seq_cst);
+    rcu_synchronize(domain);
+    rcu_reclaim_until(domain, epoch);
+}
+
+rcu_stats_t rcu_get_stats(rcu_domain_t* domain) {
+    rcu_stats_t stats;
+    stats.epoch = atomic_load_explicit(&domain->epoch, memory_order_relaxed);
+    pthread_mutex_lock(&domain->threads_lock);
+    stats.threads = domain->num_threads;
+    pthread_mutex_unlock(&domain->threads_lock);
+    pthread_mutex_lock(&domain->retired_lock);
+    stats.pending = domain->pending;
+    stats.retired = domain->retired_total;
+    stats.reclaimed = domain->reclaimed_total;
+    pthread_mutex_unlock(&domain->retired_lock);
+    return stats;
+}
+
+// --- Хуки пула ---
+
+static void rcu_hook_thread_start(void* ctx) {
+    if (!rcu_register_thread((rcu_domain_t*)ctx)) {
+        // Без регистрации чтения потока не защищены — продолжать нельзя
+        fprintf(stderr, "rcu: не удалось зарегистрировать поток пула\n");
+        abort();
+    }
+}
+
+static void rcu_hook_thread_stop(void* ctx) {
+    rcu_unregister_thread(rcu_thread_self((rcu_domain_t*)ctx));
+}
+
+static void rcu_hook_after_task(void* ctx) {
+    (void)ctx;
+    rcu_quiescent_state(current_thread);
+}
+
+static void rcu_hook_idle(void* ctx, bool sleeping) {
+    (void)ctx;
+    if (sleeping) {
+        rcu_thread_offline(current_thread);
+    } else {
+        rcu_thread_online(current_thread);
+    }
+}
+
+thread_pool_hooks_t rcu_pool_hooks(rcu_domain_t* domain) {
+    thread_pool_hooks_t hooks = {
+        .thread_start = rcu_hook_thread_start,
+        .thread_stop = rcu_hook_thread_stop,
+        .after_task = rcu_hook_after_task,
+        .idle = rcu_hook_idle,
+        .ctx = domain,
+    };
+    return hooks;
+}
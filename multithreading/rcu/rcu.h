@@ -0,0 +1,103 @@
+#ifndef RCU_H
+#define RCU_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../thread_pool/thread_pool.h"
+
+// RCU в пространстве пользователя на состояниях покоя (QSBR) с эпохами.
+//
+// Читатель ничего не делает на пути чтения: загружает указатель
+// (rcu_dereference) и работает с объектом без блокировок и атомарных
+// RMW. Писатель готовит новую версию, публикует ее атомарной заменой
+// указателя (rcu_exchange) и отдает старую в rcu_retire: она
+// освобождается, когда каждый поток домена прошел состояние покоя —
+// точку, где он не держит ссылок на разделяемые объекты.
+//
+// Состояние покоя объявляет сам поток (rcu_quiescent_state): одна
+// запись текущей эпохи в свою кэш-линию. Поток, который надолго
+// уходит в ожидание, переходит в offline и не задерживает писателей.
+// Потоки пула с rcu_pool_hooks делают это сами: состояние покоя — после
+// каждой задачи, offline — пока поток спит без работы. Поэтому задача
+// не должна хранить прочитанные через RCU указатели дольше своего
+// выполнения (и в волокне — через tp_yield/tp_sleep и ожидания).
+
+typedef struct rcu_domain rcu_domain_t;
+
+// Запись потока в домене
+typedef struct rcu_thread {
+    _Alignas(64) _Atomic uint64_t epoch; // Эпоха последнего покоя (0 — offline)
+    rcu_domain_t* domain;
+    struct rcu_thread* next;
+    int waiters;              // Писателей, ждущих этот поток (под блокировкой домена)
+    bool unregistered;        // Снят с регистрации; запись освободит последний писатель
+} rcu_thread_t;
+
+// Создание и уничтожение домена. Перед уничтожением все потоки должны
+// быть сняты с регистрации; отложенные объекты освобождаются.
+rcu_domain_t* rcu_domain_create(void);
+void rcu_domain_destroy(rcu_domain_t* domain);
+
+// Регистрация вызывающего потока (сразу online). Возвращает NULL с errno.
+rcu_thread_t* rcu_register_thread(rcu_domain_t* domain);
+void rcu_unregister_thread(rcu_thread_t* thread);
+
+// Запись вызывающего потока в домене (NULL — поток не зарегистрирован)
+rcu_thread_t* rcu_thread_self(rcu_domain_t* domain);
+
+// Состояние покоя: с этого момента поток не держит ссылок, полученных
+// через rcu_dereference раньше
+void rcu_quiescent_state(rcu_thread_t* thread);
+
+// Offline — поток не читает разделяемые объекты (например, перед долгим
+// ожиданием); online — снова читает
+void rcu_thread_offline(rcu_thread_t* thread);
+void rcu_thread_online(rcu_thread_t* thread);
+
+// Чтение опубликованного указателя
+static inline void* rcu_dereference(void* _Atomic* pointer) {
+    return atomic_load_explicit(pointer, memory_order_acquire);
+}
+
+// Публикация нового объекта; возвращает прежний (для rcu_retire)
+static inline void* rcu_exchange(void* _Atomic* pointer, void* value) {
+    return atomic_exchange_explicit(pointer, value, memory_order_acq_rel);
+}
+
+// Ожидание конца периода ожидания: каждый online-поток прошел состояние
+// покоя после вызова. Из зарегистрированного потока — только если он
+// сейчас offline, иначе ожидание самого себя не закончится.
+void rcu_synchronize(rcu_domain_t* domain);
+
+// Отложенное освобождение: destroy(object) вызовется, когда ни один поток
+// не сможет держать ссылку на object. Не ждет; время от времени сам
+// освобождает накопившиеся готовые объекты. Возвращает 0 или -1 с errno.
+int rcu_retire(rcu_domain_t* domain, void* object, void (*destroy)(void*));
+
+// Освобождение готовых отложенных объектов без ожидания.
+// Возвращает, сколько объектов освобождено.
+size_t rcu_reclaim(rcu_domain_t* domain);
+
+// rcu_synchronize и освобождение всех отложенных до вызова объектов
+void rcu_barrier(rcu_domain_t* domain);
+
+// Статистика домена
+typedef struct {
+    uint64_t epoch;           // Текущая эпоха
+    int threads;              // Зарегистрированных потоков
+    size_t pending;           // Ждут освобождения
+    uint64_t retired;         // Отдано в rcu_retire за все время
+    uint64_t reclaimed;       // Освобождено за все время
+} rcu_stats_t;
+
+rcu_stats_t rcu_get_stats(rcu_domain_t* domain);
+
+// Хуки пула для thread_pool_options_t.hooks: потоки пула регистрируются
+// в домене при запуске, объявляют состояние покоя после каждой задачи
+// и уходят в offline, пока ждут работу
+thread_pool_hooks_t rcu_pool_hooks(rcu_domain_t* domain);
+
+#endif // RCU_H
@@ -0,0 +1,194 @@
+#include "sharded_counter.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Счетчик попаданий из mutex_example.c (мьютекс вокруг каждого counter++)
+// против atomic fetch_add, шардированного счетчика и пакетного сброса.
+// Перебирается NUM_THREADS; для каждого варианта — нс на инкремент
+// в потоке, суммарная пропускная способность и цена чтения.
+// Запуск: ./bench_sharded_counter [инкрементов_на_поток] [потоки,через,запятую]
+
+#define DEFAULT_ITERATIONS 1000000L
+#define READ_ITERATIONS 1000000L
+#define BATCH_SIZE 64
+
+typedef enum { VARIANT_MUTEX, VARIANT_ATOMIC, VARIANT_SHARDED, VARIANT_BATCHED, VARIANTS } variant_t;
+
+static const char* variant_names[VARIANTS] = {"mutex", "atomic", "sharded", "batched"};
+
+typedef struct {
+    variant_t variant;
+    long iterations;
+
+    pthread_mutex_t mutex;
+    _Alignas(COUNTER_CACHE_LINE) uint64_t mutex_counter;
+    atomic_counter_t atomic;
+    sharded_counter_t sharded;
+    atomic_counter_t batched;
+
+    pthread_barrier_t start;
+} bench_t;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void* writer(void* arg) {
+    bench_t* b = (bench_t*)arg;
+    long n = b->iterations;
+
+    pthread_barrier_wait(&b->start);
+
+    switch (b->variant) {
+    case VARIANT_MUTEX:
+        for (long i = 0; i < n; i++) {
+            pthread_mutex_lock(&b->mutex);
+            b->mutex_counter++;
+            pthread_mutex_unlock(&b->mutex);
+        }
+        break;
+    case VARIANT_ATOMIC:
+        for (long i = 0; i < n; i++) {
+            atomic_counter_add(&b->atomic, 1);
+        }
+        break;
+    case VARIANT_SHARDED:
+        for (long i = 0; i < n; i++) {
+            sharded_counter_add(&b->sharded, 1);
+        }
+        break;
+    case VARIANT_BATCHED: {
+        counter_batch_t local;
+        counter_batch_init(&local, &b->batched, BATCH_SIZE);
+        for (long i = 0; i < n; i++) {
+            counter_batch_add(&local, 1);
+        }
+        counter_batch_flush(&local);
+        break;
+    }
+    default:
+        break;
+    }
+    return NULL;
+}
+
+static uint64_t read_counter(bench_t* b) {
+    switch (b->variant) {
+    case VARIANT_MUTEX: {
+        pthread_mutex_lock(&b->mutex);
+        uint64_t value = b->mutex_counter;
+        pthread_mutex_unlock(&b->mutex);
+        return value;
+    }
+    case VARIANT_ATOMIC: return atomic_counter_read(&b->atomic);
+    case VARIANT_SHARDED: return sharded_counter_read(&b->sharded);
+    case VARIANT_BATCHED: return atomic_counter_read(&b->batched);
+    default: return 0;
+    }
+}
+
+// Прогон одного варианта: нс на инкремент в потоке, млн инкрементов/с
+// суммарно и нс на чтение
+static int run(variant_t variant, int threads, long iterations, int max_threads,
+               double* ns_per_op, double* mops, double* ns_per_read) {
+    bench_t* b = NULL;
+    if (posix_memalign((void**)&b, COUNTER_CACHE_LINE, sizeof(bench_t)) != 0) return -1;
+    memset(b, 0, sizeof(*b));
+    b->variant = variant;
+    b->iterations = iterations;
+    pthread_mutex_init(&b->mutex, NULL);
+    atomic_counter_init(&b->atomic);
+    atomic_counter_init(&b->batched);
+    // Шардов не меньше потоков, чтобы у каждого была своя линия
+    if (sharded_counter_init(&b->sharded, (unsigned int)max_threads) != 0) {
+        free(b);
+        return -1;
+    }
+    pthread_barrier_init(&b->start, NULL, (unsigned int)threads + 1);
+
+    pthread_t tids[threads];
+    for (int i = 0; i < threads; i++) {
+        pthread_create(&tids[i], NULL, writer, b);
+    }
+
+    // Время засекается до отпускания барьера: потоки могут успеть
+    // закончить раньше, чем главный поток снова получит процессор
+    double start = now_sec();
+    pthread_barrier_wait(&b->start);
+    for (int i = 0; i < threads; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    double elapsed = now_sec() - start;
+
+    uint64_t expected = (uint64_t)threads * (uint64_t)iterations;
+    uint64_t value = read_counter(b);
+
+    // Цена чтения в покое: для шардированного растет с числом шардов
+    volatile uint64_t sink = 0;
+    double read_start = now_sec();
+    for (long i = 0; i < READ_ITERATIONS; i++) {
+        sink += read_counter(b);
+    }
+    double read_elapsed = now_sec() - read_start;
+    (void)sink;
+
+    *ns_per_op = elapsed * 1e9 / (double)iterations;
+    *mops = (double)expected / elapsed / 1e6;
+    *ns_per_read = read_elapsed * 1e9 / READ_ITERATIONS;
+
+    pthread_barrier_destroy(&b->start);
+    pthread_mutex_destroy(&b->mutex);
+    sharded_counter_destroy(&b->sharded);
+    free(b);
+
+    if (value != expected) {
+        fprintf(stderr, "%s: значение %llu, ожидалось %llu\n", variant_names[variant],
+                (unsigned long long)value, (unsigned long long)expected);
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    long iterations = argc > 1 ? atol(argv[1]) : DEFAULT_ITERATIONS;
+    const char* list = argc > 2 ? argv[2] : "1,2,4,8,16,32";
+    if (iterations <= 0) iterations = DEFAULT_ITERATIONS;
+
+    int thread_counts[32];
+    int num_counts = 0;
+    int max_threads = 1;
+    for (const char* p = list; *p && num_counts < 32;) {
+        char* end;
+        long n = strtol(p, &end, 10);
+        if (end == p || n <= 0) {
+            fprintf(stderr, "Неверный список потоков: %s\n", list);
+            return 1;
+        }
+        thread_counts[num_counts++] = (int)n;
+        if (n > max_threads) max_threads = (int)n;
+        p = *end == ',' ? end + 1 : end;
+    }
+
+    printf("Инкрементов на поток: %ld, пакет: %d, чтений: %ld\n\n",
+           iterations, BATCH_SIZE, READ_ITERATIONS);
+    printf("NUM_THREADS  вариант    нс/инкремент  млн инкр./с  нс/чтение\n");
+
+    for (int t = 0; t < num_counts; t++) {
+        for (int v = 0; v < VARIANTS; v++) {
+            double ns_per_op, mops, ns_per_read;
+            if (run((variant_t)v, thread_counts[t], iterations, max_threads,
+                    &ns_per_op, &mops, &ns_per_read) != 0) {
+                return 1;
+            }
+            printf("%11d  %-9s %13.2f %12.1f %10.2f\n",
+                   thread_counts[t], variant_names[v], ns_per_op, mops, ns_per_read);
+        }
+        printf("\n");
+    }
+    return 0;
+}
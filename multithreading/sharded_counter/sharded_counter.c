@@ -0,0 +1,55 @@
+#include "sharded_counter.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+_Thread_local int sharded_counter_slot = -1;
+
+// Потоки получают шарды по кругу: при потоках не больше шардов у каждого
+// своя кэш-линия
+static atomic_uint next_slot;
+
+int sharded_counter_assign_slot(void) {
+    sharded_counter_slot = (int)(atomic_fetch_add_explicit(&next_slot, 1, memory_order_relaxed)
+                                 & 0x7fffffffu);
+    return sharded_counter_slot;
+}
+
+int sharded_counter_init(sharded_counter_t* c, unsigned int num_shards) {
+    if (num_shards == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_CONF);
+        num_shards = cpus > 0 ? (unsigned int)cpus : 1;
+    }
+
+    unsigned int shards = 1;
+    while (shards < num_shards) {
+        shards <<= 1;
+    }
+
+    void* memory = NULL;
+    if (posix_memalign(&memory, COUNTER_CACHE_LINE, sizeof(counter_shard_t) * shards) != 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    c->shards = (counter_shard_t*)memory;
+    c->mask = shards - 1;
+    for (unsigned int i = 0; i < shards; i++) {
+        atomic_init(&c->shards[i].value, 0);
+    }
+    return 0;
+}
+
+void sharded_counter_destroy(sharded_counter_t* c) {
+    free(c->shards);
+    c->shards = NULL;
+}
+
+uint64_t sharded_counter_read(const sharded_counter_t* c) {
+    uint64_t sum = 0;
+    for (unsigned int i = 0; i <= c->mask; i++) {
+        sum += atomic_load_explicit(&c->shards[i].value, memory_order_relaxed);
+    }
+    return sum;
+}
@@ -0,0 +1,106 @@
+#ifndef SHARDED_COUNTER_H
+#define SHARDED_COUNTER_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Счетчики для частых инкрементов из многих потоков (счетчики попаданий,
+// статистика), три варианта с разной ценой записи и чтения:
+//
+//   atomic_counter_t  — одно слово, fetch_add. Чтение — одна загрузка,
+//                       но все пишущие потоки борются за одну кэш-линию.
+//   sharded_counter_t — по слову на кэш-линию, поток пишет в свою.
+//                       Запись не пересекается с другими потоками,
+//                       чтение суммирует все шарды.
+//   counter_batch_t   — локальный (на поток) накопитель, который сбрасывается
+//                       в общий счетчик раз в batch инкрементов. Запись почти
+//                       бесплатна, но чтение видит значение с отставанием
+//                       до batch * число_потоков.
+
+#define COUNTER_CACHE_LINE 64
+
+typedef struct {
+    _Alignas(COUNTER_CACHE_LINE) _Atomic uint64_t value;
+} atomic_counter_t;
+
+static inline void atomic_counter_init(atomic_counter_t* c) {
+    atomic_init(&c->value, 0);
+}
+
+static inline void atomic_counter_add(atomic_counter_t* c, uint64_t delta) {
+    atomic_fetch_add_explicit(&c->value, delta, memory_order_relaxed);
+}
+
+static inline uint64_t atomic_counter_read(const atomic_counter_t* c) {
+    return atomic_load_explicit(&c->value, memory_order_relaxed);
+}
+
+// Шард занимает целую кэш-линию, чтобы соседние шарды не делили ее
+typedef struct {
+    _Alignas(COUNTER_CACHE_LINE) _Atomic uint64_t value;
+} counter_shard_t;
+
+typedef struct {
+    counter_shard_t* shards;
+    unsigned int mask;        // Число шардов - 1 (степень двойки)
+} sharded_counter_t;
+
+// Номер шарда текущего потока (-1 — еще не назначен)
+extern _Thread_local int sharded_counter_slot;
+
+// Назначение потоку следующего номера шарда по кругу
+int sharded_counter_assign_slot(void);
+
+// Инициализация. num_shards округляется вверх до степени двойки;
+// 0 — по числу процессоров. Возвращает 0 или -1 (errno = ENOMEM).
+int sharded_counter_init(sharded_counter_t* c, unsigned int num_shards);
+
+void sharded_counter_destroy(sharded_counter_t* c);
+
+// Увеличение шарда текущего потока. Потоков может быть больше, чем
+// шардов, поэтому шард все равно атомарный, но борьбы за линию почти нет.
+static inline void sharded_counter_add(sharded_counter_t* c, uint64_t delta) {
+    int slot = sharded_counter_slot;
+    if (slot < 0) {
+        slot = sharded_counter_assign_slot();
+    }
+    atomic_fetch_add_explicit(&c->shards[(unsigned int)slot & c->mask].value, delta,
+                              memory_order_relaxed);
+}
+
+// Сумма всех шардов. При параллельной записи результат — значение
+// на какой-то момент во время чтения (каждый шард монотонен).
+uint64_t sharded_counter_read(const sharded_counter_t* c);
+
+// Накопитель потока для пакетной записи в atomic_counter_t.
+// Используется только своим потоком; перед завершением потока
+// остаток нужно сбросить через counter_batch_flush.
+typedef struct {
+    atomic_counter_t* target;
+    uint64_t pending;         // Еще не переданные в target
+    uint64_t batch;           // Порог сброса
+} counter_batch_t;
+
+static inline void counter_batch_init(counter_batch_t* b, atomic_counter_t* target,
+                                      uint64_t batch) {
+    b->target = target;
+    b->pending = 0;
+    b->batch = batch > 0 ? batch : 1;
+}
+
+static inline void counter_batch_flush(counter_batch_t* b) {
+    if (b->pending != 0) {
+        atomic_counter_add(b->target, b->pending);
+        b->pending = 0;
+    }
+}
+
+static inline void counter_batch_add(counter_batch_t* b, uint64_t delta) {
+    b->pending += delta;
+    if (b->pending >= b->batch) {
+        counter_batch_flush(b);
+    }
+}
+
+#endif // SHARDED_COUNTER_H
@@ -0,0 +1,198 @@
+#include "task_graph.h"
+#include "../../common/futex.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Накладные расходы планирования на узел графа (узлы пустые).
+//   wide — корень, N независимых узлов, сток (N + 2 узла, 2N ребер);
+//          для сравнения — N задач одним thread_pool_add_tasks
+//   deep — цепочка из N узлов; для сравнения — прежний способ, когда
+//          задача сама ставит в пул следующую
+// Граф строится один раз и запускается ROUNDS раз; время построения
+// показано отдельно. В конце — отмена: узел в середине цепочки
+// возвращает ошибку, и оставшиеся узлы не вызываются.
+// Запуск: ./bench_task_graph [N]
+
+#define NUM_THREADS 4
+#define DEFAULT_NODES 100000
+#define ROUNDS 5
+
+static int empty_node(void* arg) {
+    (void)arg;
+    return 0;
+}
+
+static void empty_task(void* arg) {
+    (void)arg;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Все узлы выполнены успешно
+static int check_done(task_graph_t* graph) {
+    for (int i = 0; i < task_graph_size(graph); i++) {
+        if (task_graph_node_state(graph, i) != TASK_GRAPH_NODE_DONE) {
+            fprintf(stderr, "Узел %d не выполнен\n", i);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Среднее время запуска графа на узел за ROUNDS запусков
+static double run_graph(task_graph_t* graph) {
+    uint64_t total = 0;
+    for (int r = 0; r < ROUNDS; r++) {
+        uint64_t begin = now_ns();
+        if (task_graph_submit(graph, NULL, NULL) != 0 || task_graph_wait(graph) != 0) {
+            perror("task_graph");
+            exit(1);
+        }
+        total += now_ns() - begin;
+        if (check_done(graph) != 0) {
+            exit(1);
+        }
+    }
+    return (double)total / ROUNDS / task_graph_size(graph);
+}
+
+// --- прежний способ для deep: задача ставит следующую ---
+
+typedef struct {
+    thread_pool_t* pool;
+    long left;
+    _Atomic uint32_t done;   // futex
+} chain_t;
+
+static void chain_step(void* arg) {
+    chain_t* chain = (chain_t*)arg;
+    if (--chain->left > 0) {
+        thread_pool_add_task(chain->pool, chain_step, chain);
+    } else {
+        atomic_store(&chain->done, 1);
+        futex_wake(&chain->done, 1, false);
+    }
+}
+
+static double run_chain(thread_pool_t* pool, long nodes) {
+    uint64_t total = 0;
+    for (int r = 0; r < ROUNDS; r++) {
+        chain_t chain = { .pool = pool, .left = nodes };
+        atomic_init(&chain.done, 0);
+        uint64_t begin = now_ns();
+        thread_pool_add_task(pool, chain_step, &chain);
+        while (!atomic_load(&chain.done)) {
+            futex_wait(&chain.done, 0, NULL, false);
+        }
+        total += now_ns() - begin;
+        // Последняя задача еще может выходить из chain_step
+        thread_pool_wait(pool);
+    }
+    return (double)total / ROUNDS / nodes;
+}
+
+static double run_flat(thread_pool_t* pool, long nodes) {
+    void** args = (void**)calloc(nodes, sizeof(void*));
+    uint64_t total = 0;
+    for (int r = 0; r < ROUNDS; r++) {
+        uint64_t begin = now_ns();
+        thread_pool_add_tasks(pool, empty_task, args, (int)nodes);
+        thread_pool_wait(pool);
+        total += now_ns() - begin;
+    }
+    free(args);
+    return (double)total / ROUNDS / nodes;
+}
+
+// --- отмена ---
+
+static int failing_node(void* arg) {
+    (void)arg;
+    return EIO;
+}
+
+static void print_row(const char* name, double graph_ns, double build_ns, double baseline_ns,
+                      const char* baseline) {
+    printf("%-6s %12.1f %14.1f %12.1f   (%s)\n", name, graph_ns, build_ns, baseline_ns, baseline);
+}
+
+int main(int argc, char* argv[]) {
+    long nodes = argc > 1 ? atol(argv[1]) : DEFAULT_NODES;
+    if (nodes <= 0) nodes = DEFAULT_NODES;
+
+    thread_pool_options_t options = { .num_threads = NUM_THREADS, .quiet = true };
+    thread_pool_t* pool = thread_pool_create_with_options(&options);
+    if (!pool) {
+        return 1;
+    }
+    printf("Потоков пула: %d, узлов: %ld, запусков: %d\n\n", NUM_THREADS, nodes, ROUNDS);
+    printf("%-6s %12s %14s %12s\n", "граф", "нс на узел", "построение нс", "без графа нс");
+
+    // wide
+    uint64_t begin = now_ns();
+    task_graph_t* wide = task_graph_create(pool);
+    int root = task_graph_add_node(wide, empty_node, NULL);
+    int sink = task_graph_add_node(wide, empty_node, NULL);
+    for (long i = 0; i < nodes; i++) {
+        int node = task_graph_add_node(wide, empty_node, NULL);
+        task_graph_add_edge(wide, root, node);
+        task_graph_add_edge(wide, node, sink);
+    }
+    double build_ns = (double)(now_ns() - begin) / task_graph_size(wide);
+    double wide_ns = run_graph(wide);
+    print_row("wide", wide_ns, build_ns, run_flat(pool, nodes), "thread_pool_add_tasks");
+    task_graph_destroy(wide);
+
+    // deep
+    begin = now_ns();
+    task_graph_t* deep = task_graph_create(pool);
+    int prev = -1;
+    for (long i = 0; i < nodes; i++) {
+        int node = task_graph_add_node(deep, empty_node, NULL);
+        if (prev >= 0) {
+            task_graph_add_edge(deep, prev, node);
+        }
+        prev = node;
+    }
+    build_ns = (double)(now_ns() - begin) / task_graph_size(deep);
+    double deep_ns = run_graph(deep);
+    print_row("deep", deep_ns, build_ns, run_chain(pool, nodes), "задача ставит следующую");
+    task_graph_destroy(deep);
+
+    // Отмена: цепочка из 1000 узлов, 500-й возвращает EIO
+    task_graph_t* cancel = task_graph_create(pool);
+    prev = -1;
+    for (int i = 0; i < 1000; i++) {
+        int node = task_graph_add_node(cancel, i == 500 ? failing_node : empty_node, NULL);
+        if (prev >= 0) {
+            task_graph_add_edge(cancel, prev, node);
+        }
+        prev = node;
+    }
+    task_graph_submit(cancel, NULL, NULL);
+    int status = task_graph_wait(cancel);
+    int counts[4] = { 0 };
+    for (int i = 0; i < task_graph_size(cancel); i++) {
+        counts[task_graph_node_state(cancel, i)]++;
+    }
+    printf("\nОтмена: итог %d (EIO = %d), выполнено %d, с ошибкой %d, отменено %d\n", status, EIO,
+           counts[TASK_GRAPH_NODE_DONE], counts[TASK_GRAPH_NODE_FAILED],
+           counts[TASK_GRAPH_NODE_CANCELLED]);
+
+    // Цикл обнаруживается при запуске
+    task_graph_add_edge(cancel, 999, 0);
+    if (task_graph_submit(cancel, NULL, NULL) == 0 || errno != ELOOP) {
+        fprintf(stderr, "Цикл не обнаружен\n");
+        return 1;
+    }
+    task_graph_destroy(cancel);
+
+    thread_pool_destroy(pool);
+    return 0;
+}
@@ -0,0 +1,359 @@
+#include "task_graph.h"
+#include "../../common/futex.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Сколько готовых преемников ставится в пул одним thread_pool_add_tasks
+#define READY_BATCH 64
+
+// Слово running: GRAPH_RUNNING, пока граф выполняется, и GRAPH_WAITING,
+// если на слове кто-то спит и при завершении нужен futex_wake
+#define GRAPH_RUNNING 0x1u
+#define GRAPH_WAITING 0x2u
+
+typedef struct {
+    task_graph_t* graph;
+    task_graph_fn function;
+    void* arg;
+    uint32_t first_successor;  // Начало преемников в graph->successors
+    uint32_t num_successors;
+    uint32_t num_predecessors;
+    _Atomic uint32_t predecessors_left; // Незавершенных предшественников
+    _Atomic int state;         // task_graph_node_state_t
+} task_graph_node_t;
+
+typedef struct {
+    uint32_t from;
+    uint32_t to;
+} task_graph_edge_t;
+
+struct task_graph {
+    thread_pool_t* pool;
+
+    task_graph_node_t* nodes;
+    int num_nodes;
+    int nodes_capacity;
+    task_graph_edge_t* edges;  // Ребра в порядке добавления
+    size_t num_edges;
+    size_t edges_capacity;
+    uint32_t* successors;      // Преемники узлов подряд (CSR), строится при запуске
+    bool finalized;            // successors соответствует edges, циклов нет
+
+    _Atomic uint32_t running;  // GRAPH_RUNNING | GRAPH_WAITING (слово futex)
+    atomic_int remaining;      // Узлов до завершения графа
+    atomic_bool cancelled;
+    atomic_int status;         // Итог: 0 или первый код ошибки
+    task_graph_done_cb done;
+    void* done_arg;
+};
+
+static void task_graph_run_node(void* arg);
+
+// Постановка готовых узлов в пул; если пул не принял, они выполняются здесь
+static void task_graph_push(task_graph_t* graph, task_graph_node_t** ready, int count) {
+    if (count == 0) {
+        return;
+    }
+    if (thread_pool_add_tasks(graph->pool, task_graph_run_node, (void* const*)ready, count) != 0) {
+        for (int i = 0; i < count; i++) {
+            task_graph_run_node(ready[i]);
+        }
+    }
+}
+
+// После сброса running граф может быть сразу уничтожен ожидающим потоком,
+// поэтому к нему больше не обращаемся: futex_wake по освобожденному адресу
+// безвреден.
+static void task_graph_finish(task_graph_t* graph) {
+    if (graph->done) {
+        graph->done(graph, atomic_load(&graph->status), graph->done_arg);
+    }
+    if (atomic_exchange(&graph->running, 0) & GRAPH_WAITING) {
+        futex_wake(&graph->running, INT_MAX, false);
+    }
+}
+
+// Первая ошибка становится итогом графа и отменяет оставшиеся узлы
+static void task_graph_fail(task_graph_t* graph, int status) {
+    int expected = 0;
+    atomic_compare_exchange_strong(&graph->status, &expected, status);
+    atomic_store(&graph->cancelled, true);
+}
+
+// Задача пула: узел графа. Отмененный узел не вызывается, но
+// преемников освобождает так же, чтобы граф дошел до конца.
+static void task_graph_run_node(void* arg) {
+    task_graph_node_t* node = (task_graph_node_t*)arg;
+    task_graph_t* graph = node->graph;
+
+    int state = TASK_GRAPH_NODE_CANCELLED;
+    if (!atomic_load_explicit(&graph->cancelled, memory_order_relaxed)) {
+        int rc = node->function(node->arg);
+        if (rc != 0) {
+            task_graph_fail(graph, rc);
+            state = TASK_GRAPH_NODE_FAILED;
+        } else {
+            state = TASK_GRAPH_NODE_DONE;
+        }
+    }
+    atomic_store_explicit(&node->state, state, memory_order_relaxed);
+
+    task_graph_node_t* ready[READY_BATCH];
+    int count = 0;
+    const uint32_t* successor = graph->successors + node->first_successor;
+    for (uint32_t i = 0; i < node->num_successors; i++) {
+        task_graph_node_t* next = &graph->nodes[successor[i]];
+        // acq_rel: результаты всех предшественников видны преемнику
+        if (atomic_fetch_sub_explicit(&next->predecessors_left, 1, memory_order_acq_rel) == 1) {
+            ready[count++] = next;
+            if (count == READY_BATCH) {
+                task_graph_push(graph, ready, count);
+                count = 0;
+            }
+        }
+    }
+    task_graph_push(graph, ready, count);
+
+    if (atomic_fetch_sub_explicit(&graph->remaining, 1, memory_order_acq_rel) == 1) {
+        task_graph_finish(graph);
+    }
+}
+
+task_graph_t* task_graph_create(thread_pool_t* pool) {
+    if (!pool) {
+        errno = EINVAL;
+        return NULL;
+    }
+    task_graph_t* graph = (task_graph_t*)calloc(1, sizeof(task_graph_t));
+    if (!graph) {
+        return NULL;
+    }
+    graph->pool = pool;
+    atomic_init(&graph->running, 0);
+    atomic_init(&graph->remaining, 0);
+    atomic_init(&graph->cancelled, false);
+    atomic_init(&graph->status, 0);
+    return graph;
+}
+
+void task_graph_destroy(task_graph_t* graph) {
+    if (!graph) {
+        return;
+    }
+    free(graph->nodes);
+    free(graph->edges);
+    free(graph->successors);
+    free(graph);
+}
+
+int task_graph_add_node(task_graph_t* graph, task_graph_fn function, void* arg) {
+    if (!graph || !function) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (atomic_load(&graph->running)) {
+        errno = EBUSY;
+        return -1;
+    }
+    if (graph->num_nodes == graph->nodes_capacity) {
+        int capacity = graph->nodes_capacity ? graph->nodes_capacity * 2 : 64;
+        task_graph_node_t* nodes = (task_graph_node_t*)realloc(
+            graph->nodes, (size_t)capacity * sizeof(task_graph_node_t));
+        if (!nodes) {
+            return -1;
+        }
+        graph->nodes = nodes;
+        graph->nodes_capacity = capacity;
+    }
+    task_graph_node_t* node = &graph->nodes[graph->num_nodes];
+    memset(node, 0, sizeof(*node));
+    node->graph = graph;
+    node->function = function;
+    node->arg = arg;
+    atomic_init(&node->state, TASK_GRAPH_NODE_PENDING);
+    graph->finalized = false;
+    return graph->num_nodes++;
+}
+
+int task_graph_add_edge(task_graph_t* graph, int from, int to) {
+    if (!graph || from < 0 || to < 0 || from >= graph->num_nodes || to >= graph->num_nodes) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (atomic_load(&graph->running)) {
+        errno = EBUSY;
+        return -1;
+    }
+    if (graph->num_edges == graph->edges_capacity) {
+        size_t capacity = graph->edges_capacity ? graph->edges_capacity * 2 : 64;
+        task_graph_edge_t* edges = (task_graph_edge_t*)realloc(
+            graph->edges, capacity * sizeof(task_graph_edge_t));
+        if (!edges) {
+            return -1;
+        }
+        graph->edges = edges;
+        graph->edges_capacity = capacity;
+    }
+    graph->edges[graph->num_edges].from = (uint32_t)from;
+    graph->edges[graph->num_edges].to = (uint32_t)to;
+    graph->num_edges++;
+    graph->finalized = false;
+    return 0;
+}
+
+// Преемники подряд по узлам и проверка на циклы (алгоритм Кана)
+static int task_graph_finalize(task_graph_t* graph) {
+    int n = graph->num_nodes;
+    uint32_t* successors = (uint32_t*)malloc((graph->num_edges + 1) * sizeof(uint32_t));
+    uint32_t* order = (uint32_t*)malloc(((size_t)n + 1) * sizeof(uint32_t));
+    uint32_t* left = (uint32_t*)malloc(((size_t)n + 1) * sizeof(uint32_t));
+    if (!successors || !order || !left) {
+        free(successors);
+        free(order);
+        free(left);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    for (int i = 0; i < n; i++) {
+        graph->nodes[i].num_successors = 0;
+        graph->nodes[i].num_predecessors = 0;
+    }
+    for (size_t e = 0; e < graph->num_edges; e++) {
+        graph->nodes[graph->edges[e].from].num_successors++;
+        graph->nodes[graph->edges[e].to].num_predecessors++;
+    }
+    uint32_t offset = 0;
+    for (int i = 0; i < n; i++) {
+        graph->nodes[i].first_successor = offset;
+        offset += graph->nodes[i].num_successors;
+        graph->nodes[i].num_successors = 0;
+    }
+    for (size_t e = 0; e < graph->num_edges; e++) {
+        task_graph_node_t* from = &graph->nodes[graph->edges[e].from];
+        successors[from->first_successor + from->num_successors++] = graph->edges[e].to;
+    }
+
+    // Все узлы должны попасть в топологический порядок
+    int head = 0, tail = 0;
+    for (int i = 0; i < n; i++) {
+        left[i] = graph->nodes[i].num_predecessors;
+        if (left[i] == 0) {
+            order[tail++] = (uint32_t)i;
+        }
+    }
+    while (head < tail) {
+        task_graph_node_t* node = &graph->nodes[order[head++]];
+        for (uint32_t i = 0; i < node->num_successors; i++) {
+            uint32_t next = successors[node->first_successor + i];
+            if (--left[next] == 0) {
+                order[tail++] = next;
+            }
+        }
+    }
+    free(order);
+    free(left);
+    if (tail != n) {
+        free(successors);
+        errno = ELOOP;
+        return -1;
+    }
+
+    free(graph->successors);
+    graph->successors = successors;
+    graph->finalized = true;
+    return 0;
+}
+
+int task_graph_submit(task_graph_t* graph, task_graph_done_cb done, void* arg) {
+    if (!graph) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (atomic_load(&graph->running)) {
+        errno = EBUSY;
+        return -1;
+    }
+    if (!graph->finalized && task_graph_finalize(graph) != 0) {
+        return -1;
+    }
+
+    graph->done = done;
+    graph->done_arg = arg;
+    atomic_store(&graph->status, 0);
+    atomic_store(&graph->cancelled, false);
+    // Пустой граф: в пул ставить нечего, done вызывается здесь же
+    if (graph->num_nodes == 0) {
+        if (done) {
+            done(graph, 0, arg);
+        }
+        return 0;
+    }
+
+    // Счетчики выставляются до постановки первого узла
+    for (int i = 0; i < graph->num_nodes; i++) {
+        task_graph_node_t* node = &graph->nodes[i];
+        atomic_store_explicit(&node->predecessors_left, node->num_predecessors,
+                              memory_order_relaxed);
+        atomic_store_explicit(&node->state, TASK_GRAPH_NODE_PENDING, memory_order_relaxed);
+    }
+    atomic_store(&graph->remaining, graph->num_nodes);
+    atomic_store(&graph->running, GRAPH_RUNNING);
+
+    task_graph_node_t* ready[READY_BATCH];
+    int count = 0;
+    for (int i = 0; i < graph->num_nodes; i++) {
+        if (graph->nodes[i].num_predecessors == 0) {
+            ready[count++] = &graph->nodes[i];
+            if (count == READY_BATCH) {
+                task_graph_push(graph, ready, count);
+                count = 0;
+            }
+        }
+    }
+    task_graph_push(graph, ready, count);
+    return 0;
+}
+
+int task_graph_wait(task_graph_t* graph) {
+    if (!graph) {
+        errno = EINVAL;
+        return -1;
+    }
+    uint32_t state = atomic_load(&graph->running);
+    while (state & GRAPH_RUNNING) {
+        // Флаг ставится только выполняющемуся графу: после сброса running
+        // в task_graph_finish CAS не пройдет
+        if (!(state & GRAPH_WAITING)) {
+            if (!atomic_compare_exchange_weak(&graph->running, &state,
+                                              state | GRAPH_WAITING)) {
+                continue;
+            }
+            state |= GRAPH_WAITING;
+        }
+        futex_wait(&graph->running, state, NULL, false);
+        state = atomic_load(&graph->running);
+    }
+    return atomic_load(&graph->status);
+}
+
+void task_graph_cancel(task_graph_t* graph) {
+    if (graph && atomic_load(&graph->running)) {
+        task_graph_fail(graph, ECANCELED);
+    }
+}
+
+int task_graph_size(const task_graph_t* graph) {
+    return graph ? graph->num_nodes : 0;
+}
+
+task_graph_node_state_t task_graph_node_state(const task_graph_t* graph, int node) {
+    if (!graph || node < 0 || node >= graph->num_nodes) {
+        return TASK_GRAPH_NODE_PENDING;
+    }
+    return (task_graph_node_state_t)atomic_load(&graph->nodes[node].state);
+}
@@ -0,0 +1,70 @@
+#ifndef TASK_GRAPH_H
+#define TASK_GRAPH_H
+
+#include <stdbool.h>
+#include "../thread_pool/thread_pool.h"
+
+// Граф задач (DAG) поверх пула потоков: узлы и ребра объявляются
+// заранее, затем граф запускается целиком. У каждого узла атомарный
+// счетчик незавершенных предшественников; узел ставится в пул в тот
+// момент, когда последний предшественник уменьшает счетчик до нуля,
+// поэтому независимые ветви выполняются параллельно без цепочек
+// "задача ставит следующую".
+//
+// Узел возвращает 0 при успехе. Ненулевой код отменяет граф: узлы, еще
+// не начавшие выполняться, помечаются отмененными и не вызываются
+// (уже выполняющиеся доработают), а код становится итогом графа.
+//
+// Граф можно запускать повторно после завершения; структура (узлы и
+// ребра) проверяется на циклы один раз после каждого изменения.
+
+// Функция узла: 0 — успех, иначе код ошибки
+typedef int (*task_graph_fn)(void* arg);
+
+typedef struct task_graph task_graph_t;
+
+// Вызывается один раз после завершения всех узлов: обычно в потоке пула,
+// но прямо в task_graph_submit для пустого графа и в вызвавшем потоке,
+// если пул не принял узлы и они выполнены на месте
+typedef void (*task_graph_done_cb)(task_graph_t* graph, int status, void* arg);
+
+// Состояние узла после запуска
+typedef enum {
+    TASK_GRAPH_NODE_PENDING,   // Еще не выполнен
+    TASK_GRAPH_NODE_DONE,      // Выполнен успешно
+    TASK_GRAPH_NODE_FAILED,    // Вернул ошибку
+    TASK_GRAPH_NODE_CANCELLED  // Не вызывался из-за отмены
+} task_graph_node_state_t;
+
+// Создание пустого графа для пула. Возвращает NULL с errno при ошибке.
+task_graph_t* task_graph_create(thread_pool_t* pool);
+
+// Уничтожение (граф не должен выполняться)
+void task_graph_destroy(task_graph_t* graph);
+
+// Добавление узла. Возвращает его номер (>= 0) или -1 с errno
+// (EBUSY — граф выполняется).
+int task_graph_add_node(task_graph_t* graph, task_graph_fn function, void* arg);
+
+// Ребро: узел to начнется только после завершения from.
+// Возвращает 0 или -1 с errno (EINVAL — нет такого узла).
+int task_graph_add_edge(task_graph_t* graph, int from, int to);
+
+// Запуск графа; done (может быть NULL) вызывается по завершении.
+// Возвращает 0 или -1 с errno: ELOOP — в графе цикл, EBUSY — граф
+// уже выполняется. Пустой граф завершается сразу: done вызывается
+// до возврата из task_graph_submit.
+int task_graph_submit(task_graph_t* graph, task_graph_done_cb done, void* arg);
+
+// Ожидание завершения. Возвращает итог: 0, код первой ошибки узла или
+// ECANCELED после task_graph_cancel. Не вызывать из узлов этого графа.
+int task_graph_wait(task_graph_t* graph);
+
+// Отмена выполняющегося графа извне
+void task_graph_cancel(task_graph_t* graph);
+
+// Число узлов и состояние узла node после последнего запуска
+int task_graph_size(const task_graph_t* graph);
+task_graph_node_state_t task_graph_node_state(const task_graph_t* graph, int node);
+
+#endif // TASK_GRAPH_H
@@ -0,0 +1,77 @@
+#include "thread_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Сравнение поштучного добавления задач (цикл с thread_pool_add_task,
+// как в example.c) и пакетного thread_pool_add_tasks на веерах задач.
+
+#define FANOUT 256
+#define ROUNDS 2000
+#define NUM_THREADS 4
+#define SLOT_STRIDE 8  // Счетчик на кэш-линию
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void tiny_task(void* arg) {
+    atomic_fetch_add_explicit((atomic_long*)arg, 1, memory_order_relaxed);
+}
+
+// Отправка веера по одной задаче
+static double run_single(thread_pool_t* pool, atomic_long* slots) {
+    double start = now_sec();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < FANOUT; i++) {
+            thread_pool_add_task(pool, tiny_task, &slots[i * SLOT_STRIDE]);
+        }
+    }
+    thread_pool_wait(pool);
+    return (double)ROUNDS * FANOUT / (now_sec() - start);
+}
+
+// Отправка веера одним пакетом
+static double run_bulk(thread_pool_t* pool, atomic_long* slots) {
+    void* args[FANOUT];
+    for (int i = 0; i < FANOUT; i++) {
+        args[i] = &slots[i * SLOT_STRIDE];
+    }
+
+    double start = now_sec();
+    for (int r = 0; r < ROUNDS; r++) {
+        thread_pool_add_tasks(pool, tiny_task, args, FANOUT);
+    }
+    thread_pool_wait(pool);
+    return (double)ROUNDS * FANOUT / (now_sec() - start);
+}
+
+int main(void) {
+    // Каждая задача пишет в свою кэш-линию, чтобы не мешать друг другу
+    atomic_long* slots = calloc(SLOT_STRIDE * FANOUT, sizeof(atomic_long));
+
+    for (int mode = 0; mode < 2; mode++) {
+        thread_pool_options_t options = {
+            .num_threads = NUM_THREADS,
+            .work_stealing = mode == 1,
+        };
+        thread_pool_t* pool = thread_pool_create_with_options(&options);
+        if (!pool) {
+            free(slots);
+            return 1;
+        }
+
+        double single = run_single(pool, slots);
+        double bulk = run_bulk(pool, slots);
+
+        printf("%-13s по одной: %10.0f задач/с, пакетом: %10.0f задач/с (x%.2f)\n",
+               mode == 1 ? "work-stealing" : "mutex", single, bulk, bulk / single);
+
+        thread_pool_destroy(pool);
+    }
+
+    free(slots);
+    return 0;
+}
@@ -0,0 +1,187 @@
+#define _GNU_SOURCE
+#include "thread_pool.h"
+#include "numa_topology.h"
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+
+// Задача, ограниченная пропускной способностью памяти: суммирование
+// больших буферов, каждый из которых лежит на своем NUMA-узле. На каждом
+// узле свой поток-поставщик, закрепленный за CPU этого узла, добавляет
+// задачи по своему буферу. Сравниваются пул без закрепления (одна общая
+// очередь, задачу может взять поток любого узла) и пул с numa_spread
+// (очередь на узел, потоки узла берут задачи своего узла первыми).
+// Запуск: ./bench_numa [МБ_на_узел] [проходов]
+
+#define CHUNK_BYTES (1024 * 1024)
+
+typedef struct {
+    const uint64_t* data;
+    size_t words;
+    int node;                 // Узел, в памяти которого лежит data
+} sum_arg_t;
+
+typedef struct {
+    thread_pool_t* pool;
+    int node;
+    const uint64_t* buffer;
+    size_t bytes;
+    int rounds;
+} submitter_arg_t;
+
+static numa_topology_t topo;
+static atomic_long local_tasks;
+static atomic_long remote_tasks;
+static _Atomic uint64_t checksum;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void sum_task(void* arg) {
+    sum_arg_t* a = (sum_arg_t*)arg;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < a->words; i++) {
+        sum += a->data[i];
+    }
+    atomic_fetch_add_explicit(&checksum, sum, memory_order_relaxed);
+
+    // Где выполнилась задача относительно своих данных
+    int cpu = sched_getcpu();
+    bool local = cpu >= 0 && cpu < topo.num_cpus && topo.cpu_node[cpu] == a->node;
+    atomic_fetch_add_explicit(local ? &local_tasks : &remote_tasks, 1, memory_order_relaxed);
+}
+
+// Закрепление текущего потока за всеми CPU узла
+static void pin_to_node(int node) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu = 0; cpu < topo.num_cpus; cpu++) {
+        if (topo.cpu_node[cpu] == node) CPU_SET(cpu, &set);
+    }
+    sched_setaffinity(0, sizeof(set), &set);
+}
+
+static void* submitter(void* arg) {
+    submitter_arg_t* s = (submitter_arg_t*)arg;
+    pin_to_node(s->node);
+
+    size_t words_per_chunk = CHUNK_BYTES / sizeof(uint64_t);
+    size_t chunks = s->bytes / CHUNK_BYTES;
+    for (int r = 0; r < s->rounds; r++) {
+        for (size_t c = 0; c < chunks; c++) {
+            sum_arg_t a = {s->buffer + c * words_per_chunk, words_per_chunk, s->node};
+            thread_pool_add_task_copy(s->pool, sum_task, &a, sizeof(a));
+        }
+    }
+    return NULL;
+}
+
+// Буфер в памяти узла node, заполненный потоком этого узла
+static uint64_t* alloc_on_node(int node, size_t bytes) {
+    void* p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return NULL;
+    numa_bind_memory(p, bytes, topo.node_id[node]);
+
+    pin_to_node(node);
+    uint64_t* data = (uint64_t*)p;
+    for (size_t i = 0; i < bytes / sizeof(uint64_t); i++) {
+        data[i] = i;
+    }
+    return data;
+}
+
+static void run(const char* name, thread_pool_t* pool, uint64_t** buffers,
+                size_t bytes, int rounds) {
+    atomic_store(&local_tasks, 0);
+    atomic_store(&remote_tasks, 0);
+
+    pthread_t* threads = malloc(sizeof(pthread_t) * topo.num_nodes);
+    submitter_arg_t* args = malloc(sizeof(submitter_arg_t) * topo.num_nodes);
+
+    double start = now_sec();
+    for (int n = 0; n < topo.num_nodes; n++) {
+        args[n] = (submitter_arg_t){pool, n, buffers[n], bytes, rounds};
+        pthread_create(&threads[n], NULL, submitter, &args[n]);
+    }
+    for (int n = 0; n < topo.num_nodes; n++) {
+        pthread_join(threads[n], NULL);
+    }
+    thread_pool_wait(pool);
+    double elapsed = now_sec() - start;
+
+    long local = atomic_load(&local_tasks);
+    long remote = atomic_load(&remote_tasks);
+    double total = (double)bytes * rounds * topo.num_nodes;
+    printf("%s %8.2f ГБ/с, задач на чужом узле: %5.1f%% (%ld из %ld)\n",
+           name, total / elapsed / 1e9,
+           local + remote ? 100.0 * remote / (local + remote) : 0.0, remote, local + remote);
+
+    free(threads);
+    free(args);
+}
+
+int main(int argc, char* argv[]) {
+    size_t mb = argc > 1 ? strtoul(argv[1], NULL, 0) : 64;
+    int rounds = argc > 2 ? atoi(argv[2]) : 8;
+    size_t bytes = mb * 1024 * 1024;
+
+    if (numa_topology_load(&topo) != 0) {
+        perror("numa_topology_load");
+        return 1;
+    }
+
+    int cores = 0;
+    for (int n = 0; n < topo.num_nodes; n++) {
+        int cpus[NUMA_MAX_CPUS];
+        int count = numa_node_cpus(&topo, n, cpus, NUMA_MAX_CPUS);
+        cores += count;
+        printf("Узел %d: %d ядер\n", topo.node_id[n], count);
+    }
+    if (topo.num_nodes == 1) {
+        printf("Один NUMA-узел: разницы между режимами ожидать не стоит\n");
+    }
+
+    uint64_t** buffers = malloc(sizeof(uint64_t*) * topo.num_nodes);
+    for (int n = 0; n < topo.num_nodes; n++) {
+        buffers[n] = alloc_on_node(n, bytes);
+        if (!buffers[n]) {
+            perror("mmap");
+            return 1;
+        }
+    }
+    // Главный поток больше не привязан к последнему узлу
+    cpu_set_t all;
+    CPU_ZERO(&all);
+    for (int cpu = 0; cpu < topo.num_cpus; cpu++) {
+        if (topo.cpu_node[cpu] >= 0) CPU_SET(cpu, &all);
+    }
+    sched_setaffinity(0, sizeof(all), &all);
+
+    printf("Буфер %zu МБ на узел, проходов %d, потоков %d\n\n", mb, rounds, cores);
+
+    thread_pool_options_t plain = {.num_threads = cores};
+    thread_pool_t* pool = thread_pool_create_with_options(&plain);
+    if (!pool) return 1;
+    run("без закрепления:", pool, buffers, bytes, rounds);
+    thread_pool_destroy(pool);
+
+    thread_pool_options_t spread = {.num_threads = cores, .numa_spread = true};
+    pool = thread_pool_create_with_options(&spread);
+    if (!pool) return 1;
+    run("numa_spread:     ", pool, buffers, bytes, rounds);
+    thread_pool_destroy(pool);
+
+    printf("\nКонтрольная сумма: %llu\n", (unsigned long long)atomic_load(&checksum));
+
+    for (int n = 0; n < topo.num_nodes; n++) {
+        munmap(buffers[n], bytes);
+    }
+    free(buffers);
+    return 0;
+}
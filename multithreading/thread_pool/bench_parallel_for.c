@@ -0,0 +1,202 @@
+#include "thread_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Масштабирование thread_pool_parallel_reduce по числу потоков пула.
+//   primes — число простых до PRIME_LIMIT перебором делителей: стоимость
+//            итерации растет к концу диапазона; для сравнения — диапазон,
+//            заранее поделенный на равные куски по числу участников
+//   sum    — сумма SUM_ELEMENTS uint64 (упирается в пропускную способность
+//            памяти), в ГБ/с
+// Ускорение считается относительно последовательного цикла. Вызывающий
+// поток тоже участвует, поэтому при N потоках пула участников N + 1.
+// Запуск: ./bench_parallel_for [потоков...]   (по умолчанию 1 2 4 8)
+
+#define PRIME_LIMIT 2000000L
+#define SUM_ELEMENTS (32L * 1024 * 1024)   // 256 МиБ
+#define ROUNDS 3
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static long count_primes(long lo, long hi) {
+    long count = 0;
+    for (long i = lo < 2 ? 2 : lo; i < hi; i++) {
+        bool is_prime = true;
+        for (long j = 2; j * j <= i; j++) {
+            if (i % j == 0) {
+                is_prime = false;
+                break;
+            }
+        }
+        count += is_prime;
+    }
+    return count;
+}
+
+static void primes_body(void* ctx, long lo, long hi, void* partial) {
+    (void)ctx;
+    *(long*)partial += count_primes(lo, hi);
+}
+
+static void sum_body(void* ctx, long lo, long hi, void* partial) {
+    const uint64_t* data = (const uint64_t*)ctx;
+    uint64_t sum = 0;
+    for (long i = lo; i < hi; i++) {
+        sum += data[i];
+    }
+    *(uint64_t*)partial += sum;
+}
+
+static void combine_long(void* ctx, void* result, const void* partial) {
+    (void)ctx;
+    *(long*)result += *(const long*)partial;
+}
+
+static void combine_u64(void* ctx, void* result, const void* partial) {
+    (void)ctx;
+    *(uint64_t*)result += *(const uint64_t*)partial;
+}
+
+// --- равные куски заранее ---
+
+typedef struct {
+    long lo;
+    long hi;
+    long count;
+} static_chunk_t;
+
+static void static_primes_task(void* arg) {
+    static_chunk_t* chunk = (static_chunk_t*)arg;
+    chunk->count = count_primes(chunk->lo, chunk->hi);
+}
+
+// Участников столько же, сколько у parallel_reduce: пул плюс вызывающий
+static long static_primes(thread_pool_t* pool, int threads) {
+    int parts = threads + 1;
+    static_chunk_t chunks[parts];
+    void* args[parts];
+    for (int i = 0; i < parts; i++) {
+        chunks[i].lo = PRIME_LIMIT * i / parts;
+        chunks[i].hi = PRIME_LIMIT * (i + 1) / parts;
+        args[i] = &chunks[i];
+    }
+    thread_pool_add_tasks(pool, static_primes_task, args, parts - 1);
+    static_primes_task(&chunks[parts - 1]);
+    thread_pool_wait(pool);
+    long total = 0;
+    for (int i = 0; i < parts; i++) {
+        total += chunks[i].count;
+    }
+    return total;
+}
+
+static uint64_t lazy_primes(thread_pool_t* pool, int threads, const uint64_t* data) {
+    (void)threads;
+    (void)data;
+    long count = 0;
+    thread_pool_parallel_reduce(pool, 0, PRIME_LIMIT, 0, primes_body, combine_long,
+                                &count, sizeof(count), NULL);
+    return (uint64_t)count;
+}
+
+static uint64_t lazy_sum(thread_pool_t* pool, int threads, const uint64_t* data) {
+    (void)threads;
+    uint64_t sum = 0;
+    thread_pool_parallel_reduce(pool, 0, SUM_ELEMENTS, 0, sum_body, combine_u64,
+                                &sum, sizeof(sum), (void*)data);
+    return sum;
+}
+
+static uint64_t static_primes_run(thread_pool_t* pool, int threads, const uint64_t* data) {
+    (void)data;
+    return (uint64_t)static_primes(pool, threads);
+}
+
+static uint64_t seq_primes(thread_pool_t* pool, int threads, const uint64_t* data) {
+    (void)pool;
+    (void)threads;
+    (void)data;
+    return (uint64_t)count_primes(0, PRIME_LIMIT);
+}
+
+static uint64_t seq_sum(thread_pool_t* pool, int threads, const uint64_t* data) {
+    (void)pool;
+    (void)threads;
+    uint64_t sum = 0;
+    sum_body((void*)data, 0, SUM_ELEMENTS, &sum);
+    return sum;
+}
+
+// Лучшее время из ROUNDS запусков, мс; результат последнего — в *result
+static double best_ms(uint64_t (*run)(thread_pool_t*, int, const uint64_t*),
+                      thread_pool_t* pool, int threads, const uint64_t* data, uint64_t* result) {
+    uint64_t best = UINT64_MAX;
+    for (int r = 0; r < ROUNDS; r++) {
+        uint64_t start = now_ns();
+        *result = run(pool, threads, data);
+        uint64_t elapsed = now_ns() - start;
+        if (elapsed < best) best = elapsed;
+    }
+    return best / 1e6;
+}
+
+int main(int argc, char* argv[]) {
+    int default_threads[] = { 1, 2, 4, 8 };
+    int num_counts = argc > 1 ? argc - 1 : 4;
+
+    uint64_t* data = (uint64_t*)malloc(sizeof(uint64_t) * SUM_ELEMENTS);
+    if (!data) {
+        perror("malloc");
+        return 1;
+    }
+    for (long i = 0; i < SUM_ELEMENTS; i++) {
+        data[i] = (uint64_t)i;
+    }
+    const uint64_t expected_sum = (uint64_t)SUM_ELEMENTS * (SUM_ELEMENTS - 1) / 2;
+    const double sum_gb = SUM_ELEMENTS * sizeof(uint64_t) / 1e9;
+
+    uint64_t primes, sum;
+    double seq_primes_ms = best_ms(seq_primes, NULL, 0, data, &primes);
+    double seq_sum_ms = best_ms(seq_sum, NULL, 0, data, &sum);
+    if (sum != expected_sum) {
+        fprintf(stderr, "Неверная сумма\n");
+        return 1;
+    }
+    printf("primes до %ld: %llu, последовательно %.1f мс\n", PRIME_LIMIT, (unsigned long long)primes,
+           seq_primes_ms);
+    printf("sum %.0f МБ: последовательно %.1f мс, %.2f ГБ/с\n\n", sum_gb * 1e3, seq_sum_ms,
+           sum_gb / (seq_sum_ms / 1e3));
+
+    printf("%7s %14s %9s %14s %9s %11s %9s\n", "потоков", "primes мс", "ускор.",
+           "равные куски", "ускор.", "sum ГБ/с", "ускор.");
+    for (int c = 0; c < num_counts; c++) {
+        int threads = argc > 1 ? atoi(argv[c + 1]) : default_threads[c];
+        if (threads <= 0) continue;
+        thread_pool_options_t options = { .num_threads = threads, .quiet = true };
+        thread_pool_t* pool = thread_pool_create_with_options(&options);
+        if (!pool) {
+            return 1;
+        }
+
+        uint64_t lazy_count, static_count, parallel_sum;
+        double lazy_ms = best_ms(lazy_primes, pool, threads, data, &lazy_count);
+        double static_ms = best_ms(static_primes_run, pool, threads, data, &static_count);
+        double sum_ms = best_ms(lazy_sum, pool, threads, data, &parallel_sum);
+        if (lazy_count != primes || static_count != primes || parallel_sum != expected_sum) {
+            fprintf(stderr, "Неверный результат при %d потоках\n", threads);
+            return 1;
+        }
+        printf("%7d %14.1f %9.2f %14.1f %9.2f %11.2f %9.2f\n", threads,
+               lazy_ms, seq_primes_ms / lazy_ms, static_ms, seq_primes_ms / static_ms,
+               sum_gb / (sum_ms / 1e3), seq_sum_ms / sum_ms);
+        thread_pool_destroy(pool);
+    }
+
+    free(data);
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include "thread_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+// Время ожидания в очереди для срочных задач на фоне большого хвоста
+// обычных и фоновых задач. Ожидание срочных задач не должно зависеть от
+// размера хвоста; со старением фоновые задачи перестают ждать, пока
+// разберутся все обычные.
+
+#define NUM_THREADS 4
+#define BACKLOG_TASKS 40000
+#define URGENT_TASKS 200
+#define URGENT_INTERVAL_US 1000
+#define TASK_WORK_NS 20000
+
+// Занять процессор примерно на ns наносекунд
+static void spin_ns(long ns) {
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    do {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } while ((now.tv_sec - start.tv_sec) * 1000000000L + (now.tv_nsec - start.tv_nsec) < ns);
+}
+
+static void work_task(void* arg) {
+    (void)arg;
+    spin_ns(TASK_WORK_NS);
+}
+
+static void print_level(const char* name, const thread_pool_priority_stats_t* s) {
+    printf("  %-9s взято %6llu, состарено %5llu, ожидание: avg %8.1f мкс, "
+           "p50 %8.1f мкс, p99 %8.1f мкс, max %8.1f мкс\n",
+           name, (unsigned long long)s->dequeued, (unsigned long long)s->aged,
+           s->wait_avg_ns / 1e3, s->wait_p50_ns / 1e3, s->wait_p99_ns / 1e3,
+           s->wait_max_ns / 1e3);
+}
+
+static void run(int aging_ms) {
+    thread_pool_options_t options = {
+        .num_threads = NUM_THREADS,
+        .priority_aging_ms = aging_ms,
+    };
+    thread_pool_t* pool = thread_pool_create_with_options(&options);
+    if (!pool) return;
+
+    // Хвост обычной и фоновой работы вперемешку
+    for (int i = 0; i < BACKLOG_TASKS; i++) {
+        int priority = (i % 2) ? THREAD_POOL_PRIORITY_NORMAL : THREAD_POOL_PRIORITY_MIN;
+        thread_pool_add_task_with_priority(pool, work_task, NULL, priority);
+    }
+
+    // Срочные задачи приходят равномерно, пока хвост разбирается
+    for (int i = 0; i < URGENT_TASKS; i++) {
+        thread_pool_add_task_with_priority(pool, work_task, NULL, THREAD_POOL_PRIORITY_MAX);
+        usleep(URGENT_INTERVAL_US);
+    }
+
+    thread_pool_wait(pool);
+
+    thread_pool_stats_t stats = thread_pool_get_stats(pool);
+    printf("\nСтарение: %s\n", aging_ms > 0 ? "вкл" : "выкл");
+    print_level("срочные", &stats.priority[THREAD_POOL_PRIORITY_MAX]);
+    print_level("обычные", &stats.priority[THREAD_POOL_PRIORITY_NORMAL]);
+    print_level("фоновые", &stats.priority[THREAD_POOL_PRIORITY_MIN]);
+
+    thread_pool_destroy(pool);
+}
+
+int main(void) {
+    run(0);
+    run(5);
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include "thread_pool.h"
+#include "../../common/futex.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Отложенные задачи на колесе таймеров при большом числе ожидающих.
+//   insert  — постановка N таймеров со сроками от 1 минуты до 1 часа
+//   jitter  — на их фоне SHORT_TIMERS таймеров со сроками до 2 с:
+//             насколько позже срока задача начинает выполняться
+//   cancel  — отмена всех N
+//   burst   — N таймеров со сроками до 2 с срабатывают почти разом
+// Запуск: ./bench_timers [N]
+
+#define NUM_THREADS 4
+#define DEFAULT_TIMERS 1000000L
+#define SHORT_TIMERS 10000L
+#define SHORT_MAX_MS 2000
+#define LONG_MIN_MS 60000
+#define LONG_MAX_MS 3600000
+
+// Гистограмма на каждый поток пула: у гистограммы один писатель
+static latency_histogram_t histograms[NUM_THREADS + 1];
+static atomic_int histograms_used;
+static _Thread_local latency_histogram_t* thread_histogram;
+
+static _Atomic uint32_t fired;   // futex: сработавших задач
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t rng_state = 88172645463325252ULL;
+
+static uint64_t random_between(uint64_t low, uint64_t high) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return low + rng_state % (high - low + 1);
+}
+
+// Аргумент задачи — момент, раньше которого она не должна начаться
+static void on_timer(void* arg) {
+    uint64_t due = *(const uint64_t*)arg;
+    uint64_t now = now_ns();
+    if (!thread_histogram) {
+        thread_histogram = &histograms[atomic_fetch_add(&histograms_used, 1)];
+    }
+    latency_histogram_record(thread_histogram, now > due ? now - due : 0);
+    if (now < due) {
+        fprintf(stderr, "Задача выполнена на %llu нс раньше срока\n",
+                (unsigned long long)(due - now));
+    }
+    atomic_fetch_add(&fired, 1);
+    futex_wake(&fired, 1, false);
+}
+
+static void never(void* arg) {
+    (void)arg;
+    fprintf(stderr, "Отмененная задача сработала\n");
+}
+
+static void wait_fired(uint32_t expected) {
+    uint32_t current;
+    while ((current = atomic_load(&fired)) < expected) {
+        futex_wait(&fired, current, NULL, false);
+    }
+}
+
+// Сводка по всем гистограммам; затем они обнуляются
+static void print_jitter(const char* name, long count, double elapsed) {
+    latency_histogram_t total = { 0 };
+    for (int i = 0; i < atomic_load(&histograms_used); i++) {
+        latency_histogram_merge(&total, &histograms[i]);
+    }
+    printf("%-8s %8ld таймеров за %6.2f с: опоздание avg %7.1f мкс, p50 %7.1f мкс, "
+           "p99 %7.1f мкс, max %7.1f мкс\n", name, count, elapsed,
+           latency_histogram_mean(&total) / 1e3,
+           latency_histogram_percentile(&total, 0.50) / 1e3,
+           latency_histogram_percentile(&total, 0.99) / 1e3,
+           latency_counter_get(&total.max_ns) / 1e3);
+    for (int i = 0; i < NUM_THREADS + 1; i++) {
+        histograms[i] = (latency_histogram_t){ 0 };
+    }
+}
+
+// Постановка count таймеров со сроками из [low_ms, high_ms]
+static double schedule_timers(thread_pool_t* pool, long count, uint64_t low_ms, uint64_t high_ms,
+                              void (*function)(void*), uint64_t* due, thread_pool_timer_t* ids) {
+    uint64_t begin = now_ns();
+    for (long i = 0; i < count; i++) {
+        uint64_t delay = random_between(low_ms, high_ms);
+        due[i] = now_ns() + delay * 1000000ULL;
+        ids[i] = thread_pool_schedule_after(pool, delay, function, &due[i]);
+        if (ids[i] == 0) {
+            fprintf(stderr, "thread_pool_schedule_after: ошибка\n");
+            exit(1);
+        }
+    }
+    return (double)(now_ns() - begin) / count;
+}
+
+int main(int argc, char* argv[]) {
+    long count = argc > 1 ? atol(argv[1]) : DEFAULT_TIMERS;
+    if (count <= 0) count = DEFAULT_TIMERS;
+
+    thread_pool_options_t options = { .num_threads = NUM_THREADS, .quiet = true };
+    thread_pool_t* pool = thread_pool_create_with_options(&options);
+    uint64_t* due = (uint64_t*)malloc(sizeof(uint64_t) * count);
+    uint64_t* short_due = (uint64_t*)malloc(sizeof(uint64_t) * SHORT_TIMERS);
+    thread_pool_timer_t* ids = (thread_pool_timer_t*)malloc(sizeof(thread_pool_timer_t) * count);
+    thread_pool_timer_t* short_ids =
+        (thread_pool_timer_t*)malloc(sizeof(thread_pool_timer_t) * SHORT_TIMERS);
+    if (!pool || !due || !short_due || !ids || !short_ids) {
+        fprintf(stderr, "Не удалось подготовить замер\n");
+        return 1;
+    }
+    printf("Потоков пула: %d, тик %d мс\n\n", NUM_THREADS, THREAD_POOL_TIMER_TICK_MS);
+
+    // Первый вызов запускает поток таймеров: прогрев
+    thread_pool_timer_cancel(pool, thread_pool_schedule_after(pool, LONG_MAX_MS, never, NULL));
+
+    double insert_ns = schedule_timers(pool, count, LONG_MIN_MS, LONG_MAX_MS, never, due, ids);
+    printf("insert   %8ld таймеров: %6.1f нс на таймер\n", count, insert_ns);
+
+    uint64_t begin = now_ns();
+    schedule_timers(pool, SHORT_TIMERS, 1, SHORT_MAX_MS, on_timer, short_due, short_ids);
+    wait_fired(SHORT_TIMERS);
+    print_jitter("jitter", SHORT_TIMERS, (now_ns() - begin) / 1e9);
+
+    begin = now_ns();
+    for (long i = 0; i < count; i++) {
+        if (thread_pool_timer_cancel(pool, ids[i]) != 0) {
+            fprintf(stderr, "Таймер %ld не отменен\n", i);
+            return 1;
+        }
+    }
+    printf("cancel   %8ld таймеров: %6.1f нс на таймер\n", count,
+           (double)(now_ns() - begin) / count);
+
+    atomic_store(&fired, 0);
+    begin = now_ns();
+    double burst_insert_ns = schedule_timers(pool, count, 1, SHORT_MAX_MS, on_timer, due, ids);
+    wait_fired((uint32_t)count);
+    print_jitter("burst", count, (now_ns() - begin) / 1e9);
+    printf("         (постановка %.1f нс на таймер)\n", burst_insert_ns);
+
+    thread_pool_wait(pool);
+    thread_pool_destroy(pool);
+    free(due);
+    free(short_due);
+    free(ids);
+    free(short_ids);
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include "thread_pool.h"
+#include "trace_ring.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Стоимость трассировки пула.
+//   запись  — trace_ring_record в кольцо в одном потоке (без пула)
+//   пул     — поштучное добавление пустых задач с выключенной и
+//             включенной трассировкой; на задачу приходится четыре
+//             события (постановка, взятие, начало, конец)
+// Запуск: ./bench_trace [файл] — сохранить трассу последнего замера
+// для ./trace_dump файл > trace.json
+
+#define NUM_THREADS 4
+#define TASKS 500000
+#define REPEATS 3
+#define RECORDS 20000000L
+#define RING_EVENTS 1024
+#define EVENTS_PER_TASK 4
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void empty_task(void* arg) {
+    (void)arg;
+}
+
+// Запись события в кольцо: время, четыре поля и публикация head
+static double measure_record(bool tsc) {
+    trace_ring_t* ring = (trace_ring_t*)aligned_alloc(64, sizeof(trace_ring_t) +
+                                                      RING_EVENTS * sizeof(trace_event_t));
+    atomic_init(&ring->head, 0);
+    ring->mask = RING_EVENTS - 1;
+    ring->tsc = tsc;
+    uint64_t start = now_ns();
+    for (long i = 0; i < RECORDS; i++) {
+        trace_ring_record(ring, TRACE_START, ring, empty_task, 0);
+    }
+    double ns = (double)(now_ns() - start) / RECORDS;
+    free(ring);
+    return ns;
+}
+
+// Лучшее из REPEATS время на задачу, нс
+static double measure_tasks(thread_pool_t* pool) {
+    double best = 0;
+    for (int r = 0; r < REPEATS; r++) {
+        uint64_t start = now_ns();
+        for (int i = 0; i < TASKS; i++) {
+            thread_pool_add_task(pool, empty_task, NULL);
+        }
+        thread_pool_wait(pool);
+        double ns = (double)(now_ns() - start) / TASKS;
+        if (r == 0 || ns < best) best = ns;
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    const char* path = argc > 1 ? argv[1] : NULL;
+
+    printf("Запись события: TSC %.1f нс, CLOCK_MONOTONIC_RAW %.1f нс\n\n",
+           measure_record(true), measure_record(false));
+
+    printf("%-14s %14s %14s %16s\n", "", "выкл., нс/зад.", "вкл., нс/зад.", "нс на событие");
+    thread_pool_t* pool = NULL;
+    for (int mode = 0; mode < 2; mode++) {
+        thread_pool_options_t options = {
+            .num_threads = NUM_THREADS,
+            .work_stealing = mode == 1,
+            .quiet = true,
+        };
+        pool = thread_pool_create_with_options(&options);
+        if (!pool) {
+            fprintf(stderr, "Не удалось создать пул\n");
+            return 1;
+        }
+        double off = measure_tasks(pool);
+        if (thread_pool_trace_start(pool, 0) != 0) {
+            perror("thread_pool_trace_start");
+            return 1;
+        }
+        double on = measure_tasks(pool);
+        thread_pool_trace_stop(pool);
+        printf("%-14s %14.1f %14.1f %16.1f\n", mode == 0 ? "общая очередь" : "work-stealing",
+               off, on, (on - off) / EVENTS_PER_TASK);
+
+        if (mode == 1 && path != NULL) {
+            if (thread_pool_trace_save(pool, path) != 0) {
+                perror("thread_pool_trace_save");
+                return 1;
+            }
+            printf("\nТрасса сохранена в %s\n", path);
+        }
+        thread_pool_destroy(pool);
+    }
+    return 0;
+}
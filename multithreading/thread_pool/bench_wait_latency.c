@@ -0,0 +1,86 @@
+#include "thread_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Задержка пробуждения ожидающего: время от завершения последней задачи
+// пакета до возврата из thread_pool_wait / thread_pool_group_wait.
+// При опросе с usleep(10000) она в среднем составляла около 5 мс.
+
+#define NUM_THREADS 4
+#define BATCH 16
+#define ROUNDS 2000
+
+static atomic_ullong last_finish_ns;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void short_task(void* arg) {
+    (void)arg;
+    uint64_t now = now_ns();
+    uint64_t prev = atomic_load_explicit(&last_finish_ns, memory_order_relaxed);
+    while (prev < now &&
+           !atomic_compare_exchange_weak_explicit(&last_finish_ns, &prev, now,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+}
+
+static void print_result(const char* name, latency_histogram_t* h) {
+    printf("%-18s avg %8.1f мкс, p50 %8.1f мкс, p99 %8.1f мкс, max %8.1f мкс\n", name,
+           latency_histogram_mean(h) / 1e3,
+           latency_histogram_percentile(h, 0.50) / 1e3,
+           latency_histogram_percentile(h, 0.99) / 1e3,
+           latency_counter_get(&h->max_ns) / 1e3);
+}
+
+static int run(bool work_stealing) {
+    thread_pool_options_t options = {
+        .num_threads = NUM_THREADS,
+        .work_stealing = work_stealing,
+    };
+    thread_pool_t* pool = thread_pool_create_with_options(&options);
+    if (!pool) return 1;
+
+    latency_histogram_t* pool_wait = calloc(1, sizeof(latency_histogram_t));
+    latency_histogram_t* group_wait = calloc(1, sizeof(latency_histogram_t));
+    thread_pool_group_t* group = thread_pool_group_create(pool);
+
+    for (int r = 0; r < ROUNDS; r++) {
+        atomic_store(&last_finish_ns, 0);
+        for (int i = 0; i < BATCH; i++) {
+            thread_pool_add_task(pool, short_task, NULL);
+        }
+        thread_pool_wait(pool);
+        uint64_t done = now_ns();
+        latency_histogram_record(pool_wait, done - atomic_load(&last_finish_ns));
+
+        atomic_store(&last_finish_ns, 0);
+        for (int i = 0; i < BATCH; i++) {
+            thread_pool_group_add_task(group, short_task, NULL);
+        }
+        thread_pool_group_wait(group);
+        done = now_ns();
+        latency_histogram_record(group_wait, done - atomic_load(&last_finish_ns));
+    }
+
+    printf("%s, пакеты по %d задач, %d раундов\n",
+           work_stealing ? "work-stealing" : "mutex", BATCH, ROUNDS);
+    print_result("thread_pool_wait", pool_wait);
+    print_result("group_wait", group_wait);
+
+    thread_pool_group_destroy(group);
+    thread_pool_destroy(pool);
+    free(pool_wait);
+    free(group_wait);
+    return 0;
+}
+
+int main(void) {
+    if (run(false) != 0) return 1;
+    return run(true);
+}
@@ -0,0 +1,96 @@
+#include "thread_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Сравнение пропускной способности пула с общей очередью под мьютексом
+// и пула в режиме work-stealing на мелких задачах.
+//
+// Сценарии:
+//   external — все задачи добавляет главный поток (только глобальная очередь)
+//   fanout   — главный поток добавляет корневые задачи, каждая из которых
+//              порождает дочерние задачи изнутри пула
+
+#define TOTAL_TASKS 400000
+#define FANOUT 100
+#define WORK_ITERATIONS 200  // ~ доли микросекунды полезной работы
+
+static thread_pool_t* bench_pool;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Мелкая задача: немного арифметики без обращения к общей памяти
+static void tiny_task(void* arg) {
+    (void)arg;
+    volatile unsigned int x = 0;
+    for (int i = 0; i < WORK_ITERATIONS; i++) {
+        x += i;
+    }
+}
+
+// Корневая задача порождает FANOUT дочерних
+static void root_task(void* arg) {
+    (void)arg;
+    for (int i = 0; i < FANOUT; i++) {
+        thread_pool_add_task(bench_pool, tiny_task, NULL);
+    }
+}
+
+static double run_external(thread_pool_t* pool) {
+    double start = now_sec();
+    for (int i = 0; i < TOTAL_TASKS; i++) {
+        thread_pool_add_task(pool, tiny_task, NULL);
+    }
+    thread_pool_wait(pool);
+    return TOTAL_TASKS / (now_sec() - start);
+}
+
+static double run_fanout(thread_pool_t* pool) {
+    int roots = TOTAL_TASKS / FANOUT;
+    double start = now_sec();
+    for (int i = 0; i < roots; i++) {
+        thread_pool_add_task(pool, root_task, NULL);
+    }
+    thread_pool_wait(pool);
+    return roots * (FANOUT + 1) / (now_sec() - start);
+}
+
+int main(void) {
+    const int thread_counts[] = {1, 4, 16, 64};
+    const int num_counts = sizeof(thread_counts) / sizeof(thread_counts[0]);
+    double results[4][2][2]; // [потоки][режим][сценарий]
+
+    for (int t = 0; t < num_counts; t++) {
+        for (int mode = 0; mode < 2; mode++) {
+            thread_pool_options_t options = {
+                .num_threads = thread_counts[t],
+                .work_stealing = mode == 1,
+            };
+            bench_pool = thread_pool_create_with_options(&options);
+            if (!bench_pool) {
+                return 1;
+            }
+
+            results[t][mode][0] = run_external(bench_pool);
+            results[t][mode][1] = run_fanout(bench_pool);
+
+            thread_pool_destroy(bench_pool);
+        }
+    }
+
+    printf("\n%-8s %-10s %16s %16s\n", "потоки", "сценарий", "mutex, задач/с", "ws, задач/с");
+    for (int t = 0; t < num_counts; t++) {
+        const char* names[] = {"external", "fanout"};
+        for (int s = 0; s < 2; s++) {
+            printf("%-8d %-10s %16.0f %16.0f  (x%.2f)\n", thread_counts[t], names[s],
+                   results[t][0][s], results[t][1][s],
+                   results[t][1][s] / results[t][0][s]);
+        }
+    }
+
+    return 0;
+}
@@ -1,14 +1,18 @@
 #include "thread_pool.h"
+#include "../compute_kernels/compute_kernels.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <time.h>
 
-// Структура для передачи данных в задачу
+// Структура для передачи данных в задачу.
+// Копируется в узел задачи целиком, поэтому должна укладываться
+// в THREAD_POOL_INLINE_ARG_SIZE байт.
 typedef struct {
     int task_id;
     int duration_ms;
-    char* message;
+    char message[56];
 } task_data_t;
 
 // Пример задачи для пула потоков
@@ -21,53 +25,63 @@ void example_task(void* arg) {
     usleep(data->duration_ms * 1000);
     
     printf("Задача %d завершена за %d мс\n", data->task_id, data->duration_ms);
-    
-    // Освобождение памяти
-    free(data->message);
-    free(data);
 }
 
-// Задача вычисления чисел Фибоначчи
+// Задача вычисления чисел Фибоначчи (длинная арифметика, без переполнения)
 void fibonacci_task(void* arg) {
     int n = *(int*)arg;
-    long long a = 0, b = 1, c;
     
     if (n <= 0) return;
     
     printf("Вычисление Fibonacci(%d)...\n", n);
     
-    for (int i = 2; i <= n; i++) {
-        c = a + b;
-        a = b;
-        b = c;
+    bignum_t result;
+    if (fibonacci_compute(NULL, (uint64_t)n, &result) != 0) {
+        printf("Fibonacci(%d): не хватило памяти\n", n);
+        return;
     }
-    
-    printf("Fibonacci(%d) = %lld\n", n, b);
-    
-    free(arg);
+    char* text = bignum_to_decimal(&result);
+    if (!text) {
+        printf("Fibonacci(%d): не хватило памяти для вывода\n", n);
+        bignum_free(&result);
+        return;
+    }
+    size_t digits = strlen(text);
+    if (digits > 40) {
+        printf("Fibonacci(%d) = %.20s...%s (%zu цифр)\n", n, text, text + digits - 20, digits);
+    } else {
+        printf("Fibonacci(%d) = %s\n", n, text);
+    }
+    free(text);
+    bignum_free(&result);
 }
 
-// Задача поиска простых чисел
+// Задача поиска простых чисел (решето по сегментам в кэше)
 void prime_search_task(void* arg) {
     int limit = *(int*)arg;
-    int count = 0;
     
     printf("Поиск простых чисел до %d...\n", limit);
     
-    for (int i = 2; i <= limit; i++) {
-        int is_prime = 1;
-        for (int j = 2; j * j <= i; j++) {
-            if (i % j == 0) {
-                is_prime = 0;
-                break;
-            }
-        }
-        if (is_prime) count++;
+    prime_sieve_t sieve;
+    if (prime_sieve_init(&sieve, (uint64_t)limit, 0) != 0) {
+        printf("Поиск простых чисел до %d: не хватило памяти\n", limit);
+        return;
     }
+    uint64_t count = prime_sieve_count_range(&sieve, 0, (uint64_t)limit + 1);
+    prime_sieve_destroy(&sieve);
     
-    printf("Найдено %d простых чисел до %d\n", count, limit);
-    
-    free(arg);
+    printf("Найдено %llu простых чисел до %d\n", (unsigned long long)count, limit);
+}
+
+// Периодическая задача: считает свои запуски
+void heartbeat_task(void* arg) {
+    atomic_int* beats = (atomic_int*)arg;
+    printf("Периодическая задача: запуск %d\n", atomic_fetch_add(beats, 1) + 1);
+}
+
+// Отложенная задача
+void delayed_task(void* arg) {
+    printf("Отложенная задача: %s\n", (const char*)arg);
 }
 
 // Обработчик ошибок для пула потоков
@@ -95,38 +109,28 @@ int main() {
     // Добавление 10 задач
     printf("\nДобавляем 10 задач в пул...\n");
     for (int i = 0; i < 10; i++) {
-        task_data_t* data = malloc(sizeof(task_data_t));
-        data->task_id = i + 1;
-        data->duration_ms = 100 + (rand() % 400); // 100-500 мс
-        data->message = malloc(50);
-        snprintf(data->message, 50, "Сообщение от задачи %d", i + 1);
+        task_data_t data;
+        data.task_id = i + 1;
+        data.duration_ms = 100 + (rand() % 400); // 100-500 мс
+        snprintf(data.message, sizeof(data.message), "Сообщение от задачи %d", i + 1);
         
-        if (thread_pool_add_task(pool, example_task, data) != 0) {
+        // Данные копируются в узел задачи — без malloc на каждую задачу
+        if (thread_pool_add_task_copy(pool, example_task, &data, sizeof(data)) != 0) {
             printf("Не удалось добавить задачу %d\n", i + 1);
-            free(data->message);
-            free(data);
         }
     }
     
     // Добавление задач вычислений
     printf("\nДобавляем вычислительные задачи...\n");
     for (int i = 0; i < 5; i++) {
-        int* n = malloc(sizeof(int));
-        *n = 30 + rand() % 20; // 30-49
-        
-        if (thread_pool_add_task(pool, fibonacci_task, n) != 0) {
-            free(n);
-        }
+        int n = 50 + rand() % 950; // 50-999
+        thread_pool_add_task_copy(pool, fibonacci_task, &n, sizeof(n));
     }
     
     // Добавление задач поиска простых чисел
     for (int i = 0; i < 3; i++) {
-        int* limit = malloc(sizeof(int));
-        *limit = 10000 + rand() % 50000; // 10000-59999
-        
-        if (thread_pool_add_task(pool, prime_search_task, limit) != 0) {
-            free(limit);
-        }
+        int limit = 10000000 + rand() % 50000000; // 10-60 млн
+        thread_pool_add_task_copy(pool, prime_search_task, &limit, sizeof(limit));
     }
     
     // Ожидание завершения всех задач
@@ -138,7 +142,55 @@ int main() {
     printf("\nСтатистика пула потоков:\n");
     printf("  Активные потоки: %d\n", stats.active_threads);
     printf("  Задач в очереди: %d\n", stats.queued_tasks);
-    
+    printf("  Узлов задач занято: %d из %d (из кучи: %ld)\n",
+           stats.task_slab_in_use, stats.task_slab_capacity, stats.task_heap_allocs);
+    printf("  Задач выполнено: %llu\n", (unsigned long long)stats.total_tasks_completed);
+    
+    // Подробно: счетчики потоков и перцентили задержек
+    thread_pool_dump_stats(pool, stdout);
+    
+    // Группы задач: ожидание только своей части работы
+    printf("\nГруппы задач...\n");
+    static int fib_args[3] = {1000, 10000, 100000};
+    static int prime_args[2] = {200000000, 300000000};
+    thread_pool_group_t* fib_group = thread_pool_group_create(pool);
+    thread_pool_group_t* prime_group = thread_pool_group_create(pool);
+    if (fib_group && prime_group) {
+        for (int i = 0; i < 3; i++) {
+            thread_pool_group_add_task(fib_group, fibonacci_task, &fib_args[i]);
+        }
+        for (int i = 0; i < 2; i++) {
+            thread_pool_group_add_task(prime_group, prime_search_task, &prime_args[i]);
+        }
+
+        thread_pool_group_t* groups[2] = {fib_group, prime_group};
+        int first = thread_pool_group_wait_any(groups, 2, -1);
+        printf("Первой завершилась группа: %s\n", first == 0 ? "Фибоначчи" : "простые числа");
+
+        if (thread_pool_group_timedwait(prime_group, 10) != 0) {
+            printf("Простые числа еще считаются, осталось задач: %d\n",
+                   thread_pool_group_pending(prime_group));
+        }
+        thread_pool_group_wait(fib_group);
+        thread_pool_group_wait(prime_group);
+        printf("Обе группы завершены\n");
+    }
+    thread_pool_group_destroy(fib_group);
+    thread_pool_group_destroy(prime_group);
+    
+    // Отложенные и периодические задачи вместо отдельных спящих потоков
+    printf("\nОтложенные задачи...\n");
+    static atomic_int beats = 0;
+    thread_pool_timer_t heartbeat = thread_pool_schedule_every(pool, 100, heartbeat_task, &beats);
+    thread_pool_schedule_after(pool, 250, delayed_task, "через 250 мс");
+    thread_pool_timer_t cancelled = thread_pool_schedule_after(pool, 200, delayed_task,
+                                                               "не должна выполниться");
+    thread_pool_timer_cancel(pool, cancelled);
+    usleep(450 * 1000);
+    thread_pool_timer_cancel(pool, heartbeat);
+    thread_pool_wait(pool);
+    printf("Периодическая задача отменена после %d запусков\n", atomic_load(&beats));
+
     // Уничтожение пула
     printf("\nЗавершаем работу пула потоков...\n");
     thread_pool_destroy(pool);
@@ -155,19 +207,23 @@ int main() {
     // Добавление большого количества задач
     printf("Добавляем 20 быстрых задач...\n");
     for (int i = 0; i < 20; i++) {
-        task_data_t* data = malloc(sizeof(task_data_t));
-        data->task_id = 100 + i;
-        data->duration_ms = 50 + (rand() % 100); // 50-150 мс
-        data->message = malloc(50);
-        snprintf(data->message, 50, "Быстрая задача %d", 100 + i);
+        task_data_t data;
+        data.task_id = 100 + i;
+        data.duration_ms = 50 + (rand() % 100); // 50-150 мс
+        snprintf(data.message, sizeof(data.message), "Быстрая задача %d", 100 + i);
         
-        thread_pool_add_task(advanced_pool, example_task, data);
+        thread_pool_add_task_copy(advanced_pool, example_task, &data, sizeof(data));
     }
     
     // Ожидание
     printf("Ожидаем завершения...\n");
     thread_pool_wait(advanced_pool);
     
+    // Задачи ждали в очереди, поэтому пул добавлял потоки
+    thread_pool_stats_t advanced_stats = thread_pool_get_stats(advanced_pool);
+    printf("Потоков сейчас: %d, запущено за все время: %d\n",
+           advanced_stats.live_threads, advanced_stats.threads_started);
+    
     // Уничтожение расширенного пула
     thread_pool_destroy(advanced_pool);
     
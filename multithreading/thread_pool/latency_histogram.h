@@ -0,0 +1,108 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+// Гистограмма задержек в наносекундах с логарифмическими корзинами.
+// Каждая степень двойки делится на 4 подкорзины, поэтому погрешность
+// перцентиля не превышает 25%, а запись — это несколько битовых операций.
+//
+// Писатель у гистограммы один (поток-владелец или держатель блокировки),
+// поэтому запись — обычные load/store без lock-префикса. Поля атомарные,
+// чтобы читать гистограмму из других потоков без блокировки; снимок при
+// этом может быть слегка несогласованным (count впереди корзин).
+
+#define LATENCY_SUB_BITS 2
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define LATENCY_BUCKETS (64 * LATENCY_SUB_BUCKETS)
+
+typedef struct {
+    _Atomic uint64_t buckets[LATENCY_BUCKETS];
+    _Atomic uint64_t count;
+    _Atomic uint64_t sum_ns;
+    _Atomic uint64_t max_ns;
+} latency_histogram_t;
+
+// Увеличение счетчика единственным писателем
+static inline void latency_counter_add(_Atomic uint64_t* counter, uint64_t value) {
+    atomic_store_explicit(counter,
+                          atomic_load_explicit(counter, memory_order_relaxed) + value,
+                          memory_order_relaxed);
+}
+
+static inline uint64_t latency_counter_get(const _Atomic uint64_t* counter) {
+    return atomic_load_explicit(counter, memory_order_relaxed);
+}
+
+// Номер корзины для значения
+static inline int latency_bucket(uint64_t ns) {
+    if (ns < LATENCY_SUB_BUCKETS) {
+        return (int)ns;
+    }
+    int log2 = 63 - __builtin_clzll(ns);
+    int sub = (int)((ns >> (log2 - LATENCY_SUB_BITS)) & (LATENCY_SUB_BUCKETS - 1));
+    return (log2 - LATENCY_SUB_BITS + 1) * LATENCY_SUB_BUCKETS + sub;
+}
+
+// Верхняя граница значений корзины
+static inline uint64_t latency_bucket_upper(int bucket) {
+    if (bucket < LATENCY_SUB_BUCKETS) {
+        return (uint64_t)bucket;
+    }
+    int log2 = bucket / LATENCY_SUB_BUCKETS + LATENCY_SUB_BITS - 1;
+    uint64_t sub = (uint64_t)(bucket % LATENCY_SUB_BUCKETS);
+    uint64_t base = 1ULL << log2;
+    uint64_t step = base >> LATENCY_SUB_BITS;
+    return base + (sub + 1) * step - 1;
+}
+
+static inline void latency_histogram_record(latency_histogram_t* h, uint64_t ns) {
+    latency_counter_add(&h->buckets[latency_bucket(ns)], 1);
+    latency_counter_add(&h->count, 1);
+    latency_counter_add(&h->sum_ns, ns);
+    if (ns > latency_counter_get(&h->max_ns)) {
+        atomic_store_explicit(&h->max_ns, ns, memory_order_relaxed);
+    }
+}
+
+// Добавление содержимого src в dst (писатель dst — вызывающий поток)
+static inline void latency_histogram_merge(latency_histogram_t* dst, const latency_histogram_t* src) {
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        latency_counter_add(&dst->buckets[i], latency_counter_get(&src->buckets[i]));
+    }
+    latency_counter_add(&dst->count, latency_counter_get(&src->count));
+    latency_counter_add(&dst->sum_ns, latency_counter_get(&src->sum_ns));
+    uint64_t max_ns = latency_counter_get(&src->max_ns);
+    if (max_ns > latency_counter_get(&dst->max_ns)) {
+        atomic_store_explicit(&dst->max_ns, max_ns, memory_order_relaxed);
+    }
+}
+
+// Среднее значение
+static inline uint64_t latency_histogram_mean(const latency_histogram_t* h) {
+    uint64_t count = latency_counter_get(&h->count);
+    return count ? latency_counter_get(&h->sum_ns) / count : 0;
+}
+
+// Перцентиль (0 < p <= 1), округленный вверх до границы корзины
+static inline uint64_t latency_histogram_percentile(const latency_histogram_t* h, double p) {
+    uint64_t count = latency_counter_get(&h->count);
+    uint64_t max_ns = latency_counter_get(&h->max_ns);
+    if (count == 0) return 0;
+
+    uint64_t target = (uint64_t)(p * (double)count);
+    if (target == 0) target = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += latency_counter_get(&h->buckets[i]);
+        if (seen >= target) {
+            uint64_t upper = latency_bucket_upper(i);
+            return upper < max_ns ? upper : max_ns;
+        }
+    }
+    return max_ns;
+}
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,182 @@
+#define _GNU_SOURCE
+#include "numa_topology.h"
+#include <dirent.h>
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define SYSFS_NODE_DIR "/sys/devices/system/node"
+#define SYSFS_CPU_DIR "/sys/devices/system/cpu"
+
+// Первая строка файла без перевода строки
+static int read_line(const char* path, char* buf, size_t size) {
+    FILE* f = fopen(path, "r");
+    if (!f) return -1;
+
+    char* line = fgets(buf, (int)size, f);
+    fclose(f);
+    if (!line) return -1;
+
+    buf[strcspn(buf, "\n")] = '\0';
+    return 0;
+}
+
+int numa_parse_cpulist(const char* list, bool* cpus, int max) {
+    const char* p = list;
+    int top = 0;
+
+    while (*p) {
+        if (*p == ',' || *p == ' ') {
+            p++;
+            continue;
+        }
+
+        char* end;
+        long first = strtol(p, &end, 10);
+        if (end == p) return -1;
+        long last = first;
+        p = end;
+
+        if (*p == '-') {
+            p++;
+            last = strtol(p, &end, 10);
+            if (end == p) return -1;
+            p = end;
+        }
+        if (first < 0 || last < first) return -1;
+
+        for (long cpu = first; cpu <= last && cpu < max; cpu++) {
+            cpus[cpu] = true;
+            if (cpu + 1 > top) top = (int)cpu + 1;
+        }
+    }
+
+    return top;
+}
+
+static int compare_int(const void* a, const void* b) {
+    return *(const int*)a - *(const int*)b;
+}
+
+// Номера узлов из sysfs по возрастанию; возвращает их количество
+static int list_sysfs_nodes(int* ids, int max) {
+    DIR* dir = opendir(SYSFS_NODE_DIR);
+    if (!dir) return 0;
+
+    int count = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL && count < max) {
+        int id;
+        char tail;
+        if (sscanf(entry->d_name, "node%d%c", &id, &tail) == 1) {
+            ids[count++] = id;
+        }
+    }
+    closedir(dir);
+
+    qsort(ids, (size_t)count, sizeof(int), compare_int);
+    return count;
+}
+
+int numa_topology_load(numa_topology_t* topo) {
+    memset(topo, 0, sizeof(*topo));
+    for (int cpu = 0; cpu < NUMA_MAX_CPUS; cpu++) {
+        topo->cpu_node[cpu] = -1;
+    }
+
+    // Учитываем только CPU, на которых процессу разрешено работать
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return -1;
+    }
+
+    int ids[NUMA_MAX_NODES];
+    int sysfs_nodes = list_sysfs_nodes(ids, NUMA_MAX_NODES);
+    char path[256];
+    char line[4096];
+
+    for (int i = 0; i < sysfs_nodes; i++) {
+        bool cpus[NUMA_MAX_CPUS] = {false};
+        snprintf(path, sizeof(path), SYSFS_NODE_DIR "/node%d/cpulist", ids[i]);
+        if (read_line(path, line, sizeof(line)) != 0 ||
+            numa_parse_cpulist(line, cpus, NUMA_MAX_CPUS) <= 0) {
+            continue;  // Узел только с памятью
+        }
+
+        int index = topo->num_nodes;
+        int found = 0;
+        for (int cpu = 0; cpu < NUMA_MAX_CPUS && cpu < CPU_SETSIZE; cpu++) {
+            if (cpus[cpu] && CPU_ISSET(cpu, &allowed)) {
+                topo->cpu_node[cpu] = (short)index;
+                if (cpu + 1 > topo->num_cpus) topo->num_cpus = cpu + 1;
+                found++;
+            }
+        }
+        if (found > 0) {
+            topo->node_id[index] = ids[i];
+            topo->num_nodes++;
+        }
+    }
+
+    // Без sysfs все разрешенные CPU — один узел
+    if (topo->num_nodes == 0) {
+        for (int cpu = 0; cpu < NUMA_MAX_CPUS && cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                topo->cpu_node[cpu] = 0;
+                if (cpu + 1 > topo->num_cpus) topo->num_cpus = cpu + 1;
+            }
+        }
+        topo->node_id[0] = 0;
+        topo->num_nodes = 1;
+    }
+
+    // Основной поток ядра — первый разрешенный из его соседей по SMT
+    for (int cpu = 0; cpu < topo->num_cpus; cpu++) {
+        if (topo->cpu_node[cpu] < 0) continue;
+
+        bool siblings[NUMA_MAX_CPUS] = {false};
+        snprintf(path, sizeof(path), SYSFS_CPU_DIR "/cpu%d/topology/thread_siblings_list", cpu);
+        if (read_line(path, line, sizeof(line)) != 0 ||
+            numa_parse_cpulist(line, siblings, NUMA_MAX_CPUS) <= 0) {
+            topo->cpu_primary[cpu] = true;
+            continue;
+        }
+
+        int first = cpu;
+        for (int other = 0; other < cpu; other++) {
+            if (siblings[other] && topo->cpu_node[other] >= 0) {
+                first = other;
+                break;
+            }
+        }
+        topo->cpu_primary[cpu] = first == cpu;
+    }
+
+    return 0;
+}
+
+int numa_node_cpus(const numa_topology_t* topo, int node, int* cpus, int max) {
+    int count = 0;
+    for (int cpu = 0; cpu < topo->num_cpus && count < max; cpu++) {
+        if (topo->cpu_node[cpu] == node && topo->cpu_primary[cpu]) {
+            cpus[count++] = cpu;
+        }
+    }
+    return count;
+}
+
+int numa_bind_memory(void* addr, size_t len, int node_id) {
+    if (node_id < 0 || node_id >= NUMA_MAX_NODES) return -1;
+
+    unsigned long mask[NUMA_MAX_NODES / (8 * sizeof(unsigned long)) + 1] = {0};
+    mask[node_id / (8 * sizeof(unsigned long))] |= 1UL << (node_id % (8 * sizeof(unsigned long)));
+
+    long rc = syscall(SYS_mbind, addr, len, MPOL_PREFERRED, mask,
+                      (unsigned long)(sizeof(mask) * 8), 0UL);
+    return rc == 0 ? 0 : -1;
+}
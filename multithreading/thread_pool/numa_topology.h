@@ -0,0 +1,38 @@
+#ifndef NUMA_TOPOLOGY_H
+#define NUMA_TOPOLOGY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Топология процессоров и NUMA-узлов из /sys/devices/system/node и
+// /sys/devices/system/cpu. Без libnuma: привязка памяти — прямой
+// системный вызов mbind.
+
+#define NUMA_MAX_CPUS 1024
+#define NUMA_MAX_NODES 64
+
+typedef struct {
+    int num_cpus;                    // Наибольший номер CPU + 1
+    int num_nodes;                   // Узлов, на которых есть процессоры
+    int node_id[NUMA_MAX_NODES];     // Номер узла в sysfs по индексу
+    short cpu_node[NUMA_MAX_CPUS];   // Индекс узла для CPU, -1 — CPU нет
+    bool cpu_primary[NUMA_MAX_CPUS]; // Первый аппаратный поток своего ядра
+} numa_topology_t;
+
+// Чтение топологии. Если sysfs недоступен, все CPU из sched_getaffinity
+// считаются одним узлом. Возвращает 0 или -1.
+int numa_topology_load(numa_topology_t* topo);
+
+// Разбор списка вида "0-3,8,10-11" в массив флагов размера max.
+// Возвращает наибольший номер + 1 или -1 при ошибке формата.
+int numa_parse_cpulist(const char* list, bool* cpus, int max);
+
+// Основные (по одному на ядро) CPU узла с индексом node, не больше max.
+// Возвращает их количество.
+int numa_node_cpus(const numa_topology_t* topo, int node, int* cpus, int max);
+
+// Предпочесть для страниц [addr, addr + len) узел node_id (MPOL_PREFERRED).
+// Вызывать до первого обращения к памяти. Возвращает 0 или -1.
+int numa_bind_memory(void* addr, size_t len, int node_id);
+
+#endif // NUMA_TOPOLOGY_H
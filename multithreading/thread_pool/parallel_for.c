@@ -0,0 +1,241 @@
+#include "thread_pool.h"
+#include "../../common/futex.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Параллельный цикл с ленивым делением диапазона.
+//
+// Диапазон режется на отрезки по grain итераций. У каждого участника
+// (вызывающий поток и задачи-помощники в пуле) свой слот с еще не
+// взятыми отрезками [first, last), упакованными в одно 64-битное слово.
+// Владелец берет отрезки по одному с начала слота, а участник без работы
+// одним CAS забирает себе вторую половину чужого слота. Вначале весь
+// диапазон лежит в слоте вызывающего, так что деление происходит только
+// тогда, когда есть свободный поток, а не заранее на фиксированные куски.
+
+// Сколько отрезков на участника при автоматическом grain
+#define AUTO_CHUNKS_PER_PARTICIPANT 8
+// Сколько помощников ставится в пул за один thread_pool_add_tasks
+#define HELPER_BATCH 64
+
+typedef struct {
+    _Alignas(64) _Atomic uint64_t range; // (first << 32) | last, в отрезках
+    atomic_bool used;                    // Участник выполнил хотя бы один отрезок
+} parallel_slot_t;
+
+typedef struct {
+    long begin;
+    long end;
+    unsigned long grain;      // Итераций в отрезке (без знака, как и длина диапазона)
+    void (*body)(void* ctx, long lo, long hi);
+    void (*reduce_body)(void* ctx, long lo, long hi, void* partial);
+    void* ctx;
+    unsigned char* partials;  // Частичные суммы участников (NULL — без свертки)
+    size_t partial_stride;
+    int max_slots;
+    atomic_int num_slots;     // Зарегистрировано участников
+    _Atomic uint32_t chunks_left; // Невыполненных отрезков
+    _Atomic uint32_t done;    // futex: все отрезки выполнены
+    atomic_int refs;          // Вызывающий и еще не завершившиеся помощники
+    parallel_slot_t slots[];
+} parallel_job_t;
+
+static inline uint64_t range_pack(uint32_t first, uint32_t last) {
+    return ((uint64_t)first << 32) | last;
+}
+
+static void parallel_job_release(parallel_job_t* job) {
+    if (atomic_fetch_sub_explicit(&job->refs, 1, memory_order_acq_rel) == 1) {
+        free(job);
+    }
+}
+
+// Выполнение отрезков из своего слота, пока их не заберут или не кончатся
+static void parallel_run_own(parallel_job_t* job, int self) {
+    parallel_slot_t* slot = &job->slots[self];
+    void* partial = job->partials ? job->partials + (size_t)self * job->partial_stride : NULL;
+    uint32_t completed = 0;
+
+    uint64_t range = atomic_load_explicit(&slot->range, memory_order_acquire);
+    for (;;) {
+        uint32_t first = (uint32_t)(range >> 32);
+        uint32_t last = (uint32_t)range;
+        if (first >= last) {
+            break;
+        }
+        if (!atomic_compare_exchange_weak_explicit(&slot->range, &range,
+                                                   range_pack(first + 1, last),
+                                                   memory_order_acq_rel,
+                                                   memory_order_acquire)) {
+            continue;
+        }
+        unsigned long offset = (unsigned long)first * job->grain;
+        unsigned long left = (unsigned long)job->end - (unsigned long)job->begin - offset;
+        long lo = (long)((unsigned long)job->begin + offset);
+        long hi = left > job->grain ? (long)((unsigned long)lo + job->grain) : job->end;
+        if (partial) {
+            job->reduce_body(job->ctx, lo, hi, partial);
+        } else {
+            job->body(job->ctx, lo, hi);
+        }
+        completed++;
+        range = atomic_load_explicit(&slot->range, memory_order_acquire);
+    }
+
+    if (completed > 0) {
+        atomic_store_explicit(&slot->used, true, memory_order_relaxed);
+        // release: частичная сумма видна тому, кто увидит done
+        if (atomic_fetch_sub_explicit(&job->chunks_left, completed,
+                                      memory_order_acq_rel) == completed) {
+            atomic_store_explicit(&job->done, 1, memory_order_release);
+            futex_wake(&job->done, 1, false);
+        }
+    }
+}
+
+// Забрать вторую половину невыполненных отрезков другого участника
+static bool parallel_steal(parallel_job_t* job, int self) {
+    int count = atomic_load_explicit(&job->num_slots, memory_order_acquire);
+    for (int k = 1; k < count; k++) {
+        parallel_slot_t* victim = &job->slots[(self + k) % count];
+        uint64_t range = atomic_load_explicit(&victim->range, memory_order_acquire);
+        for (;;) {
+            uint32_t first = (uint32_t)(range >> 32);
+            uint32_t last = (uint32_t)range;
+            if (first >= last) {
+                break;
+            }
+            // Последний отрезок тоже забирается: владелец может быть занят
+            uint32_t mid = first + (last - first) / 2;
+            if (atomic_compare_exchange_weak_explicit(&victim->range, &range,
+                                                      range_pack(first, mid),
+                                                      memory_order_acq_rel,
+                                                      memory_order_acquire)) {
+                atomic_store_explicit(&job->slots[self].range, range_pack(mid, last),
+                                      memory_order_release);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static void parallel_participate(parallel_job_t* job, int self) {
+    do {
+        parallel_run_own(job, self);
+    } while (parallel_steal(job, self));
+}
+
+// Задача-помощник: регистрирует слот и ищет работу, пока она есть
+static void parallel_helper(void* arg) {
+    parallel_job_t* job = (parallel_job_t*)arg;
+    int self = atomic_fetch_add_explicit(&job->num_slots, 1, memory_order_acq_rel);
+    if (self < job->max_slots) {
+        parallel_participate(job, self);
+    }
+    parallel_job_release(job);
+}
+
+static int parallel_run(thread_pool_t* pool, long begin, long end, long grain,
+                        void (*body)(void*, long, long),
+                        void (*reduce_body)(void*, long, long, void*),
+                        void (*combine)(void*, void*, const void*),
+                        void* result, size_t result_size, void* ctx) {
+    if (!pool || begin > end || (!body && !reduce_body) ||
+        (reduce_body && (!combine || !result || result_size == 0))) {
+        return -1;
+    }
+    if (begin == end) {
+        return 0;
+    }
+
+    // Длина без знака: для [LONG_MIN, LONG_MAX) end - begin в long не помещается,
+    // и округления вверх ниже не переполняются
+    unsigned long length = (unsigned long)end - (unsigned long)begin;
+    unsigned long chunk = (unsigned long)grain;
+    int threads = atomic_load_explicit(&pool->thread_count, memory_order_relaxed);
+    if (grain <= 0) {
+        unsigned long target = (unsigned long)(threads + 1) * AUTO_CHUNKS_PER_PARTICIPANT;
+        chunk = length / target + (length % target != 0);
+    }
+    // Номера отрезков должны помещаться в 32 бита
+    if (length / chunk >= UINT32_MAX - 1) {
+        chunk = length / (UINT32_MAX - 2) + 1;
+    }
+    uint32_t chunks = (uint32_t)(length / chunk + (length % chunk != 0));
+    int helpers = (long)threads < (long)chunks - 1 ? threads : (int)chunks - 1;
+    int max_slots = helpers + 1;
+
+    size_t stride = reduce_body ? (result_size + 63) / 64 * 64 : 0;
+    size_t header = sizeof(parallel_job_t) + sizeof(parallel_slot_t) * (size_t)max_slots;
+    header = (header + 63) / 64 * 64;
+    parallel_job_t* job = (parallel_job_t*)aligned_alloc(64, header + stride * max_slots);
+    if (!job) {
+        return -1;
+    }
+    job->begin = begin;
+    job->end = end;
+    job->grain = chunk;
+    job->body = body;
+    job->reduce_body = reduce_body;
+    job->ctx = ctx;
+    job->partials = reduce_body ? (unsigned char*)job + header : NULL;
+    job->partial_stride = stride;
+    job->max_slots = max_slots;
+    atomic_init(&job->num_slots, 1);
+    atomic_init(&job->chunks_left, chunks);
+    atomic_init(&job->done, 0);
+    atomic_init(&job->refs, 1 + helpers);
+    for (int i = 0; i < max_slots; i++) {
+        atomic_init(&job->slots[i].range, i == 0 ? range_pack(0, chunks) : 0);
+        atomic_init(&job->slots[i].used, false);
+        if (reduce_body) {
+            memcpy(job->partials + (size_t)i * stride, result, result_size);
+        }
+    }
+
+    // Помощники, которых пул не принял, просто не участвуют
+    void* args[HELPER_BATCH];
+    for (int i = 0; i < HELPER_BATCH; i++) {
+        args[i] = job;
+    }
+    for (int submitted = 0; submitted < helpers;) {
+        int batch = helpers - submitted < HELPER_BATCH ? helpers - submitted : HELPER_BATCH;
+        if (thread_pool_add_tasks(pool, parallel_helper, args, batch) != 0) {
+            atomic_fetch_sub(&job->refs, helpers - submitted);
+            break;
+        }
+        submitted += batch;
+    }
+
+    parallel_participate(job, 0);
+    while (!atomic_load_explicit(&job->done, memory_order_acquire)) {
+        futex_wait(&job->done, 0, NULL, false);
+    }
+
+    if (reduce_body) {
+        int count = atomic_load(&job->num_slots);
+        if (count > max_slots) count = max_slots;
+        for (int i = 0; i < count; i++) {
+            if (atomic_load_explicit(&job->slots[i].used, memory_order_relaxed)) {
+                combine(ctx, result, job->partials + (size_t)i * stride);
+            }
+        }
+    }
+    parallel_job_release(job);
+    return 0;
+}
+
+// Параллельный цикл
+int thread_pool_parallel_for(thread_pool_t* pool, long begin, long end, long grain,
+                             void (*body)(void* ctx, long lo, long hi), void* ctx) {
+    return parallel_run(pool, begin, end, grain, body, NULL, NULL, NULL, 0, ctx);
+}
+
+// Параллельная свертка
+int thread_pool_parallel_reduce(thread_pool_t* pool, long begin, long end, long grain,
+                                void (*body)(void* ctx, long lo, long hi, void* partial),
+                                void (*combine)(void* ctx, void* result, const void* partial),
+                                void* result, size_t result_size, void* ctx) {
+    return parallel_run(pool, begin, end, grain, NULL, body, combine, result, result_size, ctx);
+}
@@ -0,0 +1,210 @@
+#include "task_slab.h"
+#include "numa_topology.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#define HUGE_PAGE_SIZE (2UL * 1024 * 1024)
+
+#define SLAB_INDEX_MASK 0xffffffffULL
+
+// Индекс+1 узла (0 зарезервирован под "нет узла")
+static inline uint32_t slab_ref(task_slab_t* slab, task_t* task) {
+    return (uint32_t)(task - slab->nodes) + 1;
+}
+
+static inline task_t* slab_node(task_slab_t* slab, uint32_t ref) {
+    return &slab->nodes[ref - 1];
+}
+
+// Добавление цепочки first..last в общий стек
+static void slab_push_chain(task_slab_t* slab, task_t* first, task_t* last) {
+    uint64_t head = atomic_load_explicit(&slab->free_head, memory_order_relaxed);
+    uint64_t next;
+
+    do {
+        atomic_store_explicit(&last->slab_next, (uint32_t)(head & SLAB_INDEX_MASK),
+                              memory_order_relaxed);
+        next = (((head >> 32) + 1) << 32) | slab_ref(slab, first);
+    } while (!atomic_compare_exchange_weak_explicit(&slab->free_head, &head, next,
+                                                    memory_order_release,
+                                                    memory_order_relaxed));
+}
+
+// Извлечение узла из общего стека
+static task_t* slab_pop(task_slab_t* slab) {
+    uint64_t head = atomic_load_explicit(&slab->free_head, memory_order_acquire);
+    uint64_t next;
+    task_t* task;
+
+    do {
+        uint32_t ref = (uint32_t)(head & SLAB_INDEX_MASK);
+        if (ref == 0) {
+            return NULL;
+        }
+        task = slab_node(slab, ref);
+        // Узел мог быть уже извлечен и переиспользован другим потоком:
+        // тогда тег в голове изменился и CAS не пройдет
+        uint32_t after = atomic_load_explicit(&task->slab_next, memory_order_relaxed);
+        next = (((head >> 32) + 1) << 32) | after;
+    } while (!atomic_compare_exchange_weak_explicit(&slab->free_head, &head, next,
+                                                    memory_order_acquire,
+                                                    memory_order_acquire));
+
+    return task;
+}
+
+int task_slab_init(task_slab_t* slab, size_t capacity, bool huge_pages, int numa_node) {
+    memset(slab, 0, sizeof(*slab));
+    atomic_init(&slab->free_head, 0);
+    atomic_init(&slab->shared_allocs, 0);
+    atomic_init(&slab->shared_frees, 0);
+    atomic_init(&slab->heap_allocs, 0);
+
+    if (capacity == 0) {
+        return 0;
+    }
+    if (capacity > SLAB_INDEX_MASK - 1) {
+        return -1;
+    }
+
+    size_t size = capacity * sizeof(task_t);
+    void* region = MAP_FAILED;
+
+    if (huge_pages) {
+        size_t huge_size = (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+        region = mmap(NULL, huge_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (region != MAP_FAILED) {
+            size = huge_size;
+            slab->huge_pages = true;
+        }
+    }
+
+    if (region == MAP_FAILED) {
+        region = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (region == MAP_FAILED) {
+            return -1;
+        }
+        // Если зарезервированных huge pages нет, просим прозрачные
+        if (huge_pages) {
+            madvise(region, size, MADV_HUGEPAGE);
+        }
+    }
+
+    slab->nodes = (task_t*)region;
+    slab->capacity = capacity;
+    slab->mapped_size = size;
+
+    // Страницы еще не тронуты: политика узла действует до их связывания ниже
+    if (numa_node >= 0) {
+        numa_bind_memory(region, size, numa_node);
+    }
+
+    // Связываем все узлы в стек: 1 -> 2 -> ... -> capacity
+    for (size_t i = 0; i < capacity; i++) {
+        task_t* task = &slab->nodes[i];
+        task->flags = 0;
+        atomic_init(&task->slab_next, i + 1 < capacity ? (uint32_t)(i + 2) : 0);
+    }
+    atomic_store(&slab->free_head, 1);
+
+    return 0;
+}
+
+void task_slab_destroy(task_slab_t* slab) {
+    if (slab->nodes) {
+        munmap(slab->nodes, slab->mapped_size);
+        slab->nodes = NULL;
+    }
+}
+
+void task_slab_cache_init(task_slab_cache_t* cache) {
+    cache->head = 0;
+    cache->count = 0;
+    atomic_init(&cache->allocs, 0);
+    atomic_init(&cache->frees, 0);
+}
+
+// Отделить из кэша цепочку из n узлов и вернуть ее в общий стек
+static void slab_cache_release(task_slab_t* slab, task_slab_cache_t* cache, int n) {
+    if (n <= 0 || cache->head == 0) return;
+
+    task_t* first = slab_node(slab, cache->head);
+    task_t* last = first;
+    int taken = 1;
+    while (taken < n) {
+        uint32_t ref = atomic_load_explicit(&last->slab_next, memory_order_relaxed);
+        if (ref == 0) break;
+        last = slab_node(slab, ref);
+        taken++;
+    }
+    cache->count -= taken;
+    cache->head = atomic_load_explicit(&last->slab_next, memory_order_relaxed);
+
+    slab_push_chain(slab, first, last);
+}
+
+void task_slab_cache_flush(task_slab_t* slab, task_slab_cache_t* cache) {
+    slab_cache_release(slab, cache, cache->count);
+}
+
+task_t* task_slab_alloc(task_slab_t* slab, task_slab_cache_t* cache) {
+    task_t* task = NULL;
+
+    if (cache && cache->head != 0) {
+        task = slab_node(slab, cache->head);
+        cache->head = atomic_load_explicit(&task->slab_next, memory_order_relaxed);
+        cache->count--;
+    } else if (slab->nodes) {
+        task = slab_pop(slab);
+    }
+
+    if (task) {
+        task->flags = 0;
+        if (cache) {
+            atomic_store_explicit(&cache->allocs,
+                                  atomic_load_explicit(&cache->allocs, memory_order_relaxed) + 1,
+                                  memory_order_relaxed);
+        } else {
+            atomic_fetch_add_explicit(&slab->shared_allocs, 1, memory_order_relaxed);
+        }
+        return task;
+    }
+
+    // Пул исчерпан или отключен — выделяем узел из кучи
+    void* memory = NULL;
+    if (posix_memalign(&memory, _Alignof(task_t), sizeof(task_t)) != 0) {
+        return NULL;
+    }
+    task = (task_t*)memory;
+    task->flags = TASK_FLAG_HEAP;
+    atomic_fetch_add_explicit(&slab->heap_allocs, 1, memory_order_relaxed);
+    return task;
+}
+
+void task_slab_free(task_slab_t* slab, task_slab_cache_t* cache, task_t* task) {
+    if (!task_slab_owns(slab, task)) {
+        free(task);
+        return;
+    }
+
+    if (cache) {
+        atomic_store_explicit(&task->slab_next, cache->head, memory_order_relaxed);
+        cache->head = slab_ref(slab, task);
+        cache->count++;
+        atomic_store_explicit(&cache->frees,
+                              atomic_load_explicit(&cache->frees, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+
+        // Кэш переполнен — отдаем половину в общий стек одной операцией CAS
+        if (cache->count >= TASK_SLAB_CACHE_MAX) {
+            slab_cache_release(slab, cache, TASK_SLAB_CACHE_MAX / 2);
+        }
+    } else {
+        atomic_store_explicit(&task->slab_next, 0, memory_order_relaxed);
+        slab_push_chain(slab, task, task);
+        atomic_fetch_add_explicit(&slab->shared_frees, 1, memory_order_relaxed);
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef TASK_SLAB_H
+#define TASK_SLAB_H
+
+#include "thread_pool.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Предвыделенный пул узлов task_t, переиспользуемых без malloc/free.
+//
+// Узлы лежат в одной области mmap (по возможности на huge pages).
+// Свободные узлы образуют общий lock-free стек (Трайбера) с тегом против ABA,
+// а у каждого рабочего потока есть небольшой локальный кэш, чтобы
+// освобождение задачи после выполнения не трогало общую кэш-линию.
+// Когда пул исчерпан, узлы выделяются из кучи (флаг TASK_FLAG_HEAP).
+
+#define TASK_SLAB_DEFAULT_CAPACITY 16384  // 16384 * 128 байт = 2 МБ
+#define TASK_SLAB_CACHE_MAX 64            // Размер локального кэша потока
+
+#define TASK_FLAG_HEAP     0x1u  // Узел выделен из кучи, а не из пула
+#define TASK_FLAG_ARG_HEAP 0x2u  // Аргумент скопирован в кучу (не влез в inline_arg)
+
+// Локальный кэш свободных узлов (используется только потоком-владельцем)
+typedef struct {
+    uint32_t head;            // Индекс+1 первого свободного узла, 0 — пусто
+    int count;                // Количество узлов в кэше
+    atomic_long allocs;       // Узлов пула выделено этим потоком
+    atomic_long frees;        // Узлов пула освобождено этим потоком
+} task_slab_cache_t;
+
+typedef struct task_slab {
+    task_t* nodes;            // Массив узлов
+    size_t capacity;          // Количество узлов
+    size_t mapped_size;       // Размер отображенной области
+    bool huge_pages;          // Область получена через MAP_HUGETLB
+
+    _Alignas(64) _Atomic uint64_t free_head;  // (тег << 32) | (индекс + 1)
+
+    _Alignas(64) atomic_long shared_allocs;   // Выделения/освобождения без кэша
+    atomic_long shared_frees;
+    atomic_long heap_allocs;  // Сколько раз пришлось обращаться к куче
+} task_slab_t;
+
+// Инициализация пула узлов. capacity == 0 — все узлы берутся из кучи.
+// numa_node >= 0 — разместить узлы в памяти этого NUMA-узла (номер в sysfs).
+int task_slab_init(task_slab_t* slab, size_t capacity, bool huge_pages, int numa_node);
+
+// Принадлежит ли узел области пула (иначе он выделен из кучи)
+static inline bool task_slab_owns(const task_slab_t* slab, const task_t* task) {
+    return slab->nodes != NULL && task >= slab->nodes && task < slab->nodes + slab->capacity;
+}
+
+// Освобождение памяти пула (все узлы должны быть возвращены)
+void task_slab_destroy(task_slab_t* slab);
+
+// Инициализация локального кэша потока
+void task_slab_cache_init(task_slab_cache_t* cache);
+
+// Возврат всех узлов локального кэша в общий стек
+void task_slab_cache_flush(task_slab_t* slab, task_slab_cache_t* cache);
+
+// Выделение узла. cache может быть NULL (поток вне пула).
+task_t* task_slab_alloc(task_slab_t* slab, task_slab_cache_t* cache);
+
+// Освобождение узла. cache может быть NULL.
+void task_slab_free(task_slab_t* slab, task_slab_cache_t* cache, task_t* task);
+
+#endif // TASK_SLAB_H
@@ -1,9 +1,19 @@
+#define _GNU_SOURCE
 #include "thread_pool.h"
+#include "task_slab.h"
+#include "ws_deque.h"
+#include "numa_topology.h"
+#include "timer_wheel.h"
+#include "trace_ring.h"
+#include "../../common/futex.h"
+#include <sched.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #include <errno.h>
+#include <time.h>
 
 // Глобальный обработчик ошибок
 static error_handler_t error_handler = NULL;
@@ -22,121 +32,1100 @@ static void thread_pool_error(const char* msg) {
     }
 }
 
-// Функция потока в пуле
-static void* thread_pool_worker(void* thread_pool) {
-    thread_pool_t* pool = (thread_pool_t*)thread_pool;
+// Состояние рабочего потока
+// Счетчики потока. Пишет только сам поток (без атомарных RMW),
+// читает thread_pool_get_stats; отдельная кэш-линия, чтобы запись
+// не мешала ворам, читающим дек.
+typedef struct {
+    _Alignas(64) _Atomic uint64_t tasks_run;
+    _Atomic uint64_t steals;
+    _Atomic uint64_t busy_ns;
+    _Atomic uint64_t idle_ns;
+    latency_histogram_t queue_wait; // От добавления до начала выполнения
+    latency_histogram_t exec;       // Время выполнения
+} thread_pool_worker_stats_t;
+
+typedef struct thread_pool_worker {
+    ws_deque_t deque;         // Локальный дек (только в режиме work-stealing)
+    thread_pool_t* pool;      // Пул, которому принадлежит поток
+    int index;                // Номер потока в пуле
+    unsigned int rng;         // Состояние генератора для выбора жертвы
+    unsigned int tick;        // Счетчик задач для проверки глобальной очереди
+    task_slab_cache_t task_cache; // Локальный кэш свободных узлов задач
+    int state;                // WORKER_* (под pool->lock)
+    int cpu;                  // CPU, за которым закреплен поток (-1 — нет)
+    int node;                 // Индекс узла в pool->nodes
+    void* stack;              // Стек в памяти узла (NULL — стек от pthread)
+    size_t stack_size;        // Размер области stack вместе с защитной страницей
+    thread_pool_worker_stats_t stats; // Переживает перезапуск потока в слоте
+} thread_pool_worker_t;
+
+// Состояние слота потока
+#define WORKER_EMPTY   0      // Поток не запущен
+#define WORKER_RUNNING 1      // Поток работает
+#define WORKER_EXITED  2      // Поток завершился из-за простоя, но не присоединен
+#define WORKER_JOINING 3      // Поток присоединяется вне pool->lock
+
+// Значения по умолчанию для динамического масштабирования
+#define DEFAULT_IDLE_TIMEOUT_MS 5000
+#define DEFAULT_SCALE_UP_WAIT_US 1000
+#define DEFAULT_SCALE_UP_QUEUE_PER_THREAD 8
+
+// Слово состояния группы: младшие 31 бит — незавершенные задачи,
+// старший бит — на слове кто-то спит и при обнулении нужен futex_wake
+#define GROUP_WAITING    0x80000000u
+#define GROUP_COUNT_MASK 0x7fffffffu
+
+// Стек закрепленного потока (резервируется без выделения страниц)
+#define WORKER_STACK_SIZE (8UL * 1024 * 1024)
+
+// Сколько сработавших таймеров поток таймеров собирает за одну блокировку
+#define TIMER_FIRE_BATCH 256
+
+// Сколько задач за раз переносить из глобальной очереди в локальный дек
+#define WS_GLOBAL_BATCH 32
+
+// Как часто (в задачах) заглядывать в глобальную очередь при непустом деке
+#define WS_GLOBAL_CHECK_INTERVAL 61
+
+// Обертки над блокировкой пула (см. THREAD_POOL_FUTEX_LOCK в thread_pool.h).
+// Ожидание с тайм-аутом в обоих вариантах идет по CLOCK_MONOTONIC.
+#ifdef THREAD_POOL_FUTEX_LOCK
+static inline int thread_pool_mutex_init(thread_pool_mutex_t* m) { return futex_mutex_init(m); }
+static inline void thread_pool_mutex_destroy(thread_pool_mutex_t* m) { futex_mutex_destroy(m); }
+static inline void thread_pool_mutex_lock(thread_pool_mutex_t* m) { futex_mutex_lock(m); }
+static inline void thread_pool_mutex_unlock(thread_pool_mutex_t* m) { futex_mutex_unlock(m); }
+static inline int thread_pool_cond_init(thread_pool_cond_t* c) { return futex_cond_init(c); }
+static inline void thread_pool_cond_destroy(thread_pool_cond_t* c) { futex_cond_destroy(c); }
+static inline int thread_pool_cond_wait(thread_pool_cond_t* c, thread_pool_mutex_t* m) {
+    return futex_cond_wait(c, m);
+}
+static inline int thread_pool_cond_timedwait(thread_pool_cond_t* c, thread_pool_mutex_t* m,
+                                             const struct timespec* deadline) {
+    return futex_cond_timedwait(c, m, deadline);
+}
+static inline void thread_pool_cond_signal(thread_pool_cond_t* c) { futex_cond_signal(c); }
+static inline void thread_pool_cond_broadcast(thread_pool_cond_t* c) { futex_cond_broadcast(c); }
+#else
+static inline int thread_pool_mutex_init(thread_pool_mutex_t* m) {
+    return pthread_mutex_init(m, NULL);
+}
+static inline void thread_pool_mutex_destroy(thread_pool_mutex_t* m) { pthread_mutex_destroy(m); }
+static inline void thread_pool_mutex_lock(thread_pool_mutex_t* m) { pthread_mutex_lock(m); }
+static inline void thread_pool_mutex_unlock(thread_pool_mutex_t* m) { pthread_mutex_unlock(m); }
+static inline int thread_pool_cond_init(thread_pool_cond_t* c) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    int rc = pthread_cond_init(c, &attr);
+    pthread_condattr_destroy(&attr);
+    return rc;
+}
+static inline void thread_pool_cond_destroy(thread_pool_cond_t* c) { pthread_cond_destroy(c); }
+static inline int thread_pool_cond_wait(thread_pool_cond_t* c, thread_pool_mutex_t* m) {
+    return pthread_cond_wait(c, m);
+}
+static inline int thread_pool_cond_timedwait(thread_pool_cond_t* c, thread_pool_mutex_t* m,
+                                             const struct timespec* deadline) {
+    return pthread_cond_timedwait(c, m, deadline);
+}
+static inline void thread_pool_cond_signal(thread_pool_cond_t* c) { pthread_cond_signal(c); }
+static inline void thread_pool_cond_broadcast(thread_pool_cond_t* c) { pthread_cond_broadcast(c); }
+#endif
+
+// Рабочий поток, выполняющий текущий код (NULL вне пула)
+static _Thread_local thread_pool_worker_t* current_worker = NULL;
+
+// Узел пула, на котором выполняется текущий поток: для потока пула —
+// узел его CPU, для внешнего потока — узел CPU, на котором он сейчас
+static int thread_pool_home_node(thread_pool_t* pool) {
+    thread_pool_worker_t* self = current_worker;
+    if (self != NULL && self->pool == pool) {
+        return self->node;
+    }
+    if (pool->num_nodes == 1) {
+        return 0;
+    }
+    
+    int cpu = sched_getcpu();
+    if (cpu < 0 || cpu >= pool->cpu_map_size || pool->cpu_node[cpu] < 0) {
+        return 0;
+    }
+    return pool->cpu_node[cpu];
+}
+
+// Выделение узла задачи из пула узлов своего NUMA-узла
+static task_t* thread_pool_task_new(thread_pool_t* pool, void (*function)(void*)) {
+    thread_pool_worker_t* self = current_worker;
+    task_t* task;
+    if (self != NULL && self->pool == pool) {
+        task = task_slab_alloc(&pool->task_slabs[self->node], &self->task_cache);
+    } else {
+        task = task_slab_alloc(&pool->task_slabs[thread_pool_home_node(pool)], NULL);
+    }
+    if (!task) {
+        thread_pool_error("Не удалось выделить память для задачи");
+        return NULL;
+    }
+    
+    task->function = function;
+    task->arg = NULL;
+    task->next = NULL;
+    task->group = NULL;
+    return task;
+}
+
+// Освобождение узла задачи вместе со скопированным аргументом
+static void thread_pool_task_release(thread_pool_t* pool, task_t* task) {
+    if (task->flags & TASK_FLAG_ARG_HEAP) {
+        free(task->arg);
+    }
+    
+    // Узел возвращается в пул, из которого выделен; узлы из кучи
+    // освобождает любой пул, поэтому для них подходит нулевой
+    int node = 0;
+    for (int i = 1; i < pool->num_nodes; i++) {
+        if (task_slab_owns(&pool->task_slabs[i], task)) {
+            node = i;
+            break;
+        }
+    }
+    
+    // Локальный кэш потока хранит узлы только своего NUMA-узла
+    thread_pool_worker_t* self = current_worker;
+    task_slab_cache_t* cache = (self != NULL && self->pool == pool && self->node == node) ?
+                               &self->task_cache : NULL;
+    task_slab_free(&pool->task_slabs[node], cache, task);
+}
+
+// Текущее время CLOCK_MONOTONIC в наносекундах
+static inline uint64_t thread_pool_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Добавление цепочки из count задач в конец очереди уровня level
+// узла node (под pool->lock)
+static void global_queue_push_chain_locked(thread_pool_t* pool, task_t* head, task_t* tail,
+                                           int count, int level, int node) {
+    thread_pool_node_t* n = &pool->nodes[node];
+    task_queue_t* queue = &n->queues[level];
+    
+    tail->next = NULL;
+    if (queue->tail) {
+        queue->tail->next = head;
+    } else {
+        queue->head = head;
+        n->bitmap |= 1u << level;
+        atomic_fetch_or_explicit(&pool->queue_bitmap, 1u << level, memory_order_relaxed);
+    }
+    queue->tail = tail;
+    queue->size += count;
+    
+    pool->queue_size += count;
+    latency_counter_add(&pool->priority_counters[level].submitted, (uint64_t)count);
+}
+
+// Добавление задачи в конец очереди уровня level узла node (под pool->lock)
+static void global_queue_push_locked(thread_pool_t* pool, task_t* task, int level, int node) {
+    global_queue_push_chain_locked(pool, task, task, 1, level, node);
+}
+
+// Выбор уровня, из которого брать следующую задачу (под pool->lock).
+// Без старения это старший непустой уровень — один поиск по битовой маске.
+// Со старением каждая задача в голове очереди получает +1 уровень за каждые
+// priority_aging_ms ожидания, но не выше MAX - 1: старший уровень всегда
+// обслуживается первым. Уровней фиксированное число, так что выбор O(1).
+// Старение действует внутри очередей одного узла.
+static int global_queue_select_locked(thread_pool_t* pool, int node, uint64_t now) {
+    thread_pool_node_t* n = &pool->nodes[node];
+    unsigned int bitmap = n->bitmap;
+    if (bitmap == 0) {
+        return -1;
+    }
+    
+    int top = 31 - __builtin_clz(bitmap);
+    if (pool->priority_aging_ms <= 0 || (bitmap & (bitmap - 1)) == 0) {
+        return top;
+    }
+    
+    if (top == THREAD_POOL_PRIORITY_MAX) {
+        return top;
+    }
+    
+    uint64_t step = (uint64_t)pool->priority_aging_ms * 1000000ULL;
+    uint64_t cap = (uint64_t)(THREAD_POOL_PRIORITY_MAX - 1) * step;
+    int best = top;
+    uint64_t best_score = 0;
+    uint64_t best_waited = 0;
+    
+    for (unsigned int rest = bitmap; rest != 0; rest &= rest - 1) {
+        int level = __builtin_ctz(rest);
+        uint64_t enqueued = n->queues[level].head->enqueue_ns;
+        uint64_t waited = now > enqueued ? now - enqueued : 0;
+        uint64_t score = (uint64_t)level * step + waited;
+        if (score > cap) score = cap;
+        
+        // При равенстве (обе задачи достигли потолка) берем более старую
+        if (score > best_score || (score == best_score && waited >= best_waited)) {
+            best = level;
+            best_score = score;
+            best_waited = waited;
+        }
+    }
+    
+    return best;
+}
+
+// Извлечение задачи из очереди уровня level узла node (под pool->lock)
+static task_t* global_queue_pop_level_locked(thread_pool_t* pool, int node, int level,
+                                             uint64_t now) {
+    thread_pool_node_t* n = &pool->nodes[node];
+    task_queue_t* queue = &n->queues[level];
+    task_t* task = queue->head;
+    if (task == NULL) {
+        return NULL;
+    }
+    
+    queue->head = task->next;
+    queue->size--;
+    pool->queue_size--;
+    
+    // Обновление хвоста очереди, если нужно
+    if (queue->head == NULL) {
+        queue->tail = NULL;
+        n->bitmap &= ~(1u << level);
+        
+        // Бит объединения снимается, когда уровень пуст на всех узлах
+        bool elsewhere = false;
+        for (int i = 0; i < pool->num_nodes && !elsewhere; i++) {
+            elsewhere = (pool->nodes[i].bitmap & (1u << level)) != 0;
+        }
+        if (!elsewhere) {
+            atomic_fetch_and_explicit(&pool->queue_bitmap, ~(1u << level), memory_order_relaxed);
+        }
+    }
+    
+    thread_pool_priority_counters_t* counters = &pool->priority_counters[level];
+    latency_counter_add(&counters->dequeued, 1);
+    latency_histogram_record(&counters->wait, now > task->enqueue_ns ? now - task->enqueue_ns : 0);
+    
+    return task;
+}
+
+// Узел, из очередей которого брать задачу потоку узла home (под pool->lock):
+// свой, если в нем есть задачи старшего непустого уровня, иначе первый
+// узел, где они есть. Чужие задачи берутся только когда своих такого
+// приоритета нет, поэтому приоритеты между узлами не нарушаются.
+static int global_queue_select_node_locked(thread_pool_t* pool, int home) {
+    unsigned int bitmap = atomic_load_explicit(&pool->queue_bitmap, memory_order_relaxed);
+    if (bitmap == 0) {
+        return -1;
+    }
+    
+    unsigned int top = 1u << (31 - __builtin_clz(bitmap));
+    if (pool->nodes[home].bitmap & top) {
+        return home;
+    }
+    for (int i = 0; i < pool->num_nodes; i++) {
+        if (pool->nodes[i].bitmap & top) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Извлечение самой приоритетной задачи из глобальных очередей (под pool->lock),
+// предпочитая очереди узла home. В level_out и node_out (если не NULL)
+// возвращаются уровень и узел, из которых взята задача.
+static task_t* global_queue_pop_locked(thread_pool_t* pool, int home, uint64_t now,
+                                       int* level_out, int* node_out) {
+    int node = global_queue_select_node_locked(pool, home);
+    int level = node >= 0 ? global_queue_select_locked(pool, node, now) : -1;
+    if (level_out) *level_out = level;
+    if (node_out) *node_out = node;
+    if (level < 0) {
+        return NULL;
+    }
+    
+    unsigned int bitmap = pool->nodes[node].bitmap;
+    if (level != 31 - __builtin_clz(bitmap)) {
+        latency_counter_add(&pool->priority_counters[level].aged, 1);
+    }
+    
+    return global_queue_pop_level_locked(pool, node, level, now);
+}
+
+// Учет завершения задачи группы. После обнуления счетчика группа может
+// быть сразу уничтожена ожидающим потоком, поэтому к ней больше не
+// обращаемся: futex_wake по освобожденному адресу безвреден.
+static void thread_pool_group_task_done(thread_pool_t* pool, thread_pool_group_t* group) {
+    uint32_t old = atomic_fetch_sub_explicit(&group->state, 1, memory_order_seq_cst);
+    if ((old & GROUP_COUNT_MASK) != 1) {
+        return;
+    }
+    
+    if (old & GROUP_WAITING) {
+        futex_wake(&group->state, INT_MAX, false);
+    }
+    
+    if (atomic_load_explicit(&pool->group_epoch_waiters, memory_order_seq_cst) > 0) {
+        atomic_fetch_add_explicit(&pool->group_epoch, 1, memory_order_seq_cst);
+        futex_wake(&pool->group_epoch, INT_MAX, false);
+    }
+}
+
+// Запись события в кольцо текущего потока
+static void thread_pool_trace_record(thread_pool_t* pool, uint32_t type, const task_t* task,
+                                     void (*function)(void*), uint32_t arg) {
+    thread_pool_worker_t* self = current_worker;
+    trace_ring_t* ring = (self != NULL && self->pool == pool) ?
+                         pool->trace->worker_rings[self->index] :
+                         thread_pool_trace_thread_ring(pool->trace);
+    if (ring != NULL) {
+        trace_ring_record(ring, type, task, function, arg);
+    }
+}
+
+// Точка трассировки: пока трассировка выключена — одна проверка флага
+static inline void thread_pool_trace(thread_pool_t* pool, uint32_t type, const task_t* task,
+                                     void (*function)(void*), uint32_t arg) {
+    if (__builtin_expect(atomic_load_explicit(&pool->trace_enabled, memory_order_acquire), 0)) {
+        thread_pool_trace_record(pool, type, task, function, arg);
+    }
+}
+
+// Выполнение задачи потоком self и учет ее завершения
+static void thread_pool_run_task(thread_pool_worker_t* self, task_t* task) {
+    thread_pool_t* pool = self->pool;
+    thread_pool_group_t* group = task->group;
+    uint64_t enqueued = task->enqueue_ns;
+    void (*function)(void*) = task->function;
+    
+    atomic_fetch_add_explicit(&pool->count, 1, memory_order_relaxed);
+    
+    thread_pool_trace(pool, TRACE_START, task, function, 0);
+    uint64_t start = thread_pool_now_ns();
+    function(task->arg);
+    uint64_t end = thread_pool_now_ns();
+    thread_pool_trace(pool, TRACE_END, task, function, 0);
+    thread_pool_task_release(pool, task);
+    
+    atomic_fetch_sub_explicit(&pool->count, 1, memory_order_relaxed);
+    
+    thread_pool_worker_stats_t* stats = &self->stats;
+    latency_counter_add(&stats->tasks_run, 1);
+    latency_counter_add(&stats->busy_ns, end - start);
+    latency_histogram_record(&stats->queue_wait, start > enqueued ? start - enqueued : 0);
+    latency_histogram_record(&stats->exec, end - start);
+    
+    if (group != NULL) {
+        thread_pool_group_task_done(pool, group);
+    }
+    
+    if (pool->hooks.after_task) {
+        pool->hooks.after_task(pool->hooks.ctx);
+    }
+    
+    // Последняя задача будит потоки в thread_pool_wait
+    if (atomic_fetch_sub_explicit(&pool->tasks_pending, 1, memory_order_seq_cst) == 1 &&
+        atomic_load_explicit(&pool->pending_waiters, memory_order_seq_cst) > 0) {
+        futex_wake(&pool->tasks_pending, INT_MAX, false);
+    }
+}
+
+static void* thread_pool_worker(void* arg);
+static bool ws_has_local_work(thread_pool_t* pool);
+
+// Разбудить не больше wanted ожидающих потоков, начиная с узла home
+// (под pool->lock). Поток считается разбуженным, пока сам не выйдет из
+// ожидания, поэтому повторные сигналы уходят другим потокам, а не
+// тому, кто уже получил сигнал, но еще не взял блокировку.
+static void thread_pool_wake_locked(thread_pool_t* pool, int wanted, int home) {
+    for (int i = 0; i < pool->num_nodes && wanted > 0; i++) {
+        thread_pool_node_t* node = &pool->nodes[(home + i) % pool->num_nodes];
+        int available = node->idle - node->wakeups;
+        if (available <= 0) continue;
+        
+        if (wanted >= available) {
+            thread_pool_cond_broadcast(&node->notify);
+            node->wakeups = node->idle;
+            wanted -= available;
+            continue;
+        }
+        for (int j = 0; j < wanted; j++) {
+            thread_pool_cond_signal(&node->notify);
+        }
+        node->wakeups += wanted;
+        wanted = 0;
+    }
+}
+
+// Разбудить все потоки всех узлов (при завершении пула)
+static void thread_pool_wake_all(thread_pool_t* pool) {
+    for (int i = 0; i < pool->num_nodes; i++) {
+        thread_pool_cond_broadcast(&pool->nodes[i].notify);
+    }
+}
+
+// Ожидание на notify своего узла (под pool->lock)
+static int thread_pool_node_wait_locked(thread_pool_worker_t* self,
+                                        const struct timespec* deadline) {
+    thread_pool_t* pool = self->pool;
+    thread_pool_node_t* node = &pool->nodes[self->node];
+    
+    node->idle++;
+    thread_pool_trace(pool, TRACE_PARK, NULL, NULL, 0);
+    if (pool->hooks.idle) {
+        pool->hooks.idle(pool->hooks.ctx, true);
+    }
+    int rc = deadline ? thread_pool_cond_timedwait(&node->notify, &pool->lock, deadline)
+                      : thread_pool_cond_wait(&node->notify, &pool->lock);
+    if (pool->hooks.idle) {
+        pool->hooks.idle(pool->hooks.ctx, false);
+    }
+    thread_pool_trace(pool, TRACE_WAKE, NULL, NULL, 0);
+    node->idle--;
+    if (node->wakeups > 0) {
+        node->wakeups--;
+    }
+    return rc;
+}
+
+// Есть ли работа для спящего потока (под pool->lock)
+static bool thread_pool_has_work_locked(thread_pool_t* pool) {
+    return pool->queue_size > 0 || (pool->work_stealing && ws_has_local_work(pool));
+}
+
+// Запуск потока в первом свободном слоте (под pool->lock).
+// Слоты потоков, завершившихся из-за простоя, занимаются только после
+// thread_pool_reap_exited: присоединять их здесь, под блокировкой, нельзя.
+static int thread_pool_start_worker_locked(thread_pool_t* pool) {
+    for (int i = 0; i < pool->max_threads; i++) {
+        thread_pool_worker_t* worker = &pool->workers[i];
+        if (worker->state != WORKER_EMPTY) continue;
+        
+        // Закрепленный поток сразу стартует на своем CPU и со стеком
+        // в памяти своего узла
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        if (worker->cpu >= 0) {
+            cpu_set_t cpuset;
+            CPU_ZERO(&cpuset);
+            CPU_SET(worker->cpu, &cpuset);
+            pthread_attr_setaffinity_np(&attr, sizeof(cpuset), &cpuset);
+        }
+        if (worker->stack) {
+            size_t guard = (size_t)sysconf(_SC_PAGESIZE);
+            pthread_attr_setstack(&attr, (char*)worker->stack + guard, worker->stack_size - guard);
+        }
+        
+        int rc = pthread_create(&pool->threads[i], &attr, thread_pool_worker, worker);
+        pthread_attr_destroy(&attr);
+        if (rc != 0) {
+            thread_pool_error("Не удалось создать поток");
+            return -1;
+        }
+        
+        worker->state = WORKER_RUNNING;
+        atomic_fetch_add_explicit(&pool->thread_count, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&pool->threads_started, 1, memory_order_relaxed);
+        return i;
+    }
+    return -1;
+}
+
+// Присоединение потоков, завершившихся из-за простоя (без pool->lock).
+// Завершающийся поток уже отпустил блокировку, но еще может выполнять
+// хук thread_stop, поэтому pthread_join под блокировкой остановил бы пул.
+static void thread_pool_reap_exited(thread_pool_t* pool) {
+    while (atomic_load_explicit(&pool->threads_exited, memory_order_relaxed) > 0) {
+        thread_pool_mutex_lock(&pool->lock);
+        int slot = -1;
+        for (int i = 0; i < pool->max_threads && slot < 0; i++) {
+            if (pool->workers[i].state == WORKER_EXITED) slot = i;
+        }
+        if (slot < 0) {
+            thread_pool_mutex_unlock(&pool->lock);
+            return;
+        }
+        pool->workers[slot].state = WORKER_JOINING;
+        atomic_fetch_sub_explicit(&pool->threads_exited, 1, memory_order_relaxed);
+        thread_pool_mutex_unlock(&pool->lock);
+        
+        pthread_join(pool->threads[slot], NULL);
+        
+        thread_pool_mutex_lock(&pool->lock);
+        pool->workers[slot].state = WORKER_EMPTY;
+        thread_pool_mutex_unlock(&pool->lock);
+    }
+}
+
+// Добавление потока, если задачи ждут в очереди дольше порога или очередь
+// растет, а свободных потоков нет (под pool->lock)
+static void thread_pool_maybe_grow_locked(thread_pool_t* pool, uint64_t waited_ns) {
+    if (!pool->dynamic_scaling || pool->shutdown) return;
+    
+    int live = atomic_load_explicit(&pool->thread_count, memory_order_relaxed);
+    if (live >= pool->max_threads) return;
+    if (atomic_load_explicit(&pool->idle_workers, memory_order_relaxed) > 0) return;
+    
+    if (waited_ns >= pool->scale_up_wait_ns ||
+        pool->queue_size > pool->scale_up_queue_per_thread * live) {
+        thread_pool_start_worker_locked(pool);
+    }
+}
+
+// Ожидание на notify (под pool->lock). При динамическом масштабировании
+// ожидание ограничено idle_timeout_ms; если за это время работы так и не
+// появилось, а потоков больше минимума, поток освобождает слот и
+// функция возвращает false — поток должен завершиться.
+static bool thread_pool_idle_wait_locked(thread_pool_worker_t* self) {
+    thread_pool_t* pool = self->pool;
+    uint64_t idle_start = thread_pool_now_ns();
+    
+    if (!pool->dynamic_scaling) {
+        thread_pool_node_wait_locked(self, NULL);
+        latency_counter_add(&self->stats.idle_ns, thread_pool_now_ns() - idle_start);
+        return true;
+    }
+    
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += pool->idle_timeout_ms / 1000;
+    deadline.tv_nsec += (long)(pool->idle_timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    
+    int rc = thread_pool_node_wait_locked(self, &deadline);
+    latency_counter_add(&self->stats.idle_ns, thread_pool_now_ns() - idle_start);
+    if (rc != ETIMEDOUT || pool->shutdown || thread_pool_has_work_locked(pool) ||
+        atomic_load_explicit(&pool->thread_count, memory_order_relaxed) <= pool->min_threads) {
+        return true;
+    }
+    
+    self->state = WORKER_EXITED;
+    atomic_fetch_sub_explicit(&pool->thread_count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&pool->threads_retired, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&pool->threads_exited, 1, memory_order_relaxed);
+    return false;
+}
+
+// Цикл потока с общей очередью под одним мьютексом
+static void thread_pool_worker_locked(thread_pool_worker_t* self) {
+    thread_pool_t* pool = self->pool;
     task_t* task;
     
     while (true) {
-        pthread_mutex_lock(&pool->lock);
+        thread_pool_mutex_lock(&pool->lock);
         
         // Ожидание задачи или сигнала завершения
         while (pool->queue_size == 0 && !pool->shutdown) {
-            pthread_cond_wait(&pool->notify, &pool->lock);
+            atomic_fetch_add_explicit(&pool->idle_workers, 1, memory_order_relaxed);
+            bool stay = thread_pool_idle_wait_locked(self);
+            atomic_fetch_sub_explicit(&pool->idle_workers, 1, memory_order_relaxed);
+            
+            if (!stay) {
+                thread_pool_mutex_unlock(&pool->lock);
+                return;
+            }
         }
         
         // Проверка флага завершения
         if (pool->shutdown) {
-            pthread_mutex_unlock(&pool->lock);
-            pthread_exit(NULL);
+            thread_pool_mutex_unlock(&pool->lock);
+            return;
         }
         
         // Извлечение задачи из очереди
-        task = pool->task_queue;
+        uint64_t now = thread_pool_now_ns();
+        task = global_queue_pop_locked(pool, self->node, now, NULL, NULL);
         if (task != NULL) {
-            pool->task_queue = task->next;
-            pool->queue_size--;
-            
-            // Обновление хвоста очереди, если нужно
-            if (pool->task_queue == NULL) {
-                pool->task_queue_tail = NULL;
-            }
-            
-            pool->count++; // Увеличиваем счетчик активных потоков
+            thread_pool_maybe_grow_locked(pool, now - task->enqueue_ns);
         }
         
-        pthread_mutex_unlock(&pool->lock);
+        thread_pool_mutex_unlock(&pool->lock);
+        thread_pool_reap_exited(pool);
         
         // Выполнение задачи
         if (task != NULL) {
-            task->function(task->arg);
-            free(task);
-            
-            pthread_mutex_lock(&pool->lock);
-            pool->count--; // Уменьшаем счетчик активных потоков
-            pthread_mutex_unlock(&pool->lock);
+            thread_pool_trace(pool, TRACE_DEQUEUE, task, task->function, TRACE_SOURCE_GLOBAL);
+            thread_pool_run_task(self, task);
+        }
+    }
+}
+
+// Есть ли задачи в чьем-либо локальном деке
+static bool ws_has_local_work(thread_pool_t* pool) {
+    for (int i = 0; i < pool->max_threads; i++) {
+        if (ws_deque_size(&pool->workers[i].deque) > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Взять задачу из глобальной очереди, прихватив часть остальных в свой дек
+static task_t* ws_take_global(thread_pool_worker_t* self) {
+    thread_pool_t* pool = self->pool;
+    
+    thread_pool_mutex_lock(&pool->lock);
+    
+    uint64_t now = thread_pool_now_ns();
+    int level, node;
+    task_t* task = global_queue_pop_locked(pool, self->node, now, &level, &node);
+    
+    // Пачкой переносим только обычные и фоновые задачи: в деке они
+    // теряют приоритет, а срочные должны браться из глобальной очереди
+    unsigned int urgent = atomic_load_explicit(&pool->queue_bitmap, memory_order_relaxed)
+                          >> (THREAD_POOL_PRIORITY_NORMAL + 1);
+    if (task != NULL) {
+        thread_pool_maybe_grow_locked(pool, now - task->enqueue_ns);
+    }
+    if (task != NULL && level <= THREAD_POOL_PRIORITY_NORMAL && urgent == 0) {
+        task_queue_t* queue = &pool->nodes[node].queues[level];
+        int live = atomic_load_explicit(&pool->thread_count, memory_order_relaxed);
+        int batch = queue->size / (live > 0 ? live : 1);
+        if (batch > WS_GLOBAL_BATCH) batch = WS_GLOBAL_BATCH;
+        
+        while (batch-- > 0) {
+            task_t* extra = queue->head;
+            if (extra == NULL || ws_deque_push(&self->deque, extra) != 0) {
+                break;
+            }
+            global_queue_pop_level_locked(pool, node, level, now);
+        }
+    }
+    
+    thread_pool_mutex_unlock(&pool->lock);
+    thread_pool_reap_exited(pool);
+    return task;
+}
+
+// Кража задачи у случайно выбранного потока
+static task_t* ws_steal(thread_pool_worker_t* self) {
+    thread_pool_t* pool = self->pool;
+    int n = pool->max_threads;
+    
+    // Деки пустых слотов пусты, поэтому обходим все слоты
+    if (atomic_load_explicit(&pool->thread_count, memory_order_relaxed) < 2) return NULL;
+    
+    // xorshift32
+    self->rng ^= self->rng << 13;
+    self->rng ^= self->rng >> 17;
+    self->rng ^= self->rng << 5;
+    int start = (int)(self->rng % (unsigned int)n);
+    
+    for (int i = 0; i < n; i++) {
+        thread_pool_worker_t* victim = &pool->workers[(start + i) % n];
+        if (victim == self) continue;
+        
+        void* item;
+        int result;
+        do {
+            result = ws_deque_steal(&victim->deque, &item);
+        } while (result == WS_DEQUE_ABORT);
+        
+        if (result == WS_DEQUE_OK) {
+            latency_counter_add(&self->stats.steals, 1);
+            return (task_t*)item;
+        }
+    }
+    
+    return NULL;
+}
+
+// Засыпание до появления работы. Возвращает false, если поток должен
+// завершиться (завершение пула или долгий простой).
+static bool ws_wait_for_work(thread_pool_worker_t* self) {
+    thread_pool_t* pool = self->pool;
+    bool running = true;
+    
+    thread_pool_mutex_lock(&pool->lock);
+    
+    // Сначала объявляем себя спящим, затем проверяем деки: в паре с барьером
+    // в thread_pool_add_task это гарантирует, что пробуждение не потеряется
+    atomic_fetch_add_explicit(&pool->idle_workers, 1, memory_order_seq_cst);
+    atomic_thread_fence(memory_order_seq_cst);
+    
+    while (running && !pool->shutdown && !thread_pool_has_work_locked(pool)) {
+        running = thread_pool_idle_wait_locked(self);
+    }
+    
+    atomic_fetch_sub_explicit(&pool->idle_workers, 1, memory_order_seq_cst);
+    running = running && !pool->shutdown;
+    
+    thread_pool_mutex_unlock(&pool->lock);
+    return running;
+}
+
+// Цикл потока в режиме work-stealing
+static void thread_pool_worker_ws(thread_pool_worker_t* self) {
+    thread_pool_t* pool = self->pool;
+    
+    while (true) {
+        task_t* task = NULL;
+        uint32_t source = TRACE_SOURCE_GLOBAL;
+        
+        // Срочные задачи берем в первую очередь, а время от времени проверяем
+        // глобальную очередь, чтобы внешние задачи не голодали за локальными
+        unsigned int urgent = atomic_load_explicit(&pool->queue_bitmap, memory_order_relaxed)
+                              >> (THREAD_POOL_PRIORITY_NORMAL + 1);
+        if (urgent != 0 || ++self->tick % WS_GLOBAL_CHECK_INTERVAL == 0) {
+            task = ws_take_global(self);
+        }
+        if (task == NULL && (task = (task_t*)ws_deque_pop(&self->deque)) != NULL) {
+            source = TRACE_SOURCE_LOCAL;
         }
+        if (task == NULL) task = ws_take_global(self);
+        if (task == NULL && (task = ws_steal(self)) != NULL) {
+            source = TRACE_SOURCE_STEAL;
+        }
+        
+        if (task != NULL) {
+            thread_pool_trace(pool, TRACE_DEQUEUE, task, task->function, source);
+            thread_pool_run_task(self, task);
+            continue;
+        }
+        
+        if (!ws_wait_for_work(self)) {
+            return;
+        }
+    }
+}
+
+// Функция потока в пуле
+static void* thread_pool_worker(void* arg) {
+    thread_pool_worker_t* self = (thread_pool_worker_t*)arg;
+    
+    current_worker = self;
+    thread_pool_hooks_t* hooks = &self->pool->hooks;
+    if (hooks->thread_start) {
+        hooks->thread_start(hooks->ctx);
+    }
+    
+    if (self->pool->work_stealing) {
+        thread_pool_worker_ws(self);
+    } else {
+        thread_pool_worker_locked(self);
+    }
+    
+    if (hooks->thread_stop) {
+        hooks->thread_stop(hooks->ctx);
     }
     
+    // Возвращаем закэшированные узлы, чтобы их могли взять другие потоки
+    task_slab_cache_flush(&self->pool->task_slabs[self->node], &self->task_cache);
+    
+    current_worker = NULL;
     return NULL;
 }
 
 // Создание пула потоков
 thread_pool_t* thread_pool_create(int num_threads) {
+    thread_pool_options_t options = {
+        .num_threads = num_threads,
+        .work_stealing = false,
+        .task_slab_capacity = 0,
+        .task_slab_huge_pages = false,
+        .priority_aging_ms = 0,
+        .dynamic_scaling = false,
+    };
+    return thread_pool_create_with_options(&options);
+}
+
+// Освобождение памяти пула (потоки уже должны быть присоединены)
+static void thread_pool_free(thread_pool_t* pool) {
+    if (pool->task_slabs) {
+        for (int i = 0; i < pool->num_nodes; i++) {
+            task_slab_destroy(&pool->task_slabs[i]);
+        }
+        free(pool->task_slabs);
+    }
+    if (pool->workers) {
+        for (int i = 0; i < pool->max_threads; i++) {
+            if (pool->workers[i].stack) {
+                munmap(pool->workers[i].stack, pool->workers[i].stack_size);
+            }
+        }
+    }
+    free(pool->workers);
+    free(pool->threads);
+    for (int i = 0; i < pool->num_nodes; i++) {
+        thread_pool_cond_destroy(&pool->nodes[i].notify);
+    }
+    free(pool->nodes);
+    free(pool->cpu_node);
+    if (pool->timers) {
+        timer_wheel_destroy(pool->timers);
+        free(pool->timers);
+    }
+    thread_pool_trace_free(pool->trace);
+    thread_pool_cond_destroy(&pool->timer_notify);
+    thread_pool_mutex_destroy(&pool->timer_lock);
+    thread_pool_mutex_destroy(&pool->lock);
+    free(pool);
+}
+
+// CPU для слота slot (вызывается до запуска потоков).
+// Возвращает -1, если CPU из options->cpus процессу недоступен.
+static int thread_pool_slot_cpu(const thread_pool_options_t* options,
+                                const numa_topology_t* topo, int slot) {
+    if (options->cpus != NULL && options->num_cpus > 0) {
+        int cpu = options->cpus[slot % options->num_cpus];
+        if (cpu < 0 || cpu >= topo->num_cpus || topo->cpu_node[cpu] < 0) {
+            return -1;
+        }
+        return cpu;
+    }
+    
+    // Слоты идут по узлам по кругу, внутри узла — по ядрам
+    int node = slot % topo->num_nodes;
+    int cpus[NUMA_MAX_CPUS];
+    int count = numa_node_cpus(topo, node, cpus, NUMA_MAX_CPUS);
+    return count > 0 ? cpus[(slot / topo->num_nodes) % count] : -1;
+}
+
+// Закрепление слотов за CPU и выделение стеков в памяти их узлов
+static int thread_pool_place_workers(thread_pool_t* pool, const thread_pool_options_t* options,
+                                     const numa_topology_t* topo) {
+    size_t guard = (size_t)sysconf(_SC_PAGESIZE);
+    
+    for (int i = 0; i < pool->max_threads; i++) {
+        thread_pool_worker_t* worker = &pool->workers[i];
+        int cpu = thread_pool_slot_cpu(options, topo, i);
+        if (cpu < 0) {
+            char msg[96];
+            snprintf(msg, sizeof(msg), "CPU для потока %d недоступен процессу", i);
+            thread_pool_error(msg);
+            return -1;
+        }
+        worker->cpu = cpu;
+        worker->node = topo->cpu_node[cpu];
+        
+        // Страницы стека выделяются при первом касании уже с политикой узла;
+        // если отобразить не удалось, поток получит обычный стек
+        void* stack = mmap(NULL, WORKER_STACK_SIZE, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+        if (stack == MAP_FAILED) continue;
+        
+        mprotect(stack, guard, PROT_NONE);
+        numa_bind_memory(stack, WORKER_STACK_SIZE, topo->node_id[worker->node]);
+        worker->stack = stack;
+        worker->stack_size = WORKER_STACK_SIZE;
+    }
+    return 0;
+}
+
+// Создание пула потоков с параметрами
+thread_pool_t* thread_pool_create_with_options(const thread_pool_options_t* options) {
+    thread_pool_options_t defaults = {0};
+    if (!options) {
+        options = &defaults;
+    }
+    
+    int num_threads = options->num_threads;
     if (num_threads <= 0) {
         num_threads = 4; // Значение по умолчанию
     }
+    int max_threads = num_threads;
+    if (options->dynamic_scaling && options->max_threads > num_threads) {
+        max_threads = options->max_threads;
+    }
     
-    thread_pool_t* pool = (thread_pool_t*)malloc(sizeof(thread_pool_t));
+    thread_pool_t* pool = (thread_pool_t*)calloc(1, sizeof(thread_pool_t));
     if (!pool) {
         thread_pool_error("Не удалось выделить память для пула потоков");
         return NULL;
     }
     
     // Инициализация полей
-    pool->thread_count = num_threads;
+    atomic_init(&pool->thread_count, 0);
     pool->queue_size = 0;
-    pool->count = 0;
+    atomic_init(&pool->count, 0);
+    atomic_init(&pool->tasks_pending, 0);
+    atomic_init(&pool->pending_waiters, 0);
+    atomic_init(&pool->group_epoch, 0);
+    atomic_init(&pool->group_epoch_waiters, 0);
+    atomic_init(&pool->idle_workers, 0);
     pool->shutdown = false;
-    pool->dynamic_scaling = false;
-    pool->task_queue = NULL;
-    pool->task_queue_tail = NULL;
+    pool->work_stealing = options->work_stealing;
+    pool->quiet = options->quiet;
+    pool->hooks = options->hooks;
+    pool->dynamic_scaling = options->dynamic_scaling;
+    pool->min_threads = num_threads;
+    pool->max_threads = max_threads;
+    pool->idle_timeout_ms = options->idle_timeout_ms > 0 ?
+                            options->idle_timeout_ms : DEFAULT_IDLE_TIMEOUT_MS;
+    pool->scale_up_wait_ns = (uint64_t)(options->scale_up_wait_us > 0 ?
+                             options->scale_up_wait_us : DEFAULT_SCALE_UP_WAIT_US) * 1000ULL;
+    pool->scale_up_queue_per_thread = options->scale_up_queue_per_thread > 0 ?
+                                      options->scale_up_queue_per_thread :
+                                      DEFAULT_SCALE_UP_QUEUE_PER_THREAD;
+    atomic_init(&pool->queue_bitmap, 0);
+    pool->priority_aging_ms = options->priority_aging_ms;
     
-    // Инициализация мьютекса и условной переменной
-    if (pthread_mutex_init(&pool->lock, NULL) != 0) {
+    // Инициализация мьютекса
+    if (thread_pool_mutex_init(&pool->lock) != 0) {
         free(pool);
         thread_pool_error("Не удалось инициализировать мьютекс");
         return NULL;
     }
     
-    if (pthread_cond_init(&pool->notify, NULL) != 0) {
-        pthread_mutex_destroy(&pool->lock);
+    // Блокировка таймеров; колесо и поток таймеров создаются при первом
+    // thread_pool_schedule_*
+    if (thread_pool_mutex_init(&pool->timer_lock) != 0) {
+        thread_pool_mutex_destroy(&pool->lock);
         free(pool);
-        thread_pool_error("Не удалось инициализировать условную переменную");
+        thread_pool_error("Не удалось инициализировать мьютекс таймеров");
+        return NULL;
+    }
+    if (thread_pool_cond_init(&pool->timer_notify) != 0) {
+        thread_pool_mutex_destroy(&pool->timer_lock);
+        thread_pool_mutex_destroy(&pool->lock);
+        free(pool);
+        thread_pool_error("Не удалось инициализировать условную переменную таймеров");
+        return NULL;
+    }
+    
+    // Топология нужна только для закрепления потоков
+    numa_topology_t* topo = NULL;
+    if ((options->cpus != NULL && options->num_cpus > 0) || options->numa_spread) {
+        topo = (numa_topology_t*)malloc(sizeof(numa_topology_t));
+        if (!topo || numa_topology_load(topo) != 0) {
+            free(topo);
+            thread_pool_free(pool);
+            thread_pool_error("Не удалось прочитать топологию процессоров");
+            return NULL;
+        }
+        
+        pool->cpu_map_size = topo->num_cpus;
+        pool->cpu_node = (short*)malloc(sizeof(short) * topo->num_cpus);
+        if (pool->cpu_node) {
+            memcpy(pool->cpu_node, topo->cpu_node, sizeof(short) * topo->num_cpus);
+        }
+    }
+    int num_nodes = topo ? topo->num_nodes : 1;
+    
+    // Очереди узлов (ожидание на notify идет по CLOCK_MONOTONIC)
+    pool->nodes = (thread_pool_node_t*)calloc(num_nodes, sizeof(thread_pool_node_t));
+    if (pool->nodes) {
+        while (pool->num_nodes < num_nodes &&
+               thread_pool_cond_init(&pool->nodes[pool->num_nodes].notify) == 0) {
+            pool->num_nodes++;
+        }
+    }
+    if (!pool->nodes || pool->num_nodes < num_nodes || (topo && !pool->cpu_node)) {
+        free(topo);
+        thread_pool_free(pool);
+        thread_pool_error("Не удалось инициализировать очереди пула");
+        return NULL;
+    }
+    
+    // Пулы переиспользуемых узлов задач, по одному в памяти каждого узла
+    int slab_capacity = options->task_slab_capacity;
+    if (slab_capacity == 0) slab_capacity = TASK_SLAB_DEFAULT_CAPACITY;
+    if (slab_capacity < 0) slab_capacity = 0;
+    
+    pool->task_slabs = (task_slab_t*)aligned_alloc(64, sizeof(task_slab_t) * num_nodes);
+    bool slabs_ok = pool->task_slabs != NULL;
+    if (slabs_ok) {
+        memset(pool->task_slabs, 0, sizeof(task_slab_t) * num_nodes);
+    }
+    for (int i = 0; i < num_nodes && slabs_ok; i++) {
+        slabs_ok = task_slab_init(&pool->task_slabs[i], (size_t)slab_capacity,
+                                  options->task_slab_huge_pages,
+                                  topo ? topo->node_id[i] : -1) == 0;
+    }
+    if (!slabs_ok) {
+        free(topo);
+        thread_pool_free(pool);
+        thread_pool_error("Не удалось выделить пул узлов задач");
         return NULL;
     }
     
-    // Выделение памяти для потоков
-    pool->threads = (pthread_t*)malloc(sizeof(pthread_t) * num_threads);
+    // Слоты под все потоки, которые могут понадобиться
+    pool->threads = (pthread_t*)malloc(sizeof(pthread_t) * max_threads);
     if (!pool->threads) {
-        pthread_mutex_destroy(&pool->lock);
-        pthread_cond_destroy(&pool->notify);
-        free(pool);
+        free(topo);
+        thread_pool_free(pool);
         thread_pool_error("Не удалось выделить память для потоков");
         return NULL;
     }
     
+    // Состояние потоков выравнивается по кэш-линии, чтобы деки не делили линии
+    void* workers = NULL;
+    if (posix_memalign(&workers, 64, sizeof(thread_pool_worker_t) * max_threads) != 0) {
+        free(topo);
+        thread_pool_free(pool);
+        thread_pool_error("Не удалось выделить память для состояния потоков");
+        return NULL;
+    }
+    pool->workers = (thread_pool_worker_t*)workers;
+    
+    for (int i = 0; i < max_threads; i++) {
+        thread_pool_worker_t* worker = &pool->workers[i];
+        ws_deque_init(&worker->deque);
+        worker->pool = pool;
+        worker->index = i;
+        worker->rng = 2463534242u + (unsigned int)i * 2654435761u;
+        worker->tick = 0;
+        task_slab_cache_init(&worker->task_cache);
+        worker->state = WORKER_EMPTY;
+        worker->cpu = -1;
+        worker->node = 0;
+        worker->stack = NULL;
+        worker->stack_size = 0;
+        memset(&worker->stats, 0, sizeof(worker->stats));
+    }
+    
+    if (topo) {
+        int rc = thread_pool_place_workers(pool, options, topo);
+        free(topo);
+        if (rc != 0) {
+            thread_pool_free(pool);
+            return NULL;
+        }
+    }
+    
+    // Кольца трассировки создаются до потоков, чтобы первые события не терялись
+    if (options->trace_events > 0 && thread_pool_trace_start(pool, options->trace_events) != 0) {
+        thread_pool_error("Не удалось выделить кольца трассировки");
+        thread_pool_free(pool);
+        return NULL;
+    }
+    
     // Создание потоков
+    thread_pool_mutex_lock(&pool->lock);
     for (int i = 0; i < num_threads; i++) {
-        if (pthread_create(&pool->threads[i], NULL, thread_pool_worker, pool) != 0) {
+        if (thread_pool_start_worker_locked(pool) < 0) {
             // В случае ошибки, завершаем уже созданные потоки
             pool->shutdown = true;
-            pthread_cond_broadcast(&pool->notify);
+            thread_pool_wake_all(pool);
+            thread_pool_mutex_unlock(&pool->lock);
             
-            for (int j = 0; j < i; j++) {
-                pthread_join(pool->threads[j], NULL);
+            for (int j = 0; j < max_threads; j++) {
+                if (pool->workers[j].state != WORKER_EMPTY) {
+                    pthread_join(pool->threads[j], NULL);
+                }
             }
             
-            free(pool->threads);
-            pthread_mutex_destroy(&pool->lock);
-            pthread_cond_destroy(&pool->notify);
-            free(pool);
-            thread_pool_error("Не удалось создать поток");
+            thread_pool_free(pool);
             return NULL;
         }
     }
+    thread_pool_mutex_unlock(&pool->lock);
     
-    printf("Пул потоков создан с %d потоками\n", num_threads);
+    if (!pool->quiet) {
+        printf("Пул потоков создан с %d потоками%s\n", num_threads,
+               pool->work_stealing ? " (work-stealing)" : "");
+        if (pool->workers[0].cpu >= 0) {
+            printf("Потоки закреплены за CPU, NUMA-узлов: %d\n", pool->num_nodes);
+        }
+    }
     return pool;
 }
 
@@ -147,51 +1136,202 @@ thread_pool_t* thread_pool_create_advanced(int min_threads, int max_threads,
     if (max_threads <= min_threads) max_threads = min_threads * 2;
     if (max_threads > 64) max_threads = 64; // Ограничение для безопасности
     
-    thread_pool_t* pool = thread_pool_create(min_threads);
+    thread_pool_options_t options = {
+        .num_threads = min_threads,
+        .dynamic_scaling = dynamic_scaling,
+        .max_threads = max_threads,
+    };
+    thread_pool_t* pool = thread_pool_create_with_options(&options);
     if (!pool) return NULL;
     
-    pool->dynamic_scaling = dynamic_scaling;
-    pool->min_threads = min_threads;
-    pool->max_threads = max_threads;
-    
     printf("Расширенный пул потоков создан: %d-%d потоков, динамическое масштабирование: %s\n",
            min_threads, max_threads, dynamic_scaling ? "вкл" : "выкл");
     
     return pool;
 }
 
+// Постановка готового узла задачи в очередь уровня priority.
+// allow_local разрешает положить задачу в локальный дек текущего потока.
+static int thread_pool_submit(thread_pool_t* pool, task_t* task, int priority,
+                              bool allow_local) {
+    atomic_fetch_add_explicit(&pool->tasks_pending, 1, memory_order_relaxed);
+    task->enqueue_ns = thread_pool_now_ns();
+    // До постановки: после нее задача может выполниться и освободиться
+    thread_pool_trace(pool, TRACE_ENQUEUE, task, task->function, (uint32_t)priority);
+    
+    // Задача, созданная потоком этого же пула, кладется в его дек без блокировок
+    thread_pool_worker_t* self = current_worker;
+    if (allow_local && pool->work_stealing && self != NULL && self->pool == pool &&
+        ws_deque_push(&self->deque, task) == 0) {
+        atomic_thread_fence(memory_order_seq_cst);
+        if (atomic_load_explicit(&pool->idle_workers, memory_order_seq_cst) > 0) {
+            thread_pool_mutex_lock(&pool->lock);
+            thread_pool_wake_locked(pool, 1, self->node);
+            thread_pool_mutex_unlock(&pool->lock);
+        }
+        return 0;
+    }
+    
+    int home = thread_pool_home_node(pool);
+    thread_pool_mutex_lock(&pool->lock);
+    
+    // Добавление задачи в очередь своего узла
+    global_queue_push_locked(pool, task, priority, home);
+    
+    // Сигнал одному ожидающему потоку, по возможности того же узла
+    thread_pool_wake_locked(pool, 1, home);
+    thread_pool_maybe_grow_locked(pool, 0);
+    thread_pool_mutex_unlock(&pool->lock);
+    thread_pool_reap_exited(pool);
+    
+    return 0;
+}
+
 // Добавление задачи в пул
 int thread_pool_add_task(thread_pool_t* pool, void (*function)(void*), void* arg) {
     if (!pool || !function) {
         return -1;
     }
     
-    task_t* task = (task_t*)malloc(sizeof(task_t));
+    task_t* task = thread_pool_task_new(pool, function);
     if (!task) {
-        thread_pool_error("Не удалось выделить память для задачи");
         return -1;
     }
+    task->arg = arg;
     
-    task->function = function;
+    return thread_pool_submit(pool, task, THREAD_POOL_PRIORITY_NORMAL, true);
+}
+
+// Добавление задачи с приоритетом
+int thread_pool_add_task_with_priority(thread_pool_t* pool, 
+                                       void (*function)(void*), 
+                                       void* arg, 
+                                       int priority) {
+    if (!pool || !function) {
+        return -1;
+    }
+    
+    if (priority < THREAD_POOL_PRIORITY_MIN) priority = THREAD_POOL_PRIORITY_MIN;
+    if (priority > THREAD_POOL_PRIORITY_MAX) priority = THREAD_POOL_PRIORITY_MAX;
+    
+    task_t* task = thread_pool_task_new(pool, function);
+    if (!task) {
+        return -1;
+    }
     task->arg = arg;
-    task->next = NULL;
     
-    pthread_mutex_lock(&pool->lock);
+    return thread_pool_submit(pool, task, priority, false);
+}
+
+// Добавление задачи с копированием аргумента в узел задачи
+int thread_pool_add_task_copy(thread_pool_t* pool, void (*function)(void*),
+                              const void* arg, size_t arg_size) {
+    if (!pool || !function) {
+        return -1;
+    }
     
-    // Добавление задачи в очередь
-    if (pool->task_queue_tail) {
-        pool->task_queue_tail->next = task;
-        pool->task_queue_tail = task;
+    task_t* task = thread_pool_task_new(pool, function);
+    if (!task) {
+        return -1;
+    }
+    
+    if (arg_size <= THREAD_POOL_INLINE_ARG_SIZE) {
+        memcpy(task->inline_arg, arg, arg_size);
+        task->arg = task->inline_arg;
     } else {
-        pool->task_queue = task;
-        pool->task_queue_tail = task;
+        // Большой аргумент все-таки приходится копировать в кучу
+        task->arg = malloc(arg_size);
+        if (!task->arg) {
+            thread_pool_task_release(pool, task);
+            thread_pool_error("Не удалось выделить память для аргумента задачи");
+            return -1;
+        }
+        memcpy(task->arg, arg, arg_size);
+        task->flags |= TASK_FLAG_ARG_HEAP;
+    }
+    
+    return thread_pool_submit(pool, task, THREAD_POOL_PRIORITY_NORMAL, true);
+}
+
+// Пакетное добавление задач
+int thread_pool_add_tasks(thread_pool_t* pool, void (*function)(void*),
+                          void* const* args, int count) {
+    if (!pool || !function || count < 0 || (count > 0 && !args)) {
+        return -1;
     }
+    if (count == 0) {
+        return 0;
+    }
+    
+    // Узлы выделяются и связываются в цепочку до захвата блокировки
+    task_t* head = NULL;
+    task_t* tail = NULL;
+    for (int i = 0; i < count; i++) {
+        task_t* task = thread_pool_task_new(pool, function);
+        if (!task) {
+            while (head != NULL) {
+                task_t* next = head->next;
+                thread_pool_task_release(pool, head);
+                head = next;
+            }
+            return -1;
+        }
+        task->arg = args[i];
+        
+        if (tail) {
+            tail->next = task;
+        } else {
+            head = task;
+        }
+        tail = task;
+    }
+    
+    atomic_fetch_add_explicit(&pool->tasks_pending, count, memory_order_relaxed);
     
-    pool->queue_size++;
+    uint64_t now = thread_pool_now_ns();
+    for (task_t* task = head; task != NULL; task = task->next) {
+        task->enqueue_ns = now;
+    }
+    if (__builtin_expect(atomic_load_explicit(&pool->trace_enabled, memory_order_acquire), 0)) {
+        for (task_t* task = head; task != NULL; task = task->next) {
+            thread_pool_trace_record(pool, TRACE_ENQUEUE, task, function,
+                                     THREAD_POOL_PRIORITY_NORMAL);
+        }
+    }
     
-    // Сигнал одному ожидающему потоку
-    pthread_cond_signal(&pool->notify);
-    pthread_mutex_unlock(&pool->lock);
+    // Поток этого же пула сначала заполняет свой дек
+    thread_pool_worker_t* self = current_worker;
+    int remaining = count;
+    if (pool->work_stealing && self != NULL && self->pool == pool) {
+        while (head != NULL && ws_deque_push(&self->deque, head) == 0) {
+            head = head->next;
+            remaining--;
+        }
+        
+        if (head == NULL) {
+            // Себя будить не нужно: одну задачу выполнит текущий поток
+            atomic_thread_fence(memory_order_seq_cst);
+            if (count > 1 &&
+                atomic_load_explicit(&pool->idle_workers, memory_order_seq_cst) > 0) {
+                thread_pool_mutex_lock(&pool->lock);
+                thread_pool_wake_locked(pool, count - 1, self->node);
+                thread_pool_mutex_unlock(&pool->lock);
+            }
+            return 0;
+        }
+    }
+    
+    int home = thread_pool_home_node(pool);
+    thread_pool_mutex_lock(&pool->lock);
+    
+    // Присоединяем всю цепочку к хвосту глобальной очереди своего узла
+    global_queue_push_chain_locked(pool, head, tail, remaining, THREAD_POOL_PRIORITY_NORMAL,
+                                   home);
+    
+    thread_pool_wake_locked(pool, count, home);
+    thread_pool_maybe_grow_locked(pool, 0);
+    thread_pool_mutex_unlock(&pool->lock);
+    thread_pool_reap_exited(pool);
     
     return 0;
 }
@@ -200,68 +1340,514 @@ int thread_pool_add_task(thread_pool_t* pool, void (*function)(void*), void* arg
 int thread_pool_wait(thread_pool_t* pool) {
     if (!pool) return -1;
     
-    // Ожидаем, пока очередь не опустеет и все потоки не освободятся
-    while (true) {
-        pthread_mutex_lock(&pool->lock);
-        int queue_empty = (pool->queue_size == 0);
-        int all_idle = (pool->count == 0);
-        pthread_mutex_unlock(&pool->lock);
+    // Сначала регистрируемся, затем читаем счетчик: поток, завершивший
+    // последнюю задачу, либо увидит нас и разбудит, либо мы увидим ноль
+    atomic_fetch_add_explicit(&pool->pending_waiters, 1, memory_order_seq_cst);
+    
+    int pending;
+    while ((pending = atomic_load_explicit(&pool->tasks_pending, memory_order_seq_cst)) > 0) {
+        futex_wait(&pool->tasks_pending, (uint32_t)pending, NULL, false);
+    }
+    
+    atomic_fetch_sub_explicit(&pool->pending_waiters, 1, memory_order_relaxed);
+    return 0;
+}
+
+// Текущий тик таймеров пула
+static uint64_t thread_pool_timer_now(thread_pool_t* pool) {
+    return (thread_pool_now_ns() - pool->timer_base_ns) / (THREAD_POOL_TIMER_TICK_MS * 1000000ULL);
+}
+
+// Сработавшие таймеры, собранные под timer_lock
+typedef struct {
+    void (*functions[TIMER_FIRE_BATCH])(void*);
+    void* args[TIMER_FIRE_BATCH];
+    int count;
+} thread_pool_timer_batch_t;
+
+static void thread_pool_timer_collect(void* ctx, void (*function)(void*), void* arg) {
+    thread_pool_timer_batch_t* batch = (thread_pool_timer_batch_t*)ctx;
+    batch->functions[batch->count] = function;
+    batch->args[batch->count] = arg;
+    batch->count++;
+}
+
+// Поток таймеров: продвигает колесо, ставит наступившие задачи в
+// очередь (уже без timer_lock) и спит до следующего срока или каскада
+static void* thread_pool_timer_thread(void* arg) {
+    thread_pool_t* pool = (thread_pool_t*)arg;
+    thread_pool_timer_batch_t batch;
+    
+    thread_pool_mutex_lock(&pool->timer_lock);
+    while (!pool->timer_stop) {
+        uint64_t now = thread_pool_timer_now(pool);
+        batch.count = 0;
+        timer_wheel_advance(pool->timers, now, TIMER_FIRE_BATCH,
+                            thread_pool_timer_collect, &batch);
+        if (batch.count > 0) {
+            thread_pool_mutex_unlock(&pool->timer_lock);
+            for (int i = 0; i < batch.count; i++) {
+                if (thread_pool_add_task(pool, batch.functions[i], batch.args[i]) != 0) {
+                    thread_pool_error("Не удалось поставить в очередь отложенную задачу");
+                }
+            }
+            thread_pool_mutex_lock(&pool->timer_lock);
+            continue;
+        }
         
-        if (queue_empty && all_idle) {
-            break;
+        // Постановка более раннего срока будит поток (см. thread_pool_timer_add)
+        uint64_t next = timer_wheel_next_tick(pool->timers);
+        pool->timer_wake_tick = next;
+        if (next == UINT64_MAX) {
+            thread_pool_cond_wait(&pool->timer_notify, &pool->timer_lock);
+        } else if (next > now) {
+            uint64_t deadline_ns = pool->timer_base_ns +
+                                   next * THREAD_POOL_TIMER_TICK_MS * 1000000ULL;
+            struct timespec deadline = {
+                .tv_sec = (time_t)(deadline_ns / 1000000000ULL),
+                .tv_nsec = (long)(deadline_ns % 1000000000ULL),
+            };
+            thread_pool_cond_timedwait(&pool->timer_notify, &pool->timer_lock, &deadline);
+        }
+        pool->timer_wake_tick = 0;
+    }
+    thread_pool_mutex_unlock(&pool->timer_lock);
+    return NULL;
+}
+
+// Колесо и поток таймеров при первом обращении (под timer_lock)
+static int thread_pool_timer_start_locked(thread_pool_t* pool) {
+    if (pool->timers) {
+        return 0;
+    }
+    timer_wheel_t* wheel = (timer_wheel_t*)malloc(sizeof(timer_wheel_t));
+    if (!wheel) {
+        thread_pool_error("Не удалось выделить память для колеса таймеров");
+        return -1;
+    }
+    pool->timer_base_ns = thread_pool_now_ns();
+    timer_wheel_init(wheel, 0);
+    pool->timers = wheel;
+    pool->timer_wake_tick = 0;
+    if (pthread_create(&pool->timer_thread, NULL, thread_pool_timer_thread, pool) != 0) {
+        timer_wheel_destroy(wheel);
+        free(wheel);
+        pool->timers = NULL;
+        thread_pool_error("Не удалось создать поток таймеров");
+        return -1;
+    }
+    return 0;
+}
+
+static thread_pool_timer_t thread_pool_timer_add(thread_pool_t* pool, uint64_t delay_ms,
+                                                 uint64_t period_ms, void (*function)(void*),
+                                                 void* arg) {
+    if (!pool || !function) {
+        return 0;
+    }
+    
+    thread_pool_mutex_lock(&pool->timer_lock);
+    if (pool->timer_stop || thread_pool_timer_start_locked(pool) != 0) {
+        thread_pool_mutex_unlock(&pool->timer_lock);
+        return 0;
+    }
+    // Срок округляется вверх до тика: задача не срабатывает раньше
+    uint64_t tick_ns = THREAD_POOL_TIMER_TICK_MS * 1000000ULL;
+    uint64_t due_ns = thread_pool_now_ns() - pool->timer_base_ns + delay_ms * 1000000ULL;
+    uint64_t expires = (due_ns + tick_ns - 1) / tick_ns;
+    uint64_t period = (period_ms + THREAD_POOL_TIMER_TICK_MS - 1) / THREAD_POOL_TIMER_TICK_MS;
+    
+    thread_pool_timer_t timer = timer_wheel_add(pool->timers, expires, period, function, arg);
+    if (timer == 0) {
+        thread_pool_error("Не удалось выделить память для таймера");
+    } else if (expires < pool->timer_wake_tick) {
+        // Поток таймеров спит дольше, чем нужно этой задаче; пока он не
+        // спит (timer_wake_tick == 0), он сам пересчитает срок
+        pool->timer_wake_tick = expires;
+        thread_pool_cond_signal(&pool->timer_notify);
+    }
+    thread_pool_mutex_unlock(&pool->timer_lock);
+    return timer;
+}
+
+// Отложенная задача
+thread_pool_timer_t thread_pool_schedule_after(thread_pool_t* pool, uint64_t delay_ms,
+                                               void (*function)(void*), void* arg) {
+    return thread_pool_timer_add(pool, delay_ms, 0, function, arg);
+}
+
+// Периодическая задача
+thread_pool_timer_t thread_pool_schedule_every(thread_pool_t* pool, uint64_t period_ms,
+                                               void (*function)(void*), void* arg) {
+    if (period_ms == 0) {
+        thread_pool_error("Период задачи должен быть больше нуля");
+        return 0;
+    }
+    return thread_pool_timer_add(pool, period_ms, period_ms, function, arg);
+}
+
+// Отмена отложенной задачи
+int thread_pool_timer_cancel(thread_pool_t* pool, thread_pool_timer_t timer) {
+    if (!pool || timer == 0) return -1;
+    
+    thread_pool_mutex_lock(&pool->timer_lock);
+    bool cancelled = pool->timers && timer_wheel_cancel(pool->timers, timer);
+    thread_pool_mutex_unlock(&pool->timer_lock);
+    return cancelled ? 0 : -1;
+}
+
+// Создание группы для задач пула
+thread_pool_group_t* thread_pool_group_create(thread_pool_t* pool) {
+    if (!pool) return NULL;
+    
+    thread_pool_group_t* group = (thread_pool_group_t*)malloc(sizeof(thread_pool_group_t));
+    if (!group) {
+        thread_pool_error("Не удалось выделить память для группы задач");
+        return NULL;
+    }
+    
+    group->pool = pool;
+    atomic_init(&group->state, 0);
+    return group;
+}
+
+// Уничтожение группы
+int thread_pool_group_destroy(thread_pool_group_t* group) {
+    if (!group) return -1;
+    
+    if (thread_pool_group_pending(group) != 0) {
+        thread_pool_error("Уничтожение группы с незавершенными задачами");
+        return -1;
+    }
+    
+    free(group);
+    return 0;
+}
+
+// Добавление задачи в пул в составе группы
+int thread_pool_group_add_task(thread_pool_group_t* group, void (*function)(void*), void* arg) {
+    if (!group || !function) {
+        return -1;
+    }
+    
+    thread_pool_t* pool = group->pool;
+    task_t* task = thread_pool_task_new(pool, function);
+    if (!task) {
+        return -1;
+    }
+    task->arg = arg;
+    task->group = group;
+    
+    atomic_fetch_add_explicit(&group->state, 1, memory_order_relaxed);
+    return thread_pool_submit(pool, task, THREAD_POOL_PRIORITY_NORMAL, true);
+}
+
+// Количество незавершенных задач группы
+int thread_pool_group_pending(thread_pool_group_t* group) {
+    if (!group) return -1;
+    return (int)(atomic_load_explicit(&group->state, memory_order_acquire) & GROUP_COUNT_MASK);
+}
+
+// Ожидание обнуления счетчика группы до момента deadline (NULL — без ограничения)
+static int thread_pool_group_wait_until(thread_pool_group_t* group,
+                                        const struct timespec* deadline) {
+    uint32_t state = atomic_load_explicit(&group->state, memory_order_acquire);
+    
+    while ((state & GROUP_COUNT_MASK) != 0) {
+        // Помечаем, что на слове спят, чтобы завершение последней задачи
+        // вызвало futex_wake; без ожидающих завершение обходится без syscall
+        if (!(state & GROUP_WAITING)) {
+            if (!atomic_compare_exchange_weak_explicit(&group->state, &state,
+                                                       state | GROUP_WAITING,
+                                                       memory_order_acquire,
+                                                       memory_order_acquire)) {
+                continue;
+            }
+            state |= GROUP_WAITING;
         }
         
-        usleep(10000); // 10 мс задержка
+        if (futex_wait(&group->state, state, deadline, false) == ETIMEDOUT) {
+            return ETIMEDOUT;
+        }
+        state = atomic_load_explicit(&group->state, memory_order_acquire);
     }
     
+    // Снимаем флаг, если в группу не успели добавить новых задач
+    if (state == GROUP_WAITING) {
+        atomic_compare_exchange_strong_explicit(&group->state, &state, 0,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed);
+    }
     return 0;
 }
 
+// Ожидание завершения всех задач группы
+int thread_pool_group_wait(thread_pool_group_t* group) {
+    if (!group) return -1;
+    return thread_pool_group_wait_until(group, NULL);
+}
+
+// Ожидание с тайм-аутом
+int thread_pool_group_timedwait(thread_pool_group_t* group, int timeout_ms) {
+    if (!group) return -1;
+    if (timeout_ms < 0) return thread_pool_group_wait_until(group, NULL);
+    
+    struct timespec deadline = futex_deadline_ms(timeout_ms);
+    return thread_pool_group_wait_until(group, &deadline);
+}
+
+// Ожидание завершения хотя бы одной из групп
+int thread_pool_group_wait_any(thread_pool_group_t* const* groups, int count, int timeout_ms) {
+    if (!groups || count <= 0 || !groups[0]) return -1;
+    
+    thread_pool_t* pool = groups[0]->pool;
+    struct timespec deadline;
+    if (timeout_ms >= 0) {
+        deadline = futex_deadline_ms(timeout_ms);
+    }
+    
+    // Группы могут завершаться в разных потоках, поэтому ждем на общем
+    // для пула счетчике эпох, который увеличивается при завершении любой
+    // группы, пока есть хоть один ожидающий в wait_any
+    atomic_fetch_add_explicit(&pool->group_epoch_waiters, 1, memory_order_seq_cst);
+    
+    int found = -1;
+    while (true) {
+        uint32_t epoch = atomic_load_explicit(&pool->group_epoch, memory_order_seq_cst);
+        
+        for (int i = 0; i < count; i++) {
+            uint32_t state = atomic_load_explicit(&groups[i]->state, memory_order_seq_cst);
+            if ((state & GROUP_COUNT_MASK) == 0) {
+                found = i;
+                break;
+            }
+        }
+        if (found >= 0) break;
+        
+        if (futex_wait(&pool->group_epoch, epoch, timeout_ms >= 0 ? &deadline : NULL,
+                       false) == ETIMEDOUT) {
+            break;
+        }
+    }
+    
+    atomic_fetch_sub_explicit(&pool->group_epoch_waiters, 1, memory_order_relaxed);
+    return found;
+}
+
 // Уничтожение пула потоков
 int thread_pool_destroy(thread_pool_t* pool) {
     if (!pool) return -1;
     
-    pthread_mutex_lock(&pool->lock);
+    // Поток таймеров останавливается первым: несработавшие задачи
+    // отбрасываются, новые в очередь не попадут
+    thread_pool_mutex_lock(&pool->timer_lock);
+    pool->timer_stop = true;
+    bool timer_started = pool->timers != NULL;
+    thread_pool_cond_signal(&pool->timer_notify);
+    thread_pool_mutex_unlock(&pool->timer_lock);
+    if (timer_started) {
+        pthread_join(pool->timer_thread, NULL);
+    }
+    
+    thread_pool_mutex_lock(&pool->lock);
     pool->shutdown = true;
-    pthread_mutex_unlock(&pool->lock);
     
     // Сигнал всем потокам
-    pthread_cond_broadcast(&pool->notify);
+    thread_pool_wake_all(pool);
+    thread_pool_mutex_unlock(&pool->lock);
     
-    // Ожидание завершения всех потоков
-    for (int i = 0; i < pool->thread_count; i++) {
-        pthread_join(pool->threads[i], NULL);
+    // Ожидание завершения работающих потоков. После установки shutdown
+    // потоки не запускаются и не завершаются из-за простоя, но рабочий
+    // поток еще может присоединять слот из WORKER_EXITED, поэтому такие
+    // слоты обходятся вторым проходом, когда рабочих потоков уже нет.
+    for (int i = 0; i < pool->max_threads; i++) {
+        thread_pool_mutex_lock(&pool->lock);
+        bool running = pool->workers[i].state == WORKER_RUNNING;
+        thread_pool_mutex_unlock(&pool->lock);
+        if (running) {
+            pthread_join(pool->threads[i], NULL);
+            thread_pool_mutex_lock(&pool->lock);
+            pool->workers[i].state = WORKER_EMPTY;
+            thread_pool_mutex_unlock(&pool->lock);
+        }
+    }
+    for (int i = 0; i < pool->max_threads; i++) {
+        if (pool->workers[i].state == WORKER_EXITED) {
+            pthread_join(pool->threads[i], NULL);
+            pool->workers[i].state = WORKER_EMPTY;
+        }
     }
     
     // Освобождение оставшихся задач в очереди
     task_t* task;
-    while (pool->task_queue != NULL) {
-        task = pool->task_queue;
-        pool->task_queue = pool->task_queue->next;
-        free(task);
+    for (int node = 0; node < pool->num_nodes; node++) {
+        for (int level = 0; level < THREAD_POOL_PRIORITY_LEVELS; level++) {
+            task_queue_t* queue = &pool->nodes[node].queues[level];
+            while (queue->head != NULL) {
+                task = queue->head;
+                queue->head = task->next;
+                thread_pool_task_release(pool, task);
+            }
+        }
+    }
+    
+    for (int i = 0; i < pool->max_threads; i++) {
+        while ((task = (task_t*)ws_deque_pop(&pool->workers[i].deque)) != NULL) {
+            thread_pool_task_release(pool, task);
+        }
     }
     
     // Освобождение ресурсов
-    free(pool->threads);
-    pthread_mutex_destroy(&pool->lock);
-    pthread_cond_destroy(&pool->notify);
-    free(pool);
+    bool quiet = pool->quiet;
+    thread_pool_free(pool);
     
-    printf("Пул потоков уничтожен\n");
+    if (!quiet) {
+        printf("Пул потоков уничтожен\n");
+    }
     return 0;
 }
 
 // Получение статистики пула
+// Сводка по гистограмме
+static void thread_pool_latency_summary(const latency_histogram_t* h,
+                                        thread_pool_latency_stats_t* out) {
+    out->count = latency_counter_get(&h->count);
+    out->avg_ns = latency_histogram_mean(h);
+    out->p50_ns = latency_histogram_percentile(h, 0.50);
+    out->p99_ns = latency_histogram_percentile(h, 0.99);
+    out->p999_ns = latency_histogram_percentile(h, 0.999);
+    out->max_ns = latency_counter_get(&h->max_ns);
+}
+
 thread_pool_stats_t thread_pool_get_stats(thread_pool_t* pool) {
     thread_pool_stats_t stats = {0};
     
     if (!pool) return stats;
     
-    pthread_mutex_lock(&pool->lock);
-    stats.active_threads = pool->count;
-    stats.queued_tasks = pool->queue_size;
-    stats.current_queue_size = pool->queue_size;
-    pthread_mutex_unlock(&pool->lock);
+    stats.active_threads = atomic_load_explicit(&pool->count, memory_order_relaxed);
+    stats.live_threads = atomic_load_explicit(&pool->thread_count, memory_order_relaxed);
+    stats.threads_started = atomic_load_explicit(&pool->threads_started, memory_order_relaxed);
+    stats.threads_retired = atomic_load_explicit(&pool->threads_retired, memory_order_relaxed);
+    
+    for (int level = 0; level < THREAD_POOL_PRIORITY_LEVELS; level++) {
+        thread_pool_priority_counters_t* counters = &pool->priority_counters[level];
+        thread_pool_priority_stats_t* out = &stats.priority[level];
+        
+        // Оба счетчика только растут: dequeued читаем первым, чтобы
+        // разность не оказалась отрицательной
+        out->dequeued = latency_counter_get(&counters->dequeued);
+        out->submitted = latency_counter_get(&counters->submitted);
+        out->aged = latency_counter_get(&counters->aged);
+        out->queued = (int)(out->submitted - out->dequeued);
+        out->wait_avg_ns = latency_histogram_mean(&counters->wait);
+        out->wait_p50_ns = latency_histogram_percentile(&counters->wait, 0.50);
+        out->wait_p99_ns = latency_histogram_percentile(&counters->wait, 0.99);
+        out->wait_p999_ns = latency_histogram_percentile(&counters->wait, 0.999);
+        out->wait_max_ns = latency_counter_get(&counters->wait.max_ns);
+        
+        stats.current_queue_size += out->queued;
+    }
+    stats.queued_tasks = stats.current_queue_size;
+    
+    // Счетчики потоков суммируются только при чтении. Сводные гистограммы
+    // (около 4 КБ) лежат на стеке: опрос статистики не выделяет память.
+    latency_histogram_t queue_wait;
+    latency_histogram_t exec;
+    memset(&queue_wait, 0, sizeof(queue_wait));
+    memset(&exec, 0, sizeof(exec));
+    for (int i = 0; i < pool->max_threads; i++) {
+        thread_pool_worker_stats_t* ws = &pool->workers[i].stats;
+        stats.total_tasks_completed += latency_counter_get(&ws->tasks_run);
+        stats.total_steals += latency_counter_get(&ws->steals);
+        stats.busy_ns += latency_counter_get(&ws->busy_ns);
+        stats.idle_ns += latency_counter_get(&ws->idle_ns);
+        latency_histogram_merge(&queue_wait, &ws->queue_wait);
+        latency_histogram_merge(&exec, &ws->exec);
+    }
+    thread_pool_latency_summary(&queue_wait, &stats.queue_wait);
+    thread_pool_latency_summary(&exec, &stats.exec);
+    
+    // Задачи в локальных деках тоже ждут выполнения
+    if (pool->work_stealing) {
+        for (int i = 0; i < pool->max_threads; i++) {
+            stats.queued_tasks += (int)ws_deque_size(&pool->workers[i].deque);
+        }
+    }
+    
+    // Заполненность пула узлов: сумма выделений минус сумма освобождений
+    // (узел может выделяться в одном пуле, а освобождаться в другом,
+    // поэтому считается только сумма по всем узлам NUMA)
+    long in_use = 0;
+    for (int i = 0; i < pool->num_nodes; i++) {
+        task_slab_t* slab = &pool->task_slabs[i];
+        in_use += atomic_load_explicit(&slab->shared_allocs, memory_order_relaxed) -
+                  atomic_load_explicit(&slab->shared_frees, memory_order_relaxed);
+        stats.task_slab_capacity += (int)slab->capacity;
+        stats.task_heap_allocs += atomic_load_explicit(&slab->heap_allocs, memory_order_relaxed);
+    }
+    for (int i = 0; i < pool->max_threads; i++) {
+        task_slab_cache_t* cache = &pool->workers[i].task_cache;
+        in_use += atomic_load_explicit(&cache->allocs, memory_order_relaxed) -
+                  atomic_load_explicit(&cache->frees, memory_order_relaxed);
+    }
+    stats.task_slab_in_use = in_use > 0 ? (int)in_use : 0;
     
     return stats;
 }
+
+// Строка сводки задержек в микросекундах
+static void thread_pool_dump_latency(FILE* out, const char* name,
+                                     const thread_pool_latency_stats_t* l) {
+    fprintf(out, "  %s: avg %.1f, p50 %.1f, p99 %.1f, p999 %.1f, max %.1f мкс\n",
+            name, l->avg_ns / 1e3, l->p50_ns / 1e3, l->p99_ns / 1e3,
+            l->p999_ns / 1e3, l->max_ns / 1e3);
+}
+
+void thread_pool_dump_stats(thread_pool_t* pool, FILE* out) {
+    if (!pool) return;
+    if (!out) out = stdout;
+    
+    thread_pool_stats_t stats = thread_pool_get_stats(pool);
+    uint64_t total_ns = stats.busy_ns + stats.idle_ns;
+    
+    fprintf(out, "Пул потоков: потоков %d (запущено %d, завершено %d), выполняется %d, "
+                 "в очереди %d\n",
+            stats.live_threads, stats.threads_started, stats.threads_retired,
+            stats.active_threads, stats.queued_tasks);
+    fprintf(out, "  Задач выполнено %llu, украдено %llu; занятость %.1f%% "
+                 "(работа %.1f мс, простой %.1f мс)\n",
+            (unsigned long long)stats.total_tasks_completed,
+            (unsigned long long)stats.total_steals,
+            total_ns ? 100.0 * (double)stats.busy_ns / (double)total_ns : 0.0,
+            stats.busy_ns / 1e6, stats.idle_ns / 1e6);
+    thread_pool_dump_latency(out, "ожидание в очереди", &stats.queue_wait);
+    thread_pool_dump_latency(out, "выполнение", &stats.exec);
+    
+    for (int i = 0; i < pool->max_threads; i++) {
+        thread_pool_worker_stats_t* ws = &pool->workers[i].stats;
+        uint64_t tasks = latency_counter_get(&ws->tasks_run);
+        if (tasks == 0 && latency_counter_get(&ws->idle_ns) == 0) continue;
+        
+        fprintf(out, "  поток %2d: задач %10llu, украдено %8llu, работа %10.1f мс, "
+                     "простой %10.1f мс, выполнение p99 %9.1f мкс",
+                i, (unsigned long long)tasks,
+                (unsigned long long)latency_counter_get(&ws->steals),
+                latency_counter_get(&ws->busy_ns) / 1e6,
+                latency_counter_get(&ws->idle_ns) / 1e6,
+                latency_histogram_percentile(&ws->exec, 0.99) / 1e3);
+        if (pool->workers[i].cpu >= 0) {
+            fprintf(out, ", CPU %d, узел %d", pool->workers[i].cpu, pool->workers[i].node);
+        }
+        fputc('\n', out);
+    }
+    
+    for (int level = THREAD_POOL_PRIORITY_LEVELS - 1; level >= 0; level--) {
+        thread_pool_priority_stats_t* p = &stats.priority[level];
+        if (p->submitted == 0) continue;
+        
+        fprintf(out, "  приоритет %d: поставлено %llu, состарено %llu, в очереди %d, "
+                     "ожидание p50 %.1f / p99 %.1f / p999 %.1f мкс\n",
+                level, (unsigned long long)p->submitted, (unsigned long long)p->aged,
+                p->queued, p->wait_p50_ns / 1e3, p->wait_p99_ns / 1e3, p->wait_p999_ns / 1e3);
+    }
+}
@@ -2,66 +2,387 @@
 #define THREAD_POOL_H
 
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "latency_histogram.h"
 
-// Структура задачи для пула потоков
+// Блокировка пула. По умолчанию pthread_mutex_t/pthread_cond_t; при сборке
+// с -DTHREAD_POOL_FUTEX_LOCK — мьютекс с адаптивным спином и условная
+// переменная с переносом ожидающих из multithreading/futex_lock.
+#ifdef THREAD_POOL_FUTEX_LOCK
+#include "../futex_lock/futex_lock.h"
+typedef futex_mutex_t thread_pool_mutex_t;
+typedef futex_cond_t thread_pool_cond_t;
+#else
+typedef pthread_mutex_t thread_pool_mutex_t;
+typedef pthread_cond_t thread_pool_cond_t;
+#endif
+
+// Уровни приоритета: чем больше число, тем раньше выполняется задача
+#define THREAD_POOL_PRIORITY_LEVELS 8
+#define THREAD_POOL_PRIORITY_MIN 0
+#define THREAD_POOL_PRIORITY_NORMAL 3   // Приоритет thread_pool_add_task
+#define THREAD_POOL_PRIORITY_MAX (THREAD_POOL_PRIORITY_LEVELS - 1)
+
+// Максимальный размер аргумента, копируемого прямо в узел задачи
+#define THREAD_POOL_INLINE_ARG_SIZE 64
+
+struct thread_pool_group;
+
+// Структура задачи для пула потоков (узел занимает две кэш-линии)
 typedef struct task {
     void (*function)(void*);  // Функция для выполнения
     void* arg;                // Аргумент функции
     struct task* next;        // Следующая задача в очереди
+    unsigned int flags;       // TASK_FLAG_* (см. task_slab.h)
+    _Atomic(unsigned int) slab_next; // Связь в списке свободных узлов
+    uint64_t enqueue_ns;      // Момент постановки в очередь (CLOCK_MONOTONIC)
+    struct thread_pool_group* group; // Группа, которой принадлежит задача
+    // Копия небольшого аргумента (thread_pool_add_task_copy)
+    _Alignas(64) unsigned char inline_arg[THREAD_POOL_INLINE_ARG_SIZE];
 } task_t;
 
+// Состояние рабочего потока (определено в thread_pool.c)
+struct thread_pool_worker;
+
+// Колесо таймеров отложенных задач (определено в timer_wheel.h)
+struct timer_wheel;
+
+// Пул узлов задач (определен в task_slab.h)
+struct task_slab;
+
+// FIFO-очередь одного уровня приоритета
+typedef struct {
+    task_t* head;
+    task_t* tail;
+    int size;
+} task_queue_t;
+
+// Счетчики одного уровня приоритета: пишутся под pool->lock,
+// читаются в thread_pool_get_stats без блокировки
+typedef struct {
+    _Atomic uint64_t submitted; // Поставлено в очередь
+    _Atomic uint64_t dequeued;  // Взято на выполнение
+    _Atomic uint64_t aged;      // Выбрано раньше более приоритетных из-за старения
+    latency_histogram_t wait; // Время ожидания в очереди
+} thread_pool_priority_counters_t;
+
+// Глобальные очереди одного NUMA-узла (все поля под pool->lock).
+// Задача, добавленная на узле N, попадает в очередь узла N, и потоки
+// этого узла берут ее раньше задач других узлов того же уровня.
+typedef struct {
+    task_queue_t queues[THREAD_POOL_PRIORITY_LEVELS]; // Очереди по приоритетам
+    unsigned int bitmap;      // Бит i установлен, если queues[i] не пуста
+    thread_pool_cond_t notify; // Здесь ждут простаивающие потоки узла
+    int idle;                 // Сколько потоков узла ждет на notify
+    int wakeups;              // Из них уже получили сигнал
+} thread_pool_node_t;
+
+// Хуки рабочих потоков: вызываются в самом потоке пула с аргументом ctx.
+// Любой из указателей может быть NULL. idle вызывается под блокировкой
+// пула, поэтому должен быть коротким и не обращаться к пулу.
+typedef struct {
+    void (*thread_start)(void* ctx);  // Поток запущен, до первой задачи
+    void (*thread_stop)(void* ctx);   // Поток завершается
+    void (*after_task)(void* ctx);    // После каждой задачи
+    void (*idle)(void* ctx, bool sleeping); // Поток засыпает без работы (true)
+                                            // и просыпается (false)
+    void* ctx;
+} thread_pool_hooks_t;
+
 // Структура пула потоков
 typedef struct {
-    pthread_mutex_t lock;     // Мьютекс для синхронизации
-    pthread_cond_t notify;    // Условная переменная для уведомлений
+    thread_pool_mutex_t lock; // Мьютекс для синхронизации
     
-    pthread_t* threads;       // Массив потоков
-    task_t* task_queue;       // Очередь задач (голова)
-    task_t* task_queue_tail;  // Хвост очереди задач
+    pthread_t* threads;       // Массив потоков (max_threads слотов)
+    struct thread_pool_worker* workers; // Состояние рабочих потоков
+    struct task_slab* task_slabs; // Переиспользуемые узлы задач, по пулу на узел
+    thread_pool_node_t* nodes; // Глобальные очереди по NUMA-узлам
+    int num_nodes;            // 1, если потоки не распределяются по узлам
+    short* cpu_node;          // Узел пула для каждого CPU (-1 — неизвестен)
+    int cpu_map_size;         // Размер cpu_node
+    atomic_uint queue_bitmap; // Объединение битовых масок всех узлов
+    int priority_aging_ms;    // Шаг старения (0 — без старения)
+    thread_pool_priority_counters_t priority_counters[THREAD_POOL_PRIORITY_LEVELS];
     
-    int thread_count;         // Количество потоков
-    int queue_size;           // Текущий размер очереди
-    int count;                // Количество активных потоков
+    atomic_int thread_count;  // Количество работающих потоков
+    int queue_size;           // Текущий размер глобальных очередей
+    atomic_int count;         // Количество активных потоков
+    atomic_int tasks_pending; // Добавленные, но еще не выполненные задачи
+                              // (слово futex для thread_pool_wait)
+    atomic_int pending_waiters; // Потоки в thread_pool_wait
+    _Atomic uint32_t group_epoch; // Растет при завершении группы (futex для wait_any)
+    atomic_int group_epoch_waiters; // Потоки в thread_pool_group_wait_any
+    atomic_int idle_workers;  // Потоки, ожидающие на notify
     bool shutdown;            // Флаг завершения работы
+    bool work_stealing;       // Локальные деки потоков и кража задач
+    bool quiet;               // Не печатать сообщения о создании и уничтожении
     bool dynamic_scaling;     // Динамическое масштабирование
     int min_threads;          // Минимальное количество потоков
     int max_threads;          // Максимальное количество потоков
+    int idle_timeout_ms;      // Простой, после которого лишний поток завершается
+    uint64_t scale_up_wait_ns; // Ожидание задачи в очереди, после которого
+                               // добавляется поток
+    int scale_up_queue_per_thread; // Очередь на поток, после которой
+                                   // добавляется поток
+    atomic_int threads_started; // Потоков запущено за все время
+    atomic_int threads_retired; // Потоков завершено из-за простоя
+    atomic_int threads_exited; // Из них еще не присоединены (WORKER_EXITED)
+    thread_pool_hooks_t hooks; // Хуки рабочих потоков
+    
+    // Отложенные и периодические задачи (все поля под timer_lock)
+    thread_pool_mutex_t timer_lock;
+    thread_pool_cond_t timer_notify; // Здесь спит поток таймеров
+    struct timer_wheel* timers; // NULL, пока ничего не запланировано
+    pthread_t timer_thread;   // Запускается вместе с колесом
+    uint64_t timer_base_ns;   // Момент нулевого тика (CLOCK_MONOTONIC)
+    uint64_t timer_wake_tick; // Тик, до которого спит поток таймеров
+                              // (0 — поток не спит)
+    bool timer_stop;
+    
+    // Трассировка (thread_pool_trace_start)
+    atomic_bool trace_enabled; // Проверяется в каждой точке трассировки
+    struct thread_pool_trace* trace; // Создается при первом включении,
+                                     // живет до thread_pool_destroy
 } thread_pool_t;
 
+// Параметры создания пула
+typedef struct {
+    int num_threads;          // Количество потоков (<= 0 — по умолчанию);
+                              // при динамическом масштабировании — минимум
+    bool work_stealing;       // Задачи, созданные внутри пула, идут в локальный дек
+                              // потока; внешние — в глобальную очередь
+    int task_slab_capacity;   // Узлов задач в пуле (0 — по умолчанию, < 0 — без пула)
+    bool task_slab_huge_pages; // Разместить узлы задач на huge pages
+    int priority_aging_ms;    // Каждые N мс ожидания поднимают задачу на уровень
+                              // приоритета при выборе, но не выше MAX - 1
+                              // (0 — без старения)
+    bool dynamic_scaling;     // Добавлять потоки под нагрузкой и убирать простаивающие
+    int max_threads;          // Верхняя граница числа потоков
+    int idle_timeout_ms;      // Простой до завершения лишнего потока (0 — 5000)
+    int scale_up_wait_us;     // Порог ожидания в очереди (0 — 1000)
+    int scale_up_queue_per_thread; // Порог длины очереди на поток (0 — 8)
+    const int* cpus;          // Закрепить слот i за CPU cpus[i % num_cpus]
+                              // (NULL — потоки не закрепляются)
+    int num_cpus;             // Длина массива cpus
+    bool numa_spread;         // Закрепить потоки по одному на ядро, поочередно
+                              // по NUMA-узлам из /sys/devices/system/node
+    bool quiet;               // Не печатать в stdout о создании и уничтожении пула
+    int trace_events;         // Сразу включить трассировку с кольцом на столько
+                              // событий на поток (0 — выключена)
+    thread_pool_hooks_t hooks; // Хуки рабочих потоков (например, rcu_pool_hooks)
+} thread_pool_options_t;
+
+// При cpus или numa_spread у каждого NUMA-узла своя очередь и свой пул
+// узлов задач (по task_slab_capacity на узел), а стеки закрепленных
+// потоков выделяются в памяти их узла.
+
 // Создание пула потоков
 thread_pool_t* thread_pool_create(int num_threads);
 
-// Расширенное создание пула с динамическим масштабированием
+// Создание пула потоков с параметрами
+thread_pool_t* thread_pool_create_with_options(const thread_pool_options_t* options);
+
+// Расширенное создание пула с динамическим масштабированием.
+// Пул стартует с min_threads потоков, добавляет их вплоть до max_threads,
+// когда задачи ждут в очереди дольше порога или очередь растет, и
+// завершает простаивающие потоки обратно до min_threads.
 thread_pool_t* thread_pool_create_advanced(int min_threads, int max_threads, 
                                            bool dynamic_scaling);
 
 // Добавление задачи в пул
 int thread_pool_add_task(thread_pool_t* pool, void (*function)(void*), void* arg);
 
-// Добавление задачи с приоритетом
+// Добавление задачи с копированием аргумента в узел задачи.
+// Функция получает указатель на копию, действительный до ее завершения.
+// Аргументы до THREAD_POOL_INLINE_ARG_SIZE байт не требуют выделения памяти.
+int thread_pool_add_task_copy(thread_pool_t* pool, void (*function)(void*),
+                              const void* arg, size_t arg_size);
+
+// Пакетное добавление count задач с общей функцией и своими аргументами.
+// Все задачи ставятся в очередь за одну блокировку, а будится не больше
+// потоков, чем есть задач в пакете.
+int thread_pool_add_tasks(thread_pool_t* pool, void (*function)(void*),
+                          void* const* args, int count);
+
+// Добавление задачи с приоритетом (THREAD_POOL_PRIORITY_MIN..MAX).
+// Такие задачи всегда идут в глобальные очереди, минуя локальные деки.
 int thread_pool_add_task_with_priority(thread_pool_t* pool, 
                                        void (*function)(void*), 
                                        void* arg, 
                                        int priority);
 
-// Ожидание завершения всех задач
+// Ожидание завершения всех задач. Поток спит на futex и просыпается
+// сразу после завершения последней задачи. Отложенные задачи
+// учитываются только с момента, когда срок наступил.
 int thread_pool_wait(thread_pool_t* pool);
 
+// Отложенные задачи. Сроки отсчитываются в тиках по
+// THREAD_POOL_TIMER_TICK_MS на иерархическом колесе таймеров
+// (timer_wheel.h): постановка и отмена — O(1) при любом числе
+// ожидающих задач. Один поток таймеров (запускается при первом вызове)
+// спит до ближайшего срока и ставит наступившие задачи в обычную
+// очередь пула; задача выполняется не раньше срока и обычно не позже
+// чем через тик после него.
+#define THREAD_POOL_TIMER_TICK_MS 1
+
+// Идентификатор отложенной задачи (0 — ошибка)
+typedef uint64_t thread_pool_timer_t;
+
+// Выполнить function(arg) через delay_ms
+thread_pool_timer_t thread_pool_schedule_after(thread_pool_t* pool, uint64_t delay_ms,
+                                               void (*function)(void*), void* arg);
+
+// Выполнять function(arg) каждые period_ms (первый раз — через period_ms).
+// Пропущенные периоды не наверстываются; если задача выполняется дольше
+// периода, следующий запуск может начаться раньше окончания предыдущего.
+thread_pool_timer_t thread_pool_schedule_every(thread_pool_t* pool, uint64_t period_ms,
+                                               void (*function)(void*), void* arg);
+
+// Отмена. Возвращает 0, если задача еще не была поставлена в очередь
+// (периодическая больше не запустится), или -1, если она уже сработала
+// или отменена. Уже поставленный в очередь запуск выполнится.
+int thread_pool_timer_cancel(thread_pool_t* pool, thread_pool_timer_t timer);
+
+// Параллельный цикл: body(ctx, lo, hi) для отрезков [lo, hi) из
+// [begin, end). Отрезки делятся лениво: вначале весь диапазон у
+// вызывающего потока, а освободившиеся участники забирают половину
+// невыполненного остатка у других, поэтому неравномерная по стоимости
+// работа распределяется сама. Вызывающий поток выполняет свою часть и
+// возвращается, когда выполнены все итерации. grain — длина отрезка:
+// отрезки начинаются с begin + k * grain, последний может быть короче
+// (<= 0 — подбирается по числу потоков). Можно вызывать из задач пула.
+// Возвращает 0 или -1.
+int thread_pool_parallel_for(thread_pool_t* pool, long begin, long end, long grain,
+                             void (*body)(void* ctx, long lo, long hi), void* ctx);
+
+// Параллельная свертка: у каждого участника своя частичная сумма
+// размера result_size, в начале равная *result (нейтральный элемент);
+// body добавляет в нее отрезок [lo, hi), а в конце частичные суммы
+// объединяются в *result через combine в произвольном порядке (операция
+// должна быть ассоциативной и коммутативной). Возвращает 0 или -1.
+int thread_pool_parallel_reduce(thread_pool_t* pool, long begin, long end, long grain,
+                                void (*body)(void* ctx, long lo, long hi, void* partial),
+                                void (*combine)(void* ctx, void* result, const void* partial),
+                                void* result, size_t result_size, void* ctx);
+
+// Трассировка. Каждый поток пишет события фиксированного размера
+// (постановка задачи в очередь, взятие, начало и конец выполнения,
+// засыпание и пробуждение рабочего потока) в свое кольцо без блокировок;
+// заполненное кольцо перезаписывает самые старые события. Время — такты
+// инвариантного TSC или CLOCK_MONOTONIC_RAW. Пока трассировка выключена,
+// каждая точка трассировки стоит одной проверки флага.
+#define THREAD_POOL_TRACE_DEFAULT_EVENTS 65536
+
+// Включение. events_per_thread — емкость кольца (<= 0 — по умолчанию;
+// округляется вверх до степени двойки), учитывается при первом
+// включении: кольца живут до уничтожения пула и сохраняют события
+// между stop и start. Возвращает 0 или -1 с errno.
+int thread_pool_trace_start(thread_pool_t* pool, int events_per_thread);
+
+// Выключение (уже записанные события остаются в кольцах)
+void thread_pool_trace_stop(thread_pool_t* pool);
+
+// Снимок колец в JSON формата Chrome trace (chrome://tracing,
+// ui.perfetto.dev): задачи — отрезки на своих потоках, связанные
+// стрелкой с моментом постановки в очередь. Можно вызывать во время
+// работы пула. Возвращает 0 или -1 с errno.
+int thread_pool_trace_write_json(thread_pool_t* pool, FILE* out);
+
+// Снимок колец в двоичный файл (быстрее JSON; преобразуется утилитой
+// trace_dump на той же архитектуре). Возвращает 0 или -1 с errno.
+int thread_pool_trace_save(thread_pool_t* pool, const char* path);
+
+// Преобразование двоичного файла thread_pool_trace_save в JSON.
+// Возвращает 0 или -1 с errno (EINVAL — не файл трассы).
+int thread_pool_trace_convert(FILE* in, FILE* out);
+
+// Группа задач: позволяет дождаться своего подмножества задач.
+// Группа из одной задачи — это future для этой задачи.
+typedef struct thread_pool_group {
+    thread_pool_t* pool;
+    _Atomic uint32_t state;   // Незавершенные задачи | GROUP_WAITING (слово futex)
+} thread_pool_group_t;
+
+// Создание группы для задач пула
+thread_pool_group_t* thread_pool_group_create(thread_pool_t* pool);
+
+// Уничтожение группы (в ней не должно быть незавершенных задач)
+int thread_pool_group_destroy(thread_pool_group_t* group);
+
+// Добавление задачи в пул в составе группы
+int thread_pool_group_add_task(thread_pool_group_t* group, void (*function)(void*), void* arg);
+
+// Количество незавершенных задач группы
+int thread_pool_group_pending(thread_pool_group_t* group);
+
+// Ожидание завершения всех задач группы
+int thread_pool_group_wait(thread_pool_group_t* group);
+
+// Ожидание с тайм-аутом. Возвращает 0 или ETIMEDOUT.
+int thread_pool_group_timedwait(thread_pool_group_t* group, int timeout_ms);
+
+// Ожидание, пока завершится хотя бы одна из групп (все группы одного пула).
+// Возвращает индекс завершенной группы или -1 по тайм-ауту
+// (timeout_ms < 0 — без ограничения).
+int thread_pool_group_wait_any(thread_pool_group_t* const* groups, int count, int timeout_ms);
+
 // Уничтожение пула потоков
 int thread_pool_destroy(thread_pool_t* pool);
 
-// Получение статистики пула
+// Статистика одного уровня приоритета
+typedef struct {
+    uint64_t submitted;
+    uint64_t dequeued;
+    uint64_t aged;
+    int queued;               // Сейчас в очереди
+    uint64_t wait_avg_ns;     // Ожидание в глобальной очереди
+    uint64_t wait_p50_ns;
+    uint64_t wait_p99_ns;
+    uint64_t wait_p999_ns;
+    uint64_t wait_max_ns;
+} thread_pool_priority_stats_t;
+
+// Сводка по гистограмме задержек
+typedef struct {
+    uint64_t count;
+    uint64_t avg_ns;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    uint64_t p999_ns;
+    uint64_t max_ns;
+} thread_pool_latency_stats_t;
+
+// Получение статистики пула. Не берет pool->lock: счетчики потоков
+// собираются при чтении, поэтому значения — согласованный лишь
+// приблизительно снимок.
 typedef struct {
     int active_threads;
-    int queued_tasks;
-    int total_tasks_completed;
-    int current_queue_size;
+    int live_threads;         // Работающих потоков
+    int threads_started;      // Запущено потоков за все время
+    int threads_retired;      // Завершено из-за простоя
+    int queued_tasks;         // В глобальных очередях и локальных деках
+    uint64_t total_tasks_completed;
+    uint64_t total_steals;    // Задач украдено из чужих деков
+    uint64_t busy_ns;         // Суммарное время выполнения задач потоками
+    uint64_t idle_ns;         // Суммарное время ожидания работы потоками
+    thread_pool_latency_stats_t queue_wait; // От добавления до начала выполнения
+    thread_pool_latency_stats_t exec;       // Время выполнения задачи
+    int current_queue_size;   // В глобальных очередях
+    int task_slab_capacity;   // Узлов задач в пуле
+    int task_slab_in_use;     // Из них занято
+    long task_heap_allocs;    // Узлов, выделенных из кучи при исчерпании пула
+    thread_pool_priority_stats_t priority[THREAD_POOL_PRIORITY_LEVELS];
 } thread_pool_stats_t;
 
 thread_pool_stats_t thread_pool_get_stats(thread_pool_t* pool);
 
+// Вывод статистики пула и каждого потока с p50/p99/p999 задержек
+void thread_pool_dump_stats(thread_pool_t* pool, FILE* out);
+
 // Установка обработчика ошибок
 typedef void (*error_handler_t)(const char* error_msg);
 void thread_pool_set_error_handler(error_handler_t handler);
@@ -0,0 +1,721 @@
+#define _GNU_SOURCE
+#include "thread_pool.h"
+#include "trace_ring.h"
+#include <dlfcn.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+// Трассировка пула: создание колец, снимок и экспорт в Chrome trace JSON.
+// Точки записи событий — в thread_pool.c.
+
+#define TRACE_MIN_EVENTS 64
+// Минимальный промежуток для пересчета тактов TSC в наносекунды
+#define TRACE_CALIBRATION_NS 10000000ULL
+#define TRACE_FILE_MAGIC "TPTRACE1"
+
+// Процессы в JSON: рабочие потоки и внешние потоки, добавляющие задачи
+#define TRACE_PID_WORKERS 1
+#define TRACE_PID_THREADS 2
+
+// Защищает создание трассы пула
+static pthread_mutex_t trace_create_lock = PTHREAD_MUTEX_INITIALIZER;
+static atomic_uint_fast64_t trace_next_id = 1;
+
+// Кольцо, в которое текущий внешний поток писал последним
+static _Thread_local struct {
+    uint64_t trace_id;
+    trace_ring_t* ring;
+} thread_ring_cache;
+
+// Инвариантный TSC идет с постоянной частотой и согласован между ядрами
+static bool trace_tsc_invariant(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+        return (edx >> 8) & 1;
+    }
+#endif
+    return false;
+}
+
+static size_t trace_ring_bytes(uint64_t capacity) {
+    return sizeof(trace_ring_t) + capacity * sizeof(trace_event_t);
+}
+
+// Страницы кольца выделяются ядром по мере записи событий
+static trace_ring_t* trace_ring_create(const thread_pool_trace_t* trace, int worker,
+                                       uint32_t tid) {
+    void* memory = mmap(NULL, trace_ring_bytes(trace->capacity), PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return NULL;
+    }
+    trace_ring_t* ring = (trace_ring_t*)memory;
+    atomic_init(&ring->head, 0);
+    ring->mask = trace->capacity - 1;
+    ring->tsc = trace->tsc;
+    ring->worker = worker;
+    ring->tid = tid;
+    ring->next = NULL;
+    return ring;
+}
+
+static void trace_ring_destroy(trace_ring_t* ring) {
+    munmap(ring, trace_ring_bytes(ring->mask + 1));
+}
+
+trace_ring_t* thread_pool_trace_thread_ring(thread_pool_trace_t* trace) {
+    if (thread_ring_cache.trace_id == trace->id) {
+        return thread_ring_cache.ring;
+    }
+
+    // Поток мог уже писать в эту трассу, переключаясь между пулами
+    uint32_t tid = (uint32_t)syscall(SYS_gettid);
+    pthread_mutex_lock(&trace->lock);
+    trace_ring_t* ring = trace->thread_rings;
+    while (ring != NULL && ring->tid != tid) {
+        ring = ring->next;
+    }
+    if (ring == NULL) {
+        ring = trace_ring_create(trace, -1, tid);
+        if (ring != NULL) {
+            ring->next = trace->thread_rings;
+            trace->thread_rings = ring;
+        }
+    }
+    pthread_mutex_unlock(&trace->lock);
+
+    if (ring != NULL) {
+        thread_ring_cache.trace_id = trace->id;
+        thread_ring_cache.ring = ring;
+    }
+    return ring;
+}
+
+void thread_pool_trace_free(thread_pool_trace_t* trace) {
+    if (!trace) return;
+    for (int i = 0; i < trace->num_workers; i++) {
+        if (trace->worker_rings[i]) {
+            trace_ring_destroy(trace->worker_rings[i]);
+        }
+    }
+    while (trace->thread_rings != NULL) {
+        trace_ring_t* next = trace->thread_rings->next;
+        trace_ring_destroy(trace->thread_rings);
+        trace->thread_rings = next;
+    }
+    free(trace->worker_rings);
+    pthread_mutex_destroy(&trace->lock);
+    free(trace);
+}
+
+static thread_pool_trace_t* trace_create(int num_workers, int events_per_thread) {
+    uint64_t capacity = TRACE_MIN_EVENTS;
+    uint64_t wanted = events_per_thread > 0 ? (uint64_t)events_per_thread
+                                            : THREAD_POOL_TRACE_DEFAULT_EVENTS;
+    while (capacity < wanted) {
+        capacity <<= 1;
+    }
+
+    thread_pool_trace_t* trace = (thread_pool_trace_t*)calloc(1, sizeof(thread_pool_trace_t));
+    if (!trace) return NULL;
+    trace->worker_rings = (trace_ring_t**)calloc((size_t)num_workers, sizeof(trace_ring_t*));
+    if (!trace->worker_rings) {
+        free(trace);
+        return NULL;
+    }
+    pthread_mutex_init(&trace->lock, NULL);
+    trace->id = atomic_fetch_add(&trace_next_id, 1);
+    trace->capacity = capacity;
+    trace->tsc = trace_tsc_invariant();
+    trace->num_workers = num_workers;
+    for (int i = 0; i < num_workers; i++) {
+        trace->worker_rings[i] = trace_ring_create(trace, i, 0);
+        if (!trace->worker_rings[i]) {
+            thread_pool_trace_free(trace);
+            errno = ENOMEM;
+            return NULL;
+        }
+    }
+    trace->start_ns = trace_clock_ns();
+    trace->start_ticks = trace_clock(trace->tsc);
+    return trace;
+}
+
+int thread_pool_trace_start(thread_pool_t* pool, int events_per_thread) {
+    if (!pool) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    pthread_mutex_lock(&trace_create_lock);
+    if (pool->trace == NULL) {
+        pool->trace = trace_create(pool->max_threads, events_per_thread);
+    }
+    bool created = pool->trace != NULL;
+    pthread_mutex_unlock(&trace_create_lock);
+    if (!created) {
+        return -1;
+    }
+
+    // Точки трассировки читают pool->trace после acquire-чтения флага
+    atomic_store_explicit(&pool->trace_enabled, true, memory_order_release);
+    return 0;
+}
+
+void thread_pool_trace_stop(thread_pool_t* pool) {
+    if (pool) {
+        atomic_store_explicit(&pool->trace_enabled, false, memory_order_relaxed);
+    }
+}
+
+// --- Снимок ---
+
+typedef struct {
+    int worker;               // Слот потока пула или -1
+    uint32_t tid;
+    uint64_t count;
+    trace_event_t* events;    // time — нс от начала трассы
+} trace_thread_t;
+
+typedef struct {
+    uint64_t address;
+    char* name;
+} trace_function_t;
+
+typedef struct {
+    int num_threads;
+    trace_thread_t* threads;
+    uint32_t num_functions;
+    trace_function_t* functions; // По возрастанию адреса
+} trace_snapshot_t;
+
+static void trace_snapshot_free(trace_snapshot_t* snapshot) {
+    for (int i = 0; i < snapshot->num_threads; i++) {
+        free(snapshot->threads[i].events);
+    }
+    free(snapshot->threads);
+    for (uint32_t i = 0; i < snapshot->num_functions; i++) {
+        free(snapshot->functions[i].name);
+    }
+    free(snapshot->functions);
+}
+
+// Копия событий кольца без остановки писателя; время переводится в нс
+// от начала трассы: ns = (ticks - start_ticks) * scale
+static int trace_ring_copy(const thread_pool_trace_t* trace, trace_ring_t* ring,
+                           double scale, trace_thread_t* out) {
+    uint64_t capacity = ring->mask + 1;
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint64_t first = head > capacity ? head - capacity : 0;
+
+    out->worker = ring->worker;
+    out->tid = ring->tid;
+    out->count = 0;
+    out->events = (trace_event_t*)malloc((head - first + 1) * sizeof(trace_event_t));
+    if (!out->events) return -1;
+    for (uint64_t i = first; i < head; i++) {
+        out->events[i - first] = ring->events[i & ring->mask];
+    }
+
+    // Писатель мог перезаписать события до after - capacity и сейчас
+    // пишет слот события after - capacity
+    atomic_thread_fence(memory_order_acquire);
+    uint64_t after = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint64_t valid = after + 1 > capacity ? after + 1 - capacity : 0;
+    uint64_t skip = valid > first ? valid - first : 0;
+    if (skip > head - first) skip = head - first;
+
+    out->count = head - first - skip;
+    memmove(out->events, out->events + skip, out->count * sizeof(trace_event_t));
+    for (uint64_t i = 0; i < out->count; i++) {
+        trace_event_t* event = &out->events[i];
+        uint64_t ticks = event->time > trace->start_ticks ? event->time - trace->start_ticks : 0;
+        event->time = (uint64_t)((double)ticks * scale);
+    }
+    return 0;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+// Имя функции: символ из таблицы динамических символов или
+// "модуль+смещение" (для addr2line -f -e модуль смещение)
+static char* trace_function_name(uint64_t address) {
+    Dl_info info;
+    char buffer[512];
+    if (dladdr((void*)(uintptr_t)address, &info) != 0) {
+        if (info.dli_sname != NULL && (uintptr_t)info.dli_saddr == address) {
+            return strdup(info.dli_sname);
+        }
+        if (info.dli_fname != NULL) {
+            const char* base = strrchr(info.dli_fname, '/');
+            snprintf(buffer, sizeof(buffer), "%s+0x%" PRIx64, base ? base + 1 : info.dli_fname,
+                     address - (uint64_t)(uintptr_t)info.dli_fbase);
+            return strdup(buffer);
+        }
+    }
+    snprintf(buffer, sizeof(buffer), "0x%" PRIx64, address);
+    return strdup(buffer);
+}
+
+// Таблица имен всех функций, встречающихся в событиях
+static int trace_snapshot_functions(trace_snapshot_t* snapshot) {
+    uint64_t total = 0;
+    for (int i = 0; i < snapshot->num_threads; i++) {
+        total += snapshot->threads[i].count;
+    }
+    uint64_t* addresses = (uint64_t*)malloc((total + 1) * sizeof(uint64_t));
+    if (!addresses) return -1;
+    uint64_t n = 0;
+    for (int i = 0; i < snapshot->num_threads; i++) {
+        const trace_thread_t* thread = &snapshot->threads[i];
+        for (uint64_t j = 0; j < thread->count; j++) {
+            if (thread->events[j].function != 0) {
+                addresses[n++] = thread->events[j].function;
+            }
+        }
+    }
+    qsort(addresses, n, sizeof(uint64_t), compare_u64);
+
+    uint64_t unique = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        if (i == 0 || addresses[i] != addresses[i - 1]) {
+            addresses[unique++] = addresses[i];
+        }
+    }
+    snapshot->functions = (trace_function_t*)calloc(unique + 1, sizeof(trace_function_t));
+    if (!snapshot->functions) {
+        free(addresses);
+        return -1;
+    }
+    for (uint64_t i = 0; i < unique; i++) {
+        snapshot->functions[i].address = addresses[i];
+        snapshot->functions[i].name = trace_function_name(addresses[i]);
+        snapshot->num_functions++;
+        if (!snapshot->functions[i].name) {
+            free(addresses);
+            return -1;
+        }
+    }
+    free(addresses);
+    return 0;
+}
+
+static int trace_snapshot_take(thread_pool_t* pool, trace_snapshot_t* snapshot) {
+    memset(snapshot, 0, sizeof(*snapshot));
+    thread_pool_trace_t* trace = pool ? pool->trace : NULL;
+    if (!trace) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // Частота TSC — по двум отсчетам обоих часов, разнесенным хотя бы
+    // на TRACE_CALIBRATION_NS
+    double scale = 1.0;
+    if (trace->tsc) {
+        uint64_t now_ns = trace_clock_ns();
+        if (now_ns - trace->start_ns < TRACE_CALIBRATION_NS) {
+            uint64_t left = TRACE_CALIBRATION_NS - (now_ns - trace->start_ns);
+            struct timespec pause = { .tv_sec = 0, .tv_nsec = (long)left };
+            nanosleep(&pause, NULL);
+            now_ns = trace_clock_ns();
+        }
+        uint64_t now_ticks = trace_clock(true);
+        scale = (double)(now_ns - trace->start_ns) / (double)(now_ticks - trace->start_ticks);
+    }
+
+    pthread_mutex_lock(&trace->lock);
+    int rings = trace->num_workers;
+    for (trace_ring_t* ring = trace->thread_rings; ring != NULL; ring = ring->next) {
+        rings++;
+    }
+    snapshot->threads = (trace_thread_t*)calloc((size_t)rings, sizeof(trace_thread_t));
+    int rc = snapshot->threads ? 0 : -1;
+    for (int i = 0; rc == 0 && i < trace->num_workers; i++) {
+        rc = trace_ring_copy(trace, trace->worker_rings[i], scale,
+                             &snapshot->threads[snapshot->num_threads++]);
+    }
+    for (trace_ring_t* ring = trace->thread_rings; rc == 0 && ring != NULL; ring = ring->next) {
+        rc = trace_ring_copy(trace, ring, scale, &snapshot->threads[snapshot->num_threads++]);
+    }
+    pthread_mutex_unlock(&trace->lock);
+
+    if (rc == 0) {
+        rc = trace_snapshot_functions(snapshot);
+    }
+    if (rc != 0) {
+        trace_snapshot_free(snapshot);
+        errno = ENOMEM;
+    }
+    return rc;
+}
+
+// --- Chrome trace JSON ---
+
+// Связь постановки задачи в очередь с началом ее выполнения
+typedef struct {
+    uint64_t task;
+    uint64_t time;
+    uint32_t thread;
+    uint32_t index;
+    uint32_t type;
+} trace_ref_t;
+
+typedef struct {
+    uint64_t flow;            // Номер стрелки (0 — нет)
+    uint64_t enqueued;        // Для TRACE_START: момент постановки
+} trace_link_t;
+
+static int compare_refs(const void* a, const void* b) {
+    const trace_ref_t* x = (const trace_ref_t*)a;
+    const trace_ref_t* y = (const trace_ref_t*)b;
+    if (x->task != y->task) return x->task < y->task ? -1 : 1;
+    if (x->time != y->time) return x->time < y->time ? -1 : 1;
+    return x->type < y->type ? -1 : x->type > y->type;
+}
+
+// Стрелки от постановки к началу выполнения. Узлы задач переиспользуются,
+// поэтому постановка связывается с ближайшим следующим началом той же задачи.
+static trace_link_t** trace_link_flows(const trace_snapshot_t* snapshot) {
+    trace_link_t** links = (trace_link_t**)calloc((size_t)snapshot->num_threads + 1,
+                                                  sizeof(trace_link_t*));
+    if (!links) return NULL;
+    uint64_t total = 0;
+    for (int i = 0; i < snapshot->num_threads; i++) {
+        total += snapshot->threads[i].count;
+        links[i] = (trace_link_t*)calloc(snapshot->threads[i].count + 1, sizeof(trace_link_t));
+        if (!links[i]) goto fail;
+    }
+    trace_ref_t* refs = (trace_ref_t*)malloc((total + 1) * sizeof(trace_ref_t));
+    if (!refs) goto fail;
+
+    uint64_t n = 0;
+    for (int i = 0; i < snapshot->num_threads; i++) {
+        const trace_thread_t* thread = &snapshot->threads[i];
+        for (uint64_t j = 0; j < thread->count; j++) {
+            const trace_event_t* event = &thread->events[j];
+            if (event->type == TRACE_ENQUEUE || event->type == TRACE_START) {
+                refs[n++] = (trace_ref_t){ event->task, event->time, (uint32_t)i,
+                                           (uint32_t)j, event->type };
+            }
+        }
+    }
+    qsort(refs, n, sizeof(trace_ref_t), compare_refs);
+
+    uint64_t next_flow = 1;
+    const trace_ref_t* pending = NULL;
+    for (uint64_t i = 0; i < n; i++) {
+        const trace_ref_t* ref = &refs[i];
+        if (pending != NULL && pending->task != ref->task) {
+            pending = NULL;
+        }
+        if (ref->type == TRACE_ENQUEUE) {
+            pending = ref;
+        } else if (pending != NULL) {
+            uint64_t flow = next_flow++;
+            links[pending->thread][pending->index].flow = flow;
+            links[ref->thread][ref->index].flow = flow;
+            links[ref->thread][ref->index].enqueued = pending->time;
+            pending = NULL;
+        }
+    }
+    free(refs);
+    return links;
+
+fail:
+    for (int i = 0; i < snapshot->num_threads; i++) {
+        free(links[i]);
+    }
+    free(links);
+    return NULL;
+}
+
+static const char* trace_snapshot_function(const trace_snapshot_t* snapshot, uint64_t address) {
+    uint32_t lo = 0, hi = snapshot->num_functions;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (snapshot->functions[mid].address < address) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < snapshot->num_functions && snapshot->functions[lo].address == address) {
+        return snapshot->functions[lo].name;
+    }
+    return "?";
+}
+
+// Вывод строки в JSON с экранированием
+static void trace_json_string(FILE* out, const char* text) {
+    fputc('"', out);
+    for (const unsigned char* p = (const unsigned char*)text; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fprintf(out, "\\%c", *p);
+        } else if (*p < 0x20) {
+            fprintf(out, "\\u%04x", *p);
+        } else {
+            fputc(*p, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static const char* trace_source_name(uint32_t source) {
+    switch (source) {
+        case TRACE_SOURCE_LOCAL: return "local";
+        case TRACE_SOURCE_STEAL: return "steal";
+        default: return "global";
+    }
+}
+
+// События одного потока: задачи и сон — отрезки ("X"), постановка —
+// отрезок нулевой длины с началом стрелки, взятие — мгновенное событие
+static void trace_json_thread(FILE* out, const trace_snapshot_t* snapshot, int index,
+                              const trace_link_t* links) {
+    const trace_thread_t* thread = &snapshot->threads[index];
+    int pid = thread->worker >= 0 ? TRACE_PID_WORKERS : TRACE_PID_THREADS;
+    uint32_t tid = thread->worker >= 0 ? (uint32_t)thread->worker + 1 : thread->tid;
+    const trace_event_t* start = NULL;
+    const trace_event_t* park = NULL;
+    uint64_t start_link = 0;
+
+    fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,"
+                 "\"args\":{\"name\":", pid, tid);
+    char name[64];
+    if (thread->worker >= 0) {
+        snprintf(name, sizeof(name), "worker %d", thread->worker);
+    } else {
+        snprintf(name, sizeof(name), "thread %u", thread->tid);
+    }
+    trace_json_string(out, name);
+    fprintf(out, "}}");
+
+    for (uint64_t i = 0; i < thread->count; i++) {
+        const trace_event_t* event = &thread->events[i];
+        double ts = event->time / 1000.0;
+        switch (event->type) {
+        case TRACE_ENQUEUE:
+            fprintf(out, ",\n{\"name\":\"enqueue\",\"cat\":\"queue\",\"ph\":\"X\",\"ts\":%.3f,"
+                         "\"dur\":0,\"pid\":%d,\"tid\":%u,\"args\":{\"function\":", ts, pid, tid);
+            trace_json_string(out, trace_snapshot_function(snapshot, event->function));
+            fprintf(out, ",\"priority\":%u}}", event->arg);
+            if (links[i].flow != 0) {
+                fprintf(out, ",\n{\"name\":\"queue\",\"cat\":\"queue\",\"ph\":\"s\",\"id\":%" PRIu64
+                             ",\"ts\":%.3f,\"pid\":%d,\"tid\":%u}", links[i].flow, ts, pid, tid);
+            }
+            break;
+        case TRACE_DEQUEUE:
+            fprintf(out, ",\n{\"name\":\"dequeue\",\"cat\":\"queue\",\"ph\":\"i\",\"s\":\"t\","
+                         "\"ts\":%.3f,\"pid\":%d,\"tid\":%u,\"args\":{\"source\":\"%s\"}}",
+                    ts, pid, tid, trace_source_name(event->arg));
+            break;
+        case TRACE_START:
+            start = event;
+            start_link = i;
+            if (links[i].flow != 0) {
+                fprintf(out, ",\n{\"name\":\"queue\",\"cat\":\"queue\",\"ph\":\"f\",\"bp\":\"e\","
+                             "\"id\":%" PRIu64 ",\"ts\":%.3f,\"pid\":%d,\"tid\":%u}",
+                        links[i].flow, ts, pid, tid);
+            }
+            break;
+        case TRACE_END:
+            // Начало могло быть перезаписано в кольце
+            if (start == NULL || start->task != event->task) break;
+            fprintf(out, ",\n{\"name\":");
+            trace_json_string(out, trace_snapshot_function(snapshot, event->function));
+            fprintf(out, ",\"cat\":\"task\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,"
+                         "\"tid\":%u,\"args\":{\"task\":\"0x%" PRIx64 "\"",
+                    start->time / 1000.0, (event->time - start->time) / 1000.0, pid, tid,
+                    event->task);
+            if (links[start_link].flow != 0) {
+                fprintf(out, ",\"queue_wait_us\":%.3f",
+                        (start->time - links[start_link].enqueued) / 1000.0);
+            }
+            fprintf(out, "}}");
+            start = NULL;
+            break;
+        case TRACE_PARK:
+            park = event;
+            break;
+        case TRACE_WAKE:
+            if (park == NULL) break;
+            fprintf(out, ",\n{\"name\":\"idle\",\"cat\":\"idle\",\"ph\":\"X\",\"ts\":%.3f,"
+                         "\"dur\":%.3f,\"pid\":%d,\"tid\":%u}",
+                    park->time / 1000.0, (event->time - park->time) / 1000.0, pid, tid);
+            park = NULL;
+            break;
+        }
+    }
+}
+
+static int trace_snapshot_write_json(const trace_snapshot_t* snapshot, FILE* out) {
+    trace_link_t** links = trace_link_flows(snapshot);
+    if (!links) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+                 "\"args\":{\"name\":\"thread_pool\"}},\n", TRACE_PID_WORKERS);
+    fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+                 "\"args\":{\"name\":\"submitting threads\"}}", TRACE_PID_THREADS);
+    for (int i = 0; i < snapshot->num_threads; i++) {
+        trace_json_thread(out, snapshot, i, links[i]);
+        free(links[i]);
+    }
+    free(links);
+    fprintf(out, "\n]}\n");
+    return ferror(out) ? -1 : 0;
+}
+
+int thread_pool_trace_write_json(thread_pool_t* pool, FILE* out) {
+    if (!out) {
+        errno = EINVAL;
+        return -1;
+    }
+    trace_snapshot_t snapshot;
+    if (trace_snapshot_take(pool, &snapshot) != 0) {
+        return -1;
+    }
+    int rc = trace_snapshot_write_json(&snapshot, out);
+    trace_snapshot_free(&snapshot);
+    return rc;
+}
+
+// --- Двоичный файл ---
+//
+// "TPTRACE1", число потоков и функций (uint32), функции (адрес uint64,
+// длина имени uint32, имя), затем потоки (слот int32, tid uint32,
+// число событий uint64, события trace_event_t). Порядок байтов и
+// выравнивание — как у записавшей машины.
+
+int thread_pool_trace_save(thread_pool_t* pool, const char* path) {
+    if (!path) {
+        errno = EINVAL;
+        return -1;
+    }
+    trace_snapshot_t snapshot;
+    if (trace_snapshot_take(pool, &snapshot) != 0) {
+        return -1;
+    }
+    FILE* out = fopen(path, "wb");
+    if (!out) {
+        trace_snapshot_free(&snapshot);
+        return -1;
+    }
+
+    uint32_t num_threads = (uint32_t)snapshot.num_threads;
+    fwrite(TRACE_FILE_MAGIC, 1, 8, out);
+    fwrite(&num_threads, sizeof(num_threads), 1, out);
+    fwrite(&snapshot.num_functions, sizeof(snapshot.num_functions), 1, out);
+    for (uint32_t i = 0; i < snapshot.num_functions; i++) {
+        uint32_t length = (uint32_t)strlen(snapshot.functions[i].name);
+        fwrite(&snapshot.functions[i].address, sizeof(uint64_t), 1, out);
+        fwrite(&length, sizeof(length), 1, out);
+        fwrite(snapshot.functions[i].name, 1, length, out);
+    }
+    for (int i = 0; i < snapshot.num_threads; i++) {
+        const trace_thread_t* thread = &snapshot.threads[i];
+        int32_t worker = thread->worker;
+        fwrite(&worker, sizeof(worker), 1, out);
+        fwrite(&thread->tid, sizeof(thread->tid), 1, out);
+        fwrite(&thread->count, sizeof(thread->count), 1, out);
+        fwrite(thread->events, sizeof(trace_event_t), thread->count, out);
+    }
+    trace_snapshot_free(&snapshot);
+
+    int rc = ferror(out) ? -1 : 0;
+    if (fclose(out) != 0) {
+        rc = -1;
+    }
+    return rc;
+}
+
+static int trace_read(FILE* in, void* data, size_t size) {
+    return fread(data, 1, size, in) == size ? 0 : -1;
+}
+
+static int trace_snapshot_read(FILE* in, trace_snapshot_t* snapshot) {
+    memset(snapshot, 0, sizeof(*snapshot));
+    char magic[8];
+    uint32_t num_threads, num_functions;
+    if (trace_read(in, magic, sizeof(magic)) != 0 || memcmp(magic, TRACE_FILE_MAGIC, 8) != 0 ||
+        trace_read(in, &num_threads, sizeof(num_threads)) != 0 ||
+        trace_read(in, &num_functions, sizeof(num_functions)) != 0 ||
+        num_threads > INT32_MAX) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    snapshot->functions = (trace_function_t*)calloc((size_t)num_functions + 1,
+                                                    sizeof(trace_function_t));
+    snapshot->threads = (trace_thread_t*)calloc((size_t)num_threads + 1, sizeof(trace_thread_t));
+    if (!snapshot->functions || !snapshot->threads) {
+        trace_snapshot_free(snapshot);
+        errno = ENOMEM;
+        return -1;
+    }
+    for (uint32_t i = 0; i < num_functions; i++) {
+        trace_function_t* function = &snapshot->functions[i];
+        uint32_t length;
+        if (trace_read(in, &function->address, sizeof(uint64_t)) != 0 ||
+            trace_read(in, &length, sizeof(length)) != 0 || length > 4096 ||
+            !(function->name = (char*)calloc(length + 1, 1))) {
+            goto invalid;
+        }
+        snapshot->num_functions++;
+        if (trace_read(in, function->name, length) != 0) {
+            goto invalid;
+        }
+    }
+    for (uint32_t i = 0; i < num_threads; i++) {
+        trace_thread_t* thread = &snapshot->threads[i];
+        int32_t worker;
+        if (trace_read(in, &worker, sizeof(worker)) != 0 ||
+            trace_read(in, &thread->tid, sizeof(thread->tid)) != 0 ||
+            trace_read(in, &thread->count, sizeof(thread->count)) != 0 ||
+            thread->count > (1ULL << 32)) {
+            goto invalid;
+        }
+        thread->worker = worker;
+        snapshot->num_threads++;
+        thread->events = (trace_event_t*)malloc((thread->count + 1) * sizeof(trace_event_t));
+        if (!thread->events ||
+            trace_read(in, thread->events, thread->count * sizeof(trace_event_t)) != 0) {
+            goto invalid;
+        }
+    }
+    return 0;
+
+invalid:
+    trace_snapshot_free(snapshot);
+    errno = EINVAL;
+    return -1;
+}
+
+int thread_pool_trace_convert(FILE* in, FILE* out) {
+    if (!in || !out) {
+        errno = EINVAL;
+        return -1;
+    }
+    trace_snapshot_t snapshot;
+    if (trace_snapshot_read(in, &snapshot) != 0) {
+        return -1;
+    }
+    int rc = trace_snapshot_write_json(&snapshot, out);
+    trace_snapshot_free(&snapshot);
+    return rc;
+}
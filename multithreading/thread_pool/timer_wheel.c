@@ -0,0 +1,303 @@
+#include "timer_wheel.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define L0_SLOTS (1u << TIMER_WHEEL_L0_BITS)
+#define LN_SLOTS (1u << TIMER_WHEEL_LN_BITS)
+#define L0_MASK (L0_SLOTS - 1)
+#define LN_MASK (LN_SLOTS - 1)
+// Дальше этого срок ограничивается, запись ждет на верхнем уровне
+#define MAX_DELTA ((1ULL << (TIMER_WHEEL_L0_BITS + \
+                             (TIMER_WHEEL_LEVELS - 1) * TIMER_WHEEL_LN_BITS)) - 1)
+
+// Сдвиг уровня: слот уровня level охватывает 2^shift тиков
+static inline int level_shift(int level) {
+    return level == 0 ? 0 : TIMER_WHEEL_L0_BITS + (level - 1) * TIMER_WHEEL_LN_BITS;
+}
+
+static inline void bitmap_set(uint64_t* bits, unsigned int slot) {
+    bits[slot / 64] |= 1ULL << (slot % 64);
+}
+
+static inline void bitmap_clear(uint64_t* bits, unsigned int slot) {
+    bits[slot / 64] &= ~(1ULL << (slot % 64));
+}
+
+// Расстояние от start до ближайшего установленного бита по кругу из
+// nbits (кратно 64), не меньше min_distance; -1 — такого нет
+static int bitmap_distance(const uint64_t* bits, unsigned int nbits, unsigned int start,
+                           unsigned int min_distance) {
+    for (unsigned int distance = min_distance; distance < nbits;) {
+        unsigned int slot = (start + distance) % nbits;
+        uint64_t word = bits[slot / 64] >> (slot % 64);
+        if (word != 0) {
+            unsigned int found = distance + (unsigned int)__builtin_ctzll(word);
+            // Найденный бит может лежать за началом круга — тогда он уже
+            // просмотрен с другой стороны, но расстояние все равно верное
+            return found < nbits ? (int)found : -1;
+        }
+        distance += 64 - slot % 64;
+    }
+    return -1;
+}
+
+static void slot_insert(timer_wheel_t* wheel, timer_wheel_entry_t* entry, int level,
+                        unsigned int slot) {
+    timer_wheel_entry_t** head = &wheel->slots[level][slot];
+    entry->prev = NULL;
+    entry->next = *head;
+    if (*head) {
+        (*head)->prev = entry;
+    }
+    *head = entry;
+    entry->slot = (uint16_t)(level * L0_SLOTS + slot);
+    bitmap_set(wheel->occupied[level], slot);
+    wheel->level_count[level]++;
+}
+
+static void slot_remove(timer_wheel_t* wheel, timer_wheel_entry_t* entry) {
+    int level = entry->slot / L0_SLOTS;
+    unsigned int slot = entry->slot % L0_SLOTS;
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        wheel->slots[level][slot] = entry->next;
+    }
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    }
+    if (!wheel->slots[level][slot]) {
+        bitmap_clear(wheel->occupied[level], slot);
+    }
+    wheel->level_count[level]--;
+}
+
+// Слот по сроку относительно текущего тика
+static void wheel_place(timer_wheel_t* wheel, timer_wheel_entry_t* entry) {
+    uint64_t expires = entry->expires;
+    if (expires <= wheel->tick) {
+        slot_insert(wheel, entry, 0, (unsigned int)(wheel->tick & L0_MASK));
+        return;
+    }
+    uint64_t delta = expires - wheel->tick;
+    if (delta < L0_SLOTS) {
+        slot_insert(wheel, entry, 0, (unsigned int)(expires & L0_MASK));
+        return;
+    }
+    if (delta > MAX_DELTA) {
+        expires = wheel->tick + MAX_DELTA;
+        delta = MAX_DELTA;
+    }
+    for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+        int shift = level_shift(level);
+        if (delta < 1ULL << (shift + TIMER_WHEEL_LN_BITS)) {
+            slot_insert(wheel, entry, level, (unsigned int)((expires >> shift) & LN_MASK));
+            return;
+        }
+    }
+}
+
+// Каскад на границе tick (кратной 256): слот уровня 1 спускается вниз,
+// и если его индекс 0 — то и слот уровня 2, и так далее
+static void wheel_cascade(timer_wheel_t* wheel) {
+    for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+        unsigned int slot = (unsigned int)((wheel->tick >> level_shift(level)) & LN_MASK);
+        timer_wheel_entry_t* entry = wheel->slots[level][slot];
+        wheel->slots[level][slot] = NULL;
+        bitmap_clear(wheel->occupied[level], slot);
+        while (entry) {
+            timer_wheel_entry_t* next = entry->next;
+            wheel->level_count[level]--;
+            wheel_place(wheel, entry);
+            entry = next;
+        }
+        if (slot != 0) {
+            break;
+        }
+    }
+}
+
+static timer_wheel_entry_t* entry_alloc(timer_wheel_t* wheel) {
+    if (!wheel->free_list) {
+        if (wheel->num_chunks == wheel->chunks_capacity) {
+            size_t capacity = wheel->chunks_capacity ? wheel->chunks_capacity * 2 : 16;
+            timer_wheel_entry_t** chunks = (timer_wheel_entry_t**)realloc(
+                wheel->chunks, capacity * sizeof(timer_wheel_entry_t*));
+            if (!chunks) {
+                return NULL;
+            }
+            wheel->chunks = chunks;
+            wheel->chunks_capacity = capacity;
+        }
+        timer_wheel_entry_t* chunk = (timer_wheel_entry_t*)calloc(TIMER_WHEEL_CHUNK,
+                                                                  sizeof(timer_wheel_entry_t));
+        if (!chunk) {
+            return NULL;
+        }
+        uint32_t base = (uint32_t)(wheel->num_chunks * TIMER_WHEEL_CHUNK);
+        wheel->chunks[wheel->num_chunks++] = chunk;
+        // Записи связываются в порядке возрастания индекса
+        for (int i = TIMER_WHEEL_CHUNK - 1; i >= 0; i--) {
+            chunk[i].index = base + (uint32_t)i;
+            chunk[i].generation = 1;
+            chunk[i].next = wheel->free_list;
+            wheel->free_list = &chunk[i];
+        }
+    }
+    timer_wheel_entry_t* entry = wheel->free_list;
+    wheel->free_list = entry->next;
+    return entry;
+}
+
+static void entry_free(timer_wheel_t* wheel, timer_wheel_entry_t* entry) {
+    entry->queued = false;
+    entry->generation++;
+    entry->next = wheel->free_list;
+    wheel->free_list = entry;
+}
+
+static timer_wheel_entry_t* entry_lookup(timer_wheel_t* wheel, uint64_t id) {
+    uint64_t ref = id & 0xffffffffULL;
+    if (ref == 0 || ref > wheel->num_chunks * TIMER_WHEEL_CHUNK) {
+        return NULL;
+    }
+    timer_wheel_entry_t* entry = &wheel->chunks[(ref - 1) / TIMER_WHEEL_CHUNK]
+                                               [(ref - 1) % TIMER_WHEEL_CHUNK];
+    if (!entry->queued || entry->generation != (uint32_t)(id >> 32)) {
+        return NULL;
+    }
+    return entry;
+}
+
+void timer_wheel_init(timer_wheel_t* wheel, uint64_t now) {
+    memset(wheel, 0, sizeof(*wheel));
+    wheel->tick = now;
+}
+
+void timer_wheel_destroy(timer_wheel_t* wheel) {
+    for (size_t i = 0; i < wheel->num_chunks; i++) {
+        free(wheel->chunks[i]);
+    }
+    free(wheel->chunks);
+    memset(wheel, 0, sizeof(*wheel));
+}
+
+uint64_t timer_wheel_add(timer_wheel_t* wheel, uint64_t expires, uint64_t period,
+                         void (*function)(void*), void* arg) {
+    timer_wheel_entry_t* entry = entry_alloc(wheel);
+    if (!entry) {
+        return 0;
+    }
+    entry->expires = expires;
+    entry->period = period;
+    entry->function = function;
+    entry->arg = arg;
+    entry->queued = true;
+    wheel_place(wheel, entry);
+    wheel->pending++;
+    return ((uint64_t)entry->generation << 32) | ((uint64_t)entry->index + 1);
+}
+
+bool timer_wheel_cancel(timer_wheel_t* wheel, uint64_t id) {
+    timer_wheel_entry_t* entry = entry_lookup(wheel, id);
+    if (!entry) {
+        return false;
+    }
+    slot_remove(wheel, entry);
+    entry_free(wheel, entry);
+    wheel->pending--;
+    return true;
+}
+
+// Ближайший тик, на котором что-то может произойти, если уровень 0 пуст:
+// граница, кратная слоту самого низкого непустого уровня
+static uint64_t wheel_skip_target(const timer_wheel_t* wheel) {
+    for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+        if (wheel->level_count[level] > 0) {
+            uint64_t span = 1ULL << level_shift(level);
+            return (wheel->tick + span - 1) & ~(span - 1);
+        }
+    }
+    return UINT64_MAX;
+}
+
+size_t timer_wheel_advance(timer_wheel_t* wheel, uint64_t now, size_t max,
+                           timer_wheel_fire_fn fire, void* ctx) {
+    size_t fired = 0;
+    while (wheel->tick <= now) {
+        if (!wheel->tick_cascaded) {
+            // Пустые тики пропускаются до следующего возможного каскада
+            if (wheel->level_count[0] == 0) {
+                uint64_t target = wheel_skip_target(wheel);
+                if (target > wheel->tick) {
+                    wheel->tick = target <= now ? target : now + 1;
+                    continue;
+                }
+            }
+            if ((wheel->tick & L0_MASK) == 0) {
+                wheel_cascade(wheel);
+            }
+            wheel->tick_cascaded = true;
+        }
+
+        unsigned int slot = (unsigned int)(wheel->tick & L0_MASK);
+        while (wheel->slots[0][slot]) {
+            if (fired == max) {
+                return fired;
+            }
+            timer_wheel_entry_t* entry = wheel->slots[0][slot];
+            slot_remove(wheel, entry);
+            void (*function)(void*) = entry->function;
+            void* arg = entry->arg;
+            if (entry->period > 0) {
+                // Пропущенные периоды не наверстываются
+                uint64_t behind = wheel->tick - entry->expires;
+                entry->expires += (behind / entry->period + 1) * entry->period;
+                wheel_place(wheel, entry);
+            } else {
+                entry_free(wheel, entry);
+                wheel->pending--;
+            }
+            fire(ctx, function, arg);
+            fired++;
+        }
+        wheel->tick++;
+        wheel->tick_cascaded = false;
+    }
+    return fired;
+}
+
+uint64_t timer_wheel_next_tick(const timer_wheel_t* wheel) {
+    if (wheel->pending == 0) {
+        return UINT64_MAX;
+    }
+    uint64_t next = UINT64_MAX;
+    if (wheel->level_count[0] > 0) {
+        int distance = bitmap_distance(wheel->occupied[0], L0_SLOTS,
+                                       (unsigned int)(wheel->tick & L0_MASK), 0);
+        if (distance >= 0) {
+            next = wheel->tick + (uint64_t)distance;
+        }
+    }
+    for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+        if (wheel->level_count[level] == 0) {
+            continue;
+        }
+        int shift = level_shift(level);
+        uint64_t base = wheel->tick >> shift;
+        // Слот текущего периода еще не спущен только ровно на границе
+        bool boundary = !wheel->tick_cascaded &&
+                        (wheel->tick & ((1ULL << shift) - 1)) == 0;
+        int distance = bitmap_distance(wheel->occupied[level], LN_SLOTS,
+                                       (unsigned int)(base & LN_MASK), boundary ? 0 : 1);
+        // Слот текущего индекса спускается через полный оборот уровня
+        if (distance < 0) {
+            distance = LN_SLOTS;
+        }
+        uint64_t cascade = (base + (uint64_t)distance) << shift;
+        if (cascade < next) {
+            next = cascade;
+        }
+    }
+    return next;
+}
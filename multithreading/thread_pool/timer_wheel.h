@@ -0,0 +1,86 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Иерархическое колесо таймеров (Varghese & Lauck) для отложенных задач
+// пула. Время измеряется в тиках; колесо не потокобезопасно — пул
+// вызывает его под своей блокировкой таймеров.
+//
+// Уровень 0 — 256 слотов по одному тику, уровни 1..4 — по 64 слота,
+// каждый следующий в 64 раза крупнее: охват 2^32 тиков (при тике 1 мс
+// около 49 суток; более далекие сроки дожидаются на верхнем уровне).
+// Добавление и отмена — O(1): запись попадает в двусвязный список слота
+// по сроку. Записи верхних уровней спускаются вниз (каскад), когда
+// колесо доходит до их слота, поэтому каждая запись переносится не
+// больше четырех раз.
+//
+// Записи лежат в блоках по TIMER_WHEEL_CHUNK и переиспользуются через
+// список свободных; идентификатор — (поколение << 32) | (индекс + 1),
+// поэтому отмена сработавшего таймера безопасна и ничего не делает.
+
+#define TIMER_WHEEL_LEVELS 5
+#define TIMER_WHEEL_L0_BITS 8
+#define TIMER_WHEEL_LN_BITS 6
+#define TIMER_WHEEL_CHUNK 4096
+
+typedef struct timer_wheel_entry {
+    struct timer_wheel_entry* next;
+    struct timer_wheel_entry* prev;
+    uint64_t expires;         // Срок в тиках
+    uint64_t period;          // 0 — однократный
+    void (*function)(void*);
+    void* arg;
+    uint32_t generation;      // Растет при освобождении записи
+    uint32_t index;           // Номер записи среди всех блоков
+    uint16_t slot;            // Где запись сейчас: уровень * 256 + слот
+    bool queued;              // Запись в колесе
+} timer_wheel_entry_t;
+
+typedef struct timer_wheel {
+    // Слоты: уровень 0 — 256 списков, остальные — по 64
+    timer_wheel_entry_t* slots[TIMER_WHEEL_LEVELS][1 << TIMER_WHEEL_L0_BITS];
+    uint64_t occupied[TIMER_WHEEL_LEVELS][4]; // Битовые карты непустых слотов
+    size_t level_count[TIMER_WHEEL_LEVELS];   // Записей на уровне
+
+    uint64_t tick;            // Следующий необработанный тик
+    bool tick_cascaded;       // Каскад для tick уже выполнен
+
+    timer_wheel_entry_t** chunks; // Блоки записей
+    size_t num_chunks;
+    size_t chunks_capacity;
+    timer_wheel_entry_t* free_list; // Свободные записи (связь через next)
+    size_t pending;           // Записей в колесе
+} timer_wheel_t;
+
+// Вызывается для каждой сработавшей записи
+typedef void (*timer_wheel_fire_fn)(void* ctx, void (*function)(void*), void* arg);
+
+// Инициализация колеса, текущий тик — now
+void timer_wheel_init(timer_wheel_t* wheel, uint64_t now);
+
+// Освобождение памяти записей (оставшиеся записи не срабатывают)
+void timer_wheel_destroy(timer_wheel_t* wheel);
+
+// Добавление записи со сроком expires (в прошлом — срабатывает на ближайшем
+// тике); period > 0 — после срабатывания запись переставляется на
+// expires + period. Возвращает идентификатор или 0 при нехватке памяти.
+uint64_t timer_wheel_add(timer_wheel_t* wheel, uint64_t expires, uint64_t period,
+                         void (*function)(void*), void* arg);
+
+// Удаление записи. Возвращает true, если запись еще была в колесе.
+bool timer_wheel_cancel(timer_wheel_t* wheel, uint64_t id);
+
+// Продвижение колеса до тика now включительно: для сработавших записей
+// вызывается fire. Останавливается после max срабатываний (продолжить
+// можно следующим вызовом). Возвращает число срабатываний.
+size_t timer_wheel_advance(timer_wheel_t* wheel, uint64_t now, size_t max,
+                           timer_wheel_fire_fn fire, void* ctx);
+
+// Тик, к которому нужно вызвать timer_wheel_advance: ближайший срок на
+// уровне 0 или ближайший каскад верхнего уровня. UINT64_MAX — колесо пусто.
+uint64_t timer_wheel_next_tick(const timer_wheel_t* wheel);
+
+#endif // TIMER_WHEEL_H
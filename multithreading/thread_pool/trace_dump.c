@@ -0,0 +1,38 @@
+#include "thread_pool.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+// Преобразование двоичной трассы пула (thread_pool_trace_save) в JSON
+// формата Chrome trace для chrome://tracing или ui.perfetto.dev.
+// Запуск: ./trace_dump трасса [файл.json] (без второго аргумента — в stdout)
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Использование: %s трасса [файл.json]\n", argv[0]);
+        return 2;
+    }
+
+    FILE* in = fopen(argv[1], "rb");
+    if (!in) {
+        fprintf(stderr, "%s: %s\n", argv[1], strerror(errno));
+        return 1;
+    }
+    FILE* out = argc > 2 ? fopen(argv[2], "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "%s: %s\n", argv[2], strerror(errno));
+        fclose(in);
+        return 1;
+    }
+
+    int rc = thread_pool_trace_convert(in, out);
+    if (rc != 0) {
+        fprintf(stderr, "%s: %s\n", argv[1],
+                errno == EINVAL ? "не файл трассы пула" : strerror(errno));
+    }
+    fclose(in);
+    if (out != stdout && fclose(out) != 0) {
+        rc = -1;
+    }
+    return rc == 0 ? 0 : 1;
+}
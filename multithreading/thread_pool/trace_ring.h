@@ -0,0 +1,106 @@
+#ifndef TRACE_RING_H
+#define TRACE_RING_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Кольцо событий трассировки пула. У каждого потока (рабочего или
+// добавляющего задачи) свое кольцо, поэтому запись — без атомарных RMW
+// и без блокировок: событие пишется в слот head & mask, затем head
+// публикуется store-release. Заполненное кольцо перезаписывает самые
+// старые события, как бортовой самописец.
+//
+// Читатель копирует события, не останавливая писателя: он читает head
+// до и после копирования и отбрасывает события, которые писатель мог
+// успеть перезаписать за это время.
+
+// Типы событий
+#define TRACE_ENQUEUE 1       // Задача поставлена в очередь (arg — приоритет)
+#define TRACE_DEQUEUE 2       // Задача взята на выполнение (arg — TRACE_SOURCE_*)
+#define TRACE_START   3       // Начало выполнения задачи
+#define TRACE_END     4       // Конец выполнения задачи
+#define TRACE_PARK    5       // Поток уснул в ожидании работы
+#define TRACE_WAKE    6       // Поток проснулся
+
+// Откуда взята задача
+#define TRACE_SOURCE_GLOBAL 0 // Глобальная очередь
+#define TRACE_SOURCE_LOCAL  1 // Свой дек
+#define TRACE_SOURCE_STEAL  2 // Украдена из чужого дека
+
+typedef struct {
+    uint64_t time;            // Такты TSC или нс CLOCK_MONOTONIC_RAW
+    uint64_t task;            // Адрес узла задачи (узлы переиспользуются)
+    uint64_t function;        // Функция задачи
+    uint32_t type;            // TRACE_*
+    uint32_t arg;
+} trace_event_t;
+
+typedef struct trace_ring {
+    _Alignas(64) _Atomic uint64_t head; // Событий записано за все время
+    uint64_t mask;            // Емкость - 1 (емкость — степень двойки)
+    bool tsc;                 // Время в тактах TSC
+    int worker;               // Слот потока пула или -1 для внешнего потока
+    uint32_t tid;             // Поток ядра (для внешних потоков)
+    struct trace_ring* next;  // Список колец внешних потоков
+    _Alignas(64) trace_event_t events[];
+} trace_ring_t;
+
+// Трасса пула: кольца и точка отсчета времени
+typedef struct thread_pool_trace {
+    uint64_t id;              // Уникален в процессе (кэш колец потоков)
+    uint64_t capacity;        // Событий в каждом кольце
+    bool tsc;                 // Время в тактах TSC (инвариантный TSC)
+    uint64_t start_ticks;     // Момент начала в тактах часов колец
+    uint64_t start_ns;        // Он же по CLOCK_MONOTONIC_RAW
+    int num_workers;
+    trace_ring_t** worker_rings; // Кольцо на каждый слот потока пула
+    pthread_mutex_t lock;     // Защищает thread_rings
+    trace_ring_t* thread_rings; // Кольца внешних потоков
+} thread_pool_trace_t;
+
+static inline uint64_t trace_clock_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Время в единицах кольца: rdtsc — около десятка тактов без системного
+// вызова; без TSC — CLOCK_MONOTONIC_RAW через vDSO
+static inline uint64_t trace_clock(bool tsc) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (tsc) {
+        return __rdtsc();
+    }
+#else
+    (void)tsc;
+#endif
+    return trace_clock_ns();
+}
+
+// Запись события единственным писателем кольца
+static inline void trace_ring_record(trace_ring_t* ring, uint32_t type, const void* task,
+                                     void (*function)(void*), uint32_t arg) {
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    trace_event_t* event = &ring->events[head & ring->mask];
+    event->time = trace_clock(ring->tsc);
+    event->task = (uint64_t)(uintptr_t)task;
+    event->function = (uint64_t)(uintptr_t)function;
+    event->type = type;
+    event->arg = arg;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+// Кольцо внешнего потока для трассы (создается при первом событии).
+// Возвращает NULL, если не хватило памяти — событие тогда теряется.
+trace_ring_t* thread_pool_trace_thread_ring(thread_pool_trace_t* trace);
+
+// Освобождение трассы (потоки пула уже присоединены)
+void thread_pool_trace_free(thread_pool_trace_t* trace);
+
+#endif // TRACE_RING_H
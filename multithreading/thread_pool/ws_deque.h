@@ -0,0 +1,101 @@
+#ifndef WS_DEQUE_H
+#define WS_DEQUE_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+// Дек Чейза-Лева (Chase-Lev) фиксированной емкости для work-stealing.
+// Владелец кладет и забирает задачи с "низа" без блокировок,
+// остальные потоки крадут с "верха" через CAS.
+// Реализация по статье Lê, Pop, Cohen, Zappa Nardelli (PPoPP 2013).
+
+#define WS_DEQUE_CAPACITY 1024  // Степень двойки
+#define WS_DEQUE_MASK (WS_DEQUE_CAPACITY - 1)
+
+#define WS_DEQUE_OK 0
+#define WS_DEQUE_EMPTY 1
+#define WS_DEQUE_ABORT 2  // Проиграли гонку другому вору, можно повторить
+
+typedef struct {
+    _Alignas(64) atomic_long top;     // Изменяется ворами
+    _Alignas(64) atomic_long bottom;  // Изменяется только владельцем
+    _Alignas(64) _Atomic(void*) buffer[WS_DEQUE_CAPACITY];
+} ws_deque_t;
+
+static inline void ws_deque_init(ws_deque_t* d) {
+    atomic_init(&d->top, 0);
+    atomic_init(&d->bottom, 0);
+    for (size_t i = 0; i < WS_DEQUE_CAPACITY; i++) {
+        atomic_init(&d->buffer[i], NULL);
+    }
+}
+
+// Добавление элемента владельцем. Возвращает -1, если дек заполнен.
+static inline int ws_deque_push(ws_deque_t* d, void* item) {
+    long b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    long t = atomic_load_explicit(&d->top, memory_order_acquire);
+
+    if (b - t >= WS_DEQUE_CAPACITY) {
+        return -1;
+    }
+
+    atomic_store_explicit(&d->buffer[b & WS_DEQUE_MASK], item, memory_order_relaxed);
+    atomic_store_explicit(&d->bottom, b + 1, memory_order_release);
+    return 0;
+}
+
+// Извлечение элемента владельцем (LIFO). Возвращает NULL, если дек пуст.
+static inline void* ws_deque_pop(ws_deque_t* d) {
+    long b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long t = atomic_load_explicit(&d->top, memory_order_relaxed);
+
+    void* item = NULL;
+    if (t <= b) {
+        item = atomic_load_explicit(&d->buffer[b & WS_DEQUE_MASK], memory_order_relaxed);
+        if (t == b) {
+            // Последний элемент: соревнуемся с ворами
+            if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1,
+                                                         memory_order_seq_cst,
+                                                         memory_order_relaxed)) {
+                item = NULL;
+            }
+            atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        }
+    } else {
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+    }
+
+    return item;
+}
+
+// Кража элемента другим потоком (FIFO)
+static inline int ws_deque_steal(ws_deque_t* d, void** item) {
+    long t = atomic_load_explicit(&d->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+
+    if (t >= b) {
+        return WS_DEQUE_EMPTY;
+    }
+
+    void* value = atomic_load_explicit(&d->buffer[t & WS_DEQUE_MASK], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1,
+                                                 memory_order_seq_cst,
+                                                 memory_order_relaxed)) {
+        return WS_DEQUE_ABORT;
+    }
+
+    *item = value;
+    return WS_DEQUE_OK;
+}
+
+// Приблизительный размер (точен только для владельца)
+static inline long ws_deque_size(ws_deque_t* d) {
+    long b = atomic_load_explicit(&d->bottom, memory_order_seq_cst);
+    long t = atomic_load_explicit(&d->top, memory_order_seq_cst);
+    return b > t ? b - t : 0;
+}
+
+#endif // WS_DEQUE_H
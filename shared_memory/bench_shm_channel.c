@@ -0,0 +1,213 @@
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "shm_channel.h"
+
+// Канал в разделяемой памяти против pipe между двумя процессами:
+// пропускная способность для записей разного размера и задержка
+// пинг-понга (половина времени обмена туда-обратно).
+
+#define CHANNEL_CAPACITY (1024 * 1024)
+#define PING_PONG_ROUNDS 20000
+#define PING_SIZE 64
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void read_full(int fd, void* buf, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = read(fd, (char*)buf + done, size - done);
+        if (n <= 0) {
+            perror("read");
+            exit(1);
+        }
+        done += (size_t)n;
+    }
+}
+
+static void write_full(int fd, const void* buf, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = write(fd, (const char*)buf + done, size - done);
+        if (n <= 0) {
+            perror("write");
+            exit(1);
+        }
+        done += (size_t)n;
+    }
+}
+
+// Создание канала, имя которого сразу удаляется: отображение
+// наследуется дочерним процессом через fork
+static int channel_create_anon(shm_channel_t* ch, const char* name) {
+    shm_channel_unlink(name);
+    if (shm_channel_create(ch, name, CHANNEL_CAPACITY) != 0) {
+        perror("shm_channel_create");
+        return -1;
+    }
+    shm_channel_unlink(name);
+    return 0;
+}
+
+static void pipe_create(int fds[2]) {
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        exit(1);
+    }
+    // Буфер pipe того же размера, что и кольцо канала (если позволяет система)
+    fcntl(fds[1], F_SETPIPE_SZ, CHANNEL_CAPACITY);
+}
+
+// Пропускная способность канала, МБ/с
+static double shm_throughput(size_t size, long count) {
+    shm_channel_t ch;
+    if (channel_create_anon(&ch, "/bench_shm_channel") != 0) return -1;
+
+    char* buf = malloc(size);
+    memset(buf, 'x', size);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        for (long i = 0; i < count; i++) {
+            if (shm_channel_recv(&ch, buf, size) != (ssize_t)size) _exit(1);
+        }
+        _exit(0);
+    }
+
+    double start = now_sec();
+    for (long i = 0; i < count; i++) {
+        shm_channel_send(&ch, buf, size);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    double elapsed = now_sec() - start;
+
+    shm_channel_detach(&ch);
+    free(buf);
+    return (double)size * count / elapsed / 1e6;
+}
+
+// Пропускная способность pipe, МБ/с
+static double pipe_throughput(size_t size, long count) {
+    int fds[2];
+    pipe_create(fds);
+
+    char* buf = malloc(size);
+    memset(buf, 'x', size);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[1]);
+        for (long i = 0; i < count; i++) {
+            read_full(fds[0], buf, size);
+        }
+        _exit(0);
+    }
+    close(fds[0]);
+
+    double start = now_sec();
+    for (long i = 0; i < count; i++) {
+        write_full(fds[1], buf, size);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    double elapsed = now_sec() - start;
+
+    close(fds[1]);
+    free(buf);
+    return (double)size * count / elapsed / 1e6;
+}
+
+// Задержка в одну сторону через пару каналов, мкс
+static double shm_latency(void) {
+    shm_channel_t ping, pong;
+    if (channel_create_anon(&ping, "/bench_shm_ping") != 0) return -1;
+    if (channel_create_anon(&pong, "/bench_shm_pong") != 0) return -1;
+
+    char buf[PING_SIZE] = {0};
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        for (int i = 0; i < PING_PONG_ROUNDS; i++) {
+            shm_channel_recv(&ping, buf, sizeof(buf));
+            shm_channel_send(&pong, buf, sizeof(buf));
+        }
+        _exit(0);
+    }
+
+    double start = now_sec();
+    for (int i = 0; i < PING_PONG_ROUNDS; i++) {
+        shm_channel_send(&ping, buf, sizeof(buf));
+        shm_channel_recv(&pong, buf, sizeof(buf));
+    }
+    double elapsed = now_sec() - start;
+
+    int status;
+    waitpid(pid, &status, 0);
+    shm_channel_detach(&ping);
+    shm_channel_detach(&pong);
+    return elapsed / PING_PONG_ROUNDS / 2 * 1e6;
+}
+
+// Задержка в одну сторону через пару pipe, мкс
+static double pipe_latency(void) {
+    int ping[2], pong[2];
+    pipe_create(ping);
+    pipe_create(pong);
+
+    char buf[PING_SIZE] = {0};
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        for (int i = 0; i < PING_PONG_ROUNDS; i++) {
+            read_full(ping[0], buf, sizeof(buf));
+            write_full(pong[1], buf, sizeof(buf));
+        }
+        _exit(0);
+    }
+
+    double start = now_sec();
+    for (int i = 0; i < PING_PONG_ROUNDS; i++) {
+        write_full(ping[1], buf, sizeof(buf));
+        read_full(pong[0], buf, sizeof(buf));
+    }
+    double elapsed = now_sec() - start;
+
+    int status;
+    waitpid(pid, &status, 0);
+    close(ping[0]);
+    close(ping[1]);
+    close(pong[0]);
+    close(pong[1]);
+    return elapsed / PING_PONG_ROUNDS / 2 * 1e6;
+}
+
+int main(void) {
+    const struct {
+        size_t size;
+        long count;
+    } cases[] = {{64, 1000000}, {1024, 200000}, {16384, 20000}};
+
+    printf("Пропускная способность (кольцо и буфер pipe по %d КиБ):\n", CHANNEL_CAPACITY / 1024);
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        double shm = shm_throughput(cases[i].size, cases[i].count);
+        double pip = pipe_throughput(cases[i].size, cases[i].count);
+        printf("  запись %5zu байт: shm_channel %8.1f МБ/с, pipe %8.1f МБ/с (x%.2f)\n",
+               cases[i].size, shm, pip, shm / pip);
+    }
+
+    double shm = shm_latency();
+    double pip = pipe_latency();
+    printf("Задержка в одну сторону (%d байт): shm_channel %.2f мкс, pipe %.2f мкс\n",
+           PING_SIZE, shm, pip);
+    return 0;
+}
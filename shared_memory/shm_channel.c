@@ -0,0 +1,314 @@
+#include "shm_channel.h"
+#include "../common/futex.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Заголовок записи в области данных
+typedef struct {
+    uint32_t len;
+    uint32_t reserved;
+} shm_record_t;
+
+#define SHM_RECORD_ALIGN 8
+#define SHM_RECORD_PAD UINT32_MAX  // Заглушка до конца кольца
+
+// Область данных начинается сразу после заголовка, выровненного по кэш-линии
+#define SHM_CHANNEL_DATA_OFFSET \
+    ((sizeof(shm_channel_header_t) + SHM_CHANNEL_CACHE_LINE - 1) & \
+     ~(size_t)(SHM_CHANNEL_CACHE_LINE - 1))
+
+static inline uint64_t record_size(size_t len) {
+    return sizeof(shm_record_t) + ((len + SHM_RECORD_ALIGN - 1) & ~(uint64_t)(SHM_RECORD_ALIGN - 1));
+}
+
+static inline shm_record_t* record_at(shm_channel_t* ch, uint64_t pos) {
+    return (shm_record_t*)(ch->data + (pos & ch->mask));
+}
+
+static void shm_channel_attach(shm_channel_t* ch, void* addr, size_t map_size, int fd) {
+    ch->hdr = (shm_channel_header_t*)addr;
+    ch->data = (unsigned char*)addr + SHM_CHANNEL_DATA_OFFSET;
+    ch->map_size = map_size;
+    ch->mask = ch->hdr->capacity - 1;
+    ch->fd = fd;
+
+    ch->head = atomic_load_explicit(&ch->hdr->head, memory_order_acquire);
+    ch->tail = atomic_load_explicit(&ch->hdr->tail, memory_order_acquire);
+    ch->tail_cache = ch->tail;
+    ch->head_cache = ch->head;
+    ch->reserved_head = ch->head;
+    ch->reserved = 0;
+    ch->current = 0;
+}
+
+int shm_channel_create(shm_channel_t* ch, const char* name, size_t capacity) {
+    if (!ch || !name || capacity > (SIZE_MAX >> 2)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    size_t cap = SHM_CHANNEL_MIN_CAPACITY;
+    while (cap < capacity) {
+        cap <<= 1;
+    }
+    size_t map_size = SHM_CHANNEL_DATA_OFFSET + cap;
+
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0666);
+    if (fd < 0) {
+        return -1;
+    }
+
+    // ftruncate заполняет сегмент нулями: индексы и слова futex уже 0
+    if (ftruncate(fd, (off_t)map_size) != 0) {
+        int saved = errno;
+        close(fd);
+        shm_unlink(name);
+        errno = saved;
+        return -1;
+    }
+
+    void* addr = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        int saved = errno;
+        close(fd);
+        shm_unlink(name);
+        errno = saved;
+        return -1;
+    }
+
+    shm_channel_header_t* hdr = (shm_channel_header_t*)addr;
+    hdr->capacity = cap;
+    hdr->record_align = SHM_RECORD_ALIGN;
+    atomic_store_explicit(&hdr->magic, SHM_CHANNEL_MAGIC, memory_order_release);
+
+    shm_channel_attach(ch, addr, map_size, fd);
+    return 0;
+}
+
+int shm_channel_open(shm_channel_t* ch, const char* name) {
+    if (!ch || !name) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    // Писатель мог создать сегмент, но еще не задать размер
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < SHM_CHANNEL_DATA_OFFSET) {
+        close(fd);
+        errno = ENOENT;
+        return -1;
+    }
+
+    size_t map_size = (size_t)st.st_size;
+    void* addr = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+
+    shm_channel_header_t* hdr = (shm_channel_header_t*)addr;
+    if (atomic_load_explicit(&hdr->magic, memory_order_acquire) != SHM_CHANNEL_MAGIC ||
+        hdr->record_align != SHM_RECORD_ALIGN ||
+        SHM_CHANNEL_DATA_OFFSET + hdr->capacity > map_size) {
+        munmap(addr, map_size);
+        close(fd);
+        errno = ENOENT;
+        return -1;
+    }
+
+    shm_channel_attach(ch, addr, map_size, fd);
+    return 0;
+}
+
+void shm_channel_detach(shm_channel_t* ch) {
+    if (!ch || !ch->hdr) return;
+    munmap(ch->hdr, ch->map_size);
+    close(ch->fd);
+    ch->hdr = NULL;
+    ch->data = NULL;
+}
+
+int shm_channel_unlink(const char* name) {
+    return shm_unlink(name);
+}
+
+size_t shm_channel_max_record(const shm_channel_t* ch) {
+    // Запись вместе с возможной заглушкой перед ней должна уложиться в кольцо
+    return (size_t)((ch->mask + 1) / 2 - sizeof(shm_record_t));
+}
+
+// Разбудить другую сторону, если она спит на event. Барьер упорядочивает
+// публикацию индекса перед проверкой флага, парный барьер — в ожидании.
+static void shm_channel_notify(_Atomic uint32_t* event, _Atomic uint32_t* sleeping) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(sleeping, memory_order_relaxed) &&
+        atomic_exchange_explicit(sleeping, 0, memory_order_relaxed)) {
+        atomic_fetch_add_explicit(event, 1, memory_order_release);
+        futex_wake(event, 1, true);
+    }
+}
+
+// Писатель: свободно ли total байт, с обновлением кэша позиции читателя
+static bool shm_channel_has_space(shm_channel_t* ch, uint64_t total) {
+    ch->tail_cache = atomic_load_explicit(&ch->hdr->tail, memory_order_acquire);
+    return ch->mask + 1 - (ch->head - ch->tail_cache) >= total;
+}
+
+static void shm_channel_wait_space(shm_channel_t* ch, uint64_t total) {
+    shm_channel_header_t* hdr = ch->hdr;
+
+    // Номер события читаем до флага: если читатель успеет сбросить флаг,
+    // он же изменит space_event, и futex_wait сразу вернется
+    uint32_t seen = atomic_load_explicit(&hdr->space_event, memory_order_acquire);
+    atomic_store_explicit(&hdr->producer_sleeping, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    if (!shm_channel_has_space(ch, total)) {
+        futex_wait(&hdr->space_event, seen, NULL, true);
+    }
+}
+
+void* shm_channel_reserve(shm_channel_t* ch, size_t len) {
+    if (len > shm_channel_max_record(ch)) {
+        errno = EMSGSIZE;
+        return NULL;
+    }
+
+    uint64_t need = record_size(len);
+    uint64_t contiguous = ch->mask + 1 - (ch->head & ch->mask);
+    uint64_t total = contiguous < need ? contiguous + need : need;
+
+    while (ch->mask + 1 - (ch->head - ch->tail_cache) < total) {
+        if (shm_channel_has_space(ch, total)) break;
+        shm_channel_wait_space(ch, total);
+    }
+
+    // Запись не помещается до конца кольца: остаток занимает заглушка,
+    // которую читатель пропустит
+    ch->reserved_head = ch->head;
+    if (contiguous < need) {
+        record_at(ch, ch->head)->len = SHM_RECORD_PAD;
+        ch->reserved_head += contiguous;
+    }
+    ch->reserved = len;
+
+    return record_at(ch, ch->reserved_head) + 1;
+}
+
+void shm_channel_commit(shm_channel_t* ch, size_t len) {
+    if (len > ch->reserved) {
+        len = ch->reserved;
+    }
+
+    record_at(ch, ch->reserved_head)->len = (uint32_t)len;
+    ch->head = ch->reserved_head + record_size(len);
+    ch->reserved = 0;
+
+    atomic_store_explicit(&ch->hdr->head, ch->head, memory_order_release);
+    shm_channel_notify(&ch->hdr->data_event, &ch->hdr->consumer_sleeping);
+}
+
+int shm_channel_send(shm_channel_t* ch, const void* data, size_t len) {
+    void* dst = shm_channel_reserve(ch, len);
+    if (!dst) {
+        return -1;
+    }
+    memcpy(dst, data, len);
+    shm_channel_commit(ch, len);
+    return 0;
+}
+
+void shm_channel_close(shm_channel_t* ch) {
+    atomic_store_explicit(&ch->hdr->closed, 1, memory_order_release);
+    shm_channel_notify(&ch->hdr->data_event, &ch->hdr->consumer_sleeping);
+}
+
+void shm_channel_drain(shm_channel_t* ch) {
+    // Все прочитано, когда свободно все кольцо
+    while (!shm_channel_has_space(ch, ch->mask + 1)) {
+        shm_channel_wait_space(ch, ch->mask + 1);
+    }
+}
+
+// Читатель: есть ли непрочитанные данные, с обновлением кэша позиции писателя
+static bool shm_channel_has_data(shm_channel_t* ch) {
+    ch->head_cache = atomic_load_explicit(&ch->hdr->head, memory_order_acquire);
+    return ch->head_cache != ch->tail;
+}
+
+static void shm_channel_wait_data(shm_channel_t* ch) {
+    shm_channel_header_t* hdr = ch->hdr;
+
+    uint32_t seen = atomic_load_explicit(&hdr->data_event, memory_order_acquire);
+    atomic_store_explicit(&hdr->consumer_sleeping, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    if (!shm_channel_has_data(ch) &&
+        !atomic_load_explicit(&hdr->closed, memory_order_acquire)) {
+        futex_wait(&hdr->data_event, seen, NULL, true);
+    }
+}
+
+const void* shm_channel_peek(shm_channel_t* ch, size_t* len) {
+    for (;;) {
+        if (ch->tail == ch->head_cache && !shm_channel_has_data(ch)) {
+            if (atomic_load_explicit(&ch->hdr->closed, memory_order_acquire)) {
+                // Последняя запись могла быть опубликована перед закрытием
+                if (!shm_channel_has_data(ch)) {
+                    return NULL;
+                }
+                continue;
+            }
+            shm_channel_wait_data(ch);
+            continue;
+        }
+
+        shm_record_t* rec = record_at(ch, ch->tail);
+        if (rec->len == SHM_RECORD_PAD) {
+            ch->tail += ch->mask + 1 - (ch->tail & ch->mask);
+            continue;
+        }
+
+        ch->current = record_size(rec->len);
+        if (len) *len = rec->len;
+        return rec + 1;
+    }
+}
+
+void shm_channel_release(shm_channel_t* ch) {
+    if (ch->current == 0) return;
+
+    ch->tail += ch->current;
+    ch->current = 0;
+
+    atomic_store_explicit(&ch->hdr->tail, ch->tail, memory_order_release);
+    shm_channel_notify(&ch->hdr->space_event, &ch->hdr->producer_sleeping);
+}
+
+ssize_t shm_channel_recv(shm_channel_t* ch, void* buf, size_t buf_size) {
+    size_t len;
+    const void* rec = shm_channel_peek(ch, &len);
+    if (!rec) {
+        return 0;
+    }
+    if (len > buf_size) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    memcpy(buf, rec, len);
+    shm_channel_release(ch);
+    return (ssize_t)len;
+}
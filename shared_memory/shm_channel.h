@@ -0,0 +1,110 @@
+#ifndef SHM_CHANNEL_H
+#define SHM_CHANNEL_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+// Канал записей переменной длины в разделяемой памяти POSIX между двумя
+// процессами: один писатель и один читатель.
+//
+// Сегмент начинается с заголовка, за которым идет кольцевая область
+// данных. Позиция записи (head) и позиция чтения (tail) — монотонные
+// счетчики байт на разных кэш-линиях. Запись — 8-байтовый заголовок с
+// длиной и данные, выровненные по 8 байт; запись никогда не разрывается
+// концом кольца, вместо этого остаток кольца помечается заглушкой.
+//
+// Ожидание данных и свободного места — futex на словах в самом сегменте,
+// без активного ожидания и таймеров.
+
+#define SHM_CHANNEL_MAGIC 0x53484d43u  // "SHMC"
+#define SHM_CHANNEL_CACHE_LINE 64
+#define SHM_CHANNEL_MIN_CAPACITY 4096
+
+typedef struct {
+    _Atomic uint32_t magic;  // Записывается последним: сегмент готов
+    uint32_t record_align;
+    uint64_t capacity;    // Размер области данных, степень двойки
+
+    // Сторона писателя
+    _Alignas(SHM_CHANNEL_CACHE_LINE) _Atomic uint64_t head;
+    _Atomic uint32_t data_event;        // futex: появились данные
+    _Atomic uint32_t consumer_sleeping;
+    _Atomic uint32_t closed;            // Писатель больше ничего не отправит
+
+    // Сторона читателя
+    _Alignas(SHM_CHANNEL_CACHE_LINE) _Atomic uint64_t tail;
+    _Atomic uint32_t space_event;       // futex: освободилось место
+    _Atomic uint32_t producer_sleeping;
+} shm_channel_header_t;
+
+// Отображение канала в адресное пространство процесса
+typedef struct {
+    shm_channel_header_t* hdr;
+    unsigned char* data;
+    size_t map_size;
+    uint64_t mask;
+    int fd;
+
+    // Локальное состояние писателя
+    uint64_t head;
+    uint64_t tail_cache;
+    uint64_t reserved_head;
+    size_t reserved;
+
+    // Локальное состояние читателя
+    uint64_t tail;
+    uint64_t head_cache;
+    size_t current;
+} shm_channel_t;
+
+// Создание сегмента name с областью данных не меньше capacity байт
+// (округляется вверх до степени двойки). Вызывает писатель.
+// Возвращает 0 или -1 с errno.
+int shm_channel_create(shm_channel_t* ch, const char* name, size_t capacity);
+
+// Подключение к существующему сегменту. Если сегмент еще не создан
+// или не инициализирован, возвращает -1 с errno = ENOENT.
+int shm_channel_open(shm_channel_t* ch, const char* name);
+
+// Отключение от сегмента (munmap и close); сегмент остается
+void shm_channel_detach(shm_channel_t* ch);
+
+// Удаление имени сегмента
+int shm_channel_unlink(const char* name);
+
+// Максимальная длина одной записи
+size_t shm_channel_max_record(const shm_channel_t* ch);
+
+// Писатель: место под запись длиной до len байт прямо в сегменте.
+// Ждет, пока читатель освободит место. NULL с errno = EMSGSIZE,
+// если запись не поместится в канал.
+void* shm_channel_reserve(shm_channel_t* ch, size_t len);
+
+// Писатель: публикация зарезервированной записи фактической длины len
+void shm_channel_commit(shm_channel_t* ch, size_t len);
+
+// Писатель: копирование и публикация записи
+int shm_channel_send(shm_channel_t* ch, const void* data, size_t len);
+
+// Писатель: больше записей не будет
+void shm_channel_close(shm_channel_t* ch);
+
+// Писатель: ожидание, пока читатель заберет все записи
+void shm_channel_drain(shm_channel_t* ch);
+
+// Читатель: следующая запись без копирования. Ждет появления записи;
+// NULL, если писатель закрыл канал и записей больше нет.
+const void* shm_channel_peek(shm_channel_t* ch, size_t* len);
+
+// Читатель: освобождение записи, полученной через shm_channel_peek
+void shm_channel_release(shm_channel_t* ch);
+
+// Читатель: копирование следующей записи в buf. Возвращает длину,
+// 0 после закрытия канала (пустую запись так не отличить от конца —
+// для нее нужен shm_channel_peek) или -1 с errno = EMSGSIZE, если буфер
+// мал (запись при этом остается в канале).
+ssize_t shm_channel_recv(shm_channel_t* ch, void* buf, size_t buf_size);
+
+#endif // SHM_CHANNEL_H
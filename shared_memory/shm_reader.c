@@ -0,0 +1,42 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include "shm_channel.h"
+
+// Читатель: выводит записи из канала в разделяемой памяти, пока
+// писатель не закроет канал.
+
+int main() {
+    const char* name = "/my_shared_memory";
+    shm_channel_t ch;
+
+    // Подключение: сегмент создает писатель. Ожидание здесь только при
+    // запуске — дальше данные и место ждутся на futex в сегменте.
+    while (shm_channel_open(&ch, name) != 0) {
+        if (errno != ENOENT) {
+            perror("shm_channel_open");
+            return 1;
+        }
+        printf("Ждем, пока писатель создаст %s...\n", name);
+        sleep(1);
+    }
+
+    printf("Подключились к каналу %s\n", name);
+
+    int count = 0;
+    size_t len;
+    const char* record;
+
+    // Запись читается прямо из разделяемой памяти, затем освобождается
+    while ((record = shm_channel_peek(&ch, &len)) != NULL) {
+        printf("Прочитано (%zu байт): %s\n", len, record);
+        shm_channel_release(&ch);
+        count++;
+    }
+
+    printf("Писатель закрыл канал, всего прочитано %d записей\n", count);
+
+    shm_channel_detach(&ch);
+    return 0;
+}
@@ -1,33 +1,57 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <fcntl.h>
-#include <sys/shm.h>
-#include <sys/stat.h>
-#include <sys/mman.h>
+#include <errno.h>
 #include <unistd.h>
+#include "shm_channel.h"
 
-int main() {
+// Писатель: отправляет записи разной длины через канал в разделяемой
+// памяти. Запуск: ./shm_writer [число_записей] [размер_сегмента_байт]
+// Читатель (shm_reader) может быть запущен до или после писателя.
+
+int main(int argc, char* argv[]) {
     const char* name = "/my_shared_memory";
-    const int SIZE = 4096;
-    
-    // Создание сегмента разделяемой памяти
-    int shm_fd = shm_open(name, O_CREAT | O_RDWR, 0666);
-    ftruncate(shm_fd, SIZE);
-    
-    // Отображение в адресное пространство процесса
-    char* ptr = mmap(0, SIZE, PROT_WRITE, MAP_SHARED, shm_fd, 0);
-    
-    // Запись данных
-    sprintf(ptr, "Привет из процесса-писателя! PID: %d", getpid());
-    
-    printf("Данные записаны в разделяемую память\n");
-    
-    // Пауза для чтения другим процессом
-    sleep(10);
-    
+    int count = argc > 1 ? atoi(argv[1]) : 20;
+    size_t size = argc > 2 ? strtoul(argv[2], NULL, 0) : 64 * 1024;
+
+    // Сегмент от прошлого запуска мог остаться, если писатель был убит
+    shm_channel_unlink(name);
+
+    // Создание сегмента разделяемой памяти с каналом
+    shm_channel_t ch;
+    if (shm_channel_create(&ch, name, size) != 0) {
+        perror("shm_channel_create");
+        return 1;
+    }
+
+    printf("Канал %s создан, область данных %zu байт, запись до %zu байт\n",
+           name, (size_t)ch.hdr->capacity, shm_channel_max_record(&ch));
+
+    for (int i = 0; i < count; i++) {
+        // Запись формируется прямо в разделяемой памяти, без копирования
+        size_t max_len = 256;
+        char* ptr = shm_channel_reserve(&ch, max_len);
+        if (!ptr) {
+            perror("shm_channel_reserve");
+            break;
+        }
+
+        int len = snprintf(ptr, max_len, "Привет из процесса-писателя! PID: %d, запись %d%.*s",
+                           getpid(), i, i % 16, "................");
+        shm_channel_commit(&ch, (size_t)len + 1);
+    }
+
+    printf("Записано %d записей, ждем, пока читатель их заберет...\n", count);
+
+    // Пустых ожиданий нет: писатель спит на futex, пока читатель не освободит кольцо
+    shm_channel_close(&ch);
+    shm_channel_drain(&ch);
+
+    printf("Все записи прочитаны\n");
+
     // Удаление разделяемой памяти
-    shm_unlink(name);
-    
+    shm_channel_detach(&ch);
+    shm_channel_unlink(name);
+
     return 0;
 }